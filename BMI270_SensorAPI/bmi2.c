@@ -1914,8 +1914,13 @@ int8_t bmi2_sec_init(struct bmi2_dev *dev)
 
             if (rslt == BMI2_OK)
             {
+                /* Storing the chip-id value read from
+                 * the register to identify the sensor
+                 */
+                dev->chip_id = chip_id;
+
                 /* Validate chip-id */
-                if (chip_id == dev->chip_id)
+                if (chip_id == dev->variant->chip_id)
                 {
                     /* Assign resolution to the structure */
                     dev->resolution = 16;
@@ -1935,10 +1940,6 @@ int8_t bmi2_sec_init(struct bmi2_dev *dev)
                 }
                 else
                 {
-                    /* Storing the chip-id value read from
-                     * the register to identify the sensor
-                     */
-                    dev->chip_id = chip_id;
                     rslt = BMI2_E_DEV_NOT_FOUND;
                 }
             }
@@ -1964,12 +1965,17 @@ int8_t bmi2_get_regs(uint8_t reg_addr, uint8_t *data, uint16_t len, struct bmi2_
     /* Variable to define loop */
     uint16_t index = 0;
 
-    /* Variable to define temporary buffer */
-    uint8_t temp_buf[BMI2_MAX_LEN];
+    /* Variable to define temporary buffer, from the scratch arena */
+    uint8_t *temp_buf = NULL;
 
     /* Null-pointer check */
     rslt = null_ptr_check(dev);
     if ((rslt == BMI2_OK) && (data != NULL))
+    {
+        temp_buf = bmi2_scratch_alloc(len + dev->dummy_byte, dev);
+    }
+
+    if (temp_buf != NULL)
     {
         /* Configuring reg_addr for SPI Interface */
         if (dev->intf == BMI2_SPI_INTF)
@@ -2001,6 +2007,12 @@ int8_t bmi2_get_regs(uint8_t reg_addr, uint8_t *data, uint16_t len, struct bmi2_
         {
             rslt = BMI2_E_COM_FAIL;
         }
+
+        bmi2_scratch_free(temp_buf, dev);
+    }
+    else if ((rslt == BMI2_OK) && (data != NULL))
+    {
+        rslt = BMI2_E_SCRATCH;
     }
     else
     {
@@ -2229,7 +2241,7 @@ int8_t bmi2_write_config_file(struct bmi2_dev *dev)
 
     /* Null-pointer check */
     rslt = null_ptr_check(dev);
-    if ((rslt == BMI2_OK) && (dev->config_size != 0))
+    if ((rslt == BMI2_OK) && (dev->variant != NULL) && (dev->variant->config_size != 0))
     {
         /* Bytes written are multiples of 2 */
         if ((dev->read_write_len % 2) != 0)
@@ -2952,7 +2964,7 @@ int8_t bmi2_set_fifo_config(uint16_t config, uint8_t enable, struct bmi2_dev *de
             if (enable == BMI2_ENABLE)
             {
                 data[1] = data[1] | fifo_config_1;
-                if (dev->variant_feature & BMI2_CRT_RTOSK_ENABLE)
+                if (dev->variant->variant_feature & BMI2_CRT_RTOSK_ENABLE)
                 {
                     /* Burst length is needed for CRT
                      *  FIFO enable will reset the default values
@@ -5181,7 +5193,7 @@ int8_t bmi2_get_gyro_cross_sense(struct bmi2_dev *dev)
     struct bmi2_feat_sensor_data data;
 
     /* Check if the feature is supported by this variant */
-    if (dev->variant_feature & BMI2_GYRO_CROSS_SENS_ENABLE)
+    if (dev->variant->variant_feature & BMI2_GYRO_CROSS_SENS_ENABLE)
     {
         rslt = null_ptr_check(dev);
         if (rslt == BMI2_OK)
@@ -5321,8 +5333,8 @@ int8_t bmi2_perform_gyro_foc(struct bmi2_dev *dev)
     /* Variable to store status of gyroscope enable */
     uint8_t gyr_en = 0;
 
-    /* Array of structure to store gyroscope data */
-    struct bmi2_sens_axes_data gyr_value[128];
+    /* Structure to store gyroscope data; each sample is summed as it's read, so one will do */
+    struct bmi2_sens_axes_data gyr_value = { 0, 0, 0, 0 };
 
     /* Structure to store gyroscope data temporarily */
     struct bmi2_foc_temp_value temp = { 0, 0, 0 };
@@ -5365,13 +5377,13 @@ int8_t bmi2_perform_gyro_foc(struct bmi2_dev *dev)
                 /* Read 128 samples of gyroscope data on data ready interrupt */
                 if ((rslt == BMI2_OK) && (reg_status & BMI2_DRDY_GYR))
                 {
-                    rslt = read_gyro_xyz(&gyr_value[loop], dev);
+                    rslt = read_gyro_xyz(&gyr_value, dev);
                     if (rslt == BMI2_OK)
                     {
                         /* Store the data in a temporary structure */
-                        temp.x = temp.x + (int32_t)gyr_value[loop].x;
-                        temp.y = temp.y + (int32_t)gyr_value[loop].y;
-                        temp.z = temp.z + (int32_t)gyr_value[loop].z;
+                        temp.x = temp.x + (int32_t)gyr_value.x;
+                        temp.y = temp.y + (int32_t)gyr_value.y;
+                        temp.z = temp.z + (int32_t)gyr_value.z;
                     }
                 }
 
@@ -5456,7 +5468,7 @@ int8_t bmi2_get_feat_config(uint8_t sw_page, uint8_t *feat_config, struct bmi2_d
     else
     {
         /* Check whether the page is valid */
-        if (sw_page < dev->page_max)
+        if (sw_page < dev->variant->page_max)
         {
             /* Switch page */
             rslt = bmi2_set_regs(BMI2_FEAT_PAGE_ADDR, &sw_page, 1, dev);
@@ -5519,6 +5531,49 @@ int8_t bmi2_get_feat_config(uint8_t sw_page, uint8_t *feat_config, struct bmi2_d
     return rslt;
 }
 
+/*!
+ * @brief This API takes a zeroed buffer from the device's scratch arena.
+ */
+void *bmi2_scratch_alloc(uint16_t size, struct bmi2_dev *dev)
+{
+    /* Buffer to return */
+    uint8_t *buf = NULL;
+
+    /* Variable to define loop */
+    uint16_t index;
+
+    /* Round up so that every buffer stays aligned for the widest type put in one */
+    size = (uint16_t)((size + 3) & ~3U);
+
+    if ((dev != NULL) && (dev->scratch != NULL) && (size <= (dev->scratch->size - dev->scratch->used)))
+    {
+        buf = &dev->scratch->buf[dev->scratch->used];
+        dev->scratch->used += size;
+        if (dev->scratch->used > dev->scratch->peak)
+        {
+            dev->scratch->peak = dev->scratch->used;
+        }
+
+        for (index = 0; index < size; index++)
+        {
+            buf[index] = 0;
+        }
+    }
+
+    return buf;
+}
+
+/*!
+ * @brief This API gives a buffer from bmi2_scratch_alloc() back to the arena.
+ */
+void bmi2_scratch_free(const void *buf, struct bmi2_dev *dev)
+{
+    if ((buf != NULL) && (dev != NULL) && (dev->scratch != NULL))
+    {
+        dev->scratch->used = (uint16_t)((const uint8_t *)buf - dev->scratch->buf);
+    }
+}
+
 /*!
  * @brief This API is used to extract the input feature configuration
  * details from the look-up table.
@@ -5533,11 +5588,11 @@ uint8_t bmi2_extract_input_feat_config(struct bmi2_feature_config *feat_config,
     uint8_t feat_found = BMI2_FALSE;
 
     /* Search for the input feature from the input configuration array */
-    while (loop < dev->input_sens)
+    while (loop < dev->variant->input_sens)
     {
-        if (dev->feat_config[loop].type == type)
+        if (dev->variant->feat_config[loop].type == type)
         {
-            *feat_config = dev->feat_config[loop];
+            *feat_config = dev->variant->feat_config[loop];
             feat_found = BMI2_TRUE;
             break;
         }
@@ -5571,7 +5626,7 @@ static int8_t write_config_file(struct bmi2_dev *dev)
     uint16_t index = 0;
 
     /* config file size */
-    uint16_t config_size = dev->config_size;
+    uint16_t config_size = dev->variant->config_size;
 
     /* Variable to get the remainder */
     uint8_t remain = (uint8_t)(config_size % dev->read_write_len);
@@ -5595,7 +5650,7 @@ static int8_t write_config_file(struct bmi2_dev *dev)
                 /* Write the configuration file */
                 for (index = 0; (index < config_size) && (rslt == BMI2_OK); index += dev->read_write_len)
                 {
-                    rslt = upload_file((dev->config_file_ptr + index), index, dev->read_write_len, dev);
+                    rslt = upload_file((dev->variant->config_file_ptr + index), index, dev->read_write_len, dev);
                 }
             }
             else
@@ -5606,7 +5661,7 @@ static int8_t write_config_file(struct bmi2_dev *dev)
                 /* Write the configuration file for the balancem bytes */
                 for (index = 0; (index < bal_byte) && (rslt == BMI2_OK); index += dev->read_write_len)
                 {
-                    rslt = upload_file((dev->config_file_ptr + index), index, dev->read_write_len, dev);
+                    rslt = upload_file((dev->variant->config_file_ptr + index), index, dev->read_write_len, dev);
                 }
 
                 if (rslt == BMI2_OK)
@@ -5622,7 +5677,7 @@ static int8_t write_config_file(struct bmi2_dev *dev)
                          (index < config_size) && (rslt == BMI2_OK);
                          index += dev->read_write_len)
                     {
-                        rslt = upload_file((dev->config_file_ptr + index), index, dev->read_write_len, dev);
+                        rslt = upload_file((dev->variant->config_file_ptr + index), index, dev->read_write_len, dev);
                     }
 
                     /* Restore the user set length back from the temporary variable */
@@ -5875,8 +5930,8 @@ static int8_t set_gyro_user_gain_config(const struct bmi2_gyro_user_gain_config
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -5893,6 +5948,12 @@ static int8_t set_gyro_user_gain_config(const struct bmi2_gyro_user_gain_config
     /* Copy the feature configuration address to a local pointer */
     uint16_t *data_p = (uint16_t *) (void *)feat_config;
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for user-gain feature and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&user_gain_config, BMI2_GYRO_GAIN_UPDATE, dev);
     if (feat_found)
@@ -5944,6 +6005,8 @@ static int8_t set_gyro_user_gain_config(const struct bmi2_gyro_user_gain_config
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -6282,8 +6345,8 @@ static int8_t get_gyro_gain_update_config(struct bmi2_gyro_user_gain_config *con
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -6303,6 +6366,12 @@ static int8_t get_gyro_gain_update_config(struct bmi2_gyro_user_gain_config *con
     /* Initialize feature configuration for user-gain */
     struct bmi2_feature_config user_gain_config = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for user-gain feature and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&user_gain_config, BMI2_GYRO_GAIN_UPDATE, dev);
     if (feat_found)
@@ -6344,6 +6413,8 @@ static int8_t get_gyro_gain_update_config(struct bmi2_gyro_user_gain_config *con
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -9108,8 +9179,8 @@ static int8_t get_remap_axes(struct bmi2_axes_remap *remap, struct bmi2_dev *dev
     /* Variable to define error */
     int8_t rslt = BMI2_OK;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -9123,6 +9194,12 @@ static int8_t get_remap_axes(struct bmi2_axes_remap *remap, struct bmi2_dev *dev
     /* Variable to get the status of advance power save */
     uint8_t aps_stat;
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Get status of advance power save mode */
     aps_stat = dev->aps_status;
     if (aps_stat == BMI2_ENABLE)
@@ -9179,6 +9256,8 @@ static int8_t get_remap_axes(struct bmi2_axes_remap *remap, struct bmi2_dev *dev
         }
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -9190,8 +9269,8 @@ static int8_t set_remap_axes(const struct bmi2_axes_remap *remap, struct bmi2_de
     /* Variable to define error */
     int8_t rslt = BMI2_OK;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -9226,6 +9305,12 @@ static int8_t set_remap_axes(const struct bmi2_axes_remap *remap, struct bmi2_de
     /* Variable to get the status of advance power save */
     uint8_t aps_stat;
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Get status of advance power save mode */
     aps_stat = dev->aps_status;
     if (aps_stat == BMI2_ENABLE)
@@ -9297,6 +9382,8 @@ static int8_t set_remap_axes(const struct bmi2_axes_remap *remap, struct bmi2_de
         }
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -9451,8 +9538,8 @@ static int8_t perform_accel_foc(const struct bmi2_accel_foc_g_value *accel_g_val
     /* Variable to store status read from the status register */
     uint8_t reg_status = 0;
 
-    /* Array of structure to store accelerometer data */
-    struct bmi2_sens_axes_data accel_value[128] = { { 0 } };
+    /* Structure to store accelerometer data; each sample is summed as it's read, so one will do */
+    struct bmi2_sens_axes_data accel_value = { 0, 0, 0, 0 };
 
     /* Structure to store accelerometer data temporarily */
     struct bmi2_foc_temp_value temp = { 0, 0, 0 };
@@ -9488,20 +9575,20 @@ static int8_t perform_accel_foc(const struct bmi2_accel_foc_g_value *accel_g_val
 
         if ((rslt == BMI2_OK) && (reg_status & BMI2_DRDY_ACC))
         {
-            rslt = read_accel_xyz(&accel_value[loop], dev);
+            rslt = read_accel_xyz(&accel_value, dev);
         }
 
         if (rslt == BMI2_OK)
         {
-            rslt = read_accel_xyz(&accel_value[loop], dev);
+            rslt = read_accel_xyz(&accel_value, dev);
         }
 
         if (rslt == BMI2_OK)
         {
             /* Store the data in a temporary structure */
-            temp.x = temp.x + (int32_t)accel_value[loop].x;
-            temp.y = temp.y + (int32_t)accel_value[loop].y;
-            temp.z = temp.z + (int32_t)accel_value[loop].z;
+            temp.x = temp.x + (int32_t)accel_value.x;
+            temp.y = temp.y + (int32_t)accel_value.y;
+            temp.z = temp.z + (int32_t)accel_value.z;
         }
         else
         {
@@ -10188,7 +10275,7 @@ static int8_t write_crt_config_file(uint16_t write_len,
              (index < (start_index + config_file_size)) && (rslt == BMI2_OK);
              index += write_len)
         {
-            rslt = upload_file((dev->config_file_ptr + index), index, write_len, dev);
+            rslt = upload_file((dev->variant->config_file_ptr + index), index, write_len, dev);
             if (index >= ((start_index + config_file_size) - (write_len)))
             {
                 last_byte_flag = 1;
@@ -10208,7 +10295,7 @@ static int8_t write_crt_config_file(uint16_t write_len,
         /* Write the configuration file for the balance bytes */
         for (index = start_index; (index < balance_byte) && (rslt == BMI2_OK); index += write_len)
         {
-            rslt = upload_file((dev->config_file_ptr + index), index, write_len, dev);
+            rslt = upload_file((dev->variant->config_file_ptr + index), index, write_len, dev);
             if (rslt == BMI2_OK)
             {
                 rslt = process_crt_download(last_byte_flag, dev);
@@ -10226,7 +10313,7 @@ static int8_t write_crt_config_file(uint16_t write_len,
                  (index < (start_index + config_file_size)) && (rslt == BMI2_OK);
                  index += write_len)
             {
-                rslt = upload_file((dev->config_file_ptr + index), index, write_len, dev);
+                rslt = upload_file((dev->variant->config_file_ptr + index), index, write_len, dev);
                 if (index < ((start_index + config_file_size) - write_len))
                 {
                     last_byte_flag = 1;
@@ -10348,7 +10435,7 @@ static int8_t do_gtrigger_test(uint8_t gyro_st_crt, struct bmi2_dev *dev)
     if (rslt == BMI2_OK)
     {
         /* Check if the variant supports this feature */
-        if (dev->variant_feature & BMI2_CRT_RTOSK_ENABLE)
+        if (dev->variant->variant_feature & BMI2_CRT_RTOSK_ENABLE)
         {
             /* Get status of advance power save mode */
             aps_stat = dev->aps_status;
@@ -10517,16 +10604,23 @@ static int8_t crt_gyro_st_update_result(struct bmi2_dev *dev)
 static int8_t get_maxburst_len(uint8_t *max_burst_len, struct bmi2_dev *dev)
 {
     int8_t rslt = BMI2_OK;
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
     uint8_t idx = 0;
     uint8_t feat_found = 0;
     struct bmi2_feature_config maxburst_length_bytes = { 0, 0, 0 };
     uint8_t aps_stat;
 
-    if ((dev->variant_feature & BMI2_CRT_IN_FIFO_NOT_REQ) != 0)
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
+    if ((dev->variant->variant_feature & BMI2_CRT_IN_FIFO_NOT_REQ) != 0)
     {
         *max_burst_len = 0;
 
+        bmi2_scratch_free(feat_config, dev);
         return BMI2_OK;
     }
 
@@ -10568,6 +10662,8 @@ static int8_t get_maxburst_len(uint8_t *max_burst_len, struct bmi2_dev *dev)
         }
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -10577,7 +10673,7 @@ static int8_t get_maxburst_len(uint8_t *max_burst_len, struct bmi2_dev *dev)
 static int8_t set_maxburst_len(const uint16_t write_len_byte, struct bmi2_dev *dev)
 {
     int8_t rslt = BMI2_OK;
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
     uint8_t idx = 0;
     uint8_t reg_addr = 0;
     uint8_t max_burst_len = 0;
@@ -10586,9 +10682,16 @@ static int8_t set_maxburst_len(const uint16_t write_len_byte, struct bmi2_dev *d
     uint8_t aps_stat;
     uint16_t burst_len = write_len_byte / 2;
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* for variant that support crt outside fifo, do not modify the max burst len */
-    if ((dev->variant_feature & BMI2_CRT_IN_FIFO_NOT_REQ) != 0)
+    if ((dev->variant->variant_feature & BMI2_CRT_IN_FIFO_NOT_REQ) != 0)
     {
+        bmi2_scratch_free(feat_config, dev);
         return BMI2_OK;
     }
 
@@ -10649,6 +10752,8 @@ static int8_t set_maxburst_len(const uint16_t write_len_byte, struct bmi2_dev *d
         }
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -10660,8 +10765,8 @@ static int8_t set_nvm_prep_prog(uint8_t nvm_prep, struct bmi2_dev *dev)
     /* Variable to define error */
     int8_t rslt = BMI2_OK;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -10673,6 +10778,12 @@ static int8_t set_nvm_prep_prog(uint8_t nvm_prep, struct bmi2_dev *dev)
     /* Initialize feature configuration for nvm preparation*/
     struct bmi2_feature_config nvm_config = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for bmi2 gyro self offset correction feature as nvm program preparation feature is
      * present in the same Word and extract its configuration details
      */
@@ -10702,6 +10813,8 @@ static int8_t set_nvm_prep_prog(uint8_t nvm_prep, struct bmi2_dev *dev)
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -10712,7 +10825,7 @@ static int8_t select_self_test(uint8_t gyro_st_crt, struct bmi2_dev *dev)
 {
     int8_t rslt;
 
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     uint8_t idx = 0;
 
@@ -10721,6 +10834,12 @@ static int8_t select_self_test(uint8_t gyro_st_crt, struct bmi2_dev *dev)
 
     struct bmi2_feature_config gyro_self_test_crt_config = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for bmi2 crt gyro self-test feature and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&gyro_self_test_crt_config, BMI2_CRT_GYRO_SELF_TEST, dev);
     if (feat_found)
@@ -10748,6 +10867,8 @@ static int8_t select_self_test(uint8_t gyro_st_crt, struct bmi2_dev *dev)
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -10833,8 +10954,8 @@ static int8_t abort_bmi2(uint8_t abort_enable, struct bmi2_dev *dev)
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -10846,6 +10967,12 @@ static int8_t abort_bmi2(uint8_t abort_enable, struct bmi2_dev *dev)
     /* Initialize feature configuration for blocking a feature */
     struct bmi2_feature_config block_config = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for bmi2 Abort feature and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&block_config, BMI2_ABORT_CRT_GYRO_SELF_TEST, dev);
     if (feat_found)
@@ -10872,6 +10999,8 @@ static int8_t abort_bmi2(uint8_t abort_enable, struct bmi2_dev *dev)
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -11024,12 +11153,18 @@ static int8_t extract_config_file(uint8_t *config_major, uint8_t *config_minor,
     /* Variable to define advance power save mode status */
     uint8_t aps_stat;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Initialize feature configuration for config file identification */
     struct bmi2_feature_config config_id = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Check the power mode status */
     aps_stat = dev->aps_status;
     if (aps_stat == BMI2_ENABLE)
@@ -11077,6 +11212,8 @@ static int8_t extract_config_file(uint8_t *config_major, uint8_t *config_minor,
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -11089,11 +11226,11 @@ static void extract_feat_int_map(struct bmi2_map_int *map_int, uint8_t type, con
     uint8_t loop = 0;
 
     /* Search for the interrupts from the input configuration array */
-    while (loop < dev->sens_int_map)
+    while (loop < dev->variant->sens_int_map)
     {
-        if (dev->map_int[loop].type == type)
+        if (dev->variant->map_int[loop].type == type)
         {
-            *map_int = dev->map_int[loop];
+            *map_int = dev->variant->map_int[loop];
             break;
         }
 
@@ -11110,8 +11247,8 @@ static int8_t get_gyro_gain_update_status(struct bmi2_gyr_user_gain_status *user
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variables to define index */
     uint8_t idx = 0;
@@ -11122,6 +11259,12 @@ static int8_t get_gyro_gain_update_status(struct bmi2_gyr_user_gain_status *user
     /* Initialize feature output for gyroscope user gain status */
     struct bmi2_feature_config user_gain_cfg = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for gyroscope user gain status output feature and extract its
      * configuration details
      */
@@ -11153,6 +11296,8 @@ static int8_t get_gyro_gain_update_status(struct bmi2_gyr_user_gain_status *user
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -11171,11 +11316,11 @@ static uint8_t extract_output_feat_config(struct bmi2_feature_config *feat_outpu
     uint8_t feat_found = BMI2_FALSE;
 
     /* Search for the output feature from the output configuration array */
-    while (loop < dev->out_sens)
+    while (loop < dev->variant->out_sens)
     {
-        if (dev->feat_output[loop].type == type)
+        if (dev->variant->feat_output[loop].type == type)
         {
-            *feat_output = dev->feat_output[loop];
+            *feat_output = dev->variant->feat_output[loop];
             feat_found = BMI2_TRUE;
             break;
         }
@@ -11196,8 +11341,8 @@ static int8_t get_gyro_cross_sense(int16_t *cross_sense, struct bmi2_dev *dev)
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define index */
     uint8_t idx = 0;
@@ -11210,7 +11355,13 @@ static int8_t get_gyro_cross_sense(int16_t *cross_sense, struct bmi2_dev *dev)
     /* Initialize feature output for gyroscope cross sensitivity */
     struct bmi2_feature_config cross_sense_out_config = { 0, 0, 0 };
 
-    if (dev->variant_feature & BMI2_MAXIMUM_FIFO_VARIANT)
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
+    if (dev->variant->variant_feature & BMI2_MAXIMUM_FIFO_VARIANT)
     {
         /* For maximum_fifo variant fetch the correction factor from GPIO0 */
         rslt = bmi2_get_regs(BMI2_GYR_CAS_GPIO0_ADDR, &corr_fact_zx, 1, dev);
@@ -11261,6 +11412,8 @@ static int8_t get_gyro_cross_sense(int16_t *cross_sense, struct bmi2_dev *dev)
         }
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
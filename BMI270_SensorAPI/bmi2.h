@@ -2022,6 +2022,28 @@ uint8_t bmi2_extract_input_feat_config(struct bmi2_feature_config *feat_config,
  */
 int8_t bmi2_get_feat_config(uint8_t sw_page, uint8_t *feat_config, struct bmi2_dev *dev);
 
+/*!
+ * @brief This API takes a zeroed buffer from the device's scratch arena,
+ * in place of a temporary on the stack. Buffers are given back in the
+ * reverse order they were taken.
+ *
+ * @param[in] size          : Size of the buffer in bytes.
+ * @param[in] dev           : Structure instance of bmi2_dev.
+ *
+ * @return Pointer to the buffer, aligned to 4 bytes, or NULL if the device
+ * has no arena or it doesn't have size bytes left.
+ */
+void *bmi2_scratch_alloc(uint16_t size, struct bmi2_dev *dev);
+
+/*!
+ * @brief This API gives a buffer from bmi2_scratch_alloc() back to the
+ * arena, along with any taken after it.
+ *
+ * @param[in] buf           : Buffer to give back; NULL is ignored.
+ * @param[in] dev           : Structure instance of bmi2_dev.
+ */
+void bmi2_scratch_free(const void *buf, struct bmi2_dev *dev);
+
 /**
  * \ingroup bmi2
  * \defgroup bmi2AccelOffset Accelerometer Offset Compensation
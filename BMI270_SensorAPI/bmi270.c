@@ -516,7 +516,7 @@ const struct bmi2_feature_config bmi270_feat_out[BMI270_MAX_FEAT_OUT] = {
 };
 
 /*! @name  Global array that stores the feature interrupts of BMI270 */
-struct bmi2_map_int bmi270_map_int[BMI270_MAX_INT_MAP] = {
+const struct bmi2_map_int bmi270_map_int[BMI270_MAX_INT_MAP] = {
     { .type = BMI2_SIG_MOTION, .sens_map_int = BMI270_INT_SIG_MOT_MASK },
     { .type = BMI2_STEP_COUNTER, .sens_map_int = BMI270_INT_STEP_COUNTER_MASK },
     { .type = BMI2_STEP_DETECTOR, .sens_map_int = BMI270_INT_STEP_DETECTOR_MASK },
@@ -1343,13 +1343,26 @@ static int8_t disable_sensor_features(uint64_t sensor_sel, struct bmi2_dev *dev)
 /*!         User Interface Definitions
  ****************************************************************************/
 
+/*! @name What every BMI270 shares, referenced from each device structure */
+const struct bmi2_variant bmi270_variant = {
+    .chip_id = BMI270_CHIP_ID,
+    .config_file_ptr = bmi270_config_file,
+    .config_size = sizeof(bmi270_config_file),
+    .variant_feature = BMI2_GYRO_CROSS_SENS_ENABLE | BMI2_CRT_RTOSK_ENABLE,
+    .feat_config = bmi270_feat_in,
+    .feat_output = bmi270_feat_out,
+    .map_int = bmi270_map_int,
+    .page_max = BMI270_MAX_PAGE_NUM,
+    .input_sens = BMI270_MAX_FEAT_IN,
+    .out_sens = BMI270_MAX_FEAT_OUT,
+    .sens_int_map = BMI270_MAX_INT_MAP
+};
+
 /*!
  *  @brief This API:
- *  1) updates the device structure with address of the configuration file.
+ *  1) Points the device structure at bmi270_variant, unless it has a variant already.
  *  2) Initializes BMI270 sensor.
  *  3) Writes the configuration file.
- *  4) Updates the feature offset parameters in the device structure.
- *  5) Updates the maximum number of pages, in the device structure.
  */
 int8_t bmi270_init(struct bmi2_dev *dev)
 {
@@ -1360,14 +1373,13 @@ int8_t bmi270_init(struct bmi2_dev *dev)
     rslt = null_ptr_check(dev);
     if (rslt == BMI2_OK)
     {
-        /* Assign chip id of BMI270 */
-        dev->chip_id = BMI270_CHIP_ID;
-
-        /* get the size of config array */
-        dev->config_size = sizeof(bmi270_config_file);
-
-        /* Enable the variant specific features if any */
-        dev->variant_feature = BMI2_GYRO_CROSS_SENS_ENABLE | BMI2_CRT_RTOSK_ENABLE;
+        /* Use the tables every sensor of this variant shares, unless the caller
+         * has given its own (e.g. to load a different configuration file)
+         */
+        if (!dev->variant)
+        {
+            dev->variant = &bmi270_variant;
+        }
 
         /* An extra dummy byte is read during SPI read */
         if (dev->intf == BMI2_SPI_INTF)
@@ -1379,54 +1391,10 @@ int8_t bmi270_init(struct bmi2_dev *dev)
             dev->dummy_byte = 0;
         }
 
-        /* If configuration file pointer is not assigned any address */
-        if (!dev->config_file_ptr)
-        {
-            /* Give the address of the configuration file array to
-             * the device pointer
-             */
-            dev->config_file_ptr = bmi270_config_file;
-        }
-
         /* Initialize BMI2 sensor */
         rslt = bmi2_sec_init(dev);
         if (rslt == BMI2_OK)
         {
-            /* Assign the offsets of the feature input
-             * configuration to the device structure
-             */
-            dev->feat_config = bmi270_feat_in;
-
-            /* Assign the offsets of the feature output to
-             * the device structure
-             */
-            dev->feat_output = bmi270_feat_out;
-
-            /* Assign the maximum number of pages to the
-             * device structure
-             */
-            dev->page_max = BMI270_MAX_PAGE_NUM;
-
-            /* Assign maximum number of input sensors/
-             * features to device structure
-             */
-            dev->input_sens = BMI270_MAX_FEAT_IN;
-
-            /* Assign maximum number of output sensors/
-             * features to device structure
-             */
-            dev->out_sens = BMI270_MAX_FEAT_OUT;
-
-            /* Assign the offsets of the feature interrupt
-             * to the device structure
-             */
-            dev->map_int = bmi270_map_int;
-
-            /* Assign maximum number of feature interrupts
-             * to device structure
-             */
-            dev->sens_int_map = BMI270_MAX_INT_MAP;
-
             /* Get the gyroscope cross axis sensitivity */
             rslt = bmi2_get_gyro_cross_sense(dev);
         }
@@ -2101,8 +2069,8 @@ static int8_t set_any_motion(uint8_t enable, struct bmi2_dev *dev)
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -2113,6 +2081,12 @@ static int8_t set_any_motion(uint8_t enable, struct bmi2_dev *dev)
     /* Initialize feature configuration for any-motion */
     struct bmi2_feature_config any_mot_config = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for any-motion feature and extract its configurations details */
     feat_found = bmi2_extract_input_feat_config(&any_mot_config, BMI2_ANY_MOTION, dev);
     if (feat_found)
@@ -2145,6 +2119,8 @@ static int8_t set_any_motion(uint8_t enable, struct bmi2_dev *dev)
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -2156,8 +2132,8 @@ static int8_t set_no_motion(uint8_t enable, struct bmi2_dev *dev)
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -2168,6 +2144,12 @@ static int8_t set_no_motion(uint8_t enable, struct bmi2_dev *dev)
     /* Initialize feature configuration for no-motion */
     struct bmi2_feature_config no_mot_config = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for no-motion feature and extract its configurations details */
     feat_found = bmi2_extract_input_feat_config(&no_mot_config, BMI2_NO_MOTION, dev);
     if (feat_found)
@@ -2200,6 +2182,8 @@ static int8_t set_no_motion(uint8_t enable, struct bmi2_dev *dev)
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -2211,8 +2195,8 @@ static int8_t set_step_detector(uint8_t enable, struct bmi2_dev *dev)
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -2223,6 +2207,12 @@ static int8_t set_step_detector(uint8_t enable, struct bmi2_dev *dev)
     /* Initialize feature configuration for step detector */
     struct bmi2_feature_config step_det_config = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for step detector feature and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&step_det_config, BMI2_STEP_DETECTOR, dev);
     if (feat_found)
@@ -2255,6 +2245,8 @@ static int8_t set_step_detector(uint8_t enable, struct bmi2_dev *dev)
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -2266,8 +2258,8 @@ static int8_t set_step_counter(uint8_t enable, struct bmi2_dev *dev)
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -2278,6 +2270,12 @@ static int8_t set_step_counter(uint8_t enable, struct bmi2_dev *dev)
     /* Initialize feature configuration for step counter */
     struct bmi2_feature_config step_count_config = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for step counter feature and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&step_count_config, BMI2_STEP_COUNTER, dev);
     if (feat_found)
@@ -2310,6 +2308,8 @@ static int8_t set_step_counter(uint8_t enable, struct bmi2_dev *dev)
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -2321,8 +2321,8 @@ static int8_t set_sig_motion(uint8_t enable, struct bmi2_dev *dev)
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -2333,6 +2333,12 @@ static int8_t set_sig_motion(uint8_t enable, struct bmi2_dev *dev)
     /* Initialize feature configuration for sig-motion */
     struct bmi2_feature_config sig_mot_config = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for sig-motion feature and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&sig_mot_config, BMI2_SIG_MOTION, dev);
     if (feat_found)
@@ -2365,6 +2371,8 @@ static int8_t set_sig_motion(uint8_t enable, struct bmi2_dev *dev)
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -2376,8 +2384,8 @@ static int8_t set_step_activity(uint8_t enable, struct bmi2_dev *dev)
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -2388,6 +2396,12 @@ static int8_t set_step_activity(uint8_t enable, struct bmi2_dev *dev)
     /* Initialize feature configuration for step activity */
     struct bmi2_feature_config step_act_config = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for step activity feature and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&step_act_config, BMI2_STEP_ACTIVITY, dev);
     if (feat_found)
@@ -2422,6 +2436,8 @@ static int8_t set_step_activity(uint8_t enable, struct bmi2_dev *dev)
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -2434,8 +2450,8 @@ static int8_t set_gyro_self_offset_corr(uint8_t enable, struct bmi2_dev *dev)
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -2446,6 +2462,12 @@ static int8_t set_gyro_self_offset_corr(uint8_t enable, struct bmi2_dev *dev)
     /* Initialize feature configuration for self-offset correction */
     struct bmi2_feature_config self_off_corr_cfg = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for self-offset correction and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&self_off_corr_cfg, BMI2_GYRO_SELF_OFF, dev);
     if (feat_found)
@@ -2480,6 +2502,8 @@ static int8_t set_gyro_self_offset_corr(uint8_t enable, struct bmi2_dev *dev)
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -2491,8 +2515,8 @@ static int8_t set_wrist_gesture(uint8_t enable, struct bmi2_dev *dev)
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -2503,6 +2527,12 @@ static int8_t set_wrist_gesture(uint8_t enable, struct bmi2_dev *dev)
     /* Initialize feature configuration for wrist gesture */
     struct bmi2_feature_config wrist_gest_cfg = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for wrist gesture and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&wrist_gest_cfg, BMI2_WRIST_GESTURE, dev);
     if (feat_found)
@@ -2535,6 +2565,8 @@ static int8_t set_wrist_gesture(uint8_t enable, struct bmi2_dev *dev)
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -2546,8 +2578,8 @@ static int8_t set_wrist_wear_wake_up(uint8_t enable, struct bmi2_dev *dev)
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -2558,6 +2590,12 @@ static int8_t set_wrist_wear_wake_up(uint8_t enable, struct bmi2_dev *dev)
     /* Initialize feature configuration for wrist wear wake up */
     struct bmi2_feature_config wrist_wake_up_cfg = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for wrist wear wake up and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&wrist_wake_up_cfg, BMI2_WRIST_WEAR_WAKE_UP, dev);
     if (feat_found)
@@ -2592,6 +2630,8 @@ static int8_t set_wrist_wear_wake_up(uint8_t enable, struct bmi2_dev *dev)
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -2604,8 +2644,8 @@ static int8_t set_gyro_user_gain(uint8_t enable, struct bmi2_dev *dev)
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -2616,6 +2656,12 @@ static int8_t set_gyro_user_gain(uint8_t enable, struct bmi2_dev *dev)
     /* Initialize feature configuration for gyroscope user gain */
     struct bmi2_feature_config gyr_user_gain_cfg = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for user gain feature and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&gyr_user_gain_cfg, BMI2_GYRO_GAIN_UPDATE, dev);
     if (feat_found)
@@ -2648,6 +2694,8 @@ static int8_t set_gyro_user_gain(uint8_t enable, struct bmi2_dev *dev)
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -2660,8 +2708,8 @@ static int8_t set_any_motion_config(const struct bmi2_any_motion_config *config,
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -2678,6 +2726,12 @@ static int8_t set_any_motion_config(const struct bmi2_any_motion_config *config,
     /* Copy the feature configuration address to a local pointer */
     uint16_t *data_p = (uint16_t *) (void *)feat_config;
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for any-motion feature and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&any_mot_config, BMI2_ANY_MOTION, dev);
     if (feat_found)
@@ -2732,6 +2786,8 @@ static int8_t set_any_motion_config(const struct bmi2_any_motion_config *config,
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -2744,8 +2800,8 @@ static int8_t set_no_motion_config(const struct bmi2_no_motion_config *config, s
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -2762,6 +2818,12 @@ static int8_t set_no_motion_config(const struct bmi2_no_motion_config *config, s
     /* Copy the feature configuration address to a local pointer */
     uint16_t *data_p = (uint16_t *) (void *)feat_config;
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for no-motion feature and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&no_mot_config, BMI2_NO_MOTION, dev);
     if (feat_found)
@@ -2816,6 +2878,8 @@ static int8_t set_no_motion_config(const struct bmi2_no_motion_config *config, s
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -2828,8 +2892,8 @@ static int8_t set_sig_motion_config(const struct bmi2_sig_motion_config *config,
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -2846,6 +2910,12 @@ static int8_t set_sig_motion_config(const struct bmi2_sig_motion_config *config,
     /* Copy the feature configuration address to a local pointer */
     uint16_t *data_p = (uint16_t *) (void *)feat_config;
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for sig-motion feature and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&sig_mot_config, BMI2_SIG_MOTION, dev);
     if (feat_found)
@@ -2885,6 +2955,8 @@ static int8_t set_sig_motion_config(const struct bmi2_sig_motion_config *config,
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -2896,8 +2968,8 @@ static int8_t set_step_count_params_config(const uint16_t *step_count_params, st
     /* Variable to define error */
     int8_t rslt = BMI2_OK;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define index */
     uint8_t index = 0;
@@ -2941,6 +3013,12 @@ static int8_t set_step_count_params_config(const uint16_t *step_count_params, st
     /* Copy the feature configuration address to a local pointer */
     uint16_t *data_p = (uint16_t *) (void *)feat_config;
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for step counter parameter feature and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&step_params_config, BMI2_STEP_COUNTER_PARAMS, dev);
     if (feat_found)
@@ -3010,6 +3088,8 @@ static int8_t set_step_count_params_config(const uint16_t *step_count_params, st
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -3021,8 +3101,8 @@ static int8_t set_step_config(const struct bmi2_step_config *config, struct bmi2
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -3039,6 +3119,12 @@ static int8_t set_step_config(const struct bmi2_step_config *config, struct bmi2
     /* Copy the feature configuration address to a local pointer */
     uint16_t *data_p = (uint16_t *) (void *)feat_config;
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for step counter feature and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&step_count_config, BMI2_STEP_COUNTER, dev);
     if (feat_found)
@@ -3083,6 +3169,8 @@ static int8_t set_step_config(const struct bmi2_step_config *config, struct bmi2
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -3095,8 +3183,8 @@ static int8_t set_wrist_gest_config(const struct bmi2_wrist_gest_config *config,
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -3113,6 +3201,12 @@ static int8_t set_wrist_gest_config(const struct bmi2_wrist_gest_config *config,
     /* Copy the feature configuration address to a local pointer */
     uint16_t *data_p = (uint16_t *) (void *)feat_config;
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for wrist gesture feature and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&wrist_gest_config, BMI2_WRIST_GESTURE, dev);
     if (feat_found)
@@ -3164,6 +3258,8 @@ static int8_t set_wrist_gest_config(const struct bmi2_wrist_gest_config *config,
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -3176,8 +3272,8 @@ static int8_t set_wrist_wear_wake_up_config(const struct bmi2_wrist_wear_wake_up
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -3194,6 +3290,12 @@ static int8_t set_wrist_wear_wake_up_config(const struct bmi2_wrist_wear_wake_up
     /* Copy the feature configuration address to a local pointer */
     uint16_t *data_p = (uint16_t *) (void *)feat_config;
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for wrist wear wake-up feature and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&wrist_wake_up_config, BMI2_WRIST_WEAR_WAKE_UP, dev);
     if (feat_found)
@@ -3255,6 +3357,8 @@ static int8_t set_wrist_wear_wake_up_config(const struct bmi2_wrist_wear_wake_up
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -3267,8 +3371,8 @@ static int8_t get_any_motion_config(struct bmi2_any_motion_config *config, struc
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -3288,6 +3392,12 @@ static int8_t get_any_motion_config(struct bmi2_any_motion_config *config, struc
     /* Initialize feature configuration for any-motion */
     struct bmi2_feature_config any_mot_config = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for any-motion feature and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&any_mot_config, BMI2_ANY_MOTION, dev);
     if (feat_found)
@@ -3330,6 +3440,8 @@ static int8_t get_any_motion_config(struct bmi2_any_motion_config *config, struc
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -3342,8 +3454,8 @@ static int8_t get_no_motion_config(struct bmi2_no_motion_config *config, struct
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -3363,6 +3475,12 @@ static int8_t get_no_motion_config(struct bmi2_no_motion_config *config, struct
     /* Initialize feature configuration for no-motion */
     struct bmi2_feature_config no_mot_config = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for no-motion feature and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&no_mot_config, BMI2_NO_MOTION, dev);
     if (feat_found)
@@ -3405,6 +3523,8 @@ static int8_t get_no_motion_config(struct bmi2_no_motion_config *config, struct
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -3417,8 +3537,8 @@ static int8_t get_sig_motion_config(struct bmi2_sig_motion_config *config, struc
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -3438,6 +3558,12 @@ static int8_t get_sig_motion_config(struct bmi2_sig_motion_config *config, struc
     /* Initialize feature configuration sig-motion */
     struct bmi2_feature_config sig_mot_config = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for sig-motion feature and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&sig_mot_config, BMI2_SIG_MOTION, dev);
     if (feat_found)
@@ -3463,6 +3589,8 @@ static int8_t get_sig_motion_config(struct bmi2_sig_motion_config *config, struc
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -3474,8 +3602,8 @@ static int8_t get_step_count_params_config(uint16_t *step_count_params, struct b
     /* Variable to define error */
     int8_t rslt = BMI2_OK;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to set flag */
     uint8_t feat_found;
@@ -3522,6 +3650,12 @@ static int8_t get_step_count_params_config(uint16_t *step_count_params, struct b
     /* Variable to index the parameters */
     uint8_t param_idx = 0;
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for step counter parameter feature and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&step_params_config, BMI2_STEP_COUNTER_PARAMS, dev);
     if (feat_found)
@@ -3582,6 +3716,8 @@ static int8_t get_step_count_params_config(uint16_t *step_count_params, struct b
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -3593,8 +3729,8 @@ static int8_t get_step_config(struct bmi2_step_config *config, struct bmi2_dev *
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -3614,6 +3750,12 @@ static int8_t get_step_config(struct bmi2_step_config *config, struct bmi2_dev *
     /* Initialize feature configuration for step counter */
     struct bmi2_feature_config step_count_config = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for step counter 4 feature and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&step_count_config, BMI2_STEP_COUNTER, dev);
     if (feat_found)
@@ -3642,6 +3784,8 @@ static int8_t get_step_config(struct bmi2_step_config *config, struct bmi2_dev *
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -3654,8 +3798,8 @@ static int8_t get_wrist_gest_config(struct bmi2_wrist_gest_config *config, struc
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -3669,6 +3813,12 @@ static int8_t get_wrist_gest_config(struct bmi2_wrist_gest_config *config, struc
     /* Copy the feature configuration address to a local pointer */
     uint16_t *data_p = (uint16_t *) (void *)feat_config;
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for wrist gesture feature and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&wrist_gest_config, BMI2_WRIST_GESTURE, dev);
     if (feat_found)
@@ -3704,6 +3854,8 @@ static int8_t get_wrist_gest_config(struct bmi2_wrist_gest_config *config, struc
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -3716,8 +3868,8 @@ static int8_t get_wrist_wear_wake_up_config(struct bmi2_wrist_wear_wake_up_confi
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -3731,6 +3883,12 @@ static int8_t get_wrist_wear_wake_up_config(struct bmi2_wrist_wear_wake_up_confi
     /* Copy the feature configuration address to a local pointer */
     uint16_t *data_p = (uint16_t *) (void *)feat_config;
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for wrist wear wake-up feature and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&wrist_wake_up_config, BMI2_WRIST_WEAR_WAKE_UP, dev);
     if (feat_found)
@@ -3776,6 +3934,8 @@ static int8_t get_wrist_wear_wake_up_config(struct bmi2_wrist_wear_wake_up_confi
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -3787,8 +3947,8 @@ static int8_t get_wrist_gest_status(uint8_t *wrist_gest, struct bmi2_dev *dev)
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variables to define index */
     uint8_t idx = 0;
@@ -3799,6 +3959,12 @@ static int8_t get_wrist_gest_status(uint8_t *wrist_gest, struct bmi2_dev *dev)
     /* Initialize feature output for wrist gesture */
     struct bmi2_feature_config wrist_gest_out_config = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for wrist gesture feature and extract its configuration details */
     feat_found = extract_output_feat_config(&wrist_gest_out_config, BMI2_WRIST_GESTURE, dev);
     if (feat_found)
@@ -3819,6 +3985,8 @@ static int8_t get_wrist_gest_status(uint8_t *wrist_gest, struct bmi2_dev *dev)
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -3830,8 +3998,8 @@ static int8_t get_step_counter_output(uint32_t *step_count, struct bmi2_dev *dev
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variables to define index */
     uint8_t idx = 0;
@@ -3842,6 +4010,12 @@ static int8_t get_step_counter_output(uint32_t *step_count, struct bmi2_dev *dev
     /* Initialize feature output for step counter */
     struct bmi2_feature_config step_cnt_out_config = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for step counter output feature and extract its configuration details */
     feat_found = extract_output_feat_config(&step_cnt_out_config, BMI2_STEP_COUNTER, dev);
     if (feat_found)
@@ -3865,6 +4039,8 @@ static int8_t get_step_counter_output(uint32_t *step_count, struct bmi2_dev *dev
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -3876,8 +4052,8 @@ static int8_t get_nvm_error_status(struct bmi2_nvm_err_status *nvm_err_stat, str
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variables to define index */
     uint8_t idx = 0;
@@ -3888,6 +4064,12 @@ static int8_t get_nvm_error_status(struct bmi2_nvm_err_status *nvm_err_stat, str
     /* Initialize feature output for NVM error status */
     struct bmi2_feature_config nvm_err_cfg = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for NVM error status feature and extract its configuration details */
     feat_found = extract_output_feat_config(&nvm_err_cfg, BMI2_NVM_STATUS, dev);
     if (feat_found)
@@ -3923,6 +4105,8 @@ static int8_t get_nvm_error_status(struct bmi2_nvm_err_status *nvm_err_stat, str
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -3935,8 +4119,8 @@ static int8_t get_user_gain_upd_status(uint8_t *status, struct bmi2_dev *dev)
     /* Variable to define error */
     int8_t rslt = BMI2_OK;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variable to define the array offset */
     uint8_t idx = 0;
@@ -3950,6 +4134,12 @@ static int8_t get_user_gain_upd_status(uint8_t *status, struct bmi2_dev *dev)
     /* Initialize feature configuration for gyroscope user gain */
     struct bmi2_feature_config gyr_user_gain_cfg = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for user gain feature and extract its configuration details */
     feat_found = bmi2_extract_input_feat_config(&gyr_user_gain_cfg, BMI2_GYRO_GAIN_UPDATE, dev);
     if (feat_found)
@@ -3986,6 +4176,8 @@ static int8_t get_user_gain_upd_status(uint8_t *status, struct bmi2_dev *dev)
         rslt = bmi2_set_adv_power_save(BMI2_ENABLE, dev);
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -3997,8 +4189,8 @@ static int8_t get_step_activity_output(uint8_t *step_act, struct bmi2_dev *dev)
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variables to define index */
     uint8_t idx = 0;
@@ -4009,6 +4201,12 @@ static int8_t get_step_activity_output(uint8_t *step_act, struct bmi2_dev *dev)
     /* Initialize feature output for step activity */
     struct bmi2_feature_config step_act_out_config = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for step activity output feature and extract its configuration details */
     feat_found = extract_output_feat_config(&step_act_out_config, BMI2_STEP_ACTIVITY, dev);
     if (feat_found)
@@ -4029,6 +4227,8 @@ static int8_t get_step_activity_output(uint8_t *step_act, struct bmi2_dev *dev)
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -4040,8 +4240,8 @@ static int8_t get_vfrm_error_status(struct bmi2_vfrm_err_status *vfrm_err_stat,
     /* Variable to define error */
     int8_t rslt;
 
-    /* Array to define the feature configuration */
-    uint8_t feat_config[BMI2_FEAT_SIZE_IN_BYTES] = { 0 };
+    /* Array to define the feature configuration, from the scratch arena */
+    uint8_t *feat_config = bmi2_scratch_alloc(BMI2_FEAT_SIZE_IN_BYTES, dev);
 
     /* Variables to define index */
     uint8_t idx = 0;
@@ -4052,6 +4252,12 @@ static int8_t get_vfrm_error_status(struct bmi2_vfrm_err_status *vfrm_err_stat,
     /* Initialize feature output for VFRM error status */
     struct bmi2_feature_config vfrm_err_cfg = { 0, 0, 0 };
 
+    /* The page doesn't fit in what is left of the scratch arena */
+    if (feat_config == NULL)
+    {
+        return BMI2_E_SCRATCH;
+    }
+
     /* Search for VFRM error status feature and extract its configuration details */
     feat_found = extract_output_feat_config(&vfrm_err_cfg, BMI2_VFRM_STATUS, dev);
     if (feat_found)
@@ -4081,6 +4287,8 @@ static int8_t get_vfrm_error_status(struct bmi2_vfrm_err_status *vfrm_err_stat,
         rslt = BMI2_E_INVALID_SENSOR;
     }
 
+    bmi2_scratch_free(feat_config, dev);
+
     return rslt;
 }
 
@@ -4121,11 +4329,11 @@ static uint8_t extract_output_feat_config(struct bmi2_feature_config *feat_outpu
     uint8_t feat_found = BMI2_FALSE;
 
     /* Search for the output feature from the output configuration array */
-    while (loop < dev->out_sens)
+    while (loop < dev->variant->out_sens)
     {
-        if (dev->feat_output[loop].type == type)
+        if (dev->variant->feat_output[loop].type == type)
         {
-            *feat_output = dev->feat_output[loop];
+            *feat_output = dev->variant->feat_output[loop];
             feat_found = BMI2_TRUE;
             break;
         }
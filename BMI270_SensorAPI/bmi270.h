@@ -120,6 +120,9 @@ extern "C" {
 /*! @name Defines maximum number of feature interrupts */
 #define BMI270_MAX_INT_MAP                   UINT8_C(8)
 
+/*! @name Feature tables and configuration file every BMI270 shares (see struct bmi2_variant) */
+extern const struct bmi2_variant bmi270_variant;
+
 /***************************************************************************/
 
 /*!     BMI270 User Interface function prototypes
@@ -138,11 +141,9 @@ extern "C" {
  * int8_t bmi270_init(struct bmi2_dev *dev);
  * \endcode
  * @details This API:
- *  1) updates the device structure with address of the configuration file.
+ *  1) Points the device structure at bmi270_variant, unless it has a variant already.
  *  2) Initializes BMI270 sensor.
  *  3) Writes the configuration file.
- *  4) Updates the feature offset parameters in the device structure.
- *  5) Updates the maximum number of pages, in the device structure.
  *
  * @param[in, out] dev      : Structure instance of bmi2_dev.
  *
@@ -510,7 +510,7 @@ const struct bmi2_feature_config bmi270_context_feat_out[BMI270_CONTEXT_MAX_FEAT
 };
 
 /*! @name  Global array that stores the feature interrupts of BMI270_CONTEXT */
-struct bmi2_map_int bmi270_c_map_int[BMI270_C_MAX_INT_MAP] = {
+const struct bmi2_map_int bmi270_c_map_int[BMI270_C_MAX_INT_MAP] = {
     { .type = BMI2_STEP_COUNTER, .sens_map_int = BMI270_C_INT_STEP_COUNTER_MASK },
     { .type = BMI2_STEP_DETECTOR, .sens_map_int = BMI270_C_INT_STEP_DETECTOR_MASK },
 };
@@ -872,13 +872,26 @@ static int8_t disable_sensor_features(uint64_t sensor_sel, struct bmi2_dev *dev)
 /*!         User Interface Definitions
  ****************************************************************************/
 
+/*! @name What every BMI270_CONTEXT shares, referenced from each device structure */
+const struct bmi2_variant bmi270_context_variant = {
+    .chip_id = BMI270_CONTEXT_CHIP_ID,
+    .config_file_ptr = bmi270_context_config_file,
+    .config_size = sizeof(bmi270_context_config_file),
+    .variant_feature = BMI2_CRT_RTOSK_ENABLE | BMI2_GYRO_CROSS_SENS_ENABLE,
+    .feat_config = bmi270_context_feat_in,
+    .feat_output = bmi270_context_feat_out,
+    .map_int = bmi270_c_map_int,
+    .page_max = BMI270_CONTEXT_MAX_PAGE_NUM,
+    .input_sens = BMI270_CONTEXT_MAX_FEAT_IN,
+    .out_sens = BMI270_CONTEXT_MAX_FEAT_OUT,
+    .sens_int_map = BMI270_C_MAX_INT_MAP
+};
+
 /*!
  *  @brief This API:
- *  1) Updates the device structure with address of the configuration file.
+ *  1) Points the device structure at bmi270_context_variant, unless it has a variant already.
  *  2) Initializes BMI270_CONTEXT sensor.
  *  3) Writes the configuration file.
- *  4) Updates the feature offset parameters in the device structure.
- *  5) Updates the maximum number of pages, in the device structure.
  */
 int8_t bmi270_context_init(struct bmi2_dev *dev)
 {
@@ -889,14 +902,13 @@ int8_t bmi270_context_init(struct bmi2_dev *dev)
     rslt = null_ptr_check(dev);
     if (rslt == BMI2_OK)
     {
-        /* Assign chip id of BMI270_CONTEXT */
-        dev->chip_id = BMI270_CONTEXT_CHIP_ID;
-
-        /* Get the size of config array */
-        dev->config_size = sizeof(bmi270_context_config_file);
-
-        /* Enable the variant specific features if any */
-        dev->variant_feature = BMI2_CRT_RTOSK_ENABLE | BMI2_GYRO_CROSS_SENS_ENABLE;
+        /* Use the tables every sensor of this variant shares, unless the caller
+         * has given its own (e.g. to load a different configuration file)
+         */
+        if (!dev->variant)
+        {
+            dev->variant = &bmi270_context_variant;
+        }
 
         /* An extra dummy byte is read during SPI read */
         if (dev->intf == BMI2_SPI_INTF)
@@ -908,54 +920,8 @@ int8_t bmi270_context_init(struct bmi2_dev *dev)
             dev->dummy_byte = 0;
         }
 
-        /* If configuration file pointer is not assigned any address */
-        if (!dev->config_file_ptr)
-        {
-            /* Give the address of the configuration file array to
-             * the device pointer
-             */
-            dev->config_file_ptr = bmi270_context_config_file;
-        }
-
         /* Initialize BMI2 sensor */
         rslt = bmi2_sec_init(dev);
-        if (rslt == BMI2_OK)
-        {
-            /* Assign the offsets of the feature input
-             * configuration to the device structure
-             */
-            dev->feat_config = bmi270_context_feat_in;
-
-            /* Assign the offsets of the feature output to
-             * the device structure
-             */
-            dev->feat_output = bmi270_context_feat_out;
-
-            /* Assign the maximum number of pages to the
-             * device structure
-             */
-            dev->page_max = BMI270_CONTEXT_MAX_PAGE_NUM;
-
-            /* Assign maximum number of input sensors/
-             * features to device structure
-             */
-            dev->input_sens = BMI270_CONTEXT_MAX_FEAT_IN;
-
-            /* Assign maximum number of output sensors/
-             * features to device structure
-             */
-            dev->out_sens = BMI270_CONTEXT_MAX_FEAT_OUT;
-
-            /* Assign the offsets of the feature interrupt
-             * to the device structure
-             */
-            dev->map_int = bmi270_c_map_int;
-
-            /* Assign maximum number of feature interrupts
-             * to device structure
-             */
-            dev->sens_int_map = BMI270_C_MAX_INT_MAP;
-        }
     }
 
     return rslt;
@@ -2531,11 +2497,11 @@ static uint8_t extract_output_feat_config(struct bmi2_feature_config *feat_outpu
     uint8_t feat_found = BMI2_FALSE;
 
     /* Search for the output feature from the output configuration array */
-    while (loop < dev->out_sens)
+    while (loop < dev->variant->out_sens)
     {
-        if (dev->feat_output[loop].type == type)
+        if (dev->variant->feat_output[loop].type == type)
         {
-            *feat_output = dev->feat_output[loop];
+            *feat_output = dev->variant->feat_output[loop];
             feat_found = BMI2_TRUE;
             break;
         }
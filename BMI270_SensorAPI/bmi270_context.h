@@ -100,6 +100,9 @@ extern "C" {
 /*! @name Defines maximum number of feature interrupts */
 #define BMI270_C_MAX_INT_MAP                         UINT8_C(2)
 
+/*! @name Feature tables and configuration file every BMI270_CONTEXT shares (see struct bmi2_variant) */
+extern const struct bmi2_variant bmi270_context_variant;
+
 /***************************************************************************/
 
 /*!     BMI270_CONTEXT User Interface function prototypes
@@ -118,11 +121,9 @@ extern "C" {
  * int8_t bmi270_context_init(struct bmi2_dev *dev);
  * \endcode
  * @details This API:
- *  1) updates the device structure with address of the configuration file.
+ *  1) Points the device structure at bmi270_context_variant, unless it has a variant already.
  *  2) Initializes BMI270_CONTEXT sensor.
  *  3) Writes the configuration file.
- *  4) Updates the feature offset parameters in the device structure.
- *  5) Updates the maximum number of pages, in the device structure.
  *
  * @param[in, out] dev      : Structure instance of bmi2_dev.
  *
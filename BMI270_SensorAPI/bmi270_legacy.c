@@ -532,7 +532,7 @@ const struct bmi2_feature_config bmi270_legacy_feat_out[BMI270_LEGACY_MAX_FEAT_O
 };
 
 /*! @name  Global array that stores the feature interrupts of BMI270_LEGACY */
-struct bmi2_map_int bmi270_legacy_map_int[BMI270_LEGACY_MAX_INT_MAP] = {
+const struct bmi2_map_int bmi270_legacy_map_int[BMI270_LEGACY_MAX_INT_MAP] = {
     { .type = BMI2_SIG_MOTION, .sens_map_int = BMI270_LEGACY_INT_SIG_MOT_MASK },
     { .type = BMI2_STEP_COUNTER, .sens_map_int = BMI270_LEGACY_INT_STEP_COUNTER_MASK },
     { .type = BMI2_STEP_DETECTOR, .sens_map_int = BMI270_LEGACY_INT_STEP_DETECTOR_MASK },
@@ -1816,13 +1816,28 @@ static int8_t disable_sensor_features(uint64_t sensor_sel, struct bmi2_dev *dev)
 /*!         User Interface Definitions
  ****************************************************************************/
 
+/*! @name What every BMI270_LEGACY shares, referenced from each device structure */
+const struct bmi2_variant bmi270_legacy_variant = {
+    .chip_id = BMI270_LEGACY_CHIP_ID,
+    .config_file_ptr = bmi270_legacy_config_file,
+    .config_size = sizeof(bmi270_legacy_config_file),
+    .variant_feature = BMI2_CRT_RTOSK_ENABLE | BMI2_GYRO_CROSS_SENS_ENABLE,
+    .feat_config = bmi270_legacy_feat_in,
+    .feat_output = bmi270_legacy_feat_out,
+    .map_int = bmi270_legacy_map_int,
+    .page_max = BMI270_LEGACY_MAX_PAGE_NUM,
+    .input_sens = BMI270_LEGACY_MAX_FEAT_IN,
+    .out_sens = BMI270_LEGACY_MAX_FEAT_OUT,
+    .sens_int_map = BMI270_LEGACY_MAX_INT_MAP,
+    .get_tap_config = get_tap_config,
+    .set_tap_config = set_tap_config
+};
+
 /*!
  *  @brief This API:
- *  1) Updates the device structure with address of the configuration file.
+ *  1) Points the device structure at bmi270_legacy_variant, unless it has a variant already.
  *  2) Initializes BMI270_LEGACY sensor.
  *  3) Writes the configuration file.
- *  4) Updates the feature offset parameters in the device structure.
- *  5) Updates the maximum number of pages, in the device structure.
  */
 int8_t bmi270_legacy_init(struct bmi2_dev *dev)
 {
@@ -1833,14 +1848,13 @@ int8_t bmi270_legacy_init(struct bmi2_dev *dev)
     rslt = null_ptr_check(dev);
     if (rslt == BMI2_OK)
     {
-        /* Assign chip id of BMI270_LEGACY */
-        dev->chip_id = BMI270_LEGACY_CHIP_ID;
-
-        /* Get the size of config array */
-        dev->config_size = sizeof(bmi270_legacy_config_file);
-
-        /* Enable the variant specific features if any */
-        dev->variant_feature = BMI2_CRT_RTOSK_ENABLE | BMI2_GYRO_CROSS_SENS_ENABLE;
+        /* Use the tables every sensor of this variant shares, unless the caller
+         * has given its own (e.g. to load a different configuration file)
+         */
+        if (!dev->variant)
+        {
+            dev->variant = &bmi270_legacy_variant;
+        }
 
         /* An extra dummy byte is read during SPI read */
         if (dev->intf == BMI2_SPI_INTF)
@@ -1852,60 +1866,10 @@ int8_t bmi270_legacy_init(struct bmi2_dev *dev)
             dev->dummy_byte = 0;
         }
 
-        /* If configuration file pointer is not assigned any address */
-        if (!dev->config_file_ptr)
-        {
-            /* Give the address of the configuration file array to
-             * the device pointer
-             */
-            dev->config_file_ptr = bmi270_legacy_config_file;
-        }
-
         /* Initialize BMI2 sensor */
         rslt = bmi2_sec_init(dev);
         if (rslt == BMI2_OK)
         {
-            /* Assign the offsets of the feature input
-             * configuration to the device structure
-             */
-            dev->feat_config = bmi270_legacy_feat_in;
-
-            /* Assign the offsets of the feature output to
-             * the device structure
-             */
-            dev->feat_output = bmi270_legacy_feat_out;
-
-            /* Assign the maximum number of pages to the
-             * device structure
-             */
-            dev->page_max = BMI270_LEGACY_MAX_PAGE_NUM;
-
-            /* Assign maximum number of input sensors
-             * features to device structure
-             */
-            dev->input_sens = BMI270_LEGACY_MAX_FEAT_IN;
-
-            /* Assign maximum number of output sensors
-             * features to device structure
-             */
-            dev->out_sens = BMI270_LEGACY_MAX_FEAT_OUT;
-
-            /* Assign the tap get configurations to function pointer */
-            dev->get_tap_config = get_tap_config;
-
-            /* Assign the tap set configurations to function pointer */
-            dev->set_tap_config = set_tap_config;
-
-            /* Assign the offsets of the feature interrupt
-             * to the device structure
-             */
-            dev->map_int = bmi270_legacy_map_int;
-
-            /* Assign maximum number of feature interrupts
-             * to device structure
-             */
-            dev->sens_int_map = BMI270_LEGACY_MAX_INT_MAP;
-
             /* Get the gyroscope cross axis sensitivity */
             rslt = bmi2_get_gyro_cross_sense(dev);
         }
@@ -4100,7 +4064,7 @@ static int8_t set_tap_detector_config(struct bmi2_tap_config *config, struct bmi
     /* Variable to define error */
     int8_t rslt;
 
-    rslt = dev->set_tap_config(config, dev);
+    rslt = dev->variant->set_tap_config(config, dev);
 
     return rslt;
 }
@@ -4724,7 +4688,7 @@ static int8_t get_tap_detector_config(struct bmi2_tap_config *config, struct bmi
     /* Variable to define error */
     int8_t rslt;
 
-    rslt = dev->get_tap_config(config, dev);
+    rslt = dev->variant->get_tap_config(config, dev);
 
     return rslt;
 }
@@ -5373,11 +5337,11 @@ static uint8_t extract_output_feat_config(struct bmi2_feature_config *feat_outpu
     uint8_t feat_found = BMI2_FALSE;
 
     /* Search for the output feature from the output configuration array */
-    while (loop < dev->out_sens)
+    while (loop < dev->variant->out_sens)
     {
-        if (dev->feat_output[loop].type == type)
+        if (dev->variant->feat_output[loop].type == type)
         {
-            *feat_output = dev->feat_output[loop];
+            *feat_output = dev->variant->feat_output[loop];
             feat_found = BMI2_TRUE;
             break;
         }
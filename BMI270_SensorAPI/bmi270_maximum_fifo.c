@@ -101,13 +101,24 @@ static int8_t null_ptr_check(const struct bmi2_dev *dev);
 /*!         User Interface Definitions
  ****************************************************************************/
 
+/*! @name What every BMI270_MAXIMUM_FIFO shares, referenced from each device structure */
+const struct bmi2_variant bmi270_maximum_fifo_variant = {
+    .chip_id = BMI270_MAXIMUM_FIFO_CHIP_ID,
+    .config_file_ptr = bmi270_maximum_fifo_config_file,
+    .config_size = sizeof(bmi270_maximum_fifo_config_file),
+    .variant_feature = BMI2_GYRO_CROSS_SENS_ENABLE | BMI2_MAXIMUM_FIFO_VARIANT,
+    .feat_config = bmi270_maximum_fifo_feat_in,
+    .feat_output = bmi270_maximum_fifo_feat_out,
+    .page_max = BMI270_MAXIMUM_FIFO_MAX_PAGE_NUM,
+    .input_sens = BMI270_MAXIMUM_FIFO_MAX_FEAT_IN,
+    .out_sens = BMI270_MAXIMUM_FIFO_MAX_FEAT_OUT
+};
+
 /*!
  *  @brief This API:
- *  1) updates the device structure with address of the configuration file.
+ *  1) Points the device structure at bmi270_maximum_fifo_variant, unless it has a variant already.
  *  2) Initializes BMI270 sensor.
  *  3) Writes the configuration file.
- *  4) Updates the feature offset parameters in the device structure.
- *  5) Updates the maximum number of pages, in the device structure.
  */
 int8_t bmi270_maximum_fifo_init(struct bmi2_dev *dev)
 {
@@ -119,13 +130,13 @@ int8_t bmi270_maximum_fifo_init(struct bmi2_dev *dev)
 
     if (rslt == BMI2_OK)
     {
-        /* Assign chip id of BMI270 */
-        dev->chip_id = BMI270_MAXIMUM_FIFO_CHIP_ID;
-
-        dev->config_size = sizeof(bmi270_maximum_fifo_config_file);
-
-        /* Enable the variant specific features if any */
-        dev->variant_feature = BMI2_GYRO_CROSS_SENS_ENABLE | BMI2_MAXIMUM_FIFO_VARIANT;
+        /* Use the tables every sensor of this variant shares, unless the caller
+         * has given its own (e.g. to load a different configuration file)
+         */
+        if (!dev->variant)
+        {
+            dev->variant = &bmi270_maximum_fifo_variant;
+        }
 
         /* An extra dummy byte is read during SPI read */
         if (dev->intf == BMI2_SPI_INTF)
@@ -137,45 +148,11 @@ int8_t bmi270_maximum_fifo_init(struct bmi2_dev *dev)
             dev->dummy_byte = 0;
         }
 
-        /* If configuration file pointer is not assigned any address */
-        if (!dev->config_file_ptr)
-        {
-            /* Give the address of the configuration file array to
-             * the device pointer
-             */
-            dev->config_file_ptr = bmi270_maximum_fifo_config_file;
-        }
-
         /* Initialize BMI2 sensor */
         rslt = bmi2_sec_init(dev);
 
         if (rslt == BMI2_OK)
         {
-            /* Assign the offsets of the feature input
-             * configuration to the device structure
-             */
-            dev->feat_config = bmi270_maximum_fifo_feat_in;
-
-            /* Assign the offsets of the feature output to
-             * the device structure
-             */
-            dev->feat_output = bmi270_maximum_fifo_feat_out;
-
-            /* Assign the maximum number of pages to the
-             * device structure
-             */
-            dev->page_max = BMI270_MAXIMUM_FIFO_MAX_PAGE_NUM;
-
-            /* Assign maximum number of input sensors/
-             * features to device structure
-             */
-            dev->input_sens = BMI270_MAXIMUM_FIFO_MAX_FEAT_IN;
-
-            /* Assign maximum number of output sensors/
-             * features to device structure
-             */
-            dev->out_sens = BMI270_MAXIMUM_FIFO_MAX_FEAT_OUT;
-
             /* Get the gyroscope cross axis sensitivity */
             rslt = bmi2_get_gyro_cross_sense(dev);
         }
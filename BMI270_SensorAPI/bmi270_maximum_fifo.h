@@ -75,6 +75,9 @@ extern "C" {
 
 /*! @name Mask definitions for feature interrupt status bits */
 
+/*! @name Feature tables and configuration file every BMI270_MAXIMUM_FIFO shares (see struct bmi2_variant) */
+extern const struct bmi2_variant bmi270_maximum_fifo_variant;
+
 /***************************************************************************/
 
 /*!     BMI270 User Interface function prototypes
@@ -93,11 +96,9 @@ extern "C" {
  * int8_t bmi270_maximum_fifo_init(struct bmi2_dev *dev);
  * \endcode
  * @details This API:
- *  1) updates the device structure with address of the configuration file.
+ *  1) Points the device structure at bmi270_maximum_fifo_variant, unless it has a variant already.
  *  2) Initializes BMI270 sensor.
  *  3) Writes the configuration file.
- *  4) Updates the feature offset parameters in the device structure.
- *  5) Updates the maximum number of pages, in the device structure.
  *
  * @param[in, out] dev      : Structure instance of bmi2_dev.
  *
@@ -178,6 +178,7 @@
 #define BMI2_E_ST_NOT_RUNING                          INT8_C(-32)
 #define BMI2_E_DATA_RDY_INT_FAILED                    INT8_C(-33)
 #define BMI2_E_INVALID_FOC_POSITION                   INT8_C(-34)
+#define BMI2_E_SCRATCH                                INT8_C(-35)
 
 /*! @name To define warnings for FIFO activity */
 #define BMI2_W_FIFO_EMPTY                             INT8_C(1)
@@ -2641,42 +2642,48 @@ struct bmi2_map_int
     uint8_t sens_map_int;
 };
 
-/*!  @name Structure to define BMI2 sensor configurations */
-struct bmi2_dev
+/*! @name Structure to define the arena the driver's temporary buffers come from */
+struct bmi2_scratch
 {
-    /*! Chip id of BMI2 */
-    uint8_t chip_id;
+    /*! Start of the arena, aligned to 4 bytes */
+    uint8_t *buf;
 
-    /*! The interface pointer is used to enable the user
-     * to link their interface descriptors for reference during the
-     * implementation of the read and write interfaces to the
-     * hardware.
-     */
-    void *intf_ptr;
+    /*! Size of the arena in bytes */
+    uint16_t size;
 
-    /*! To store warnings */
-    uint8_t info;
+    /*! Bytes in use */
+    uint16_t used;
 
-    /*! Type of Interface  */
-    enum bmi2_intf intf;
+    /*! Most bytes ever in use */
+    uint16_t peak;
+};
 
-    /*! To store interface pointer error */
-    BMI2_INTF_RETURN_TYPE intf_rslt;
+/*! @name Structure to define what every sensor of one variant shares: the feature
+ * tables, the configuration file and variant callbacks. Each variant has one, const so
+ * that it stays in flash, and each device structure points at it.
+ */
+struct bmi2_variant
+{
+    /*! Chip id of the variant */
+    uint8_t chip_id;
 
-    /*! For switching from I2C to SPI */
-    uint8_t dummy_byte;
+    /*! Pointer to the configuration data buffer address */
+    const uint8_t *config_file_ptr;
 
-    /*! Resolution for FOC */
-    uint8_t resolution;
+    /* To store hold the size of config file */
+    uint16_t config_size;
 
-    /*! User set read/write length */
-    uint16_t read_write_len;
+    /* used as a flag to enable variant specific features like crt */
+    uint16_t variant_feature;
 
-    /*! Store load status value */
-    uint8_t load_status;
+    /*! Array of feature input configuration structure */
+    const struct bmi2_feature_config *feat_config;
 
-    /*! Pointer to the configuration data buffer address */
-    const uint8_t *config_file_ptr;
+    /*! Array of feature output configuration structure */
+    const struct bmi2_feature_config *feat_output;
+
+    /*! Array of feature interrupts configuration structure */
+    const struct bmi2_map_int *map_int;
 
     /*! To define maximum page number */
     uint8_t page_max;
@@ -2687,23 +2694,41 @@ struct bmi2_dev
     /*! To define maximum number of output sensors/features */
     uint8_t out_sens;
 
-    /*! Indicate manual enable for auxiliary communication */
-    uint8_t aux_man_en;
+    /*! To define maximum number of interrupts */
+    uint8_t sens_int_map;
 
-    /*! Defines manual read burst length for auxiliary communication */
-    uint8_t aux_man_rd_burst_len;
+    /*! Function pointer to get wakeup configurations */
+    bmi2_wake_up_fptr_t get_wakeup_config;
 
-    /*! Array of feature input configuration structure */
-    const struct bmi2_feature_config *feat_config;
+    /*! Function pointer to set wakeup configurations */
+    bmi2_wake_up_fptr_t set_wakeup_config;
 
-    /*! Array of feature output configuration structure */
-    const struct bmi2_feature_config *feat_output;
+    /*! Function pointer to get tap configurations */
+    bmi2_tap_fptr_t get_tap_config;
 
-    /*! Structure to maintain a copy of the re-mapped axis */
-    struct bmi2_axes_remap remap;
+    /*! Function pointer to set tap configurations */
+    bmi2_tap_fptr_t set_tap_config;
+};
 
-    /*! Flag to hold enable status of sensors */
-    uint64_t sens_en_stat;
+/*! @name Structure to define the state of one sensor. What's the same for every
+ * sensor of a variant is in struct bmi2_variant; the members here are ordered
+ * widest first and the flags packed, so that multiple sensors cost as little
+ * RAM as possible.
+ */
+struct bmi2_dev
+{
+    /*! Tables and configuration file of the sensor's variant. Leave it NULL
+     * for the variant's init function to fill in, or point it at a copy to
+     * load a different configuration file.
+     */
+    const struct bmi2_variant *variant;
+
+    /*! The interface pointer is used to enable the user
+     * to link their interface descriptors for reference during the
+     * implementation of the read and write interfaces to the
+     * hardware.
+     */
+    void *intf_ptr;
 
     /*! Read function pointer */
     bmi2_read_fptr_t read;
@@ -2714,38 +2739,53 @@ struct bmi2_dev
     /*!  Delay function pointer */
     bmi2_delay_fptr_t delay_us;
 
+    /*! Arena for the driver's temporary buffers (register reads, feature pages, FOC samples) */
+    struct bmi2_scratch *scratch;
+
+    /*! Flag to hold enable status of sensors */
+    uint64_t sens_en_stat;
+
+    /*! User set read/write length */
+    uint16_t read_write_len;
+
     /*! To store the gyroscope cross sensitivity value */
     int16_t gyr_cross_sens_zx;
 
-    /* gyro enable status, used as a flag in CRT enabling and aborting */
-    uint8_t gyro_en : 1;
+    /*! Type of Interface  */
+    enum bmi2_intf intf;
 
-    /* advance power saving mode status, used as a flag in CRT enabling and aborting */
-    uint8_t aps_status;
+    /*! Structure to maintain a copy of the re-mapped axis */
+    struct bmi2_axes_remap remap;
 
-    /* used as a flag to enable variant specific features like crt */
-    uint16_t variant_feature;
+    /*! Chip id of BMI2, as read from the sensor */
+    uint8_t chip_id;
 
-    /* To store hold the size of config file */
-    uint16_t config_size;
+    /*! To store warnings */
+    uint8_t info;
 
-    /*! Function pointer to get wakeup configurations */
-    bmi2_wake_up_fptr_t get_wakeup_config;
+    /*! To store interface pointer error */
+    BMI2_INTF_RETURN_TYPE intf_rslt;
 
-    /*! Function pointer to set wakeup configurations */
-    bmi2_wake_up_fptr_t set_wakeup_config;
+    /*! Resolution for FOC */
+    uint8_t resolution;
 
-    /*! Function pointer to get tap configurations */
-    bmi2_tap_fptr_t get_tap_config;
+    /*! Store load status value */
+    uint8_t load_status;
 
-    /*! Function pointer to set tap configurations */
-    bmi2_tap_fptr_t set_tap_config;
+    /*! Defines manual read burst length for auxiliary communication */
+    uint8_t aux_man_rd_burst_len;
 
-    /*! Array of feature interrupts configuration structure */
-    struct bmi2_map_int *map_int;
+    /*! For switching from I2C to SPI */
+    uint8_t dummy_byte : 1;
 
-    /*! To define maximum number of interrupts */
-    uint8_t sens_int_map;
+    /*! Indicate manual enable for auxiliary communication */
+    uint8_t aux_man_en : 1;
+
+    /* gyro enable status, used as a flag in CRT enabling and aborting */
+    uint8_t gyro_en : 1;
+
+    /* advance power saving mode status, used as a flag in CRT enabling and aborting */
+    uint8_t aps_status : 1;
 };
 
 /*!  @name Structure to enable an accel axis for foc */
@@ -0,0 +1,128 @@
+#include <string.h>
+#include <driverlib.h>
+#include "aes_stream.h"
+
+#define AES_BLOCK 16
+
+#pragma PERSISTENT(starts)
+static uint32_t starts = 0;
+
+static const uint8_t key[32] = AES_STREAM_KEY;
+
+static uint8_t ring[AES_STREAM_BLOCKS][AES_BLOCK];
+// Counter block for the module's next block, and that block's number
+static uint8_t counter[AES_BLOCK];
+static uint32_t made;
+// Blocks in the ring not yet used up, and whether the module is working on another
+volatile static uint8_t ready;
+volatile static uint8_t running;
+// Set while the main loop sleeps until a block is ready
+volatile static uint8_t waiting;
+
+// The block in use, and how much of it has been used
+static uint32_t used;
+static uint8_t offset;
+
+// Start the module on block made; from the ISR, or with interrupts off
+static void start_next(void) {
+    counter[12] = made >> 24;
+    counter[13] = (made >> 16) & 0xff;
+    counter[14] = (made >> 8) & 0xff;
+    counter[15] = made & 0xff;
+    AES256_startEncryptData(AES256_BASE, counter);
+    running = 1;
+}
+
+static void next_block(void) {
+    offset = 0;
+    used += 1;
+
+    __disable_interrupt();
+    ready -= 1;
+    if (!running) {
+        start_next();
+    }
+    __enable_interrupt();
+}
+
+void aes_stream_start(uint8_t nonce[AES_STREAM_NONCE]) {
+    starts += 1;
+    memset(nonce, 0, AES_STREAM_NONCE);
+    nonce[0] = starts & 0xff;
+    nonce[1] = (starts >> 8) & 0xff;
+    nonce[2] = (starts >> 16) & 0xff;
+    nonce[3] = starts >> 24;
+
+    memset(counter, 0, sizeof(counter));
+    memcpy(counter, nonce, AES_STREAM_NONCE);
+    made = used = 0;
+    offset = 0;
+    ready = 0;
+
+    AES256_setCipherKey(AES256_BASE, key, AES256_KEYLENGTH_256BIT);
+    AES256_clearInterrupt(AES256_BASE);
+    AES256_enableInterrupt(AES256_BASE);
+
+    __disable_interrupt();
+    start_next();
+    __enable_interrupt();
+}
+
+uint32_t aes_stream_align(void) {
+    if (offset) {
+        next_block();
+    }
+    return used;
+}
+
+void aes_stream_xor(uint8_t *dst, const uint8_t *src, uint16_t len) {
+    const uint8_t *ks;
+
+    while (len) {
+        __disable_interrupt();
+        while (!ready) {
+            waiting = 1;
+
+            // Enter LPM0, with interrupts enabled, and wait for the AES interrupt
+            __bis_SR_register(LPM0_bits + GIE);
+            __disable_interrupt();
+        }
+        __enable_interrupt();
+
+        ks = ring[used % AES_STREAM_BLOCKS];
+        while (len && offset < AES_BLOCK) {
+            *dst++ = *src++ ^ ks[offset++];
+            len -= 1;
+        }
+        if (offset == AES_BLOCK) {
+            next_block();
+        }
+    }
+}
+
+
+#if defined(__TI_COMPILER_VERSION__) || defined(__IAR_SYSTEMS_ICC__)
+#pragma vector=AES256_VECTOR
+__interrupt
+#elif defined(__GNUC__)
+__attribute__((interrupt(AES256_VECTOR)))
+#endif
+void AES256_ISR(void)
+{
+  // Reading the result clears AESRDYIFG
+  AES256_getDataOut(AES256_BASE, ring[made % AES_STREAM_BLOCKS]);
+  made += 1;
+  ready += 1;
+
+  // The slot after the last one made is the one in use once the ring is full
+  if (ready < AES_STREAM_BLOCKS) {
+      start_next();
+  } else {
+      running = 0;
+  }
+
+  if (waiting) {
+      waiting = 0;
+      __bic_SR_register_on_exit(LPM0_bits); // leave low power mode
+  }
+}
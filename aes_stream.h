@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+AES-256 CTR keystream from the AES256 accelerator, for sink_aes (sink.h).
+
+The keystream doesn't depend on the data, so the module makes it ahead of time: each time it
+finishes a block, its interrupt stores the block in a ring of AES_STREAM_BLOCKS and starts on
+the next, until the ring is full. Encrypting a record is then only an XOR with what's waiting,
+and the 223 or so MCLK cycles of each block are spent while the CPU sleeps or the UART sends.
+
+Block n is the encryption of the counter block
+
+  nonce (8 bytes)  0 0 0 0  n (4 bytes, big-endian)
+
+which is AES-256-CTR as everyone else does it, with the nonce and eight zero bytes as the IV.
+Each aes_stream_start() takes a fresh nonce from a count of starts kept in FRAM, so a key never
+sees the same counter block twice. Reloading the firmware resets the count with the rest of
+FRAM, so change the key when you do, or the old nonces come round again.
+
+AES_STREAM_KEY is the key, as an initializer for 32 bytes. The default is the FIPS-197 test
+key (00 01 02 ... 1f), there to check the decryptor against, and no secret at all.
+
+CTR mode hides the data but doesn't protect it: a flipped bit in the ciphertext is a flipped
+bit in the plaintext, and nothing here notices.
+*/
+
+#ifndef AES_STREAM_KEY
+#define AES_STREAM_KEY { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, \
+                         0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, \
+                         0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, \
+                         0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f }
+#endif
+
+// Keystream blocks made ahead, 16 bytes of RAM each
+#ifndef AES_STREAM_BLOCKS
+#define AES_STREAM_BLOCKS 8
+#endif
+
+#define AES_STREAM_NONCE 8
+
+// Load the key, take a fresh nonce (copied to nonce, for the receiver) and start making
+// keystream from block 0
+void aes_stream_start(uint8_t nonce[AES_STREAM_NONCE]);
+
+// Skip what's left of the keystream block in use, and return the number of the next one
+uint32_t aes_stream_align(void);
+
+// XOR len bytes from src with the next len bytes of keystream, into dst. Sleeps if the module
+// hasn't got that far yet.
+void aes_stream_xor(uint8_t *dst, const uint8_t *src, uint16_t len);
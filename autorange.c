@@ -0,0 +1,275 @@
+#include "autorange.h"
+#include "reattach.h"
+
+// The range registers follow the ODR registers; bmi2.h has no names for them
+#define ACC_RANGE_ADDR (BMI2_ACC_CONF_ADDR + 1)
+#define GYR_RANGE_ADDR (BMI2_GYR_CONF_ADDR + 1)
+
+#define SATURATION_ACC (BMI2_SATURATION_ACC_X_MASK | BMI2_SATURATION_ACC_Y_MASK | BMI2_SATURATION_ACC_Z_MASK)
+#define SATURATION_GYR (BMI2_SATURATION_GYR_X_MASK | BMI2_SATURATION_GYR_Y_MASK | BMI2_SATURATION_GYR_Z_MASK)
+
+#pragma PERSISTENT(changes)
+static struct autorange_change changes[AUTORANGE_MAX] = { { 0 } };
+#pragma PERSISTENT(num_changes)
+static uint16_t num_changes = 0;
+
+// What's in the range registers besides the range (the gyro's OIS range bit)
+static uint8_t gyr_other;
+// Whether change 0 still waits for the first sample's sensor time
+static uint8_t unstamped;
+
+// Per group: the samples in a row under AUTORANGE_LOW, and the largest of them
+struct group {
+    uint16_t quiet;
+    uint16_t quiet_peak;
+};
+static struct group acc_group, gyr_group;
+
+// Ranges now; 2 g and 2000 dps, as set_accel_gyro_config() sets them, until autorange_start()
+static uint8_t acc_range = BMI2_ACC_RANGE_2G;
+static uint8_t gyr_range = BMI2_GYR_RANGE_2000;
+
+static uint16_t peak(const struct bmi2_sens_axes_data *v) {
+    uint16_t x = (v->x < 0) ? -(int32_t)v->x : v->x;
+    uint16_t y = (v->y < 0) ? -(int32_t)v->y : v->y;
+    uint16_t z = (v->z < 0) ? -(int32_t)v->z : v->z;
+
+    if (y > x) {
+        x = y;
+    }
+    return (z > x) ? z : x;
+}
+
+// Whether a sensor time is after the last switch's, within half the 24 bit wrap
+static uint8_t after(uint32_t sens_time, uint32_t since) {
+    uint32_t d = (sens_time - since) & 0xFFFFFF;
+
+    return d != 0 && d < 0x800000;
+}
+
+// How many ranges wider (positive) or narrower (negative) a group should go, given the peak of
+// a sample at its range; wider is toward 16 g for the accel, 2000 dps for the gyro
+static int8_t judge(struct group *g, uint16_t p) {
+    int8_t steps = 0;
+
+    // -32768 and 32767 are the rails
+    if (p >= 32767) {
+        g->quiet = 0;
+        return 4;
+    }
+    if (p >= AUTORANGE_HIGH) {
+        g->quiet = 0;
+        return 1;
+    }
+    if (p >= AUTORANGE_LOW) {
+        g->quiet = 0;
+        return 0;
+    }
+    if (g->quiet == 0 || p > g->quiet_peak) {
+        g->quiet_peak = p;
+    }
+    g->quiet += 1;
+    if (g->quiet < AUTORANGE_HOLD) {
+        return 0;
+    }
+    // Each range down doubles the values; stop while the peak is still under AUTORANGE_LOW
+    for (p = g->quiet_peak; p < AUTORANGE_LOW && steps > -4; p *= 2) {
+        steps -= 1;
+    }
+    g->quiet = 0;
+    return steps;
+}
+
+// Of two judgements, any step up over none, the larger step up, or the larger step down
+static int8_t widest(int8_t a, int8_t b) {
+    if (a > 0 || b > 0) {
+        return (a > b) ? a : b;
+    }
+    return (a < b) ? a : b;
+}
+
+static uint8_t clamp(int8_t range, uint8_t widest) {
+    if (range < 0) {
+        return 0;
+    }
+    return (range > widest) ? widest : (uint8_t)range;
+}
+
+static int8_t read_sens_time(struct bmi2_dev *bmi, uint32_t *sens_time) {
+    uint8_t sens[BMI2_SENSOR_TIME_LENGTH];
+    int8_t rslt = bmi2_get_regs(BMI2_SENSORTIME_ADDR, sens, sizeof(sens), bmi);
+
+    if (rslt == BMI2_OK) {
+        *sens_time = sens[0] | ((uint32_t)sens[1] << 8) | ((uint32_t)sens[2] << 16);
+    }
+    return rslt;
+}
+
+int8_t autorange_start(struct bmi2_dev *bmi) {
+    uint8_t regs[3];
+    int8_t rslt;
+
+    // ACC_RANGE, GYR_CONF, GYR_RANGE
+    rslt = bmi2_get_regs(ACC_RANGE_ADDR, regs, sizeof(regs), bmi);
+    if (rslt == BMI2_OK) {
+        acc_range = regs[0] & BMI2_ACC_RANGE_MASK;
+        gyr_range = regs[2] & BMI2_GYR_RANGE_MASK;
+        gyr_other = regs[2] & ~BMI2_GYR_RANGE_MASK;
+    }
+    // The sensor time comes with the first sample, rather than from a read of its own that would
+    // hold up the start of the capture
+    unstamped = 1;
+    changes[0].sens_time = 0;
+    changes[0].acc_range = acc_range;
+    changes[0].gyr_range = gyr_range;
+    num_changes = 1;
+    acc_group.quiet = gyr_group.quiet = 0;
+    return rslt;
+}
+
+int8_t autorange_update(struct bmi2_dev *bmi, const struct bmi2_sens_data *data, uint16_t count) {
+    int8_t acc_steps = 0, gyr_steps = 0;
+    uint8_t acc = acc_range, gyr = gyr_range, status, reg;
+    struct autorange_change *c;
+    uint16_t i, p, judged = 0, loud = 0;
+    uint32_t last = 0;
+    int8_t rslt = BMI2_OK;
+
+    if (num_changes == 0 || num_changes >= AUTORANGE_MAX || count == 0) {
+        return BMI2_OK;
+    }
+    if (unstamped) {
+        // A tick before the first sample, so it's judged with the rest
+        changes[0].sens_time = (data[0].sens_time - 1) & 0xFFFFFF;
+        unstamped = 0;
+    }
+    for (i = 0; i < count; i += 1) {
+        if (!after(data[i].sens_time, changes[num_changes - 1].sens_time)) {
+            continue;
+        }
+        judged += 1;
+        last = data[i].sens_time;
+        p = peak(&data[i].acc);
+        loud |= p >= AUTORANGE_HIGH;
+        acc_steps = widest(acc_steps, judge(&acc_group, p));
+        p = peak(&data[i].gyr);
+        loud |= p >= AUTORANGE_HIGH;
+        gyr_steps = widest(gyr_steps, judge(&gyr_group, p));
+    }
+
+    if (judged == 0) {
+        return BMI2_OK;
+    }
+
+    // The sensor flags clipping the filtered samples above might not show; only worth the read
+    // (and the wait after it in low power) when one of them came near the top
+    if (loud && (acc_steps < 4 || gyr_steps < 4)) {
+        rslt = bmi2_get_saturation_status(&status, bmi);
+        if (rslt != BMI2_OK) {
+            return rslt;
+        }
+        if (status & SATURATION_ACC) {
+            acc_steps = 4;
+            acc_group.quiet = 0;
+        }
+        if (status & SATURATION_GYR) {
+            gyr_steps = 4;
+            gyr_group.quiet = 0;
+        }
+    }
+
+    // Wider is a higher ACC_RANGE but a lower GYR_RANGE
+    acc = clamp((int8_t)acc_range + acc_steps, BMI2_ACC_RANGE_16G);
+    gyr = clamp((int8_t)gyr_range - gyr_steps, BMI2_GYR_RANGE_125);
+    if (acc == acc_range && gyr == gyr_range) {
+        return BMI2_OK;
+    }
+
+    // Each write that lands is a change, whatever happens after it; reattach() is told too, so
+    // a recovery doesn't put the old range back
+    if (acc != acc_range) {
+        rslt = bmi2_set_regs(ACC_RANGE_ADDR, &acc, 1, bmi);
+        if (rslt == BMI2_OK) {
+            acc_range = acc;
+            acc_group.quiet = 0;
+            reattach_note(ACC_RANGE_ADDR, acc);
+        }
+    }
+    if (rslt == BMI2_OK && gyr != gyr_range) {
+        reg = gyr_other | gyr;
+        rslt = bmi2_set_regs(GYR_RANGE_ADDR, &reg, 1, bmi);
+        if (rslt == BMI2_OK) {
+            gyr_range = gyr;
+            gyr_group.quiet = 0;
+            reattach_note(GYR_RANGE_ADDR, reg);
+        }
+    }
+    c = &changes[num_changes - 1];
+    if (acc_range == c->acc_range && gyr_range == c->gyr_range) {
+        return rslt;
+    }
+
+    // The last sample judged is the latest known to be from before the switch, which is as
+    // close as it gets if the bus has failed
+    c += 1;
+    c->sens_time = last;
+    if (rslt == BMI2_OK) {
+        rslt = read_sens_time(bmi, &c->sens_time);
+    }
+    c->acc_range = acc_range;
+    c->gyr_range = gyr_range;
+    num_changes += 1;
+    return rslt;
+}
+
+uint8_t autorange_acc_g(void) {
+    return 2 << acc_range;
+}
+
+uint16_t autorange_gyr_dps(void) {
+    return 2000 >> gyr_range;
+}
+
+uint16_t autorange_count(void) {
+    return num_changes;
+}
+
+const struct autorange_change *autorange_get(uint16_t i) {
+    return &changes[i];
+}
+
+uint16_t autorange_at(uint16_t i, uint32_t sens_time) {
+    while (i + 1 < num_changes && after(sens_time, changes[i + 1].sens_time)) {
+        i += 1;
+    }
+    return i;
+}
+
+const struct autorange_change *autorange_for(uint32_t sens_time) {
+    uint16_t i = num_changes ? num_changes - 1 : 0;
+
+    // Mostly the last one, as the samples come in
+    while (i > 0 && !after(sens_time, changes[i].sens_time)) {
+        i -= 1;
+    }
+    return &changes[i];
+}
+
+void autorange_pack(uint16_t i, uint16_t next, uint8_t out[AUTORANGE_LEN]) {
+    const struct autorange_change *c = &changes[i];
+    uint8_t k, sum = 0;
+
+    out[0] = AUTORANGE_SYNC0;
+    out[1] = AUTORANGE_SYNC1;
+    out[2] = next & 0xff;
+    out[3] = next >> 8;
+    out[4] = c->sens_time & 0xff;
+    out[5] = (c->sens_time >> 8) & 0xff;
+    out[6] = (c->sens_time >> 16) & 0xff;
+    out[7] = c->acc_range;
+    out[8] = c->gyr_range;
+    for (k = 0; k < AUTORANGE_LEN - 1; k += 1) {
+        sum += out[k];
+    }
+    out[9] = ~sum;
+}
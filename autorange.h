@@ -0,0 +1,100 @@
+#pragma once
+
+#include <stdint.h>
+#include "BMI270_SensorAPI/bmi2.h"
+
+/*
+Automatic range switching for the accel and gyro, so an impact doesn't clip at the 2 g and
+2000 dps set_accel_gyro_config() starts with, and a quiet stretch doesn't waste bits on range
+it never uses.
+
+The capture loops hand autorange_update() each sample as it's taken. For each of accel and
+gyro, separately:
+- saturated (the sample at the rails, or the flag in the SATURATION register, read when a sample
+  reaches AUTORANGE_HIGH): straight to the widest range,
+- any axis at or over AUTORANGE_HIGH LSB: up one range,
+- every axis under AUTORANGE_LOW for AUTORANGE_HOLD samples in a row: down as many ranges as
+  the largest of them allows, each halving the range and doubling the values.
+A switch is one write to ACC_RANGE or GYR_RANGE, followed by a read of the sensor time, and
+samples from before that time are left out of the next decisions, as they were taken at the old
+range. A write that lands is kept as a change even if the other one fails, and if the sensor
+time can't be read, the change takes the last sample's; either way autorange_update() returns
+the error, and a BMI2_E_COM_FAIL is for the capture loop to recover from (reattach.h).
+
+The changes are kept in FRAM with the samples, up to AUTORANGE_MAX per capture (after that the
+ranges stay put), and dump_samples() sends one ahead of the first sample taken after it, and
+one with the ranges in force ahead of the first sample of any dump, as the 10 byte record
+
+  b6 6b next_lo next_hi  sens0 sens1 sens2  acc gyr  check
+
+(next: index of the first sample at these ranges; sens: the sensor time read after the switch,
+or for the ranges the capture started with, a tick before its first sample;
+acc, gyr: the ACC_RANGE and GYR_RANGE values, +/-(2 << acc) g and +/-(2000 >> gyr) dps;
+check: the bytes before it summed, complemented), or, with DUMP_CSV, a line
+
+  !, next, sens_time, acc_g, gyr_dps
+
+A sample whose sensor time is the very tick of the read may have been taken at either range.
+*/
+
+#ifndef AUTORANGE
+#define AUTORANGE 0
+#endif
+
+#ifndef AUTORANGE_HIGH
+#define AUTORANGE_HIGH 30000
+#endif
+
+#ifndef AUTORANGE_LOW
+#define AUTORANGE_LOW 12000
+#endif
+
+// Samples under AUTORANGE_LOW before going down
+#ifndef AUTORANGE_HOLD
+#define AUTORANGE_HOLD 100
+#endif
+
+// Changes kept per capture, counting the ranges it started with
+#ifndef AUTORANGE_MAX
+#define AUTORANGE_MAX 32
+#endif
+
+#if AUTORANGE_LOW * 2 >= AUTORANGE_HIGH
+#error "AUTORANGE_LOW has to be under half of AUTORANGE_HIGH, or the ranges would see-saw"
+#endif
+
+#define AUTORANGE_SYNC0 0xB6
+#define AUTORANGE_SYNC1 0x6B
+#define AUTORANGE_LEN 10
+
+struct autorange_change {
+    // Sensor time read after the switch, 24 bit
+    uint32_t sens_time;
+    // ACC_RANGE and GYR_RANGE, range bits only
+    uint8_t acc_range;
+    uint8_t gyr_range;
+};
+
+// Forget the last capture's changes and take the sensor's ranges as the first
+int8_t autorange_start(struct bmi2_dev *bmi);
+
+// Look at count new samples, and switch ranges if they call for it. BMI2_OK, or the error
+// reading or writing the sensor.
+int8_t autorange_update(struct bmi2_dev *bmi, const struct bmi2_sens_data *data, uint16_t count);
+
+// The ranges now, for converting samples as they're taken: +/- g and +/- dps
+uint8_t autorange_acc_g(void);
+uint16_t autorange_gyr_dps(void);
+
+uint16_t autorange_count(void);
+
+const struct autorange_change *autorange_get(uint16_t i);
+
+// The change in force for a sample taken at sens_time, looking from change i on
+uint16_t autorange_at(uint16_t i, uint32_t sens_time);
+
+// The change in force for a sample taken at sens_time, looking back from the last
+const struct autorange_change *autorange_for(uint32_t sens_time);
+
+// Change i as its binary record, in force from sample next
+void autorange_pack(uint16_t i, uint16_t next, uint8_t out[AUTORANGE_LEN]);
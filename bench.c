@@ -0,0 +1,342 @@
+#include <stdio.h>
+#include <string.h>
+#include "BMI270_SensorAPI/bmi270.h"
+#include "bench.h"
+#include "util.h"
+#include "calib.h"
+
+#if BENCH
+
+// The BMI270's FIFO, and the most frames one read of it can hold (headerless accel + gyro)
+#define FIFO_SIZE 2048
+#define MAX_FRAMES (FIFO_SIZE / BMI2_FIFO_ACC_GYR_LENGTH)
+
+// Register blocks for bmi2_parse_sensor_data(), and samples for the conversions
+#define PARSE_SAMPLES 64
+
+// FIFO frame lengths without S4S, and with the aux burst at 8 bytes
+#define AUX_FRM_LEN BMI2_AUX_RD_BURST_FRM_LEN_8
+#define SENSORTIME_FRM_LEN 4
+
+// Too big for RAM on the MSP430; FRAM is as fast at 8 MHz
+#pragma PERSISTENT(fifo_buf)
+static uint8_t fifo_buf[FIFO_SIZE + 1] = { 0 };
+#pragma PERSISTENT(regs_buf)
+static uint8_t regs_buf[PARSE_SAMPLES][BMI2_ACC_GYR_AUX_SENSORTIME_NUM_BYTES] = { { 0 } };
+#pragma PERSISTENT(axes_out)
+static struct bmi2_sens_axes_data axes_out[MAX_FRAMES] = { { 0 } };
+#pragma PERSISTENT(aux_out)
+static struct bmi2_aux_fifo_data aux_out[MAX_FRAMES] = { { { 0 } } };
+#pragma PERSISTENT(calib_buf)
+static struct bmi2_sens_data calib_buf[PARSE_SAMPLES] = { { { 0 } } };
+
+// A device that's never talked to, for the parsing cases
+static struct bmi2_dev dev;
+static struct bmi2_fifo_frame fifo;
+
+// The device bmi270_init() is timed on
+static struct bmi2_dev *init_dev;
+static int8_t init_rslt;
+
+static uint32_t rand_state;
+static struct bmi2_sens_data parsed;
+// Keeps the conversions from being optimized away
+volatile static float sink;
+static char line[120];
+
+static BMI2_INTF_RETURN_TYPE no_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr) {
+    (void)reg_addr;
+    (void)reg_data;
+    (void)len;
+    (void)intf_ptr;
+    return BMI2_E_COM_FAIL;
+}
+
+static BMI2_INTF_RETURN_TYPE no_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, void *intf_ptr) {
+    (void)reg_addr;
+    (void)reg_data;
+    (void)len;
+    (void)intf_ptr;
+    return BMI2_E_COM_FAIL;
+}
+
+static void no_delay(uint32_t period, void *intf_ptr) {
+    (void)period;
+    (void)intf_ptr;
+}
+
+static uint8_t next_byte(void) {
+    uint8_t b;
+
+    // xorshift32
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+    b = rand_state & 0xff;
+    // 0x80 would read as an over-read header or empty FIFO
+    return (b == 0x80) ? 0x81 : b;
+}
+
+static void set_remap(uint8_t rotated) {
+    dev.remap.x_axis = rotated ? BMI2_MAP_Y_AXIS : BMI2_MAP_X_AXIS;
+    dev.remap.y_axis = rotated ? BMI2_MAP_X_AXIS : BMI2_MAP_Y_AXIS;
+    dev.remap.z_axis = BMI2_MAP_Z_AXIS;
+    dev.remap.x_axis_sign = BMI2_POS_SIGN;
+    dev.remap.y_axis_sign = rotated ? BMI2_NEG_SIGN : BMI2_POS_SIGN;
+    dev.remap.z_axis_sign = rotated ? BMI2_NEG_SIGN : BMI2_POS_SIGN;
+}
+
+static void init_dev_data(void) {
+    uint16_t i, j;
+
+    memset(&dev, 0, sizeof(dev));
+    dev.intf = BMI2_SPI_INTF;
+    dev.read = no_read;
+    dev.write = no_write;
+    dev.delay_us = no_delay;
+    dev.dummy_byte = 1;
+    dev.resolution = 16;
+    set_remap(0);
+
+    rand_state = 1;
+    for (i = 0; i < PARSE_SAMPLES; i++) {
+        for (j = 0; j < BMI2_ACC_GYR_AUX_SENSORTIME_NUM_BYTES; j++) {
+            regs_buf[i][j] = next_byte();
+        }
+    }
+}
+
+/* Fill fifo_buf as a read of fill bytes of FIFO would, with accel + gyro (+ aux) frames.
+Header mode ends with a sensor time frame and the over-read padding, like the real thing;
+headerless mode stops at the last whole frame. Returns the number of frames. */
+static uint16_t fill_fifo(uint8_t header, uint8_t aux, uint16_t fill) {
+    uint16_t frame_len = (aux ? AUX_FRM_LEN : 0) + BMI2_FIFO_ACC_GYR_LENGTH + (header ? 1 : 0);
+    uint16_t end = 1 + fill - (header ? SENSORTIME_FRM_LEN : 0);
+    uint16_t pos = 0, frames = 0, i;
+
+    fifo_buf[pos++] = 0;    // SPI dummy byte
+    while (pos + frame_len <= end) {
+        if (header) {
+            fifo_buf[pos++] = aux ? BMI2_FIFO_HEADER_ALL_FRM : BMI2_FIFO_HEADER_GYR_ACC_FRM;
+        }
+        for (i = header; i < frame_len; i++) {
+            fifo_buf[pos++] = next_byte();
+        }
+        frames++;
+    }
+    if (header) {
+        fifo_buf[pos++] = BMI2_FIFO_HEADER_SENS_TIME_FRM;
+        for (i = 1; i < SENSORTIME_FRM_LEN; i++) {
+            fifo_buf[pos++] = next_byte();
+        }
+        while (pos < 1 + fill) {
+            fifo_buf[pos++] = BMI2_FIFO_HEAD_OVER_READ_MSB;
+        }
+    }
+
+    memset(&fifo, 0, sizeof(fifo));
+    fifo.data = fifo_buf;
+    fifo.length = pos;
+    fifo.header_enable = header ? (BMI2_FIFO_HEADER_EN >> 8) : 0;
+    fifo.data_enable = BMI2_FIFO_ACC_EN | BMI2_FIFO_GYR_EN | (aux ? BMI2_FIFO_AUX_EN : 0);
+    fifo.acc_frm_len = BMI2_FIFO_ACC_LENGTH;
+    fifo.gyr_frm_len = BMI2_FIFO_GYR_LENGTH;
+    fifo.aux_frm_len = AUX_FRM_LEN;
+    fifo.acc_gyr_frm_len = BMI2_FIFO_ACC_GYR_LENGTH;
+    fifo.acc_aux_frm_len = BMI2_FIFO_ACC_LENGTH + AUX_FRM_LEN;
+    fifo.aux_gyr_frm_len = BMI2_FIFO_GYR_LENGTH + AUX_FRM_LEN;
+    fifo.all_frm_len = BMI2_FIFO_ACC_LENGTH + BMI2_FIFO_GYR_LENGTH + AUX_FRM_LEN;
+    return frames;
+}
+
+/* The cases: each does one unit of work and returns how many samples it covered */
+
+static uint16_t parse_once(void) {
+    uint16_t i;
+
+    for (i = 0; i < PARSE_SAMPLES; i++) {
+        (void)bmi2_parse_sensor_data(regs_buf[i], &parsed, &dev);
+    }
+    return PARSE_SAMPLES;
+}
+
+static uint16_t extract_accel_once(void) {
+    uint16_t n = MAX_FRAMES;
+
+    fifo.acc_byte_start_idx = 0;
+    (void)bmi2_extract_accel(axes_out, &n, &fifo, &dev);
+    return n;
+}
+
+static uint16_t extract_gyro_once(void) {
+    uint16_t n = MAX_FRAMES;
+
+    fifo.gyr_byte_start_idx = 0;
+    (void)bmi2_extract_gyro(axes_out, &n, &fifo, &dev);
+    return n;
+}
+
+static uint16_t extract_aux_once(void) {
+    uint16_t n = MAX_FRAMES;
+
+    fifo.aux_byte_start_idx = 0;
+    (void)bmi2_extract_aux(aux_out, &n, &fifo, &dev);
+    return n;
+}
+
+static uint16_t mps2_once(void) {
+    uint16_t i;
+    float sum = 0;
+
+    for (i = 0; i < PARSE_SAMPLES; i++) {
+        const uint8_t *acc = &regs_buf[i][BMI2_ACC_START_INDEX];
+        sum += lsb_to_mps2((int16_t)(acc[0] | (acc[1] << 8)), 2, dev.resolution);
+        sum += lsb_to_mps2((int16_t)(acc[2] | (acc[3] << 8)), 2, dev.resolution);
+        sum += lsb_to_mps2((int16_t)(acc[4] | (acc[5] << 8)), 2, dev.resolution);
+    }
+    sink = sum;
+    return PARSE_SAMPLES;
+}
+
+static uint16_t dps_once(void) {
+    uint16_t i;
+    float sum = 0;
+
+    for (i = 0; i < PARSE_SAMPLES; i++) {
+        const uint8_t *gyr = &regs_buf[i][BMI2_GYR_START_INDEX];
+        sum += lsb_to_dps((int16_t)(gyr[0] | (gyr[1] << 8)), 2000, dev.resolution);
+        sum += lsb_to_dps((int16_t)(gyr[2] | (gyr[3] << 8)), 2000, dev.resolution);
+        sum += lsb_to_dps((int16_t)(gyr[4] | (gyr[5] << 8)), 2000, dev.resolution);
+    }
+    sink = sum;
+    return PARSE_SAMPLES;
+}
+
+static uint16_t calib_once(void) {
+    calib_apply(calib_buf, PARSE_SAMPLES);
+    return PARSE_SAMPLES;
+}
+
+static uint16_t init_once(void) {
+    init_rslt = bmi270_init(init_dev);
+    return 1;
+}
+
+static void run_case(const char *name, uint16_t (*once)(void), uint32_t bytes, uint16_t inner,
+        bench_print print) {
+    uint32_t ticks[BENCH_REPS];
+    uint32_t start, min;
+    uint16_t samples, i;
+    uint8_t rep;
+
+    // Warm up, and find out how many samples a run covers
+    samples = once();
+
+    for (rep = 0; rep < BENCH_REPS; rep++) {
+        start = bench_clock_read();
+        for (i = 0; i < inner; i++) {
+            once();
+        }
+        ticks[rep] = bench_clock_read() - start;
+    }
+
+    min = ticks[0];
+    for (rep = 1; rep < BENCH_REPS; rep++) {
+        if (ticks[rep] < min) {
+            min = ticks[rep];
+        }
+    }
+    bench_report(name, samples, bytes, inner, min, bench_median(ticks, BENCH_REPS), bench_clock_hz(), print);
+}
+
+uint32_t bench_median(uint32_t *ticks, uint8_t count) {
+    uint32_t t;
+    uint8_t i, j;
+
+    // Insertion sort; there are only a handful
+    for (i = 1; i < count; i++) {
+        t = ticks[i];
+        for (j = i; j > 0 && ticks[j - 1] > t; j--) {
+            ticks[j] = ticks[j - 1];
+        }
+        ticks[j] = t;
+    }
+    return ticks[count / 2];
+}
+
+void bench_report(const char *name, uint32_t samples, uint32_t bytes, uint16_t inner,
+        uint32_t min_ticks, uint32_t median_ticks, uint32_t hz, bench_print print) {
+    uint32_t n = samples * inner;
+    // Hundredths of a tick and of a ns per sample, and bytes/s, from the fastest run
+    uint32_t ticks100 = n ? (uint32_t)((uint64_t)min_ticks * 100 / n) : 0;
+    uint32_t ns100 = n ? (uint32_t)((uint64_t)min_ticks * 100000000 / (hz / 1000) / n) : 0;
+    uint32_t rate = min_ticks ? (uint32_t)((uint64_t)bytes * inner * hz / min_ticks) : 0;
+
+    snprintf(line, sizeof(line), "%s, %lu, %lu, %lu, %lu, %lu.%02lu, %lu.%02lu, %lu",
+        name, (unsigned long)samples, (unsigned long)bytes, (unsigned long)min_ticks,
+        (unsigned long)median_ticks, (unsigned long)(ticks100 / 100), (unsigned long)(ticks100 % 100),
+        (unsigned long)(ns100 / 100), (unsigned long)(ns100 % 100), (unsigned long)rate);
+    print(line);
+}
+
+void bench_run(struct bmi2_dev *bmi, uint16_t inner, bench_print print) {
+    static const uint16_t fills[] = { FIFO_SIZE / 4, FIFO_SIZE / 2, FIFO_SIZE };
+    char name[40];
+    uint8_t header, aux, f;
+    uint16_t frames, i;
+
+    init_dev_data();
+
+    // Two lines, as the columns and the clock together don't fit in one
+    snprintf(line, sizeof(line), "# ticks at %lu Hz, best of %u runs of %u",
+        (unsigned long)bench_clock_hz(), BENCH_REPS, inner);
+    print(line);
+    print("# case, samples, bytes, min ticks, median ticks, ticks/sample, ns/sample, bytes/s");
+
+    set_remap(0);
+    run_case("parse_sensor_data", parse_once, PARSE_SAMPLES * BMI2_ACC_GYR_AUX_SENSORTIME_NUM_BYTES, inner, print);
+    set_remap(1);
+    run_case("parse_sensor_data remapped", parse_once, PARSE_SAMPLES * BMI2_ACC_GYR_AUX_SENSORTIME_NUM_BYTES, inner, print);
+    set_remap(0);
+
+    for (header = 0; header <= 1; header++) {
+        for (aux = 0; aux <= 1; aux++) {
+            for (f = 0; f < sizeof(fills) / sizeof(fills[0]); f++) {
+                frames = fill_fifo(header, aux, fills[f]);
+                if (frames == 0) {
+                    continue;
+                }
+                if (!aux) {
+                    snprintf(name, sizeof(name), "extract_accel %s %u", header ? "header" : "headerless", fills[f]);
+                    run_case(name, extract_accel_once, fifo.length, inner, print);
+                    snprintf(name, sizeof(name), "extract_gyro %s %u", header ? "header" : "headerless", fills[f]);
+                    run_case(name, extract_gyro_once, fifo.length, inner, print);
+                } else {
+                    snprintf(name, sizeof(name), "extract_aux %s %u", header ? "header" : "headerless", fills[f]);
+                    run_case(name, extract_aux_once, fifo.length, inner, print);
+                }
+            }
+        }
+    }
+
+    run_case("lsb_to_mps2", mps2_once, PARSE_SAMPLES * BMI2_FIFO_ACC_LENGTH, inner, print);
+    run_case("lsb_to_dps", dps_once, PARSE_SAMPLES * BMI2_FIFO_GYR_LENGTH, inner, print);
+
+    for (i = 0; i < PARSE_SAMPLES; i++) {
+        (void)bmi2_parse_sensor_data(regs_buf[i], &calib_buf[i], &dev);
+    }
+    run_case("calib_apply", calib_once, PARSE_SAMPLES * (BMI2_FIFO_ACC_LENGTH + BMI2_FIFO_GYR_LENGTH), inner, print);
+
+    if (bmi) {
+        init_dev = bmi;
+        init_once();
+        if (init_rslt != BMI2_OK) {
+            snprintf(line, sizeof(line), "# bmi270_init failed (%d), not timed", init_rslt);
+            print(line);
+            return;
+        }
+        run_case("bmi270_init", init_once, bmi->variant->config_size, 1, print);
+    }
+}
+
+#endif
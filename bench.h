@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+#include "BMI270_SensorAPI/bmi2.h"
+
+/*
+Microbenchmarks for the BMI270_SensorAPI paths the firmware depends on, on synthetic data:
+- bmi2_parse_sensor_data(), with the axes as they come and with a remap. get_remapped_data() is
+  static and runs on every parse either way; the remapped case shows what a rotated board costs,
+- bmi2_extract_accel(), _gyro() and _aux(), in header and headerless mode, on FIFO reads of a
+  quarter, half and all of the 2 KB FIFO,
+- lsb_to_mps2() and lsb_to_dps() from util.c,
+- calib_apply() (calib.h), the 3x3 matrix and offsets on the MPY32, with the tables it was
+  built with; the emulation's multiplier costs nothing, so only the MSP430's figure means much,
+- bmi270_init(), which is mostly the 8 KB config upload, against a real device.
+
+Each case is run once to warm up and then BENCH_REPS times; the fastest and median runs are
+reported, one CSV line per case:
+
+  case, samples, bytes, min ticks, median ticks, ticks/sample, ns/sample, bytes/s
+
+Ticks are whatever bench_clock_read() counts. On the MSP430 (bench_clock.c) that's SMCLK, read
+by a software-triggered Timer_A capture; with BENCH=1, main() runs the suite instead of
+capturing samples, with MCLK and SMCLK both at 8 MHz, so ticks are CPU cycles. The host build
+(host/bench_main.c) counts nanoseconds, and repeats each case inner times per run so the
+clock's resolution doesn't matter.
+*/
+
+#ifndef BENCH
+#define BENCH 0
+#endif
+
+#ifndef BENCH_REPS
+#define BENCH_REPS 9
+#endif
+
+// Where each line of the report goes
+typedef void (*bench_print)(const char *line);
+
+void bench_clock_init(void);
+uint32_t bench_clock_read(void);
+uint32_t bench_clock_hz(void);
+
+// Run every case. The config upload is only timed if bmi is given (already set up by
+// init_bmi_device()).
+void bench_run(struct bmi2_dev *bmi, uint16_t inner, bench_print print);
+
+// Print one line of the report; ticks are for inner * samples samples
+void bench_report(const char *name, uint32_t samples, uint32_t bytes, uint16_t inner,
+    uint32_t min_ticks, uint32_t median_ticks, uint32_t hz, bench_print print);
+
+// Median of count tick counts (reorders them)
+uint32_t bench_median(uint32_t *ticks, uint8_t count);
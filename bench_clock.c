@@ -0,0 +1,82 @@
+#include <driverlib.h>
+#include "bench.h"
+#include "wcet.h"
+
+// The clock for the benchmarks and for the WCET probes
+#if BENCH || WCET
+
+/*
+TIMER_A2 runs undivided from SMCLK and is read by a software capture on CCR1: toggling the
+capture input between GND and VCC latches the counter on the next timer clock, so a read never
+catches it mid-increment. Overflows are counted in the TAIFG interrupt to make the count 32 bits.
+*/
+
+#define BENCH_TIMER_BASE TIMER_A2_BASE
+
+volatile static uint16_t overflows;
+
+void bench_clock_init(void) {
+    Timer_A_initContinuousModeParam timer_param = {
+        .clockSource = TIMER_A_CLOCKSOURCE_SMCLK,
+        .clockSourceDivider = TIMER_A_CLOCKSOURCE_DIVIDER_1,
+        .timerInterruptEnable_TAIE = TIMER_A_TAIE_INTERRUPT_ENABLE,
+        .timerClear = TIMER_A_DO_CLEAR,
+        .startTimer = false
+    };
+    Timer_A_initCaptureModeParam capture_param = {
+        .captureRegister = TIMER_A_CAPTURECOMPARE_REGISTER_1,
+        .captureMode = TIMER_A_CAPTUREMODE_RISING_AND_FALLING_EDGE,
+        .captureInputSelect = TIMER_A_CAPTURE_INPUTSELECT_GND,
+        .synchronizeCaptureSource = TIMER_A_CAPTURE_SYNCHRONOUS,
+        .captureInterruptEnable = TIMER_A_CAPTURECOMPARE_INTERRUPT_DISABLE,
+        .captureOutputMode = TIMER_A_OUTPUTMODE_OUTBITVALUE
+    };
+
+    overflows = 0;
+    Timer_A_initContinuousMode(BENCH_TIMER_BASE, &timer_param);
+    Timer_A_initCaptureMode(BENCH_TIMER_BASE, &capture_param);
+    Timer_A_startCounter(BENCH_TIMER_BASE, TIMER_A_CONTINUOUS_MODE);
+    __enable_interrupt();
+}
+
+uint32_t bench_clock_read(void) {
+    uint16_t state = __get_SR_register() & GIE;
+    uint16_t low, high;
+
+    __disable_interrupt();
+    // Flip the capture input: the edge copies the counter into CCR1
+    TA2CCTL1 ^= CCIS0;
+    __no_operation();
+    low = Timer_A_getCaptureCompareCount(BENCH_TIMER_BASE, TIMER_A_CAPTURECOMPARE_REGISTER_1);
+    high = overflows;
+    // An overflow the ISR hasn't counted yet, from before the capture
+    if ((TA2CTL & TAIFG) && low < 0x8000) {
+        high += 1;
+    }
+    __bis_SR_register(state);
+
+    return ((uint32_t)high << 16) | low;
+}
+
+uint32_t bench_clock_hz(void) {
+    return CS_getSMCLK();
+}
+
+#if defined(__TI_COMPILER_VERSION__) || defined(__IAR_SYSTEMS_ICC__)
+#pragma vector=TIMER2_A1_VECTOR
+__interrupt
+#elif defined(__GNUC__)
+__attribute__((interrupt(TIMER2_A1_VECTOR)))
+#endif
+void TIMER2_A1_ISR(void)
+{
+    switch (__even_in_range(TA2IV, TAIV__TAIFG))
+    {
+        case TAIV__TAIFG:
+            overflows += 1;
+            break;
+        default: break;
+    }
+}
+
+#endif
@@ -0,0 +1,93 @@
+#include <driverlib.h>
+#include "BMI270_SensorAPI/bmi2.h"
+#include "bmi270_int.h"
+
+volatile static uint8_t int1_fired;
+volatile static uint8_t sleeping;
+volatile static uint16_t int1_edges;
+
+void bmi270_int_init(void) {
+    GPIO_setAsInputPinWithPullDownResistor(BMI_INT1_PORT, BMI_INT1_PIN);
+    GPIO_selectInterruptEdge(BMI_INT1_PORT, BMI_INT1_PIN, GPIO_LOW_TO_HIGH_TRANSITION);
+    GPIO_clearInterrupt(BMI_INT1_PORT, BMI_INT1_PIN);
+    GPIO_enableInterrupt(BMI_INT1_PORT, BMI_INT1_PIN);
+    int1_fired = 0;
+}
+
+int8_t bmi270_int_configure(struct bmi2_dev *bmi) {
+    int8_t rslt;
+    struct bmi2_int_pin_config pin_config;
+
+    pin_config.pin_type = BMI2_INT1;
+    rslt = bmi2_get_int_pin_config(&pin_config, bmi);
+    if (rslt == BMI2_OK) {
+        pin_config.pin_type = BMI2_INT1;
+        pin_config.int_latch = BMI2_INT_NON_LATCH;
+        pin_config.pin_cfg[0].output_en = BMI2_INT_OUTPUT_ENABLE;
+        pin_config.pin_cfg[0].od = BMI2_INT_PUSH_PULL;
+        pin_config.pin_cfg[0].lvl = BMI2_INT_ACTIVE_HIGH;
+        pin_config.pin_cfg[0].input_en = BMI2_INT_INPUT_DISABLE;
+        rslt = bmi2_set_int_pin_config(&pin_config, bmi);
+    }
+
+    return rslt;
+}
+
+uint8_t bmi270_int_active(void) {
+    return GPIO_getInputPinValue(BMI_INT1_PORT, BMI_INT1_PIN) == GPIO_INPUT_PIN_HIGH;
+}
+
+uint16_t bmi270_int_edges(void) {
+    return int1_edges;
+}
+
+void bmi270_int_sleep(void) {
+    // Interrupts stay off between the check and going to sleep so an edge in between
+    // can't get lost
+    __disable_interrupt();
+    if (!int1_fired && !bmi270_int_active()) {
+        sleeping = 1;
+
+        // Enter LPM3, with interrupts enabled, and wait for INT1
+        __bis_SR_register(LPM3_bits + GIE);
+    } else {
+        __enable_interrupt();
+    }
+    int1_fired = 0;
+}
+
+void bmi270_int_hibernate(void) {
+    __disable_interrupt();
+    if (!int1_fired && !bmi270_int_active()) {
+        sleeping = 1;
+
+        // With the regulator off, LPM4 becomes LPM4.5. The I/O pins keep their state, and the
+        // INT1 edge wakes us through a reset. If the edge beats us to it, the ISR brings us back here.
+        PMM_turnOffRegulator();
+        __bis_SR_register(LPM4_bits + GIE);
+        PMM_turnOnRegulator();
+    } else {
+        __enable_interrupt();
+    }
+    int1_fired = 0;
+}
+
+#if defined(__TI_COMPILER_VERSION__) || defined(__IAR_SYSTEMS_ICC__)
+#pragma vector=PORT1_VECTOR
+__interrupt
+#elif defined(__GNUC__)
+__attribute__((interrupt(PORT1_VECTOR)))
+#endif
+void PORT1_ISR(void)
+{
+    GPIO_clearInterrupt(BMI_INT1_PORT, BMI_INT1_PIN);
+    int1_fired = 1;
+    int1_edges += 1;
+
+    // Only wake main if it's actually waiting on INT1. The SPI and UART drivers also sleep
+    // in LPM0 mid-transfer, and waking them early would cut their transfers short.
+    if (sleeping) {
+        sleeping = 0;
+        __bic_SR_register_on_exit(LPM4_bits); // leave low power mode
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+#include "BMI270_SensorAPI/bmi2.h"
+
+/*
+The BMI270's INT1 output, wired to P1.3:
+
+P1.3 <- BMI270 pin 4 (INT1), configured push-pull, active high
+*/
+
+#define BMI_INT1_PORT GPIO_PORT_P1
+#define BMI_INT1_PIN GPIO_PIN3
+
+void bmi270_int_init(void);
+
+// Set the sensor's INT1 up the way P1.3 expects it: a push-pull, active high output,
+// non-latched. Which interrupts are mapped to it is left to the caller.
+int8_t bmi270_int_configure(struct bmi2_dev *bmi);
+
+// Whether INT1 is currently asserted
+uint8_t bmi270_int_active(void);
+
+// Rising edges of INT1 so far, wrapping around; two calls tell whether it rose in between,
+// even if it's low again by the second
+uint16_t bmi270_int_edges(void);
+
+// Sleep in LPM3 until INT1 rises (returns straight away if it already has)
+void bmi270_int_sleep(void);
+
+// Sleep in LPM4.5 until INT1 rises. RAM and registers are lost, so waking up goes through a
+// reset; this only returns if INT1 rose before we got to sleep.
+void bmi270_int_hibernate(void);
@@ -12,6 +12,9 @@ P1.7: UCB0SOMI (peripheral out, controller in) -> BMI270 pin 1
 #include <driverlib.h>
 #include "BMI270_SensorAPI/bmi270.h"
 #include "bmi270_spi.h"
+#include "spi_trace.h"
+#include "wcet.h"
+#include "mem_watch.h"
 
 volatile static const uint8_t* tx_data;
 volatile static uint32_t tx_len;
@@ -24,6 +27,105 @@ static uint32_t mclk_uhz;
 
 enum RwState { NONE, TRANSMITTING, RECEIVING, RECEIVING_REGTX };
 volatile static enum RwState rw_state = NONE;
+// Set by the deadline timer's ISR
+volatile static uint8_t deadline_hit;
+
+static struct bmi270_spi_stats stats;
+
+void init_spi() {
+    // Set pins P1.6 and P1.4 as UCB0SIMO and UCB0CLK respectively
+    GPIO_setAsPeripheralModuleFunctionOutputPin(
+        GPIO_PORT_P1,
+        GPIO_PIN6 + GPIO_PIN4,
+        GPIO_PRIMARY_MODULE_FUNCTION
+    );
+
+    // Set pin P1.7 as UCB0SOMI
+    GPIO_setAsPeripheralModuleFunctionInputPin(
+        GPIO_PORT_P1,
+        GPIO_PIN7,
+        GPIO_PRIMARY_MODULE_FUNCTION
+    );
+
+    // While it is possible to set this as an SPI chip select pin (UCB0STE), it should instead
+    // be set just as a normal GPIO output, so that it doesn't get driven low after every write.
+    GPIO_setAsOutputPin(GPIO_PORT_P1, GPIO_PIN5);
+    GPIO_setOutputLowOnPin(GPIO_PORT_P1, GPIO_PIN5);
+    __delay_cycles(100);
+    GPIO_setOutputHighOnPin(GPIO_PORT_P1, GPIO_PIN5);
+
+    // Disable the GPIO power-on default high-impedance mode
+    // to activate previously configured port settings
+    PMM_unlockLPM5();
+
+    EUSCI_B_SPI_initMasterParam param = {
+        .selectClockSource = EUSCI_B_SPI_CLOCKSOURCE_SMCLK,
+        .clockSourceFrequency = CS_getSMCLK(),
+        .desiredSpiClock = SPI_CLOCK_HZ,
+        // Per the datasheet, the BMI270 supports either 00 (the current setting) or 11 for clockPhase and clockPolarity.
+        // This is automatically detected by the BMI270.
+        .clockPhase = EUSCI_B_SPI_PHASE_DATA_CHANGED_ONFIRST_CAPTURED_ON_NEXT,
+        .clockPolarity = EUSCI_B_SPI_CLOCKPOLARITY_INACTIVITY_LOW,
+        .msbFirst = EUSCI_B_SPI_MSB_FIRST,
+        .spiMode = EUSCI_B_SPI_4PIN_UCxSTE_ACTIVE_LOW
+    };
+    EUSCI_B_SPI_initMaster(SPI_BASE, &param);
+    // Honestly I have no idea what this next line does, it might do nothing
+    EUSCI_B_SPI_select4PinFunctionality(SPI_BASE, EUSCI_B_SPI_ENABLE_SIGNAL_FOR_4WIRE_SLAVE);
+    EUSCI_B_SPI_enable(SPI_BASE);
+
+    // Free-running 1 us timer for transaction deadlines
+    Timer_A_initContinuousModeParam timer_param = {
+        .clockSource = TIMER_A_CLOCKSOURCE_SMCLK,
+        .clockSourceDivider = TIMER_A_CLOCKSOURCE_DIVIDER_8, // 8 MHz SMCLK / 8
+        .timerInterruptEnable_TAIE = TIMER_A_TAIE_INTERRUPT_DISABLE,
+        .timerClear = TIMER_A_DO_CLEAR,
+        .startTimer = true
+    };
+    Timer_A_initContinuousMode(SPI_TIMER_BASE, &timer_param);
+}
+
+/* Sleep until the transfer that was just started finishes, or until its deadline passes.
+Returns nonzero if the deadline passed first. Must be called with interrupts disabled. */
+static uint8_t wait_for_transfer(uint32_t len) {
+    uint16_t start = Timer_A_getCounterValue(SPI_TIMER_BASE);
+    uint32_t deadline = SPI_DEADLINE_US(len);
+    uint16_t elapsed;
+    uint8_t timed_out = 0;
+
+    if (deadline > 0xF000) {
+        deadline = 0xF000;
+    }
+    Timer_A_setCompareValue(SPI_TIMER_BASE, TIMER_A_CAPTURECOMPARE_REGISTER_0, start + (uint16_t)deadline);
+    Timer_A_clearCaptureCompareInterrupt(SPI_TIMER_BASE, TIMER_A_CAPTURECOMPARE_REGISTER_0);
+    Timer_A_enableCaptureCompareInterrupt(SPI_TIMER_BASE, TIMER_A_CAPTURECOMPARE_REGISTER_0);
+    deadline_hit = 0;
+
+    // Enter LPM0, with interrupts enabled, and wait for the transfer to finish or the deadline.
+    // Other ISRs (the UART, INT1, the RTC) wake the CPU too, so go back to sleep until it's one
+    // of those two, with interrupts off again while checking so neither is missed in between.
+    while (rw_state != NONE && !deadline_hit) {
+        __bis_SR_register(LPM0_bits + GIE);
+        __disable_interrupt();
+    }
+    __enable_interrupt();
+
+    Timer_A_disableCaptureCompareInterrupt(SPI_TIMER_BASE, TIMER_A_CAPTURECOMPARE_REGISTER_0);
+
+    elapsed = Timer_A_getCounterValue(SPI_TIMER_BASE) - start;
+    if (elapsed > stats.max_us) {
+        stats.max_us = elapsed;
+    }
+    stats.transactions += 1;
+
+    if (rw_state != NONE) {
+        // The ISR never finished the transfer
+        rw_state = NONE;
+        stats.timeouts += 1;
+        timed_out = 1;
+    }
+    return timed_out;
+}
 
 
 /* Delay a specified number of microseconds -- function to be passed to the BMI270 library */
@@ -38,6 +140,16 @@ void bmi2_delay_us(uint32_t period, void* intf_ptr) {
 /* Read len bytes from the device at its register reg_addr into reg_data --
 function to be passed to the BMI270 library */
 BMI2_INTF_RETURN_TYPE bmi2_spi_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr) {
+    uint8_t timed_out;
+
+#if SPI_TRACE
+    spi_trace_begin();
+#endif
+
+    // Keep the ISR from running until we're asleep, otherwise it could finish the transfer and
+    // wake us before we've gone to sleep
+    __disable_interrupt();
+
     rx_data = reg_data;
     rx_len = len;
     rx_count = 0;
@@ -48,17 +160,28 @@ BMI2_INTF_RETURN_TYPE bmi2_spi_read(uint8_t reg_addr, uint8_t *reg_data, uint32_
     EUSCI_B_SPI_enableInterrupt(SPI_BASE, EUSCI_B_SPI_RECEIVE_INTERRUPT | EUSCI_B_SPI_TRANSMIT_INTERRUPT);
     EUSCI_B_SPI_transmitData(SPI_BASE, 0x80 | reg_addr);    // MSB=1 indicates a read to the device
 
-    // Enter LPM0, with interrupts enabled, and wait for transmit interrupt
-    __bis_SR_register(LPM0_bits + GIE);
+    timed_out = wait_for_transfer(len);
 
     EUSCI_B_SPI_disableInterrupt(SPI_BASE, EUSCI_B_SPI_RECEIVE_INTERRUPT | EUSCI_B_SPI_TRANSMIT_INTERRUPT);
     GPIO_setOutputHighOnPin(GPIO_PORT_P1, GPIO_PIN5);   // Set CSB high to indicate end of transmission
-    return 0;
+
+#if SPI_TRACE
+    spi_trace_end(reg_addr, SPI_TRACE_READ | (timed_out ? SPI_TRACE_FAILED : 0), reg_data, len);
+#endif
+    return timed_out ? BMI2_SPI_E_TIMEOUT : BMI2_INTF_RET_SUCCESS;
 }
 
 /* Write len bytes from reg_data into the device at its register reg_addr --
 function to be passed to the BMI270 library */
 BMI2_INTF_RETURN_TYPE bmi2_spi_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, void *intf_ptr) {
+    uint8_t timed_out;
+
+#if SPI_TRACE
+    spi_trace_begin();
+#endif
+
+    __disable_interrupt();
+
     tx_data = reg_data;
     tx_len = len;
     tx_count = 0;
@@ -69,12 +192,15 @@ BMI2_INTF_RETURN_TYPE bmi2_spi_write(uint8_t reg_addr, const uint8_t *reg_data,
     EUSCI_B_SPI_enableInterrupt(SPI_BASE, EUSCI_B_SPI_TRANSMIT_INTERRUPT);
     EUSCI_B_SPI_transmitData(SPI_BASE, reg_addr);
 
-    // Enter LPM0, with interrupts enabled, and wait for transmit interrupt
-    __bis_SR_register(LPM0_bits + GIE);
+    timed_out = wait_for_transfer(len);
 
     EUSCI_B_SPI_disableInterrupt(SPI_BASE, EUSCI_B_SPI_TRANSMIT_INTERRUPT);
     GPIO_setOutputHighOnPin(GPIO_PORT_P1, GPIO_PIN5);   // Set CSB high to indicate end of transmission
-    return 0;
+
+#if SPI_TRACE
+    spi_trace_end(reg_addr, timed_out ? SPI_TRACE_FAILED : 0, reg_data, len);
+#endif
+    return timed_out ? BMI2_SPI_E_TIMEOUT : BMI2_INTF_RET_SUCCESS;
 }
 
 void init_bmi_device(struct bmi2_dev* bmi) {
@@ -93,8 +219,23 @@ void init_bmi_device(struct bmi2_dev* bmi) {
     // Configure max read/write length (in bytes) ( Supported length depends on target machine)
     bmi->read_write_len = 46;
 
-    // Assign to NULL to load the default config file.
-    bmi->config_file_ptr = NULL;
+    // Assign to NULL for bmi270_init() to use the BMI270's shared tables and default config file.
+    bmi->variant = NULL;
+
+    // Temporary buffers come from a fixed arena rather than the stack
+    mem_watch_attach(bmi);
+}
+
+void bmi270_spi_recover(void) {
+    // Putting the eUSCI back into reset clears its state machine and flags
+    EUSCI_B_SPI_disable(SPI_BASE);
+    rw_state = NONE;
+    init_spi();
+    stats.recoveries += 1;
+}
+
+void bmi270_spi_get_stats(struct bmi270_spi_stats *out) {
+    *out = stats;
 }
 
 #if defined(__TI_COMPILER_VERSION__) || defined(__IAR_SYSTEMS_ICC__)
@@ -105,6 +246,8 @@ __attribute__((interrupt(USCI_B0_VECTOR)))
 #endif
 void USCI_B0_ISR (void)
 {
+    WCET_ISR_BEGIN();
+
     switch (__even_in_range(UCB0IV, USCI_SPI_UCTXIFG))
     {
         case USCI_NONE: break;
@@ -158,4 +301,19 @@ void USCI_B0_ISR (void)
             break;
         default: break;
     }
+
+    WCET_ISR_END(WCET_USCI_B0_ISR);
+}
+
+#if defined(__TI_COMPILER_VERSION__) || defined(__IAR_SYSTEMS_ICC__)
+#pragma vector=TIMER1_A0_VECTOR
+__interrupt
+#elif defined(__GNUC__)
+__attribute__((interrupt(TIMER1_A0_VECTOR)))
+#endif
+void TIMER1_A0_ISR(void)
+{
+    // Transaction deadline passed; the caller sees rw_state is still set and gives up
+    deadline_hit = 1;
+    __bic_SR_register_on_exit(LPM0_bits); // leave low power mode
 }
\ No newline at end of file
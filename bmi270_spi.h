@@ -1,5 +1,39 @@
 #pragma once
 
+#include <stdint.h>
+
 #define SPI_BASE EUSCI_B0_BASE
+// Timer used for transaction deadlines, running at 1 MHz
+#define SPI_TIMER_BASE TIMER_A1_BASE
+
+// SPI clock, in Hz. SMCLK is 8 MHz in every mode, so 8 MHz is as fast as the eUSCI goes; the
+// BMI270 itself is good for 10 MHz.
+#ifndef SPI_CLOCK_HZ
+#define SPI_CLOCK_HZ 2000000UL
+#endif
+
+// Deadline for a transaction of len data bytes plus the address byte, in us. Each byte gets four
+// times its time on the wire (4 us at 2 MHz), but never less than the ISR round trip needs;
+// anything past this is a wedged bus.
+#define SPI_BYTE_DEADLINE_US ((32000000UL / SPI_CLOCK_HZ > 8) ? 32000000UL / SPI_CLOCK_HZ : 8UL)
+#define SPI_DEADLINE_US(len) (100UL + SPI_BYTE_DEADLINE_US * ((len) + 1))
+
+// Returned by the read/write functions when a transaction misses its deadline
+// (the BMI270 library turns it into BMI2_E_COM_FAIL)
+#define BMI2_SPI_E_TIMEOUT INT8_C(-1)
+
+struct bmi270_spi_stats {
+    uint32_t transactions;
+    uint32_t timeouts;
+    uint16_t recoveries;
+    // Longest transaction seen, in us
+    uint16_t max_us;
+};
+
+void init_spi(void);
+void init_bmi_device(struct bmi2_dev* bmi);
+
+// Reset and reinitialize the eUSCI after a failed transaction
+void bmi270_spi_recover(void);
 
-void init_bmi_device(struct bmi2_dev* bmi);
\ No newline at end of file
+void bmi270_spi_get_stats(struct bmi270_spi_stats *stats);
\ No newline at end of file
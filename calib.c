@@ -0,0 +1,57 @@
+#include <driverlib.h>
+#include "calib.h"
+#include "autorange.h"
+
+static const struct calib_axes acc_calib = CALIB_ACC;
+static const struct calib_axes gyr_calib = CALIB_GYR;
+
+// One of accel or gyro, at a range shift places wider than the narrowest
+static void apply(const struct calib_axes *c, struct bmi2_sens_axes_data *v, uint8_t shift) {
+    // x, y and z lie next to each other
+    int16_t *out = &v->x;
+    int16_t in[3];
+    int32_t sum;
+    uint8_t r, k;
+
+    in[0] = v->x;
+    in[1] = v->y;
+    in[2] = v->z;
+    for (r = 0; r < 3; r += 1) {
+        // The offset lined up with the Q14 products, which halves it for each range wider
+        // without losing its low bits, and half an LSB to round the sum
+        MPY32_preloadResult((uint64_t)(int64_t)((int32_t)c->offset[r] * (1L << (CALIB_Q - shift)) +
+                                                (1L << (CALIB_Q - 1))));
+        for (k = 0; k < 3; k += 1) {
+            MPY32_setOperandOne16Bit(MPY32_MULTIPLYACCUMULATE_SIGNED, (uint16_t)c->m[r][k]);
+            MPY32_setOperandTwo16Bit((uint16_t)in[k]);
+        }
+        // >> floors on both compilers
+        sum = (int32_t)(uint32_t)MPY32_getResult() >> CALIB_Q;
+        out[r] = (sum > INT16_MAX) ? INT16_MAX : (sum < INT16_MIN) ? INT16_MIN : (int16_t)sum;
+    }
+}
+
+void calib_apply(struct bmi2_sens_data *data, uint16_t count) {
+    uint8_t acc_range, gyr_range;
+    uint16_t i;
+#if AUTORANGE
+    const struct autorange_change *c;
+#endif
+
+    // As set_accel_gyro_config() sets them
+    acc_range = BMI2_ACC_RANGE_2G;
+    gyr_range = BMI2_GYR_RANGE_2000;
+    for (i = 0; i < count; i += 1) {
+#if AUTORANGE
+        c = autorange_for(data[i].sens_time);
+        acc_range = c->acc_range;
+        gyr_range = c->gyr_range;
+#endif
+        // The multiplier holds the sums between writes, so nothing else may use it until
+        // the sample is done, an ISR the compiler had multiply included
+        __disable_interrupt();
+        apply(&acc_calib, &data[i].acc, acc_range - BMI2_ACC_RANGE_2G);
+        apply(&gyr_calib, &data[i].gyr, BMI2_GYR_RANGE_125 - gyr_range);
+        __enable_interrupt();
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+#include "BMI270_SensorAPI/bmi2.h"
+
+/*
+Per-device calibration of the samples, for CALIB=1: each of accel and gyro goes through
+
+  out = M * raw + offset
+
+as it's captured, with M a 3x3 matrix that takes out the scale and misalignment of the axes, and
+offset their zero error, so what's stored and sent is ready to use without a calibration file
+on the host. The three rows are three multiply-accumulates each on the MPY32, the offset
+preloaded into the result, so a sample costs one matrix multiply and no division.
+
+M also does the board's axis remap: a rotated or flipped mounting is a signed permutation
+folded into it, so the driver's remap (bmi2_set_remap_axes()) is to stay at its default, or
+the samples would be turned twice.
+
+M is in Q14, 16384 being 1, so each entry is -2 to just under 2 and the rows' absolute sums
+have to stay under 4 for the sums to fit in 32 bits. The offsets are in LSB at the narrowest
+range, 2 g or 125 dps, and halved for each range wider, so they hold whatever range the sample
+was taken at, AUTORANGE (autorange.h) or not; the matrix is the same at every range. Outputs
+are rounded to the nearest LSB, and clipped to 16 bits.
+
+CALIB_ACC and CALIB_GYR are the tables, as initializers for struct calib_axes: M row by row,
+then the offsets of x, y and z. host/calib_fit.c works them out from still captures in a few
+orientations. They're kept in FRAM, and the defaults are the identity and no offset.
+*/
+
+#ifndef CALIB
+#define CALIB 0
+#endif
+
+#ifndef CALIB_ACC
+#define CALIB_ACC { { { 16384, 0, 0 }, { 0, 16384, 0 }, { 0, 0, 16384 } }, { 0, 0, 0 } }
+#endif
+
+#ifndef CALIB_GYR
+#define CALIB_GYR { { { 16384, 0, 0 }, { 0, 16384, 0 }, { 0, 0, 16384 } }, { 0, 0, 0 } }
+#endif
+
+#define CALIB_Q 14
+
+struct calib_axes {
+    int16_t m[3][3];
+    int16_t offset[3];
+};
+
+// Calibrate count samples in place, each at the ranges it was taken at
+void calib_apply(struct bmi2_sens_data *data, uint16_t count);
@@ -0,0 +1,93 @@
+#include <driverlib.h>
+#include "uart.h"
+#include "dma_dump.h"
+
+// Set by the ISR when the channel has moved its last byte; nothing has been sent yet at reset
+volatile static uint8_t done = 1;
+// Set while the main loop sleeps until then; nothing else gets woken, as for the UART
+volatile static uint8_t waiting;
+
+void dma_send_async(const uint8_t *buf, uint16_t len) {
+    DMA_initParam param = { 0 };
+
+    param.channelSelect = DMA_CHANNEL_0;
+    param.transferModeSelect = DMA_TRANSFER_SINGLE;
+    param.transferSize = len;
+    param.triggerSourceSelect = DMA_TRIGGERSOURCE_17; // UCA1TXIFG
+    param.transferUnitSelect = DMA_SIZE_SRCBYTE_DSTBYTE;
+    param.triggerTypeSelect = DMA_TRIGGER_RISINGEDGE;
+    DMA_init(&param);
+    DMA_setSrcAddress(DMA_CHANNEL_0, (uintptr_t)buf, DMA_DIRECTION_INCREMENT);
+    DMA_setDstAddress(DMA_CHANNEL_0, EUSCI_A_UART_getTransmitBufferAddress(EUSCI_A1_BASE),
+                      DMA_DIRECTION_UNCHANGED);
+    DMA_clearInterrupt(DMA_CHANNEL_0);
+    DMA_enableInterrupt(DMA_CHANNEL_0);
+
+    done = 0;
+    __disable_interrupt();
+    DMA_enableTransfers(DMA_CHANNEL_0);
+
+    // The trigger is UCA1TXIFG's rising edge, as the byte before moves on. If it has been and
+    // gone already, start the first transfer by hand; each one after brings the flag back up.
+    if (EUSCI_A_UART_getInterruptStatus(EUSCI_A1_BASE, EUSCI_A_UART_TRANSMIT_INTERRUPT_FLAG)) {
+        DMA_startTransfer(DMA_CHANNEL_0);
+    }
+    __enable_interrupt();
+}
+
+uint8_t dma_send_busy(void) {
+    return !done;
+}
+
+void dma_send_wait(void) {
+    __disable_interrupt();
+    while (!done) {
+        waiting = 1;
+
+        // Enter LPM0, with interrupts enabled, and wait for the DMA interrupt
+        __bis_SR_register(LPM0_bits + GIE);
+        __disable_interrupt();
+    }
+    __enable_interrupt();
+}
+
+void dma_dump(const uint8_t *buf, uint32_t len) {
+    uint8_t marker[DMA_DUMP_MARKER_LEN] = { DMA_DUMP_SYNC0, DMA_DUMP_SYNC1 };
+    uint32_t sent;
+    uint16_t chunk;
+    uint8_t seq = 0;
+
+    for (sent = 0; sent < len; sent += chunk) {
+        chunk = (len - sent > DMA_DUMP_BLOCK) ? DMA_DUMP_BLOCK : len - sent;
+        marker[2] = seq;
+        marker[3] = ~seq;
+        seq += 1;
+
+        // The block goes on the marker's last byte, still in UCA1TXBUF
+        uart_write(0, marker, sizeof(marker));
+        dma_send_async(&buf[sent], chunk);
+        dma_send_wait();
+    }
+}
+
+
+#if defined(__TI_COMPILER_VERSION__) || defined(__IAR_SYSTEMS_ICC__)
+#pragma vector=DMA_VECTOR
+__interrupt
+#elif defined(__GNUC__)
+__attribute__((interrupt(DMA_VECTOR)))
+#endif
+void DMA_ISR(void)
+{
+  switch(__even_in_range(DMAIV,DMAIV_DMA2IFG))
+  {
+    case DMAIV_DMA0IFG:
+        done = 1;
+        if (waiting) {
+            waiting = 0;
+            __bic_SR_register_on_exit(LPM0_bits); // leave low power mode
+        }
+        break;
+    default: break;
+  }
+}
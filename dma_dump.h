@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+Zero-copy dump over EUSCI_A1: DMA channel 0 moves the bytes straight from where they lie (the
+FRAM log of packed records, sink.h) into UCA1TXBUF on each UCA1TXIFG, while the CPU sleeps in
+LPM0. There's no per-byte interrupt and no copy, so the dump goes as fast as the link.
+
+The data goes in blocks of up to DMA_DUMP_BLOCK bytes, each after a marker
+
+  a5 5a seq ~seq
+
+with seq counting blocks from 0, so a receiver can pick the records up again at the next block
+after losing bytes, and tell if a whole block went missing. Keep DMA_DUMP_BLOCK a multiple of
+the record length, so no record is split by a marker.
+
+With DUMP_DMA=1, main() sends its samples to the FRAM log (OUTPUT_SINKS has to include
+SINK_FRAM and leave out SINK_UART, and DUMP_FORMAT be DUMP_BINARY) and then dumps the log this
+way. The decoder in host/uart_decode.c skips the markers.
+
+dma_send_async() is the same transfer without the marker or the wait, for anything else that
+has a buffer to go out on A1 with the CPU free in the meantime (sink_aes in sink.h). It owns
+channel 0 and DMA_ISR, so only one of them can be in a build.
+*/
+
+#ifndef DUMP_DMA
+#define DUMP_DMA 0
+#endif
+
+#ifndef DMA_DUMP_BLOCK
+#define DMA_DUMP_BLOCK 1024
+#endif
+
+#define DMA_DUMP_SYNC0 0xA5
+#define DMA_DUMP_SYNC1 0x5A
+#define DMA_DUMP_MARKER_LEN 4
+
+// Send len bytes from buf, in marked blocks, and return once the last one is in UCA1TXBUF
+void dma_dump(const uint8_t *buf, uint32_t len);
+
+// Start sending len bytes from buf on channel 0; buf has to stay put until dma_send_busy() is 0
+void dma_send_async(const uint8_t *buf, uint16_t len);
+
+// Whether channel 0 still has bytes to move
+uint8_t dma_send_busy(void);
+
+// Sleep until channel 0 has moved its last byte into UCA1TXBUF
+void dma_send_wait(void);
@@ -0,0 +1,95 @@
+#include <driverlib.h>
+#include "BMI270_SensorAPI/bmi2.h"
+#include "drdy.h"
+#include "bmi270_int.h"
+#include "reattach.h"
+#include "rtc_anchor.h"
+#include "autorange.h"
+#include "calib.h"
+#include "shock.h"
+#include "health.h"
+
+static uint16_t period;
+
+// Get the bus and the stream back after a transaction missed its deadline, then INT1, whose
+// edges may have come and gone meanwhile
+static int8_t recover(struct bmi2_dev *bmi) {
+    int8_t rslt = reattach_recover(bmi);
+
+    if (rslt == BMI2_OK) {
+        bmi270_int_init();
+    }
+    return rslt;
+}
+
+int8_t drdy_start(struct bmi2_dev *bmi, uint16_t period_sens) {
+    int8_t rslt;
+
+    period = period_sens;
+
+    // INT1 as a push-pull, active high output, carrying only data ready
+    rslt = bmi270_int_configure(bmi);
+    if (rslt == BMI2_OK) {
+        rslt = bmi2_map_data_int(BMI2_DRDY_INT, BMI2_INT1, bmi);
+    }
+
+    // Every wake-up goes straight into the SPI driver, which runs from FRAM
+    FRAMCtl_delayPowerUpFromLPM(FRAMCTL_DELAY_FROM_LPM_DISABLE);
+
+    bmi270_int_init();
+
+    return rslt;
+}
+
+uint16_t drdy_run(struct bmi2_dev *bmi, struct bmi2_sens_data *out, uint16_t count) {
+    uint16_t done = 0;
+    int8_t rslt;
+
+    while (done < count) {
+        bmi270_int_sleep();
+
+#if HEALTH
+        rslt = health_get_sensor_data(&out[done], done, bmi);
+#else
+        rslt = bmi2_get_sensor_data(&out[done], bmi);
+#endif
+        if (rslt == BMI2_E_COM_FAIL) {
+            // Wait for the next sample
+            if (recover(bmi) != BMI2_OK) {
+                return done;
+            }
+            continue;
+        }
+        if (rslt != BMI2_OK) {
+            return done;
+        }
+        // Accel and gyro run at the same rate, so the pulse is for both; anything else (a
+        // pulse that beat the previous read to the registers) is a sample already read
+        if ((out[done].status & BMI2_DRDY_ACC) && (out[done].status & BMI2_DRDY_GYR)) {
+            // The sensor time comes from the read; the sample is from the last period boundary
+            out[done].sens_time &= ~((uint32_t)period - 1);
+            done += 1;
+#if AUTORANGE
+            if (autorange_update(bmi, &out[done - 1], 1) == BMI2_E_COM_FAIL && recover(bmi) != BMI2_OK) {
+                return done;
+            }
+#endif
+#if SHOCK
+            if (shock_update(bmi, &out[done - 1], done - 1) == BMI2_E_COM_FAIL && recover(bmi) != BMI2_OK) {
+                return done;
+            }
+#endif
+#if CALIB
+            calib_apply(&out[done - 1], 1);
+#endif
+#if HEALTH
+            (void)health_idle(bmi, done, out[done - 1].sens_time);
+#endif
+        }
+#if RTC_ANCHOR
+        (void)rtc_anchor_poll(bmi, done);
+#endif
+    }
+
+    return done;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdint.h>
+#include "BMI270_SensorAPI/bmi2.h"
+
+/*
+Data-ready interrupt reads. The sensor pulses INT1 each time a new accel + gyro sample lands in
+the data registers; the MCU sleeps in LPM3 until then and reads the registers once per sample,
+so nothing is read early or twice, as can happen when polling, but the MCU still wakes up for
+every sample, which the FIFO modes don't.
+*/
+
+// Route data ready to INT1 and set the pin up. period_sens is the sample period in sensor time
+// ticks (25600 / ODR). Accel and gyro must already be enabled.
+int8_t drdy_start(struct bmi2_dev *bmi, uint16_t period_sens);
+
+// Sleep/read until count samples have been written to out; returns the number written
+// (less than count only if the sensor stopped responding). A read that fails on the bus is
+// recovered from with reattach_recover() (reattach.h), which needs reattach_snapshot() to have
+// been taken after drdy_start().
+uint16_t drdy_run(struct bmi2_dev *bmi, struct bmi2_sens_data *out, uint16_t count);
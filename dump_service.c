@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <driverlib.h>
+#include "uart.h"
+#include "dump_service.h"
+#include "rtc_anchor.h"
+
+// BMI270 sensor time is 24 bits
+#define SENS_MASK 0xFFFFFF
+
+// Longest command line taken
+#define LINE_LEN 48
+
+// The count is cleared while the index is rebuilt, so a reset part way through leaves nothing
+// rather than a capture with a stale index
+#pragma PERSISTENT(stored)
+static uint32_t stored = 0;
+// Unwrapped sensor time of the first sample of each chunk
+#pragma PERSISTENT(chunk_time)
+static uint32_t chunk_time[DUMP_SERVICE_CHUNKS] = { 0 };
+// The last range sent, for r
+#pragma PERSISTENT(last_first)
+static uint32_t last_first = 0;
+#pragma PERSISTENT(last_count)
+static uint32_t last_count = 0;
+
+void dump_service_clear(void) {
+    stored = 0;
+    last_first = 0;
+    last_count = 0;
+}
+
+void dump_service_store(const struct bmi2_sens_data *data, uint32_t count) {
+    uint32_t i, time = 0;
+
+    dump_service_clear();
+    if (count > (uint32_t)DUMP_SERVICE_STRIDE * DUMP_SERVICE_CHUNKS) {
+        count = (uint32_t)DUMP_SERVICE_STRIDE * DUMP_SERVICE_CHUNKS;
+    }
+    for (i = 0; i < count; i += 1) {
+        if (i > 0) {
+            time += (data[i].sens_time - data[i - 1].sens_time) & SENS_MASK;
+        } else {
+            time = data[0].sens_time & SENS_MASK;
+        }
+        if (i % DUMP_SERVICE_STRIDE == 0) {
+            chunk_time[i / DUMP_SERVICE_STRIDE] = time;
+        }
+    }
+    stored = count;
+}
+
+uint32_t dump_service_stored(void) {
+    return stored;
+}
+
+// Index of the first sample at or after time, or stored if there's none
+static uint32_t seek(const struct bmi2_sens_data *data, uint32_t time) {
+    uint16_t lo = 0, hi = (uint16_t)((stored + DUMP_SERVICE_STRIDE - 1) / DUMP_SERVICE_STRIDE), mid;
+    uint32_t i, t;
+
+    if (stored == 0 || time <= chunk_time[0]) {
+        return 0;
+    }
+    // The last chunk starting before time
+    while (hi - lo > 1) {
+        mid = (lo + hi) / 2;
+        if (chunk_time[mid] < time) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    i = (uint32_t)lo * DUMP_SERVICE_STRIDE;
+    t = chunk_time[lo];
+    while (t < time) {
+        i += 1;
+        if (i == stored) {
+            break;
+        }
+        t += (data[i].sens_time - data[i - 1].sens_time) & SENS_MASK;
+    }
+    return i;
+}
+
+// Unwrapped time of the last sample
+static uint32_t last_time(const struct bmi2_sens_data *data) {
+    uint32_t lo = (stored - 1) / DUMP_SERVICE_STRIDE;
+    uint32_t i = lo * DUMP_SERVICE_STRIDE;
+    uint32_t t = chunk_time[lo];
+
+    for (i += 1; i < stored; i += 1) {
+        t += (data[i].sens_time - data[i - 1].sens_time) & SENS_MASK;
+    }
+    return t;
+}
+
+static void reply(const char *line) {
+    uart_write(0, (const unsigned char *)line, strlen(line));
+}
+
+// Send what there is of count samples from first, and keep the range for r
+static void send_range(dump_service_send_fn send, uint32_t first, uint32_t count, uint8_t keep) {
+    char line[LINE_LEN];
+
+    if (first > stored) {
+        first = stored;
+    }
+    if (count > stored - first) {
+        count = stored - first;
+    }
+    if (keep) {
+        last_first = first;
+        last_count = count;
+    }
+
+    sprintf(line, "ok %lu %lu\r\n", (unsigned long)first, (unsigned long)count);
+    reply(line);
+    if (count) {
+        send(first, count);
+    }
+}
+
+void dump_service_run(const struct bmi2_sens_data *data, dump_service_send_fn send) {
+    char line[LINE_LEN];
+    char *end;
+    uint32_t a, b;
+
+    uart_rx_start();
+    for (;;) {
+        uart_read_line(line, sizeof(line));
+        a = strtoul(&line[1], &end, 10);
+        b = strtoul(end, &end, 10);
+
+        switch (line[0]) {
+        case 's':
+            if (stored) {
+                sprintf(line, "stored %lu t %lu %lu\r\n", (unsigned long)stored,
+                        (unsigned long)chunk_time[0], (unsigned long)last_time(data));
+            } else {
+                sprintf(line, "stored 0\r\n");
+            }
+            reply(line);
+            break;
+        case 'i':
+            send_range(send, a, b, 1);
+            break;
+        case 't':
+            a = seek(data, a);
+            b = seek(data, b);
+            send_range(send, a, (b > a) ? b - a : 0, 1);
+            break;
+        case 'r':
+            a = (a < last_count) ? a : last_count;
+            send_range(send, last_first + a, last_count - a, 0);
+            break;
+#if RTC_ANCHOR
+        case 'T':
+            rtc_anchor_set(a);
+            sprintf(line, "ok %lu\r\n", (unsigned long)a);
+            reply(line);
+            break;
+#endif
+        case 'x':
+            reply("bye\r\n");
+            uart_rx_stop();
+            return;
+        default:
+            reply("err\r\n");
+            break;
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdint.h>
+#include "BMI270_SensorAPI/bmi2.h"
+
+/*
+Dump service: the last capture stays in FRAM with an index over it, and any part of it can be
+asked for over the UART, on the boot that captured it or any later one, so an interrupted dump
+is picked up where it stopped instead of capturing again.
+
+dump_service_store() keeps the sample count and a chunk index: the sensor time of every
+DUMP_SERVICE_STRIDE'th sample, unwrapped from the first sample's onwards. A time is found with a
+binary search over the chunks and a scan of at most one chunk.
+
+dump_service_run() then takes commands, one per line ('\r' or '\n' ended):
+
+  s              stored <count> t <first> <last>   the capture, and its first and last times
+  i <first> <n>  ok <first> <n>, then the n samples from index first (fewer at the end)
+  t <from> <to>  ok <first> <n>, then the samples with from <= time < to
+  r <offset>     the last i or t again, from its offset'th sample on
+  T <utc>        ok <utc>, having set the RTC to utc, seconds since 1970-01-01 UTC (RTC_ANCHOR=1,
+                 rtc_anchor.h); it keeps that through resets, so the next capture's anchors are
+                 synced
+  x              bye, and dump_service_run() returns
+
+with times in sensor time ticks (39.0625 us) on the unwrapped scale of s. The samples go out as
+dump_samples() sends them, with their index in the capture, so a receiver that lost the link
+part way through knows from the last index it got what to ask for next; the last range is
+kept in FRAM, so r works across a reset too. Anything else gets err.
+*/
+
+#ifndef DUMP_SERVICE
+#define DUMP_SERVICE 0
+#endif
+
+// Samples per chunk of the index
+#ifndef DUMP_SERVICE_STRIDE
+#define DUMP_SERVICE_STRIDE 32
+#endif
+
+// Chunks in the index; a capture has to fit in DUMP_SERVICE_STRIDE * DUMP_SERVICE_CHUNKS
+#ifndef DUMP_SERVICE_CHUNKS
+#define DUMP_SERVICE_CHUNKS 64
+#endif
+
+// Sends count samples from index first, as dump_samples() does
+typedef void (*dump_service_send_fn)(uint32_t first, uint32_t count);
+
+// Forget the stored capture, before anything overwrites its samples
+void dump_service_clear(void);
+
+// Keep data[0..count) as the capture to serve, and index it
+void dump_service_store(const struct bmi2_sens_data *data, uint32_t count);
+
+// Samples in the stored capture; 0 if there's none
+uint32_t dump_service_stored(void);
+
+// Answer commands on the UART until an x; data is the stored capture
+void dump_service_run(const struct bmi2_sens_data *data, dump_service_send_fn send);
@@ -0,0 +1,251 @@
+#include <driverlib.h>
+#include "BMI270_SensorAPI/bmi2.h"
+#include "fifo_batch.h"
+#include "bmi270_int.h"
+#include "reattach.h"
+#include "rtc_anchor.h"
+#include "autorange.h"
+#include "calib.h"
+#include "health.h"
+
+// A sensor time frame (header + 3 bytes) is appended when the FIFO is read past its end
+#define SENSORTIME_FRAME_LEN 4
+
+#if FIFO_BATCH_MAX_FRAMES > 24
+// More than the default watermark's worth doesn't fit in 2 KB of RAM next to everything else.
+// FRAM writes need a wait state at 16 MHz, but the drain is bound by the bus anyway.
+#pragma PERSISTENT(fifo_buf)
+#pragma PERSISTENT(acc_buf)
+#pragma PERSISTENT(gyr_buf)
+#endif
+static uint8_t fifo_buf[FIFO_BATCH_MAX_FRAMES * FIFO_BATCH_FRAME_LEN + SENSORTIME_FRAME_LEN + 1] = { 0 };
+static struct bmi2_sens_axes_data acc_buf[FIFO_BATCH_MAX_FRAMES] = { { 0 } };
+static struct bmi2_sens_axes_data gyr_buf[FIFO_BATCH_MAX_FRAMES] = { { 0 } };
+
+static uint16_t period;
+// Sensor time of the next sample we expect, used when a batch doesn't end with a sensor time
+static uint32_t next_sens_time;
+// Whether next_sens_time has been worked out yet
+static uint8_t have_sens_time;
+
+int8_t fifo_batch_start(struct bmi2_dev *bmi, uint16_t period_sens) {
+    int8_t rslt;
+
+    period = period_sens;
+    next_sens_time = 0;
+    have_sens_time = 0;
+
+    // Start from a clean FIFO configuration, then stream accel + gyro, with headers and sensor
+    // time unless they're off
+    rslt = bmi2_set_fifo_config(BMI2_FIFO_ALL_EN, BMI2_DISABLE, bmi);
+    if (rslt == BMI2_OK) {
+#if FIFO_BATCH_HEADERLESS
+        rslt = bmi2_set_fifo_config(BMI2_FIFO_ACC_EN | BMI2_FIFO_GYR_EN, BMI2_ENABLE, bmi);
+#else
+        rslt = bmi2_set_fifo_config(BMI2_FIFO_ACC_EN | BMI2_FIFO_GYR_EN | BMI2_FIFO_HEADER_EN | BMI2_FIFO_TIME_EN,
+                                    BMI2_ENABLE, bmi);
+#endif
+    }
+    if (rslt == BMI2_OK) {
+        rslt = bmi2_set_fifo_wm(FIFO_BATCH_WM_FRAMES * FIFO_BATCH_FRAME_LEN, bmi);
+    }
+
+    // INT1 as a push-pull, active high output, carrying only the watermark interrupt
+    if (rslt == BMI2_OK) {
+        rslt = bmi270_int_configure(bmi);
+    }
+    if (rslt == BMI2_OK) {
+        rslt = bmi2_map_data_int(BMI2_DRDY_INT, BMI2_INT_NONE, bmi);
+    }
+    if (rslt == BMI2_OK) {
+        rslt = bmi2_map_data_int(BMI2_FWM_INT, BMI2_INT1, bmi);
+    }
+
+    // Let the sensor keep filling the FIFO in its low power states
+    if (rslt == BMI2_OK) {
+        rslt = bmi2_set_fifo_self_wake_up(BMI2_ENABLE, bmi);
+    }
+    if (rslt == BMI2_OK) {
+        rslt = bmi2_set_adv_power_save(BMI2_ENABLE, bmi);
+    }
+
+    // We only ever wake up to drain the FIFO, so have FRAM powered up straight away on
+    // wake-up rather than after the default delay -- the ISR and drain code run from it
+    FRAMCtl_delayPowerUpFromLPM(FRAMCTL_DELAY_FROM_LPM_DISABLE);
+
+    bmi270_int_init();
+
+    return rslt;
+}
+
+void fifo_batch_get_state(struct fifo_batch_state *state) {
+    state->period = period;
+    state->next_sens_time = next_sens_time;
+}
+
+void fifo_batch_resume(const struct fifo_batch_state *state) {
+    period = state->period;
+    next_sens_time = state->next_sens_time;
+    have_sens_time = 1;
+
+    FRAMCtl_delayPowerUpFromLPM(FRAMCTL_DELAY_FROM_LPM_DISABLE);
+    bmi270_int_init();
+}
+
+/* Sensor time of the oldest frame in the FIFO, for the first batch: at high ODRs, frames keep
+landing while it's read, so it often doesn't end with a sensor time frame to count back from.
+The FIFO length is read between two sensor time reads and taken to pair with the sensor time
+halfway between them, which is good to a tick or two (the reads can't be made back to back
+to avoid the question, as advanced power save puts a delay after each). */
+static int8_t get_oldest_sens_time(struct bmi2_dev *bmi, uint16_t *fifo_length, uint32_t *sens_time) {
+    int8_t rslt;
+    uint8_t reg[3];
+    uint32_t before, after, newest;
+
+    rslt = bmi2_get_regs(BMI2_SENSORTIME_ADDR, reg, 3, bmi);
+    before = reg[0] | ((uint32_t)reg[1] << 8) | ((uint32_t)reg[2] << 16);
+    if (rslt == BMI2_OK) {
+        rslt = bmi2_get_fifo_length(fifo_length, bmi);
+    }
+    if (rslt == BMI2_OK) {
+        rslt = bmi2_get_regs(BMI2_SENSORTIME_ADDR, reg, 3, bmi);
+    }
+    if (rslt != BMI2_OK) {
+        return rslt;
+    }
+    after = reg[0] | ((uint32_t)reg[1] << 8) | ((uint32_t)reg[2] << 16);
+
+    newest = (before + (((after - before) & 0xFFFFFF) >> 1)) & ~((uint32_t)period - 1);
+    *sens_time = (newest - (uint32_t)(*fifo_length / FIFO_BATCH_FRAME_LEN - 1) * period) & 0xFFFFFF;
+    return BMI2_OK;
+}
+
+int16_t fifo_batch_drain(struct bmi2_dev *bmi, struct bmi2_sens_data *out, uint16_t space) {
+    int8_t rslt;
+    uint16_t fifo_length;
+    uint16_t n_acc = FIFO_BATCH_MAX_FRAMES;
+    uint16_t n_gyr = FIFO_BATCH_MAX_FRAMES;
+    uint16_t n, i;
+    uint32_t sens_time;
+    struct bmi2_fifo_frame fifo = { 0 };
+
+    // Without sensor time frames, every batch needs its own anchor
+    if (have_sens_time && !FIFO_BATCH_HEADERLESS) {
+        rslt = bmi2_get_fifo_length(&fifo_length, bmi);
+    } else {
+        rslt = get_oldest_sens_time(bmi, &fifo_length, &next_sens_time);
+        have_sens_time = (rslt == BMI2_OK);
+    }
+    if (rslt != BMI2_OK) {
+        return rslt;
+    }
+
+    // Reading past the end of the FIFO gets us the sensor time frame too
+    fifo.data = fifo_buf;
+    fifo.length = fifo_length + bmi->dummy_byte;
+    if (!FIFO_BATCH_HEADERLESS) {
+        fifo.length += SENSORTIME_FRAME_LEN;
+    }
+    if (fifo.length > sizeof(fifo_buf)) {
+        fifo.length = sizeof(fifo_buf);
+    }
+
+    rslt = bmi2_read_fifo_data(&fifo, bmi);
+    if (rslt != BMI2_OK) {
+        return rslt;
+    }
+
+    // Empty FIFO or partial reads just come back as warnings
+    (void)bmi2_extract_accel(acc_buf, &n_acc, &fifo, bmi);
+    (void)bmi2_extract_gyro(gyr_buf, &n_gyr, &fifo, bmi);
+
+    n = (n_acc < n_gyr) ? n_acc : n_gyr;
+    if (n == 0) {
+        return 0;
+    }
+
+    if (fifo.sensor_time != 0) {
+        // The newest sample read landed on the last period boundary before the sensor time
+        // frame, whether or not there's room for all of them
+        sens_time = ((fifo.sensor_time & ~((uint32_t)period - 1)) - (uint32_t)(n - 1) * period) & 0xFFFFFF;
+    } else {
+        sens_time = next_sens_time;
+    }
+    if (n > space) {
+        n = space;
+    }
+
+    for (i = 0; i < n; i += 1) {
+        out[i].acc = acc_buf[i];
+        out[i].gyr = gyr_buf[i];
+        out[i].sens_time = sens_time;
+        out[i].status = BMI2_DRDY_ACC | BMI2_DRDY_GYR;
+        sens_time = (sens_time + period) & 0xFFFFFF;
+    }
+    next_sens_time = sens_time;
+
+    return n;
+}
+
+int8_t fifo_batch_recover(struct bmi2_dev *bmi) {
+    int8_t rslt = reattach_recover(bmi);
+
+    if (rslt == BMI2_OK) {
+        // Frames may have been lost with the stream, so counting on from the last batch could be
+        // off; the next drain dates its batch afresh. INT1's edges may have come and gone.
+        have_sens_time = 0;
+        bmi270_int_init();
+    }
+    return rslt;
+}
+
+uint16_t fifo_batch_run(struct bmi2_dev *bmi, struct bmi2_sens_data *out, uint16_t count) {
+    uint16_t done = 0;
+#if AUTORANGE || CALIB
+    uint16_t from;
+#endif
+    int16_t n;
+
+    while (done < count) {
+        bmi270_int_sleep();
+#if AUTORANGE || CALIB
+        from = done;
+#endif
+
+        // Keep draining while INT1 is still up, in case the FIFO got ahead of us
+        do {
+            n = fifo_batch_drain(bmi, &out[done], count - done);
+            if (n == BMI2_E_COM_FAIL) {
+                // Wait for the next watermark; what was drained before still gets seen to
+                if (fifo_batch_recover(bmi) != BMI2_OK) {
+                    return done;
+                }
+                break;
+            }
+            if (n < 0) {
+                return done;
+            }
+            done += n;
+        } while (done < count && bmi270_int_active());
+#if AUTORANGE
+        if (autorange_update(bmi, &out[from], done - from) == BMI2_E_COM_FAIL &&
+            fifo_batch_recover(bmi) != BMI2_OK) {
+            return done;
+        }
+#endif
+#if CALIB
+        calib_apply(&out[from], done - from);
+#endif
+#if HEALTH
+        // The FIFO fills on its own until the next watermark
+        if (done != 0) {
+            (void)health_idle(bmi, done, out[done - 1].sens_time);
+        }
+#endif
+#if RTC_ANCHOR
+        (void)rtc_anchor_poll(bmi, done);
+#endif
+    }
+
+    return done;
+}
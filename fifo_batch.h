@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdint.h>
+#include "BMI270_SensorAPI/bmi2.h"
+
+/*
+Deep-sleep FIFO batching. The BMI270 fills its FIFO on its own (with FIFO self wake-up and
+advanced power save on), and the MCU sits in LPM3 until the FIFO watermark interrupt on INT1.
+Then it drains the FIFO at full speed, unpacks the frames and goes straight back to sleep.
+
+Frames are read in header mode with sensor time enabled, so each batch carries the sensor
+time of the read; individual samples are timestamped by counting back from it.
+
+With FIFO_BATCH_HEADERLESS=1, frames are read without headers instead: a byte less per sample,
+but no sensor time frame, so every batch is timestamped from a separate sensor time and FIFO
+length read before it (two more transactions per batch).
+*/
+
+#ifndef FIFO_BATCH_HEADERLESS
+#define FIFO_BATCH_HEADERLESS 0
+#endif
+
+// Frames (accel + gyro) per watermark interrupt
+#ifndef FIFO_BATCH_WM_FRAMES
+#define FIFO_BATCH_WM_FRAMES 16
+#endif
+#if FIFO_BATCH_HEADERLESS
+// Headerless accel + gyro frame: 6 gyro bytes + 6 accel bytes
+#define FIFO_BATCH_FRAME_LEN 12
+#else
+// Header-mode accel + gyro frame: 1 header byte + 6 gyro bytes + 6 accel bytes
+#define FIFO_BATCH_FRAME_LEN 13
+#endif
+// Most frames drained in one go; anything beyond stays in the FIFO for the next pass
+#define FIFO_BATCH_MAX_FRAMES (FIFO_BATCH_WM_FRAMES + FIFO_BATCH_WM_FRAMES / 2)
+
+// Configure the FIFO, watermark interrupt, INT1 pin and power saving. period_sens is the
+// sample period in sensor time ticks (25600 / ODR). Accel and gyro must already be enabled.
+int8_t fifo_batch_start(struct bmi2_dev *bmi, uint16_t period_sens);
+
+// MCU-side batching state, for carrying a batch across an LPMx.5 hibernate
+struct fifo_batch_state {
+    uint16_t period;
+    uint32_t next_sens_time;
+};
+
+void fifo_batch_get_state(struct fifo_batch_state *state);
+
+// Pick batching back up after a reset without touching the sensor, which kept its configuration
+void fifo_batch_resume(const struct fifo_batch_state *state);
+
+// Drain whatever is in the FIFO (up to FIFO_BATCH_MAX_FRAMES frames) into out, returning the
+// number of samples written, or the BMI2_E_* code of a failed read (BMI2_E_COM_FAIL for a bus
+// failure, which fifo_batch_recover() can get past)
+int16_t fifo_batch_drain(struct bmi2_dev *bmi, struct bmi2_sens_data *out, uint16_t space);
+
+// Get the stream going again after a bus failure: reattach_recover(), then INT1, and have the
+// next batch dated afresh
+int8_t fifo_batch_recover(struct bmi2_dev *bmi);
+
+// Sleep/drain until count samples have been written to out, recovering from bus failures;
+// returns the number written (less than count only if the sensor stopped responding)
+uint16_t fifo_batch_run(struct bmi2_dev *bmi, struct bmi2_sens_data *out, uint16_t count);
@@ -0,0 +1,135 @@
+#include "health.h"
+
+// ERR_REG is the register before STATUS; bmi2_defs.h has no name for it
+#define ERR_REG_ADDR (BMI2_STATUS_ADDR - 1)
+
+#define STATUS_KEPT (BMI2_CMD_RDY | BMI2_AUX_BUSY)
+
+// The reads health_idle() takes turns at
+#define READ_ERR_STATUS 0
+#define READ_SATURATION 1
+#define READ_INTERNAL_ERR 2
+
+#pragma PERSISTENT(events)
+static struct health_event events[HEALTH_MAX] = { { 0 } };
+#pragma PERSISTENT(num_events)
+static uint16_t num_events = 0;
+
+// All four as last read
+static struct health_event now;
+// Whether ERR_REG and STATUS come with the samples, so health_idle() can leave them out
+static uint8_t coalesced;
+static uint8_t turn;
+static uint32_t last_read;
+
+// Keep now as an event if it's different from the last one kept
+static void note(uint16_t next) {
+    const struct health_event *last = &events[num_events - 1];
+
+    if (num_events >= HEALTH_MAX || (now.err == last->err && now.status == last->status &&
+                                     now.saturation == last->saturation &&
+                                     now.internal_err == last->internal_err)) {
+        return;
+    }
+    now.next = next;
+    events[num_events] = now;
+    num_events += 1;
+}
+
+static int8_t read_err_status(struct bmi2_dev *bmi) {
+    uint8_t regs[2];
+    int8_t rslt = bmi2_get_regs(ERR_REG_ADDR, regs, sizeof(regs), bmi);
+
+    if (rslt == BMI2_OK) {
+        now.err = regs[0];
+        now.status = regs[1] & STATUS_KEPT;
+    }
+    return rslt;
+}
+
+int8_t health_start(struct bmi2_dev *bmi) {
+    int8_t rslt;
+
+    rslt = read_err_status(bmi);
+    if (rslt == BMI2_OK) {
+        rslt = bmi2_get_saturation_status(&now.saturation, bmi);
+    }
+    if (rslt == BMI2_OK) {
+        rslt = bmi2_get_internal_error_status(&now.internal_err, bmi);
+    }
+    now.next = 0;
+    events[0] = now;
+    num_events = 1;
+    coalesced = 0;
+    turn = READ_ERR_STATUS;
+    last_read = 0;
+    return rslt;
+}
+
+int8_t health_get_sensor_data(struct bmi2_sens_data *data, uint16_t next, struct bmi2_dev *bmi) {
+    // ERR_REG, then what bmi2_get_sensor_data() reads
+    uint8_t regs[1 + BMI2_ACC_GYR_AUX_SENSORTIME_NUM_BYTES];
+    int8_t rslt = bmi2_get_regs(ERR_REG_ADDR, regs, sizeof(regs), bmi);
+
+    if (rslt == BMI2_OK) {
+        rslt = bmi2_parse_sensor_data(&regs[1], data, bmi);
+    }
+    if (rslt == BMI2_OK && num_events != 0) {
+        coalesced = 1;
+        now.err = regs[0];
+        now.status = regs[1] & STATUS_KEPT;
+        note(next);
+    }
+    return rslt;
+}
+
+int8_t health_idle(struct bmi2_dev *bmi, uint16_t next, uint32_t sens_time) {
+    int8_t rslt;
+
+    if (num_events == 0 || ((sens_time - last_read) & 0xFFFFFF) < HEALTH_PERIOD_MS * 128UL / 5) {
+        return BMI2_OK;
+    }
+    last_read = sens_time;
+
+    if (turn == READ_ERR_STATUS && coalesced) {
+        turn = READ_SATURATION;
+    }
+    if (turn == READ_ERR_STATUS) {
+        rslt = read_err_status(bmi);
+    } else if (turn == READ_SATURATION) {
+        rslt = bmi2_get_saturation_status(&now.saturation, bmi);
+    } else {
+        rslt = bmi2_get_internal_error_status(&now.internal_err, bmi);
+    }
+    turn = (turn == READ_INTERNAL_ERR) ? READ_ERR_STATUS : turn + 1;
+    if (rslt == BMI2_OK) {
+        note(next);
+    }
+    return rslt;
+}
+
+uint16_t health_count(void) {
+    return num_events;
+}
+
+const struct health_event *health_get(uint16_t i) {
+    return &events[i];
+}
+
+void health_pack(uint16_t i, uint8_t out[HEALTH_LEN]) {
+    const struct health_event *e = &events[i];
+    uint8_t k, sum = 0;
+
+    out[0] = HEALTH_SYNC0;
+    out[1] = HEALTH_SYNC1;
+    out[2] = e->next & 0xff;
+    out[3] = e->next >> 8;
+    out[4] = e->err;
+    out[5] = e->status;
+    out[6] = e->saturation;
+    out[7] = e->internal_err;
+    for (k = 0; k < HEALTH_LEN - 1; k += 1) {
+        sum += out[k];
+    }
+    out[8] = ~sum;
+}
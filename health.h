@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdint.h>
+#include "BMI270_SensorAPI/bmi2.h"
+
+/*
+Sensor health monitoring through the capture, for HEALTH=1, without reads of its own in the way
+of the samples. It watches four registers:
+- ERR_REG: fatal_err, the internal error code, fifo_err and aux_err (the last two clear on read),
+- STATUS: cmd_rdy and aux_busy (the data ready bits come and go with every sample, so they're
+  left out),
+- SATURATION: the accel and gyro axes that clipped (bmi2_get_saturation_status()), as of the
+  latest sample only, so a clip between reads goes unseen,
+- INTERNAL_ERR: the feature engine's errors (bmi2_get_internal_error_status()).
+
+ERR_REG sits just before STATUS, which is where a sample read starts, so ACQ_POLL and ACQ_DRDY
+read samples with health_get_sensor_data() instead of bmi2_get_sensor_data(): one burst a byte
+longer, and both registers come with every sample. The other two are too far from the data to
+share its read, so the capture loops call health_idle() once a sample or a FIFO batch has been
+taken, when nothing is due from the sensor for a while, and it reads one of them, taking turns,
+if HEALTH_PERIOD_MS has gone by in sensor time since the last. In the FIFO modes ERR_REG and
+STATUS take their turn there too, as one read.
+
+A change in any of them is kept in FRAM as an event, with all four as last read, up to
+HEALTH_MAX per capture counting the values it started with; after that they're still read but
+no longer kept. dump_samples() sends each ahead of the sample after it was seen, as the 9 byte
+record
+
+  e1 1e next_lo next_hi  err status saturation internal_err  check
+
+(next: index of that sample; check: the bytes before it summed, complemented), or, with
+DUMP_CSV, a line
+
+  #, next, err, status, saturation, internal_err
+*/
+
+#ifndef HEALTH
+#define HEALTH 0
+#endif
+
+// Least time between the reads health_idle() makes
+#ifndef HEALTH_PERIOD_MS
+#define HEALTH_PERIOD_MS 50
+#endif
+
+// Events kept per capture, counting the values it started with
+#ifndef HEALTH_MAX
+#define HEALTH_MAX 32
+#endif
+
+#define HEALTH_SYNC0 0xE1
+#define HEALTH_SYNC1 0x1E
+#define HEALTH_LEN 9
+
+struct health_event {
+    // Index of the first sample taken after the change was seen
+    uint16_t next;
+    uint8_t err;
+    // cmd_rdy and aux_busy only
+    uint8_t status;
+    uint8_t saturation;
+    uint8_t internal_err;
+};
+
+// Forget the last capture's events, and read all four registers for the values to start from
+int8_t health_start(struct bmi2_dev *bmi);
+
+// bmi2_get_sensor_data(), reading ERR_REG along with the sample, next being its index in the
+// capture if it's a new one
+int8_t health_get_sensor_data(struct bmi2_sens_data *data, uint16_t next, struct bmi2_dev *bmi);
+
+// An idle slot, after the sample before next, taken at sens_time: read the next register in
+// turn if it's time. BMI2_OK, or the error reading it.
+int8_t health_idle(struct bmi2_dev *bmi, uint16_t next, uint32_t sens_time);
+
+uint16_t health_count(void);
+
+const struct health_event *health_get(uint16_t i);
+
+// Event i as its binary record
+void health_pack(uint16_t i, uint8_t out[HEALTH_LEN]);
@@ -0,0 +1,85 @@
+#include <driverlib.h>
+#include "hibernate.h"
+#include "fifo_batch.h"
+#include "bmi270_int.h"
+#include "calib.h"
+
+#define HIBERNATE_VALID 0x4849
+
+struct hibernate_state {
+    // HIBERNATE_VALID while there's a state to resume; reflashing resets it to 0
+    uint16_t valid;
+
+    // The device struct as bmi270_init() and the configuration calls left it. The pointers in it
+    // are to code, const tables in FRAM or the scratch arena, which stay put as long as the
+    // firmware does.
+    struct bmi2_dev dev;
+
+    struct fifo_batch_state fifo;
+
+    // Next free slot in the sample buffer
+    uint16_t index;
+};
+
+#pragma PERSISTENT(saved)
+static struct hibernate_state saved = { 0 };
+
+uint8_t hibernate_woke(void) {
+    uint8_t woke = PMM_getInterruptStatus(PMM_LPM5_INTERRUPT) != 0;
+    PMM_clearInterrupt(PMM_LPM5_INTERRUPT);
+    return woke && saved.valid == HIBERNATE_VALID;
+}
+
+uint16_t hibernate_run(struct bmi2_dev *bmi, struct bmi2_sens_data *out, uint16_t count, uint16_t done) {
+    int16_t n;
+
+    while (1) {
+        do {
+            n = fifo_batch_drain(bmi, &out[done], count - done);
+            if (n == BMI2_E_COM_FAIL && fifo_batch_recover(bmi) == BMI2_OK) {
+                // Back to sleep until the next watermark
+                break;
+            }
+            if (n < 0) {
+                saved.valid = 0;
+                return done;
+            }
+#if CALIB
+            calib_apply(&out[done], n);
+#endif
+            done += n;
+        } while (done < count && bmi270_int_active());
+
+        if (done >= count) {
+            saved.valid = 0;
+            return done;
+        }
+
+        saved.dev = *bmi;
+        fifo_batch_get_state(&saved.fifo);
+        saved.index = done;
+        saved.valid = HIBERNATE_VALID;
+
+        bmi270_int_hibernate();
+    }
+}
+
+uint16_t hibernate_resume(struct bmi2_dev *bmi, struct bmi2_sens_data *out, uint16_t count) {
+    // Keep the freshly set up interface functions, everything else comes from before hibernating
+    bmi2_read_fptr_t read = bmi->read;
+    bmi2_write_fptr_t write = bmi->write;
+    bmi2_delay_fptr_t delay_us = bmi->delay_us;
+    void *intf_ptr = bmi->intf_ptr;
+    struct bmi2_scratch *scratch = bmi->scratch;
+
+    *bmi = saved.dev;
+    bmi->read = read;
+    bmi->write = write;
+    bmi->delay_us = delay_us;
+    bmi->intf_ptr = intf_ptr;
+    bmi->scratch = scratch;
+
+    fifo_batch_resume(&saved.fifo);
+
+    return hibernate_run(bmi, out, count, saved.index);
+}
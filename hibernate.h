@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+#include "BMI270_SensorAPI/bmi2.h"
+
+/*
+LPM4.5 hibernate between FIFO batches. The BMI270 keeps sampling into its FIFO while the MCU is
+completely off, with only FRAM retained. Everything needed to skip bmi270_init() on the way back
+up -- the bmi2_dev contents (remap, gyr_cross_sens_zx, enabled sensors, feature tables...), the
+batching state and the next sample slot -- is kept in a persistent FRAM block. Waking up from
+the FIFO watermark on INT1 goes through a reset, after which main() calls hibernate_resume() and
+carries on draining.
+
+The saved block is zeroed whenever the firmware is reflashed, so stale state is never restored.
+*/
+
+// Whether this reset was a wake-up from LPMx.5 with a saved state to resume from
+uint8_t hibernate_woke(void);
+
+// Drain batches into out until count samples have been collected, hibernating in between.
+// done is the number of samples already in out. Returns once out is full (or the sensor
+// stopped responding; a bus failure is recovered from and draining carries on); in between,
+// the MCU goes through a reset each time it wakes.
+uint16_t hibernate_run(struct bmi2_dev *bmi, struct bmi2_sens_data *out, uint16_t count, uint16_t done);
+
+// Restore the saved state into bmi and carry on with hibernate_run(). init_bmi_device() must
+// have been called first.
+uint16_t hibernate_resume(struct bmi2_dev *bmi, struct bmi2_sens_data *out, uint16_t count);
@@ -0,0 +1,98 @@
+#include <string.h>
+#include "aes_decrypt.h"
+#include "../sink.h"
+
+static void discard(struct aes_decrypt *d, size_t n) {
+    d->len -= n;
+    memmove(d->buf, &d->buf[n], d->len);
+}
+
+static uint8_t is_sync(uint8_t byte) {
+    return byte == SINK_AES_SYNC || byte == SINK_AES_START;
+}
+
+static void decrypt(struct aes_decrypt *d, uint8_t *payload, size_t len, uint32_t block) {
+    uint8_t counter[16] = { 0 }, ks[16];
+    size_t i;
+
+    memcpy(counter, d->nonce, sizeof(d->nonce));
+    for (i = 0; i < len; i++) {
+        if (i % 16 == 0) {
+            counter[12] = block >> 24;
+            counter[13] = (block >> 16) & 0xff;
+            counter[14] = (block >> 8) & 0xff;
+            counter[15] = block & 0xff;
+            aes_soft_encrypt(&d->aes, counter, ks);
+            block += 1;
+        }
+        payload[i] ^= ks[i % 16];
+    }
+}
+
+// Take whole frames off the front of the bytes
+static void parse(struct aes_decrypt *d) {
+    size_t frame;
+    uint16_t low;
+    uint8_t len, start;
+
+    while (d->len >= SINK_AES_HEADER) {
+        len = d->buf[1];
+        frame = SINK_AES_HEADER + len;
+        start = d->buf[0] == SINK_AES_START;
+        if (!is_sync(d->buf[0]) || len == 0 ||
+            (start && (len != sizeof(d->nonce) || d->buf[2] || d->buf[3]))) {
+            d->stats.resync_bytes += 1;
+            discard(d, 1);
+            continue;
+        }
+        if (d->len < frame + (d->ended ? 0 : 1)) {
+            // Wait for the byte after it, unless there won't be one
+            if (!d->ended) {
+                return;
+            }
+            d->stats.resync_bytes += d->len;
+            discard(d, d->len);
+            return;
+        }
+        if (d->len > frame && !is_sync(d->buf[frame])) {
+            d->stats.resync_bytes += 1;
+            discard(d, 1);
+            continue;
+        }
+
+        if (start) {
+            memcpy(d->nonce, &d->buf[SINK_AES_HEADER], sizeof(d->nonce));
+            d->started = 1;
+            d->block = 0;
+            d->stats.starts += 1;
+        } else if (!d->started) {
+            d->stats.unkeyed += 1;
+        } else {
+            // The keystream only moves on, so the block is the next one with these low bits
+            low = d->buf[2] | (d->buf[3] << 8);
+            d->block += (uint16_t)(low - (uint16_t)d->block);
+            decrypt(d, &d->buf[SINK_AES_HEADER], len, d->block);
+            d->stats.frames += 1;
+            d->callback(&d->buf[SINK_AES_HEADER], len, d->ctx);
+        }
+        discard(d, frame);
+    }
+}
+
+void aes_decrypt_init(struct aes_decrypt *d, const uint8_t key[32], aes_decrypt_callback callback, void *ctx) {
+    memset(d, 0, sizeof(*d));
+    aes_soft_set_key(&d->aes, key);
+    d->callback = callback;
+    d->ctx = ctx;
+}
+
+void aes_decrypt_put(struct aes_decrypt *d, uint8_t byte) {
+    d->buf[d->len] = byte;
+    d->len += 1;
+    parse(d);
+}
+
+void aes_decrypt_end(struct aes_decrypt *d) {
+    d->ended = 1;
+    parse(d);
+}
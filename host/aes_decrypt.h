@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "aes_soft.h"
+
+/*
+Decrypts sink_aes's stream (../sink.h): frames are picked out of the bytes, decrypted with the
+keystream for the block in their header and the nonce of the last start frame, and handed on,
+payload only, so what comes out is what sink_uart would have sent.
+
+A frame is taken once the byte after it is another frame's sync byte, or at the end of the
+stream; anything else (a frame cut short, or plain text sent after the samples) is skipped a
+byte at a time and counted. Frames before the first start frame can't be decrypted and are
+skipped too.
+*/
+
+#define AES_DECRYPT_FRAME (4 + 255)
+
+typedef void (*aes_decrypt_callback)(const uint8_t *payload, size_t len, void *ctx);
+
+struct aes_decrypt_stats {
+    uint32_t frames;
+    // Start frames, one per boot of the board
+    uint32_t starts;
+    // Frames thrown away for want of a start frame
+    uint32_t unkeyed;
+    // Bytes thrown away while finding the frames again
+    uint32_t resync_bytes;
+};
+
+struct aes_decrypt {
+    aes_decrypt_callback callback;
+    void *ctx;
+    struct aes_soft aes;
+    uint8_t buf[2 * AES_DECRYPT_FRAME];
+    size_t len;
+    uint8_t ended;
+    uint8_t started;
+    uint8_t nonce[8];
+    // The last frame's first keystream block, unwrapped
+    uint32_t block;
+    struct aes_decrypt_stats stats;
+};
+
+void aes_decrypt_init(struct aes_decrypt *d, const uint8_t key[32], aes_decrypt_callback callback, void *ctx);
+
+void aes_decrypt_put(struct aes_decrypt *d, uint8_t byte);
+
+// End of the stream
+void aes_decrypt_end(struct aes_decrypt *d);
@@ -0,0 +1,91 @@
+/*
+Decrypts a SINK_AES build's UART output (../sink.h) from a serial port, pty or file, and
+writes it to stdout in the format dump_samples() was built with, for uart_decode. A tty is put
+in raw mode first.
+
+usage: aes_decrypt [-k key] [path]
+  -k    the firmware's AES_STREAM_KEY, as 64 hex digits (default the FIPS-197 test key,
+        000102...1f, as in ../aes_stream.h)
+  path  where to read from (default stdin)
+  e.g. aes_decrypt build/uart.bin | build/uart_decode -f bin
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include "aes_decrypt.h"
+
+static void write_payload(const uint8_t *payload, size_t len, void *ctx) {
+    (void)ctx;
+    fwrite(payload, 1, len, stdout);
+}
+
+static int parse_key(const char *hex, uint8_t key[32]) {
+    unsigned byte;
+    uint8_t i;
+
+    if (strlen(hex) != 64) {
+        return -1;
+    }
+    for (i = 0; i < 32; i++) {
+        if (sscanf(&hex[2 * i], "%2x", &byte) != 1) {
+            return -1;
+        }
+        key[i] = (uint8_t)byte;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    struct aes_decrypt d;
+    struct termios tio;
+    uint8_t key[32], buf[256];
+    ssize_t got, i;
+    int fd = STDIN_FILENO;
+    int opt;
+
+    for (i = 0; i < 32; i++) {
+        key[i] = (uint8_t)i;
+    }
+    while ((opt = getopt(argc, argv, "k:")) != -1) {
+        if (opt != 'k' || parse_key(optarg, key) != 0) {
+            fprintf(stderr, "usage: %s [-k key] [path]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind < argc) {
+        fd = open(argv[optind], O_RDONLY | O_NOCTTY);
+        if (fd < 0) {
+            perror(argv[optind]);
+            return 1;
+        }
+    }
+    if (isatty(fd) && tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+
+    aes_decrypt_init(&d, key, write_payload, NULL);
+    for (;;) {
+        got = read(fd, buf, sizeof(buf));
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        // A pty whose other end has gone away reads as EIO
+        if (got <= 0) {
+            break;
+        }
+        for (i = 0; i < got; i++) {
+            aes_decrypt_put(&d, buf[i]);
+        }
+    }
+    aes_decrypt_end(&d);
+    fflush(stdout);
+
+    fprintf(stderr, "aes_decrypt: %u frames, %u starts, %u unkeyed, %u bytes resynced\n",
+        d.stats.frames, d.stats.starts, d.stats.unkeyed, d.stats.resync_bytes);
+    return 0;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+AES-256 encryption in software (FIPS-197), for the host: the emulated AES256 module in
+hal_host.c and the stream decryptor in aes_decrypt.c. Only the forward cipher is here, as CTR
+mode needs nothing else. Written for clarity, not speed or resistance to timing attacks.
+*/
+
+struct aes_soft {
+    // The expanded key: 15 round keys
+    uint8_t round_keys[15][16];
+};
+
+void aes_soft_set_key(struct aes_soft *aes, const uint8_t key[32]);
+
+void aes_soft_encrypt(const struct aes_soft *aes, const uint8_t in[16], uint8_t out[16]);
@@ -0,0 +1,19 @@
+// The host's bench_clock.c: nanoseconds of CLOCK_MONOTONIC_RAW, for the benchmarks and the
+// WCET probes
+
+#include <stdint.h>
+#include <time.h>
+#include "../bench.h"
+
+void bench_clock_init(void) {
+}
+
+uint32_t bench_clock_read(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+uint32_t bench_clock_hz(void) {
+    return 1000000000;
+}
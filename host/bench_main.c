@@ -0,0 +1,221 @@
+/*
+Runs the benchmarks in ../bench.c natively, timed in nanoseconds, and then bmi270_init() (which
+is mostly the config upload) against the simulated sensor on the emulated MCU. The upload is
+reported twice: in virtual time, which is what the board would take at 2 MHz SPI, and in
+wall-clock time, which is what the library and the emulation cost the host. Last, a bring-up
+(bmi270_init() and enabling accel and gyro) is recorded as a register script (../regscript.h)
+and replayed on a fresh sensor, to compare the two in virtual time and check the replay leaves
+the registers the same; the script is listed after the report. Then the encrypted stream
+(../aes_stream.h): how fast the AES256 module's keystream comes, in virtual time, which is
+what sink_aes can encrypt at, and what decrypting it costs the host, in wall-clock time.
+
+usage: bmi270_bench [-n inner] [-c cpu]
+  -n  run each case this many times per timed run (default 1000)
+  -c  pin to this CPU, for steadier numbers
+*/
+
+#define _GNU_SOURCE
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <driverlib.h>
+#include "hal_host.h"
+#include "sim_bmi270.h"
+#include "../BMI270_SensorAPI/bmi270.h"
+#include "../bench.h"
+#include "../bmi270_spi.h"
+#include "../regscript.h"
+#include "../aes_stream.h"
+#include "aes_soft.h"
+
+// Bytes of keystream per timed run
+#define AES_BENCH_BYTES 4096
+
+static void print_line(const char *line) {
+    puts(line);
+}
+
+static void print_comment(const char *line) {
+    printf("# %s\n", line);
+}
+
+// A freshly powered sensor, on the clocks main.c sets up for ACQ_POLL
+static void attach_sensor(struct bmi2_dev *bmi) {
+    static struct sim_bmi270_config sensor = { .clock_ppm = 0, .seed = 1, .motion = NULL };
+
+    hal_host_reset();
+    sim_bmi270_attach(&sensor);
+
+    CS_setDCOFreq(CS_DCORSEL_1, CS_DCOFSEL_3);
+    CS_initClockSignal(CS_MCLK, CS_DCOCLK_SELECT, CS_CLOCK_DIVIDER_1);
+    CS_initClockSignal(CS_SMCLK, CS_DCOCLK_SELECT, CS_CLOCK_DIVIDER_1);
+    init_spi();
+    init_bmi_device(bmi);
+}
+
+static void bench_upload(void) {
+    struct bmi2_dev bmi;
+    uint32_t virt[BENCH_REPS], wall[BENCH_REPS];
+    uint32_t virt_min = UINT32_MAX, wall_min = UINT32_MAX;
+    uint64_t start_ps;
+    uint32_t start;
+    uint8_t rep;
+
+    attach_sensor(&bmi);
+
+    if (bmi270_init(&bmi) != BMI2_OK) {
+        puts("# bmi270_init failed against the simulator");
+        return;
+    }
+    for (rep = 0; rep < BENCH_REPS; rep++) {
+        start_ps = hal_host_now_ps();
+        start = bench_clock_read();
+        (void)bmi270_init(&bmi);
+        wall[rep] = bench_clock_read() - start;
+        virt[rep] = (uint32_t)((hal_host_now_ps() - start_ps) / 1000);
+        if (virt[rep] < virt_min) {
+            virt_min = virt[rep];
+        }
+        if (wall[rep] < wall_min) {
+            wall_min = wall[rep];
+        }
+    }
+    bench_report("bmi270_init sim virtual", 1, bmi.variant->config_size, 1, virt_min,
+        bench_median(virt, BENCH_REPS), 1000000000, print_line);
+    bench_report("bmi270_init sim host", 1, bmi.variant->config_size, 1, wall_min,
+        bench_median(wall, BENCH_REPS), 1000000000, print_line);
+}
+
+static int8_t bring_up(struct bmi2_dev *bmi) {
+    const uint8_t sensors[2] = { BMI2_ACCEL, BMI2_GYRO };
+    int8_t rslt = bmi270_init(bmi);
+
+    if (rslt == BMI2_OK) {
+        rslt = bmi2_sensor_enable(sensors, 2, bmi);
+    }
+    return rslt;
+}
+
+// ACC_CONF up to CMD: the configuration, as against data and status, which move on by themselves
+#define CONFIG_REGS (BMI2_CMD_REG_ADDR - BMI2_ACC_CONF_ADDR)
+
+static void bench_regscript(void) {
+    struct bmi2_dev bmi;
+    uint8_t api_regs[CONFIG_REGS], script_regs[CONFIG_REGS];
+    uint32_t api_us, script_us;
+    uint64_t start_ps;
+    uint8_t i, differ = 0;
+    int8_t rslt;
+    char line[128];
+
+    // Through the API, recording
+    attach_sensor(&bmi);
+    start_ps = hal_host_now_ps();
+    regscript_record(&bmi);
+    rslt = regscript_stop(&bmi, bring_up(&bmi));
+    api_us = (uint32_t)((hal_host_now_ps() - start_ps) / 1000000);
+    if (rslt == BMI2_OK) {
+        rslt = bmi2_get_regs(BMI2_ACC_CONF_ADDR, api_regs, sizeof(api_regs), &bmi);
+    }
+    if (rslt != BMI2_OK) {
+        printf("# bring-up failed (%d) against the simulator, no register script\n", rslt);
+        return;
+    }
+
+    // Replayed on a sensor that's just been powered up
+    attach_sensor(&bmi);
+    start_ps = hal_host_now_ps();
+    rslt = regscript_run(&bmi);
+    script_us = (uint32_t)((hal_host_now_ps() - start_ps) / 1000000);
+    if (rslt == BMI2_OK) {
+        rslt = bmi2_get_regs(BMI2_ACC_CONF_ADDR, script_regs, sizeof(script_regs), &bmi);
+    }
+    if (rslt != BMI2_OK) {
+        printf("# register script replay failed (%d)\n", rslt);
+        return;
+    }
+
+    for (i = 0; i < sizeof(api_regs); i += 1) {
+        differ += api_regs[i] != script_regs[i];
+    }
+    sprintf(line, "# bring-up: api %lu us, register script %lu us (%u bytes), %u registers differ",
+        (unsigned long)api_us, (unsigned long)script_us, regscript_length(), differ);
+    puts(line);
+    regscript_print(print_comment);
+}
+
+static void bench_aes(void) {
+    static uint8_t plain[AES_BENCH_BYTES], cipher[AES_BENCH_BYTES];
+    struct bmi2_dev bmi;
+    struct aes_soft aes;
+    uint8_t nonce[AES_STREAM_NONCE], key[32] = { 0 }, counter[16] = { 0 };
+    uint32_t virt[BENCH_REPS], wall[BENCH_REPS];
+    uint32_t virt_min = UINT32_MAX, wall_min = UINT32_MAX;
+    uint64_t start_ps;
+    uint32_t start;
+    uint16_t i;
+    uint8_t rep;
+
+    attach_sensor(&bmi);
+    aes_stream_start(nonce);
+    aes_soft_set_key(&aes, key);
+    for (rep = 0; rep < BENCH_REPS; rep++) {
+        start_ps = hal_host_now_ps();
+        aes_stream_xor(cipher, plain, sizeof(plain));
+        virt[rep] = (uint32_t)((hal_host_now_ps() - start_ps) / 1000);
+
+        start = bench_clock_read();
+        for (i = 0; i < AES_BENCH_BYTES; i += 16) {
+            counter[15] = (uint8_t)i;
+            aes_soft_encrypt(&aes, counter, &cipher[i]);
+        }
+        wall[rep] = bench_clock_read() - start;
+
+        if (virt[rep] < virt_min) {
+            virt_min = virt[rep];
+        }
+        if (wall[rep] < wall_min) {
+            wall_min = wall[rep];
+        }
+    }
+    bench_report("aes_stream_xor sim virtual", AES_BENCH_BYTES / 16, AES_BENCH_BYTES, 1, virt_min,
+        bench_median(virt, BENCH_REPS), 1000000000, print_line);
+    bench_report("aes_soft_encrypt host", AES_BENCH_BYTES / 16, AES_BENCH_BYTES, 1, wall_min,
+        bench_median(wall, BENCH_REPS), 1000000000, print_line);
+}
+
+int main(int argc, char **argv) {
+    uint16_t inner = 1000;
+    cpu_set_t cpus;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:c:")) != -1) {
+        switch (opt) {
+            case 'n':
+                inner = (uint16_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'c':
+                CPU_ZERO(&cpus);
+                CPU_SET(atoi(optarg), &cpus);
+                if (sched_setaffinity(0, sizeof(cpus), &cpus)) {
+                    perror("sched_setaffinity");
+                    return 1;
+                }
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n inner] [-c cpu]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (inner == 0) {
+        inner = 1;
+    }
+
+    bench_clock_init();
+    bench_run(NULL, inner, print_line);
+    bench_upload();
+    bench_regscript();
+    bench_aes();
+    return 0;
+}
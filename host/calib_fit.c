@@ -0,0 +1,358 @@
+/*
+Works out the CALIB_ACC and CALIB_GYR tables (../calib.h) for a device from still captures: each
+capture is the device lying still with one of its axes straight up or down, as dumped by a
+firmware built with CALIB=0 and AUTORANGE=0, so at 2 g and 2000 dps. Which way up each one was
+is taken from the axis the gravity is on.
+
+The accel's matrix and offsets are a least squares fit of the captures' means to 1 g along the
+axis up, which takes four orientations not all in one plane; all six is better, and with more
+than four the residual shows how well the part fits the model. The gyro only gets its offsets,
+from the mean over all the captures, as its scale takes a known rate to measure.
+
+-m gives the board's axes in the sensor's, as bmi2_set_remap_axes() would: -m -y,x,z for a
+sensor whose x is along the board's y. The remap then goes into both matrices, and the outputs
+are the board's axes.
+
+Prints the tables as a makefile fragment on stdout, for make CALIB_TABLE=..., and a report on
+stderr: per capture, which way up it was, its accel's distance from 1 g on that axis before
+and after the tables (applied as calib.c does, in fixed point), and its mean gyro. Captures that
+can't be fitted, like a single one from a calibrated build, still get the report, with only
+the first figure.
+
+usage: calib_fit [-f bin|csv] [-m axes] capture...
+  e.g. calib_fit -m -y,x,z build/calib/still+x.bin ... build/calib/still-z.bin > build/calib/table.mk
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "uart_decode.h"
+#include "../calib.h"
+
+// LSB per g at 2 g, per dps at 2000 dps, and how many times finer 125 dps is
+#define ACC_LSB_PER_G 16384.0
+#define GYR_LSB_PER_DPS (32768.0 / 2000.0)
+#define GYR_OFFSET_SCALE 16
+
+#define MAX_CAPTURES 32
+
+struct capture {
+    const char *path;
+    uint32_t records;
+    double acc[3], gyr[3];
+    // Board axis up, and +1 or -1
+    int axis, sign;
+};
+
+static void add_record(const struct uart_decode_record *rec, void *ctx) {
+    struct capture *c = ctx;
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        c->acc[i] += rec->acc[i];
+        c->gyr[i] += rec->gyr[i];
+    }
+    c->records++;
+}
+
+static int read_capture(struct capture *c, enum uart_decode_format format) {
+    struct uart_decoder dec;
+    uint8_t buf[256];
+    ssize_t got, i;
+    int fd, k;
+
+    fd = open(c->path, O_RDONLY);
+    if (fd < 0) {
+        perror(c->path);
+        return -1;
+    }
+    uart_decoder_init(&dec, format, add_record, c);
+    for (;;) {
+        got = read(fd, buf, sizeof(buf));
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            break;
+        }
+        for (i = 0; i < got; i++) {
+            uart_decoder_put(&dec, buf[i], 0);
+        }
+    }
+    uart_decoder_finish(&dec);
+    close(fd);
+    if (c->records == 0) {
+        fprintf(stderr, "calib_fit: no samples in %s\n", c->path);
+        return -1;
+    }
+    for (k = 0; k < 3; k++) {
+        c->acc[k] /= c->records;
+        c->gyr[k] /= c->records;
+    }
+    return 0;
+}
+
+// "-y,x,z" into the signed permutation taking the sensor's axes to the board's
+static int parse_axes(const char *s, double p[3][3]) {
+    int r, sign, used = 0;
+
+    memset(p, 0, 9 * sizeof(double));
+    for (r = 0; r < 3; r++) {
+        sign = 1;
+        if (*s == '-' || *s == '+') {
+            sign = (*s == '-') ? -1 : 1;
+            s++;
+        }
+        if (*s < 'x' || *s > 'z' || (used & (1 << (*s - 'x')))) {
+            return -1;
+        }
+        used |= 1 << (*s - 'x');
+        p[r][*s - 'x'] = sign;
+        s++;
+        if (*s != ((r < 2) ? ',' : '\0')) {
+            return -1;
+        }
+        s++;
+    }
+    return 0;
+}
+
+static void mul(const double m[3][3], const double v[3], double out[3]) {
+    int r;
+
+    for (r = 0; r < 3; r++) {
+        out[r] = m[r][0] * v[0] + m[r][1] * v[1] + m[r][2] * v[2];
+    }
+}
+
+// Solve a 4x4 system in place by Gaussian elimination; -1 if it's (near enough) singular
+static int solve4(double a[4][4], double b[4], double x[4]) {
+    double t, f;
+    int i, j, k, piv;
+
+    for (i = 0; i < 4; i++) {
+        piv = i;
+        for (j = i + 1; j < 4; j++) {
+            if (fabs(a[j][i]) > fabs(a[piv][i])) {
+                piv = j;
+            }
+        }
+        if (fabs(a[piv][i]) < 1e-9 * (fabs(a[0][0]) + 1)) {
+            return -1;
+        }
+        for (k = 0; k < 4; k++) {
+            t = a[i][k];
+            a[i][k] = a[piv][k];
+            a[piv][k] = t;
+        }
+        t = b[i];
+        b[i] = b[piv];
+        b[piv] = t;
+        for (j = i + 1; j < 4; j++) {
+            f = a[j][i] / a[i][i];
+            for (k = i; k < 4; k++) {
+                a[j][k] -= f * a[i][k];
+            }
+            b[j] -= f * b[i];
+        }
+    }
+    for (i = 3; i >= 0; i--) {
+        x[i] = b[i];
+        for (k = i + 1; k < 4; k++) {
+            x[i] -= a[i][k] * x[k];
+        }
+        x[i] /= a[i][i];
+    }
+    return 0;
+}
+
+static int16_t to_q14(double v) {
+    return (int16_t)lround(v * (1 << CALIB_Q));
+}
+
+// What calib.c makes of v, at the narrowest range's offsets
+static void apply(const struct calib_axes *c, const double v[3], double out[3]) {
+    int32_t in[3], sum;
+    int r, k;
+
+    for (k = 0; k < 3; k++) {
+        in[k] = (int32_t)lround(v[k]);
+    }
+    for (r = 0; r < 3; r++) {
+        sum = c->offset[r] * (1 << CALIB_Q) + (1 << (CALIB_Q - 1));
+        for (k = 0; k < 3; k++) {
+            sum += c->m[r][k] * in[k];
+        }
+        sum >>= CALIB_Q;
+        out[r] = (sum > INT16_MAX) ? INT16_MAX : (sum < INT16_MIN) ? INT16_MIN : sum;
+    }
+}
+
+// Check each row's worst case fits the MPY32's 32 bit sum
+static int fits(const struct calib_axes *c, const char *name) {
+    int64_t worst;
+    int r, k;
+
+    for (r = 0; r < 3; r++) {
+        worst = (int64_t)abs(c->offset[r]) * (1 << CALIB_Q) + (1 << (CALIB_Q - 1));
+        for (k = 0; k < 3; k++) {
+            worst += (int64_t)abs(c->m[r][k]) * 32768;
+        }
+        if (worst > INT32_MAX) {
+            fprintf(stderr, "calib_fit: the %s table's row %d could overflow; is the part that far off?\n",
+                name, r);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void print_table(const char *name, const struct calib_axes *c) {
+    int r;
+
+    // Braced as struct calib_axes is
+    printf("%s = { {", name);
+    for (r = 0; r < 3; r++) {
+        printf(" { %d, %d, %d }%s", c->m[r][0], c->m[r][1], c->m[r][2], (r < 2) ? "," : "");
+    }
+    printf(" }, { %d, %d, %d } }\n", c->offset[0], c->offset[1], c->offset[2]);
+}
+
+// Fit the tables to the captures; -1 if they can't be
+static int fit(const struct capture *caps, int n, const double remap[3][3], const double bias[3],
+        struct calib_axes *acc_table, struct calib_axes *gyr_table) {
+    double a[4][4], b[4], x[4], row[4], out[3];
+    int i, r, j, k;
+
+    // Each board axis r: m[r] . raw + offset[r] = 1 g or 0, over the captures
+    for (r = 0; r < 3; r++) {
+        memset(a, 0, sizeof(a));
+        memset(b, 0, sizeof(b));
+        for (i = 0; i < n; i++) {
+            row[0] = caps[i].acc[0];
+            row[1] = caps[i].acc[1];
+            row[2] = caps[i].acc[2];
+            row[3] = 1;
+            for (j = 0; j < 4; j++) {
+                for (k = 0; k < 4; k++) {
+                    a[j][k] += row[j] * row[k];
+                }
+                b[j] += row[j] * ((r == caps[i].axis) ? caps[i].sign * ACC_LSB_PER_G : 0);
+            }
+        }
+        if (solve4(a, b, x) != 0) {
+            fprintf(stderr, "calib_fit: the captures need four or more ways up, not all in one plane\n");
+            return -1;
+        }
+        for (k = 0; k < 3; k++) {
+            if (fabs(x[k]) >= 2.0) {
+                fprintf(stderr, "calib_fit: the fit needs a gain of %.3f, past the 2 the tables hold\n", x[k]);
+                return -1;
+            }
+            acc_table->m[r][k] = to_q14(x[k]);
+            gyr_table->m[r][k] = to_q14(remap[r][k]);
+        }
+        acc_table->offset[r] = (int16_t)lround(x[3]);
+    }
+    // The gyro's offsets, turned to the board's axes and to LSB at 125 dps
+    mul(remap, bias, out);
+    for (r = 0; r < 3; r++) {
+        gyr_table->offset[r] = (int16_t)lround(-out[r] * GYR_OFFSET_SCALE);
+    }
+    return (fits(acc_table, "accel") && fits(gyr_table, "gyro")) ? 0 : -1;
+}
+
+// Distance of an accel reading in LSB at 2 g from 1 g on the capture's axis, in mg
+static double error_mg(const struct capture *c, const double v[3]) {
+    double d, sum = 0;
+    int k;
+
+    for (k = 0; k < 3; k++) {
+        d = v[k] - ((k == c->axis) ? c->sign * ACC_LSB_PER_G : 0);
+        sum += d * d;
+    }
+    return sqrt(sum) / ACC_LSB_PER_G * 1000;
+}
+
+int main(int argc, char **argv) {
+    enum uart_decode_format format = UART_DECODE_BINARY;
+    struct capture caps[MAX_CAPTURES];
+    struct calib_axes acc_table, gyr_table;
+    double remap[3][3] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+    double board[3], bias[3] = { 0 }, out[3];
+    double before, after, worst = 0;
+    int n, i, j, k, opt, fitted, seen = 0;
+
+    while ((opt = getopt(argc, argv, "f:m:")) != -1) {
+        if (opt == 'f' && strcmp(optarg, "bin") == 0) {
+            format = UART_DECODE_BINARY;
+        } else if (opt == 'f' && strcmp(optarg, "csv") == 0) {
+            format = UART_DECODE_CSV;
+        } else if (opt == 'm' && parse_axes(optarg, remap) == 0) {
+            continue;
+        } else {
+            fprintf(stderr, "usage: %s [-f bin|csv] [-m axes] capture...\n", argv[0]);
+            return 1;
+        }
+    }
+    n = argc - optind;
+    if (n < 1 || n > MAX_CAPTURES) {
+        fprintf(stderr, "usage: %s [-f bin|csv] [-m axes] capture...\n", argv[0]);
+        return 1;
+    }
+
+    memset(caps, 0, sizeof(caps));
+    for (i = 0; i < n; i++) {
+        caps[i].path = argv[optind + i];
+        if (read_capture(&caps[i], format) != 0) {
+            return 1;
+        }
+        // Which way up, in the board's axes
+        mul((const double (*)[3])remap, caps[i].acc, board);
+        for (k = 1, caps[i].axis = 0; k < 3; k++) {
+            if (fabs(board[k]) > fabs(board[caps[i].axis])) {
+                caps[i].axis = k;
+            }
+        }
+        caps[i].sign = (board[caps[i].axis] < 0) ? -1 : 1;
+        seen |= 1 << (2 * caps[i].axis + (caps[i].sign < 0));
+        for (k = 0; k < 3; k++) {
+            bias[k] += caps[i].gyr[k] / n;
+        }
+    }
+
+    // A capture or a few can still be looked at without a fit
+    fitted = fit(caps, n, (const double (*)[3])remap, bias, &acc_table, &gyr_table) == 0;
+
+    for (i = 0; i < n; i++) {
+        mul((const double (*)[3])remap, caps[i].acc, board);
+        before = error_mg(&caps[i], board);
+        fprintf(stderr, "%s: %c%c  %5u samples  accel %7.2f mg off", caps[i].path, (caps[i].sign > 0) ? '+' : '-',
+            'x' + caps[i].axis, caps[i].records, before);
+        if (fitted) {
+            apply(&acc_table, caps[i].acc, out);
+            after = error_mg(&caps[i], out);
+            if (after > worst) {
+                worst = after;
+            }
+            fprintf(stderr, ", %5.2f mg calibrated", after);
+        }
+        fprintf(stderr, "  gyro %6.3f %6.3f %6.3f dps\n", caps[i].gyr[0] / GYR_LSB_PER_DPS,
+            caps[i].gyr[1] / GYR_LSB_PER_DPS, caps[i].gyr[2] / GYR_LSB_PER_DPS);
+    }
+    for (k = 0, j = 0; k < 6; k++) {
+        j += (seen >> k) & 1;
+    }
+    if (!fitted) {
+        return 1;
+    }
+    fprintf(stderr, "calib_fit: %d captures, %d ways up, worst %.2f mg after\n", n, j, worst);
+
+    print_table("CALIB_ACC", &acc_table);
+    print_table("CALIB_GYR", &gyr_table);
+    return 0;
+}
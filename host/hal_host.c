@@ -0,0 +1,1223 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <driverlib.h>
+#include "hal_host.h"
+#include "aes_soft.h"
+
+#define MAX_HOOKS 8
+#define NUM_PORTS 16
+
+// Interrupt flag bits, shared by the SPI and UART models
+#define IFG_RX 0x01
+#define IFG_TX 0x02
+#define IFG_TXCPT 0x08
+
+// The firmware's ISRs; weak so a build that leaves a module out still links
+extern void EUSCI_A0_ISR(void) __attribute__((weak));
+extern void USCI_B0_ISR(void) __attribute__((weak));
+extern void TIMER0_A0_ISR(void) __attribute__((weak));
+extern void TIMER1_A0_ISR(void) __attribute__((weak));
+extern void PORT1_ISR(void) __attribute__((weak));
+extern void EUSCI_A1_ISR(void) __attribute__((weak));
+extern void DMA_ISR(void) __attribute__((weak));
+extern void AES256_ISR(void) __attribute__((weak));
+extern void RTC_C_ISR(void) __attribute__((weak));
+
+#define NUM_DMA 3
+// UCAxTXBUF's offset from the eUSCI_A base
+#define OFS_UCAXTXBUF 0x0E
+
+struct timer {
+    uint16_t base;
+    uint8_t running;
+    uint16_t source;
+    uint16_t divider;
+    uint64_t start_ps;
+    uint16_t ccr[3];
+    uint8_t ccie;
+    uint8_t ccifg;
+};
+
+struct spi {
+    uint8_t enabled;
+    uint8_t ie;
+    uint8_t ifg;
+    uint8_t rxbuf;
+    uint8_t rx_next;
+    uint32_t clk_hz;
+    uint64_t done_ps;
+};
+
+struct uart {
+    uint16_t base;
+    uint8_t enabled;
+    uint8_t ie;
+    uint8_t ifg;
+    uint8_t rxbuf;
+    uint8_t tx_byte;
+    uint64_t byte_ps;
+    uint64_t done_ps;
+    // Set by hal_host_set_uart_baud(), in place of the rate the firmware configures
+    uint32_t baud;
+};
+
+struct dma {
+    uint8_t enabled;
+    uint8_t ie;
+    uint8_t ifg;
+    uint8_t trigger;
+    uint16_t size;
+    uintptr_t src;
+    uintptr_t dst;
+    uint16_t src_dir;
+};
+
+struct aes {
+    uint8_t keyed;
+    uint8_t ie;
+    uint8_t ifg;
+    struct aes_soft key;
+    uint8_t out[16];
+    // When the block being encrypted is done
+    uint64_t done_ps;
+};
+
+struct rtc {
+    uint8_t running;
+    uint8_t ie;
+    uint8_t ifg;
+    // The calendar when the clock was started, as seconds since 1970, and when that was
+    int64_t start_utc;
+    uint64_t start_ps;
+    // Next time the seconds move on
+    uint64_t next_ps;
+};
+
+struct mpy {
+    uint8_t type;
+    uint16_t op1;
+    // RES3..RES0
+    uint64_t res;
+};
+
+struct port {
+    uint8_t dir;
+    uint8_t out;
+    uint8_t in;
+    uint8_t ie;
+    uint8_t ies;
+    uint8_t ifg;
+};
+
+static uint64_t now;
+static uint16_t sr;
+// SR that gets restored when the running ISR returns
+static uint16_t *exit_sr;
+
+static uint32_t dco_hz;
+static uint16_t clk_source[3];
+static uint16_t clk_divider[3];
+
+static struct timer timers[2];
+static struct spi spi;
+static struct uart uarts[2];
+static struct port ports[NUM_PORTS];
+static struct dma dmas[NUM_DMA];
+static struct aes aes;
+static struct mpy mpy;
+static struct rtc rtc;
+
+// hal_host_stall_spi()'s time, until it hits
+static uint64_t spi_stall_at;
+
+static struct hal_host_spi_device spi_dev;
+static uint8_t spi_cs_port;
+static uint8_t spi_cs_pin;
+static uint8_t spi_selected;
+
+static struct hal_host_hook hooks[MAX_HOOKS];
+static uint8_t num_hooks;
+
+static hal_host_uart_sink uart_sink;
+static void *uart_sink_ctx;
+
+static struct hal_host_stats stats;
+
+static void fatal(const char *what) {
+    fprintf(stderr, "hal_host: %s at t=%.6f s\n", what, (double)now / HAL_HOST_PS_PER_S);
+    exit(3);
+}
+
+/* Clocks */
+
+static uint32_t source_hz(uint16_t source) {
+    switch (source) {
+        case CS_LFXTCLK_SELECT: return 32768;
+        case CS_VLOCLK_SELECT: return 9400;
+        case CS_LFMODOSC_SELECT: return 39062;
+        case CS_DCOCLK_SELECT: return dco_hz;
+        case CS_MODOSC_SELECT: return 5000000;
+        default: return 0;
+    }
+}
+
+static uint32_t clock_hz(uint8_t index) {
+    return source_hz(clk_source[index]) / clk_divider[index];
+}
+
+static uint32_t mclk_hz(void) {
+    return clock_hz(1);
+}
+
+static uint64_t cycles_ps(uint32_t cycles) {
+    return (uint64_t)cycles * HAL_HOST_PS_PER_S / mclk_hz();
+}
+
+/* Timer_A */
+
+static struct timer *find_timer(uint16_t base) {
+    return (base == TIMER_A0_BASE) ? &timers[0] : (base == TIMER_A1_BASE) ? &timers[1] : NULL;
+}
+
+static uint32_t timer_hz(const struct timer *t) {
+    return (t->source == TIMER_A_CLOCKSOURCE_ACLK) ? clock_hz(0) : clock_hz(2);
+}
+
+// Counter value (not wrapped) at time when
+static uint64_t timer_ticks_at(const struct timer *t, uint64_t when) {
+    return (uint64_t)((unsigned __int128)(when - t->start_ps) * timer_hz(t) /
+        ((unsigned __int128)HAL_HOST_PS_PER_S * t->divider));
+}
+
+static uint64_t timer_ticks(const struct timer *t) {
+    return timer_ticks_at(t, now);
+}
+
+// When the counter reaches tick n
+static uint64_t timer_tick_ps(const struct timer *t, uint64_t n) {
+    unsigned __int128 scaled = (unsigned __int128)n * HAL_HOST_PS_PER_S * t->divider;
+    uint32_t hz = timer_hz(t);
+    return t->start_ps + (uint64_t)((scaled + hz - 1) / hz);
+}
+
+static uint64_t timer_next(const struct timer *t) {
+    uint64_t ticks;
+    uint32_t delta;
+
+    if (!t->running || !t->ccie || t->ccifg) {
+        return HAL_HOST_NEVER;
+    }
+    // Count from just before now, so a compare that lands exactly now still counts as due
+    ticks = (now > t->start_ps) ? timer_ticks_at(t, now - 1) : 0;
+    delta = (uint16_t)(t->ccr[0] - (uint16_t)ticks);
+    if (delta == 0) {
+        delta = 0x10000;
+    }
+    return timer_tick_ps(t, ticks + delta);
+}
+
+/* DMA */
+
+// Move one byte of channel d into its UART's TXBUF, which takes TXIFG straight back down
+static void dma_move(struct dma *d) {
+    uint16_t base = (d->trigger == DMA_TRIGGERSOURCE_15) ? EUSCI_A0_BASE : EUSCI_A1_BASE;
+
+    if (d->dst != (uintptr_t)(base + OFS_UCAXTXBUF)) {
+        fatal("DMA to something other than the UART's TXBUF");
+    }
+    EUSCI_A_UART_transmitData(base, *(const uint8_t *)d->src);
+    if (d->src_dir == DMA_DIRECTION_INCREMENT) {
+        d->src += 1;
+    }
+    d->size -= 1;
+    if (d->size == 0) {
+        d->enabled = 0;
+        d->ifg = 1;
+    }
+    stats.dma_transfers += 1;
+}
+
+// A UART's TXIFG just came up: a DMA channel triggered by it moves the next byte
+static void dma_trigger(uint8_t uart) {
+    uint8_t trigger = (uart == 0) ? DMA_TRIGGERSOURCE_15 : DMA_TRIGGERSOURCE_17;
+    uint8_t i;
+
+    for (i = 0; i < NUM_DMA; i++) {
+        if (dmas[i].enabled && dmas[i].trigger == trigger) {
+            dma_move(&dmas[i]);
+            return;
+        }
+    }
+}
+
+static uint8_t dma_pending(void) {
+    uint8_t i;
+
+    for (i = 0; i < NUM_DMA; i++) {
+        if (dmas[i].ie && dmas[i].ifg) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Event loop */
+
+static uint64_t next_event(void) {
+    uint64_t next = HAL_HOST_NEVER;
+    uint64_t t;
+    uint8_t i;
+
+    for (i = 0; i < 2; i++) {
+        t = timer_next(&timers[i]);
+        if (t < next) next = t;
+        if (uarts[i].done_ps < next) next = uarts[i].done_ps;
+    }
+    if (spi.done_ps < next) next = spi.done_ps;
+    if (aes.done_ps < next) next = aes.done_ps;
+    if (rtc.next_ps < next) next = rtc.next_ps;
+    for (i = 0; i < num_hooks; i++) {
+        t = hooks[i].next(hooks[i].ctx);
+        if (t < next) next = t;
+    }
+    return (next < now) ? now : next;
+}
+
+// Run everything that's due at the current time
+static void fire_due(void) {
+    uint8_t i;
+
+    for (i = 0; i < 2; i++) {
+        if (timer_next(&timers[i]) <= now) {
+            timers[i].ccifg = 1;
+        }
+        if (uarts[i].done_ps <= now) {
+            uarts[i].done_ps = HAL_HOST_NEVER;
+            uarts[i].ifg |= IFG_TX | IFG_TXCPT;
+            stats.uart_bytes += 1;
+            if (uart_sink) {
+                uart_sink(uarts[i].base, uarts[i].tx_byte, uart_sink_ctx);
+            }
+            dma_trigger(i);
+        }
+    }
+    if (spi.done_ps <= now) {
+        spi.done_ps = HAL_HOST_NEVER;
+        spi.rxbuf = spi.rx_next;
+        spi.ifg |= IFG_RX | IFG_TX;
+    }
+    if (aes.done_ps <= now) {
+        aes.done_ps = HAL_HOST_NEVER;
+        aes.ifg = 1;
+        stats.aes_blocks += 1;
+    }
+    if (rtc.next_ps <= now) {
+        rtc.next_ps += HAL_HOST_PS_PER_S;
+        rtc.ifg |= RTC_C_CLOCK_READ_READY_INTERRUPT;
+    }
+    for (i = 0; i < num_hooks; i++) {
+        if (hooks[i].next(hooks[i].ctx) <= now) {
+            hooks[i].run(hooks[i].ctx, now);
+        }
+    }
+}
+
+// Raise flags for everything up to time t, without running any ISRs
+static void run_events(uint64_t t) {
+    uint64_t next;
+
+    while ((next = next_event()) <= t) {
+        now = next;
+        fire_due();
+    }
+    if (t > now) {
+        now = t;
+    }
+}
+
+typedef void (*isr_fn)(void);
+
+// Highest priority pending interrupt, in FR6989 vector order
+static isr_fn pending_isr(void) {
+    if ((uarts[0].ie & uarts[0].ifg) && EUSCI_A0_ISR) return EUSCI_A0_ISR;
+    if ((spi.ie & spi.ifg) && USCI_B0_ISR) return USCI_B0_ISR;
+    if (timers[0].ccie && timers[0].ccifg && TIMER0_A0_ISR) {
+        // CCR0's flag clears itself when the interrupt is taken
+        timers[0].ccifg = 0;
+        return TIMER0_A0_ISR;
+    }
+    if (timers[1].ccie && timers[1].ccifg && TIMER1_A0_ISR) {
+        timers[1].ccifg = 0;
+        return TIMER1_A0_ISR;
+    }
+    if ((ports[1].ie & ports[1].ifg) && PORT1_ISR) return PORT1_ISR;
+    if (dma_pending() && DMA_ISR) return DMA_ISR;
+    if ((uarts[1].ie & uarts[1].ifg) && EUSCI_A1_ISR) return EUSCI_A1_ISR;
+    if ((rtc.ie & rtc.ifg) && RTC_C_ISR) return RTC_C_ISR;
+    if (aes.ie && aes.ifg && AES256_ISR) return AES256_ISR;
+    return NULL;
+}
+
+static void dispatch(void) {
+    isr_fn isr;
+
+    while ((sr & GIE) && (isr = pending_isr()) != NULL) {
+        uint16_t saved = sr;
+        uint16_t *outer = exit_sr;
+
+        // Interrupt entry pushes SR and clears it, so the ISR runs active with GIE off
+        exit_sr = &saved;
+        sr = 0;
+        isr();
+        exit_sr = outer;
+        sr = saved;
+
+        stats.isrs += 1;
+        run_events(now + cycles_ps(HAL_HOST_ISR_CYCLES));
+    }
+}
+
+// Move the clock to t with the CPU awake, taking interrupts as they come due
+static void advance_active(uint64_t t) {
+    uint64_t next;
+
+    while ((next = next_event()) <= t) {
+        now = next;
+        fire_due();
+        dispatch();
+    }
+    if (t > now) {
+        now = t;
+    }
+}
+
+void hal_host_bis_sr(uint16_t bits) {
+    uint8_t slept = 0;
+
+    sr |= bits;
+    dispatch();
+    while (sr & CPUOFF) {
+        uint64_t next = next_event();
+        if (next == HAL_HOST_NEVER) {
+            fatal("CPU asleep with nothing left to wake it");
+        }
+        if (!(sr & GIE)) {
+            fatal("CPU asleep with interrupts disabled");
+        }
+        stats.sleep_ps += next - now;
+        now = next;
+        slept = 1;
+        fire_due();
+        dispatch();
+    }
+    if (slept) {
+        stats.wakeups += 1;
+    }
+}
+
+void hal_host_bic_sr(uint16_t bits) {
+    sr &= ~bits;
+}
+
+void hal_host_bic_sr_on_exit(uint16_t bits) {
+    if (exit_sr) {
+        *exit_sr &= ~bits;
+    } else {
+        sr &= ~bits;
+    }
+}
+
+void hal_host_delay_cycles(uint32_t cycles) {
+    advance_active(now + cycles_ps(cycles));
+}
+
+uint16_t hal_host_read_iv(uint16_t base) {
+    uint8_t *ifg;
+    uint8_t pending;
+
+    if (base == EUSCI_B0_BASE) {
+        ifg = &spi.ifg;
+        pending = spi.ie & spi.ifg;
+    } else {
+        struct uart *u = (base == EUSCI_A0_BASE) ? &uarts[0] : &uarts[1];
+        ifg = &u->ifg;
+        pending = u->ie & u->ifg;
+    }
+
+    // Reading the IV clears the flag it reports
+    if (pending & IFG_RX) {
+        *ifg &= ~IFG_RX;
+        return USCI_SPI_UCRXIFG;
+    }
+    if (pending & IFG_TX) {
+        *ifg &= ~IFG_TX;
+        return USCI_SPI_UCTXIFG;
+    }
+    if (pending & IFG_TXCPT) {
+        *ifg &= ~IFG_TXCPT;
+        return USCI_UART_UCTXCPTIFG;
+    }
+    return USCI_NONE;
+}
+
+uint16_t hal_host_read_dma_iv(void) {
+    uint8_t i;
+
+    // Reading the IV clears the flag it reports
+    for (i = 0; i < NUM_DMA; i++) {
+        if (dmas[i].ie && dmas[i].ifg) {
+            dmas[i].ifg = 0;
+            return DMAIV_DMA0IFG + 2 * i;
+        }
+    }
+    return DMAIV_NONE;
+}
+
+uint16_t hal_host_read_rtc_iv(void) {
+    // Reading the IV clears the flag it reports
+    if (rtc.ie & rtc.ifg & RTC_C_CLOCK_READ_READY_INTERRUPT) {
+        rtc.ifg &= ~RTC_C_CLOCK_READ_READY_INTERRUPT;
+        return RTCIV__RTCRDYIFG;
+    }
+    return RTCIV__NONE;
+}
+
+uint16_t hal_host_read_rtc_ctl13(void) {
+    return rtc.running ? 0 : RTCHOLD;
+}
+
+/* Host side */
+
+void hal_host_reset(void) {
+    now = 0;
+    sr = 0;
+    exit_sr = NULL;
+
+    // Power-on defaults: DCO at 8 MHz, MCLK and SMCLK divided down to 1 MHz
+    dco_hz = 8000000;
+    clk_source[0] = CS_LFXTCLK_SELECT;
+    clk_source[1] = CS_DCOCLK_SELECT;
+    clk_source[2] = CS_DCOCLK_SELECT;
+    clk_divider[0] = 1;
+    clk_divider[1] = 8;
+    clk_divider[2] = 8;
+
+    memset(timers, 0, sizeof(timers));
+    timers[0].base = TIMER_A0_BASE;
+    timers[1].base = TIMER_A1_BASE;
+    timers[0].divider = timers[1].divider = 1;
+
+    memset(&spi, 0, sizeof(spi));
+    spi.done_ps = HAL_HOST_NEVER;
+    memset(uarts, 0, sizeof(uarts));
+    uarts[0].base = EUSCI_A0_BASE;
+    uarts[1].base = EUSCI_A1_BASE;
+    uarts[0].done_ps = uarts[1].done_ps = HAL_HOST_NEVER;
+
+    memset(ports, 0, sizeof(ports));
+    memset(dmas, 0, sizeof(dmas));
+    memset(&aes, 0, sizeof(aes));
+    aes.done_ps = HAL_HOST_NEVER;
+    memset(&mpy, 0, sizeof(mpy));
+    memset(&rtc, 0, sizeof(rtc));
+    rtc.next_ps = HAL_HOST_NEVER;
+    memset(&spi_dev, 0, sizeof(spi_dev));
+    spi_selected = 0;
+    num_hooks = 0;
+    uart_sink = NULL;
+    memset(&stats, 0, sizeof(stats));
+    stats.spi_stall_ps = HAL_HOST_NEVER;
+    spi_stall_at = HAL_HOST_NEVER;
+}
+
+uint64_t hal_host_now_ps(void) {
+    return now;
+}
+
+void hal_host_attach_spi(uint16_t base, uint8_t cs_port, uint16_t cs_pin, const struct hal_host_spi_device *dev) {
+    (void)base;
+    spi_dev = *dev;
+    spi_cs_port = cs_port;
+    spi_cs_pin = (uint8_t)cs_pin;
+}
+
+void hal_host_stall_spi(uint64_t at_ps) {
+    spi_stall_at = at_ps;
+}
+
+void hal_host_add_hook(const struct hal_host_hook *hook) {
+    if (num_hooks == MAX_HOOKS) {
+        fatal("too many hooks");
+    }
+    hooks[num_hooks++] = *hook;
+}
+
+void hal_host_set_uart_sink(hal_host_uart_sink sink, void *ctx) {
+    uart_sink = sink;
+    uart_sink_ctx = ctx;
+}
+
+void hal_host_set_input(uint8_t port, uint16_t pins, uint8_t high) {
+    struct port *p = &ports[port];
+    uint8_t old = p->in;
+
+    p->in = high ? (p->in | pins) : (p->in & ~pins);
+    // Rising edges where IES is clear, falling edges where it's set; IFG is set whether or
+    // not the interrupt is enabled
+    p->ifg |= (~old & p->in & ~p->ies) | (old & ~p->in & p->ies);
+}
+
+void hal_host_set_uart_baud(uint16_t base, uint32_t baud) {
+    struct uart *u = (base == EUSCI_A0_BASE) ? &uarts[0] : &uarts[1];
+    u->baud = baud;
+}
+
+void hal_host_uart_receive(uint16_t base, uint8_t byte) {
+    struct uart *u = (base == EUSCI_A0_BASE) ? &uarts[0] : &uarts[1];
+    u->rxbuf = byte;
+    u->ifg |= IFG_RX;
+}
+
+uint8_t hal_host_uart_rx_enabled(uint16_t base) {
+    struct uart *u = (base == EUSCI_A0_BASE) ? &uarts[0] : &uarts[1];
+    return (u->ie & IFG_RX) != 0;
+}
+
+void hal_host_drain(void) {
+    uint8_t i;
+
+    for (i = 0; i < 2; i++) {
+        if (uarts[i].done_ps != HAL_HOST_NEVER) {
+            advance_active(uarts[i].done_ps);
+        }
+    }
+}
+
+void hal_host_get_stats(struct hal_host_stats *out) {
+    *out = stats;
+    out->now_ps = now;
+}
+
+/* driverlib: WDT_A, PMM, FRAMCtl */
+
+void WDT_A_hold(uint16_t baseAddress) {
+    (void)baseAddress;
+}
+
+void PMM_unlockLPM5(void) {
+}
+
+// With no LPMx.5, LPM4 is just LPM4 whatever the regulator is doing
+void PMM_turnOffRegulator(void) {
+}
+
+void PMM_turnOnRegulator(void) {
+}
+
+uint16_t PMM_getInterruptStatus(uint16_t mask) {
+    // Never woken from LPMx.5 (see hal_host.h)
+    (void)mask;
+    return 0;
+}
+
+void PMM_clearInterrupt(uint16_t mask) {
+    (void)mask;
+}
+
+void FRAMCtl_configureWaitStateControl(uint8_t waitState) {
+    (void)waitState;
+}
+
+void FRAMCtl_delayPowerUpFromLPM(uint8_t delayStatus) {
+    (void)delayStatus;
+}
+
+/* driverlib: CS */
+
+void CS_setDCOFreq(uint16_t dcorsel, uint16_t dcofsel) {
+    static const uint32_t low[] = { 1000000, 2670000, 3500000, 4000000, 5330000, 7000000, 8000000 };
+    static const uint32_t high[] = { 1000000, 5330000, 7000000, 8000000, 16000000, 21000000, 24000000 };
+
+    if (dcofsel <= CS_DCOFSEL_6) {
+        dco_hz = (dcorsel == CS_DCORSEL_1) ? high[dcofsel] : low[dcofsel];
+    }
+}
+
+void CS_initClockSignal(uint8_t selectedClockSignal, uint16_t clockSource, uint16_t clockSourceDivider) {
+    uint8_t index = (selectedClockSignal == CS_ACLK) ? 0 : (selectedClockSignal == CS_MCLK) ? 1 : 2;
+    clk_source[index] = clockSource;
+    clk_divider[index] = clockSourceDivider;
+}
+
+void CS_setExternalClockSource(uint32_t LFXTCLK_frequency, uint32_t HFXTCLK_frequency) {
+    (void)LFXTCLK_frequency;
+    (void)HFXTCLK_frequency;
+}
+
+void CS_turnOnLFXT(uint16_t lfxtdrive) {
+    (void)lfxtdrive;
+}
+
+uint32_t CS_getACLK(void) {
+    return clock_hz(0);
+}
+
+uint32_t CS_getMCLK(void) {
+    return clock_hz(1);
+}
+
+uint32_t CS_getSMCLK(void) {
+    return clock_hz(2);
+}
+
+/* driverlib: GPIO */
+
+static void update_cs(uint8_t port) {
+    uint8_t selected;
+
+    if (port != spi_cs_port || !spi_dev.select) {
+        return;
+    }
+    selected = (ports[port].dir & spi_cs_pin) && !(ports[port].out & spi_cs_pin);
+    if (selected != spi_selected) {
+        spi_selected = selected;
+        spi_dev.select(spi_dev.ctx, selected);
+    }
+}
+
+void GPIO_setAsOutputPin(uint8_t selectedPort, uint16_t selectedPins) {
+    ports[selectedPort].dir |= selectedPins;
+    update_cs(selectedPort);
+}
+
+void GPIO_setAsInputPin(uint8_t selectedPort, uint16_t selectedPins) {
+    ports[selectedPort].dir &= ~selectedPins;
+    update_cs(selectedPort);
+}
+
+void GPIO_setAsInputPinWithPullDownResistor(uint8_t selectedPort, uint16_t selectedPins) {
+    GPIO_setAsInputPin(selectedPort, selectedPins);
+}
+
+void GPIO_setAsInputPinWithPullUpResistor(uint8_t selectedPort, uint16_t selectedPins) {
+    GPIO_setAsInputPin(selectedPort, selectedPins);
+}
+
+void GPIO_setAsPeripheralModuleFunctionInputPin(uint8_t selectedPort, uint16_t selectedPins, uint8_t mode) {
+    (void)mode;
+    ports[selectedPort].dir &= ~selectedPins;
+}
+
+void GPIO_setAsPeripheralModuleFunctionOutputPin(uint8_t selectedPort, uint16_t selectedPins, uint8_t mode) {
+    (void)mode;
+    ports[selectedPort].dir |= selectedPins;
+}
+
+void GPIO_setOutputHighOnPin(uint8_t selectedPort, uint16_t selectedPins) {
+    ports[selectedPort].out |= selectedPins;
+    update_cs(selectedPort);
+}
+
+void GPIO_setOutputLowOnPin(uint8_t selectedPort, uint16_t selectedPins) {
+    ports[selectedPort].out &= ~selectedPins;
+    update_cs(selectedPort);
+}
+
+uint8_t GPIO_getInputPinValue(uint8_t selectedPort, uint16_t selectedPins) {
+    const struct port *p = &ports[selectedPort];
+    uint8_t level = (p->dir & p->out) | (~p->dir & p->in);
+    return (level & selectedPins) ? GPIO_INPUT_PIN_HIGH : GPIO_INPUT_PIN_LOW;
+}
+
+void GPIO_selectInterruptEdge(uint8_t selectedPort, uint16_t selectedPins, uint8_t edgeSelect) {
+    if (edgeSelect == GPIO_HIGH_TO_LOW_TRANSITION) {
+        ports[selectedPort].ies |= selectedPins;
+    } else {
+        ports[selectedPort].ies &= ~selectedPins;
+    }
+}
+
+void GPIO_enableInterrupt(uint8_t selectedPort, uint16_t selectedPins) {
+    ports[selectedPort].ie |= selectedPins;
+}
+
+void GPIO_disableInterrupt(uint8_t selectedPort, uint16_t selectedPins) {
+    ports[selectedPort].ie &= ~selectedPins;
+}
+
+void GPIO_clearInterrupt(uint8_t selectedPort, uint16_t selectedPins) {
+    ports[selectedPort].ifg &= ~selectedPins;
+}
+
+uint16_t GPIO_getInterruptStatus(uint8_t selectedPort, uint16_t selectedPins) {
+    return ports[selectedPort].ifg & selectedPins;
+}
+
+/* driverlib: Timer_A */
+
+void Timer_A_initContinuousMode(uint16_t baseAddress, Timer_A_initContinuousModeParam *param) {
+    struct timer *t = find_timer(baseAddress);
+
+    t->source = param->clockSource;
+    t->divider = param->clockSourceDivider;
+    if (param->timerClear == TIMER_A_DO_CLEAR) {
+        t->start_ps = now;
+    }
+    t->running = param->startTimer;
+}
+
+void Timer_A_initCompareMode(uint16_t baseAddress, Timer_A_initCompareModeParam *param) {
+    struct timer *t = find_timer(baseAddress);
+    uint8_t index = param->compareRegister / 2 - 1;
+
+    t->ccr[index] = param->compareValue;
+    if (index == 0) {
+        t->ccie = (param->compareInterruptEnable == TIMER_A_CAPTURECOMPARE_INTERRUPT_ENABLE);
+    }
+}
+
+void Timer_A_setCompareValue(uint16_t baseAddress, uint16_t compareRegister, uint16_t compareValue) {
+    find_timer(baseAddress)->ccr[compareRegister / 2 - 1] = compareValue;
+}
+
+uint16_t Timer_A_getCounterValue(uint16_t baseAddress) {
+    const struct timer *t = find_timer(baseAddress);
+    return t->running ? (uint16_t)timer_ticks(t) : 0;
+}
+
+void Timer_A_enableCaptureCompareInterrupt(uint16_t baseAddress, uint16_t captureCompareRegister) {
+    if (captureCompareRegister == TIMER_A_CAPTURECOMPARE_REGISTER_0) {
+        find_timer(baseAddress)->ccie = 1;
+    }
+}
+
+void Timer_A_disableCaptureCompareInterrupt(uint16_t baseAddress, uint16_t captureCompareRegister) {
+    if (captureCompareRegister == TIMER_A_CAPTURECOMPARE_REGISTER_0) {
+        find_timer(baseAddress)->ccie = 0;
+    }
+}
+
+void Timer_A_clearCaptureCompareInterrupt(uint16_t baseAddress, uint16_t captureCompareRegister) {
+    if (captureCompareRegister == TIMER_A_CAPTURECOMPARE_REGISTER_0) {
+        find_timer(baseAddress)->ccifg = 0;
+    }
+}
+
+void Timer_A_stop(uint16_t baseAddress) {
+    find_timer(baseAddress)->running = 0;
+}
+
+/* driverlib: EUSCI_A_UART */
+
+static struct uart *find_uart(uint16_t base) {
+    return (base == EUSCI_A0_BASE) ? &uarts[0] : &uarts[1];
+}
+
+bool EUSCI_A_UART_init(uint16_t baseAddress, EUSCI_A_UART_initParam *param) {
+    struct uart *u = find_uart(baseAddress);
+    uint32_t clk = (param->selectClockSource == EUSCI_A_UART_CLOCKSOURCE_ACLK) ? clock_hz(0) : clock_hz(2);
+    uint32_t bits = 10 + (param->parity != EUSCI_A_UART_NO_PARITY) + (param->numberofStopBits == EUSCI_A_UART_TWO_STOP_BITS);
+    // Clocks per bit, in eighths: UCBRx (times 16 with oversampling), UCBRFx, and UCBRSx's
+    // one bits as an approximation of its fractional part
+    uint32_t div8 = param->overSampling ?
+        (uint32_t)(16 * param->clockPrescalar + param->firstModReg) * 8 + __builtin_popcount(param->secondModReg) :
+        (uint32_t)param->clockPrescalar * 8 + __builtin_popcount(param->secondModReg);
+
+    u->enabled = 0;
+    u->byte_ps = u->baud ? (uint64_t)bits * HAL_HOST_PS_PER_S / u->baud :
+        (uint64_t)bits * div8 * HAL_HOST_PS_PER_S / 8 / clk;
+    return STATUS_SUCCESS;
+}
+
+void EUSCI_A_UART_enable(uint16_t baseAddress) {
+    struct uart *u = find_uart(baseAddress);
+    u->enabled = 1;
+    u->ifg = IFG_TX;
+}
+
+void EUSCI_A_UART_disable(uint16_t baseAddress) {
+    struct uart *u = find_uart(baseAddress);
+    u->enabled = 0;
+    u->ie = 0;
+    u->ifg = IFG_TX;
+    u->done_ps = HAL_HOST_NEVER;
+}
+
+void EUSCI_A_UART_transmitData(uint16_t baseAddress, uint8_t transmitData) {
+    struct uart *u = find_uart(baseAddress);
+
+    if (!u->enabled) {
+        return;
+    }
+    u->ifg &= ~(IFG_TX | IFG_TXCPT);
+    u->tx_byte = transmitData;
+    u->done_ps = now + u->byte_ps;
+}
+
+uint8_t EUSCI_A_UART_receiveData(uint16_t baseAddress) {
+    struct uart *u = find_uart(baseAddress);
+    u->ifg &= ~IFG_RX;
+    return u->rxbuf;
+}
+
+void EUSCI_A_UART_enableInterrupt(uint16_t baseAddress, uint8_t mask) {
+    find_uart(baseAddress)->ie |= mask;
+}
+
+void EUSCI_A_UART_disableInterrupt(uint16_t baseAddress, uint8_t mask) {
+    find_uart(baseAddress)->ie &= ~mask;
+}
+
+void EUSCI_A_UART_clearInterrupt(uint16_t baseAddress, uint8_t mask) {
+    find_uart(baseAddress)->ifg &= ~mask;
+}
+
+uint8_t EUSCI_A_UART_getInterruptStatus(uint16_t baseAddress, uint8_t mask) {
+    return find_uart(baseAddress)->ifg & mask;
+}
+
+uint32_t EUSCI_A_UART_getTransmitBufferAddress(uint16_t baseAddress) {
+    return baseAddress + OFS_UCAXTXBUF;
+}
+
+/* driverlib: DMA */
+
+static struct dma *find_dma(uint8_t channelSelect) {
+    if ((channelSelect >> 4) >= NUM_DMA) {
+        fatal("no such DMA channel");
+    }
+    return &dmas[channelSelect >> 4];
+}
+
+void DMA_init(DMA_initParam *param) {
+    struct dma *d = find_dma(param->channelSelect);
+
+    if (param->transferModeSelect != DMA_TRANSFER_SINGLE ||
+        param->transferUnitSelect != DMA_SIZE_SRCBYTE_DSTBYTE ||
+        param->triggerTypeSelect != DMA_TRIGGER_RISINGEDGE ||
+        (param->triggerSourceSelect != DMA_TRIGGERSOURCE_15 &&
+         param->triggerSourceSelect != DMA_TRIGGERSOURCE_17)) {
+        fatal("DMA set up for something other than single byte transfers to a UART");
+    }
+    d->trigger = param->triggerSourceSelect;
+    d->size = param->transferSize;
+}
+
+void DMA_setTransferSize(uint8_t channelSelect, uint16_t transferSize) {
+    find_dma(channelSelect)->size = transferSize;
+}
+
+uint16_t DMA_getTransferSize(uint8_t channelSelect) {
+    return find_dma(channelSelect)->size;
+}
+
+void DMA_setSrcAddress(uint8_t channelSelect, uintptr_t srcAddress, uint16_t directionSelect) {
+    struct dma *d = find_dma(channelSelect);
+    d->src = srcAddress;
+    d->src_dir = directionSelect;
+}
+
+void DMA_setDstAddress(uint8_t channelSelect, uintptr_t dstAddress, uint16_t directionSelect) {
+    (void)directionSelect;
+    find_dma(channelSelect)->dst = dstAddress;
+}
+
+void DMA_enableTransfers(uint8_t channelSelect) {
+    find_dma(channelSelect)->enabled = 1;
+}
+
+void DMA_startTransfer(uint8_t channelSelect) {
+    struct dma *d = find_dma(channelSelect);
+
+    if (d->enabled) {
+        dma_move(d);
+    }
+}
+
+void DMA_disableTransfers(uint8_t channelSelect) {
+    find_dma(channelSelect)->enabled = 0;
+}
+
+void DMA_enableInterrupt(uint8_t channelSelect) {
+    find_dma(channelSelect)->ie = 1;
+}
+
+void DMA_disableInterrupt(uint8_t channelSelect) {
+    find_dma(channelSelect)->ie = 0;
+}
+
+uint16_t DMA_getInterruptStatus(uint8_t channelSelect) {
+    return find_dma(channelSelect)->ifg ? DMA_INT_ACTIVE : DMA_INT_INACTIVE;
+}
+
+void DMA_clearInterrupt(uint8_t channelSelect) {
+    find_dma(channelSelect)->ifg = 0;
+}
+
+/* driverlib: AES256 */
+
+uint8_t AES256_setCipherKey(uint16_t baseAddress, const uint8_t *cipherKey, uint16_t keyLength) {
+    (void)baseAddress;
+    if (keyLength != AES256_KEYLENGTH_256BIT) {
+        fatal("AES key other than 256 bits");
+    }
+    if (aes.done_ps != HAL_HOST_NEVER) {
+        fatal("AES key written while the module is busy");
+    }
+    aes_soft_set_key(&aes.key, cipherKey);
+    aes.keyed = 1;
+    return STATUS_SUCCESS;
+}
+
+void AES256_startEncryptData(uint16_t baseAddress, const uint8_t *data) {
+    (void)baseAddress;
+    if (!aes.keyed) {
+        fatal("AES encryption without a key");
+    }
+    if (aes.done_ps != HAL_HOST_NEVER) {
+        fatal("AES data written while the module is busy");
+    }
+    // Worked out now, but not there to read until the module would have finished
+    aes_soft_encrypt(&aes.key, data, aes.out);
+    aes.ifg = 0;
+    aes.done_ps = now + cycles_ps(HAL_HOST_AES_CYCLES);
+}
+
+uint8_t AES256_getDataOut(uint16_t baseAddress, uint8_t *outputData) {
+    (void)baseAddress;
+    if (aes.done_ps != HAL_HOST_NEVER) {
+        return STATUS_FAIL;
+    }
+    memcpy(outputData, aes.out, sizeof(aes.out));
+    aes.ifg = 0;
+    return STATUS_SUCCESS;
+}
+
+void AES256_encryptData(uint16_t baseAddress, const uint8_t *data, uint8_t *encryptedData) {
+    AES256_startEncryptData(baseAddress, data);
+    while (AES256_isBusy(baseAddress) == AES256_BUSY) {
+        advance_active(aes.done_ps);
+    }
+    AES256_getDataOut(baseAddress, encryptedData);
+}
+
+uint16_t AES256_isBusy(uint16_t baseAddress) {
+    (void)baseAddress;
+    return (aes.done_ps != HAL_HOST_NEVER) ? AES256_BUSY : AES256_NOT_BUSY;
+}
+
+void AES256_clearInterrupt(uint16_t baseAddress) {
+    (void)baseAddress;
+    aes.ifg = 0;
+}
+
+uint32_t AES256_getInterruptStatus(uint16_t baseAddress) {
+    (void)baseAddress;
+    return aes.ifg ? AES256_READY_INTERRUPT : 0;
+}
+
+void AES256_enableInterrupt(uint16_t baseAddress) {
+    (void)baseAddress;
+    aes.ie = 1;
+}
+
+void AES256_disableInterrupt(uint16_t baseAddress) {
+    (void)baseAddress;
+    aes.ie = 0;
+}
+
+/* driverlib: MPY32 */
+
+void MPY32_setOperandOne16Bit(uint8_t multiplicationType, uint16_t operand) {
+    mpy.type = multiplicationType;
+    mpy.op1 = operand;
+}
+
+// Writing the second operand does the operation; a 16 x 16 bit one leaves its 32 bit result,
+// or the sum, in RES1:RES0, and the sign of a signed one in RES3:RES2
+void MPY32_setOperandTwo16Bit(uint16_t operand) {
+    uint32_t product, sum;
+
+    if (mpy.type & MPY32_MULTIPLY_SIGNED) {
+        product = (uint32_t)((int32_t)(int16_t)mpy.op1 * (int16_t)operand);
+    } else {
+        product = (uint32_t)mpy.op1 * operand;
+    }
+    sum = (mpy.type & MPY32_MULTIPLYACCUMULATE_UNSIGNED) ? (uint32_t)mpy.res + product : product;
+    if (mpy.type & MPY32_MULTIPLY_SIGNED) {
+        mpy.res = (uint64_t)(int64_t)(int32_t)sum;
+    } else {
+        mpy.res = sum;
+    }
+}
+
+uint64_t MPY32_getResult(void) {
+    return mpy.res;
+}
+
+void MPY32_preloadResult(uint64_t result) {
+    mpy.res = result;
+}
+
+/* driverlib: RTC_C */
+
+// Time since the clock was started; it runs from LFXT, which the emulation takes to be exact
+static uint64_t rtc_elapsed_ps(void) {
+    return rtc.running ? now - rtc.start_ps : 0;
+}
+
+void RTC_C_initCalendar(uint16_t baseAddress, Calendar *CalendarTime, uint16_t formatSelect) {
+    struct tm tm = { 0 };
+
+    (void)baseAddress;
+    if (formatSelect != RTC_C_FORMAT_BINARY) {
+        fatal("RTC calendar in BCD");
+    }
+    if (CalendarTime->Month < 1 || CalendarTime->Month > 12) {
+        fatal("RTC month out of range");
+    }
+    tm.tm_sec = CalendarTime->Seconds;
+    tm.tm_min = CalendarTime->Minutes;
+    tm.tm_hour = CalendarTime->Hours;
+    tm.tm_mday = CalendarTime->DayOfMonth;
+    tm.tm_mon = CalendarTime->Month - 1;
+    tm.tm_year = CalendarTime->Year - 1900;
+    rtc.start_utc = (int64_t)timegm(&tm);
+    rtc.running = 0;
+    rtc.next_ps = HAL_HOST_NEVER;
+}
+
+void RTC_C_startClock(uint16_t baseAddress) {
+    (void)baseAddress;
+    if (clk_source[0] != CS_LFXTCLK_SELECT) {
+        fatal("RTC started without ACLK from LFXT");
+    }
+    rtc.running = 1;
+    rtc.start_ps = now;
+    rtc.next_ps = now + HAL_HOST_PS_PER_S;
+}
+
+void RTC_C_holdClock(uint16_t baseAddress) {
+    (void)baseAddress;
+    rtc.start_utc += (int64_t)(rtc_elapsed_ps() / HAL_HOST_PS_PER_S);
+    rtc.running = 0;
+    rtc.next_ps = HAL_HOST_NEVER;
+}
+
+Calendar RTC_C_getCalendarTime(uint16_t baseAddress) {
+    time_t t = (time_t)(rtc.start_utc + (int64_t)(rtc_elapsed_ps() / HAL_HOST_PS_PER_S));
+    struct tm tm;
+    Calendar cal;
+
+    (void)baseAddress;
+    gmtime_r(&t, &tm);
+    cal.Seconds = tm.tm_sec;
+    cal.Minutes = tm.tm_min;
+    cal.Hours = tm.tm_hour;
+    cal.DayOfWeek = tm.tm_wday;
+    cal.DayOfMonth = tm.tm_mday;
+    cal.Month = tm.tm_mon + 1;
+    cal.Year = tm.tm_year + 1900;
+    return cal;
+}
+
+uint8_t RTC_C_getPrescaleValue(uint16_t baseAddress, uint8_t prescaleSelect) {
+    // RT0PS counts ACLK at 32768 Hz, and RT1PS its overflows, so RT1PS's top bit is the seconds
+    uint64_t ticks = rtc_elapsed_ps() * 32768 / HAL_HOST_PS_PER_S;
+
+    (void)baseAddress;
+    return (prescaleSelect == RTC_C_PRESCALE_0) ? (ticks & 0xff) : ((ticks >> 8) & 0xff);
+}
+
+void RTC_C_enableInterrupt(uint16_t baseAddress, uint8_t interruptMask) {
+    (void)baseAddress;
+    if (interruptMask & ~RTC_C_CLOCK_READ_READY_INTERRUPT) {
+        fatal("RTC interrupt other than read ready");
+    }
+    rtc.ie |= interruptMask;
+}
+
+void RTC_C_disableInterrupt(uint16_t baseAddress, uint8_t interruptMask) {
+    (void)baseAddress;
+    rtc.ie &= ~interruptMask;
+}
+
+uint8_t RTC_C_getInterruptStatus(uint16_t baseAddress, uint8_t interruptFlagMask) {
+    (void)baseAddress;
+    return rtc.ifg & interruptFlagMask;
+}
+
+void RTC_C_clearInterrupt(uint16_t baseAddress, uint8_t interruptFlagMask) {
+    (void)baseAddress;
+    rtc.ifg &= ~interruptFlagMask;
+}
+
+/* driverlib: EUSCI_B_SPI */
+
+void EUSCI_B_SPI_initMaster(uint16_t baseAddress, EUSCI_B_SPI_initMasterParam *param) {
+    uint32_t prescaler = param->clockSourceFrequency / param->desiredSpiClock;
+
+    (void)baseAddress;
+    spi.clk_hz = param->clockSourceFrequency / (prescaler ? prescaler : 1);
+}
+
+void EUSCI_B_SPI_select4PinFunctionality(uint16_t baseAddress, uint8_t select4PinFunctionality) {
+    (void)baseAddress;
+    (void)select4PinFunctionality;
+}
+
+void EUSCI_B_SPI_enable(uint16_t baseAddress) {
+    (void)baseAddress;
+    spi.enabled = 1;
+    spi.ifg = IFG_TX;
+}
+
+void EUSCI_B_SPI_disable(uint16_t baseAddress) {
+    // Software reset clears the enables and flags and aborts any byte in flight
+    (void)baseAddress;
+    spi.enabled = 0;
+    spi.ie = 0;
+    spi.ifg = IFG_TX;
+    spi.done_ps = HAL_HOST_NEVER;
+}
+
+void EUSCI_B_SPI_transmitData(uint16_t baseAddress, uint8_t transmitData) {
+    (void)baseAddress;
+    if (!spi.enabled) {
+        return;
+    }
+    spi.ifg &= ~IFG_TX;
+    spi.rx_next = (spi_selected && spi_dev.transfer) ? spi_dev.transfer(spi_dev.ctx, transmitData) : 0xFF;
+    spi.done_ps = now + 8 * HAL_HOST_PS_PER_S / spi.clk_hz;
+    if (now >= spi_stall_at) {
+        // Only disabling the eUSCI clears it
+        spi.done_ps = HAL_HOST_NEVER;
+        spi_stall_at = HAL_HOST_NEVER;
+        stats.spi_stall_ps = now;
+    }
+    stats.spi_bytes += 1;
+}
+
+uint8_t EUSCI_B_SPI_receiveData(uint16_t baseAddress) {
+    (void)baseAddress;
+    spi.ifg &= ~IFG_RX;
+    return spi.rxbuf;
+}
+
+void EUSCI_B_SPI_enableInterrupt(uint16_t baseAddress, uint8_t mask) {
+    (void)baseAddress;
+    spi.ie |= mask;
+}
+
+void EUSCI_B_SPI_disableInterrupt(uint16_t baseAddress, uint8_t mask) {
+    (void)baseAddress;
+    spi.ie &= ~mask;
+}
+
+void EUSCI_B_SPI_clearInterrupt(uint16_t baseAddress, uint8_t mask) {
+    (void)baseAddress;
+    spi.ifg &= ~mask;
+}
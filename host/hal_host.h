@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+Emulated MSP430FR6989 for running the firmware on Linux.
+
+The emulation is a deterministic event loop on a virtual clock (in picoseconds since reset):
+- time only advances while the firmware is asleep in an LPM or spinning in __delay_cycles, plus
+  a fixed cost per interrupt (HAL_HOST_ISR_CYCLES), so a run is repeatable and goes as fast
+  as the host can manage,
+- eUSCI_B0 (SPI), eUSCI_A0/A1 (UART), TIMER_A0/A1 (continuous mode, CCR0), port 1, the
+  DMA (single byte transfers into a UART's TXBUF, on its TXIFG), the AES256 module
+  (encryption with a 256 bit key, in software: aes_soft.h), the MPY32 (16 x 16 bit multiplies
+  and multiply-accumulates) and the RTC_C (calendar mode from an exact LFXT, with the
+  read-ready interrupt) are emulated well enough for the
+  drivers in this tree; their flags are raised when a byte, compare or block would finish on
+  the real part,
+- interrupts are dispatched by calling the firmware's ISRs by name, in the FR6989's priority
+  order, whenever GIE is set.
+
+Bytes the SPI master shifts out are exchanged with whatever device is attached while its chip
+select is low. hal_host_stall_spi() hangs the eUSCI once, to try out the firmware's deadlines.
+Anything else that needs to do things at a point in time (the simulated sensor
+producing samples, a host decoder reading the UART) hooks into the loop with
+hal_host_add_hook().
+
+The shift register is modelled single-buffered: TXIFG and RXIFG come up together when a byte
+finishes, which is the order the SPI and UART ISRs were written against.
+
+LPMx.5 isn't emulated: with the regulator off, LPM4 behaves like plain LPM4 and RAM survives,
+so the hibernate path resumes in place rather than through a reset.
+*/
+
+// Virtual cycles charged for each interrupt (entry, IV read, the handler, and reti)
+#define HAL_HOST_ISR_CYCLES 40
+
+// MCLK cycles the AES256 module takes over a block with a 256 bit key
+#define HAL_HOST_AES_CYCLES 223
+
+#define HAL_HOST_NEVER UINT64_MAX
+
+#define HAL_HOST_PS_PER_S 1000000000000ULL
+
+// A device on the SPI bus, selected by a GPIO output going low
+struct hal_host_spi_device {
+    void (*select)(void *ctx, uint8_t selected);
+    // Called as each byte starts; returns what the device shifts back
+    uint8_t (*transfer)(void *ctx, uint8_t mosi);
+    void *ctx;
+};
+
+// Something that needs to run at a particular virtual time
+struct hal_host_hook {
+    // When it next wants to run, or HAL_HOST_NEVER
+    uint64_t (*next)(void *ctx);
+    void (*run)(void *ctx, uint64_t now_ps);
+    void *ctx;
+};
+
+// Called with each byte a UART finishes sending
+typedef void (*hal_host_uart_sink)(uint16_t base, uint8_t byte, void *ctx);
+
+struct hal_host_stats {
+    uint64_t now_ps;
+    // Time spent in an LPM
+    uint64_t sleep_ps;
+    uint32_t wakeups;
+    uint32_t isrs;
+    uint32_t spi_bytes;
+    uint32_t uart_bytes;
+    uint32_t dma_transfers;
+    uint32_t aes_blocks;
+    // hal_host_stall_spi()'s stall, if it has hit: when, or HAL_HOST_NEVER
+    uint64_t spi_stall_ps;
+};
+
+void hal_host_reset(void);
+
+uint64_t hal_host_now_ps(void);
+
+void hal_host_attach_spi(uint16_t base, uint8_t cs_port, uint16_t cs_pin, const struct hal_host_spi_device *dev);
+void hal_host_add_hook(const struct hal_host_hook *hook);
+void hal_host_set_uart_sink(hal_host_uart_sink sink, void *ctx);
+
+// Drive an input pin from outside, raising its interrupt flag on the selected edge
+void hal_host_set_input(uint8_t port, uint16_t pins, uint8_t high);
+
+// Run a UART at this baud rate instead of the one the firmware sets up (0 to stop overriding);
+// call before the firmware initialises it
+void hal_host_set_uart_baud(uint16_t base, uint32_t baud);
+
+// Deliver a byte to a UART's receiver, as if it had just finished arriving
+void hal_host_uart_receive(uint16_t base, uint8_t byte);
+
+// Whether the firmware has a UART's receive interrupt enabled, i.e. is listening
+uint8_t hal_host_uart_rx_enabled(uint16_t base);
+
+// Have the first byte the SPI master sends at or after at_ps never finish, as if the eUSCI had
+// hung, until the firmware puts it back into reset
+void hal_host_stall_spi(uint64_t at_ps);
+
+// Run the clock forward to when every UART has finished sending (e.g. after the firmware returns)
+void hal_host_drain(void);
+
+void hal_host_get_stats(struct hal_host_stats *stats);
@@ -0,0 +1,446 @@
+#pragma once
+
+/*
+Host stand-in for the parts of TI's MSP430 driverlib (and the compiler intrinsics) that the
+firmware uses, so main.c, uart.c, bmi270_spi.c and friends build unmodified with a Linux gcc.
+
+Everything here is backed by the emulated peripherals in hal_host.c, which run on a virtual
+clock: time only moves when the firmware sleeps in an LPM or spins in __delay_cycles, and
+interrupts are dispatched the way the real core does it (GIE, LPM bits in SR, and
+__bic_SR_register_on_exit() editing the SR that gets restored on return).
+
+Only what the firmware actually calls is here. Anything new has to be added both here and in
+hal_host.c.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define STATUS_SUCCESS 0x01
+#define STATUS_FAIL 0x00
+
+// The ISRs are ordinary functions on the host; the hal calls them by name
+#define interrupt(vector)
+
+// Status register bits
+#define GIE 0x0008
+#define CPUOFF 0x0010
+#define OSCOFF 0x0020
+#define SCG0 0x0040
+#define SCG1 0x0080
+#define LPM0_bits (CPUOFF)
+#define LPM1_bits (SCG0 + CPUOFF)
+#define LPM2_bits (SCG1 + CPUOFF)
+#define LPM3_bits (SCG1 + SCG0 + CPUOFF)
+#define LPM4_bits (SCG1 + SCG0 + OSCOFF + CPUOFF)
+
+void hal_host_bis_sr(uint16_t bits);
+void hal_host_bic_sr_on_exit(uint16_t bits);
+void hal_host_bic_sr(uint16_t bits);
+void hal_host_delay_cycles(uint32_t cycles);
+uint16_t hal_host_read_iv(uint16_t base);
+uint16_t hal_host_read_dma_iv(void);
+uint16_t hal_host_read_rtc_iv(void);
+uint16_t hal_host_read_rtc_ctl13(void);
+
+#define __bis_SR_register(bits) hal_host_bis_sr(bits)
+#define __bic_SR_register(bits) hal_host_bic_sr(bits)
+#define __bic_SR_register_on_exit(bits) hal_host_bic_sr_on_exit(bits)
+#define __enable_interrupt() hal_host_bis_sr(GIE)
+#define __disable_interrupt() hal_host_bic_sr(GIE)
+#define __delay_cycles(cycles) hal_host_delay_cycles(cycles)
+#define __even_in_range(val, range) (val)
+#define __no_operation() ((void)0)
+
+// Peripheral base addresses, as on the FR6989
+#define WDT_A_BASE 0x015C
+#define TIMER_A0_BASE 0x0340
+#define TIMER_A1_BASE 0x0380
+#define EUSCI_A0_BASE 0x05C0
+#define EUSCI_A1_BASE 0x05E0
+#define EUSCI_B0_BASE 0x0640
+#define AES256_BASE 0x09C0
+#define RTC_C_BASE 0x04A0
+
+#define UCA0IV hal_host_read_iv(EUSCI_A0_BASE)
+#define UCA1IV hal_host_read_iv(EUSCI_A1_BASE)
+#define UCB0IV hal_host_read_iv(EUSCI_B0_BASE)
+#define DMAIV hal_host_read_dma_iv()
+#define RTCIV hal_host_read_rtc_iv()
+// Only RTCHOLD reads back
+#define RTCCTL13 hal_host_read_rtc_ctl13()
+
+// Interrupt vector values
+#define USCI_NONE 0x00
+#define USCI_UART_UCRXIFG 0x02
+#define USCI_UART_UCTXIFG 0x04
+#define USCI_UART_UCSTTIFG 0x06
+#define USCI_UART_UCTXCPTIFG 0x08
+#define USCI_SPI_UCRXIFG 0x02
+#define USCI_SPI_UCTXIFG 0x04
+
+/* WDT_A */
+
+void WDT_A_hold(uint16_t baseAddress);
+
+/* CS */
+
+#define CS_ACLK 0x01
+#define CS_MCLK 0x02
+#define CS_SMCLK 0x04
+
+#define CS_LFXTCLK_SELECT 0x00
+#define CS_VLOCLK_SELECT 0x01
+#define CS_LFMODOSC_SELECT 0x02
+#define CS_DCOCLK_SELECT 0x03
+#define CS_MODOSC_SELECT 0x04
+#define CS_HFXTCLK_SELECT 0x05
+
+// Dividers are their own value on the host
+#define CS_CLOCK_DIVIDER_1 1
+#define CS_CLOCK_DIVIDER_2 2
+#define CS_CLOCK_DIVIDER_4 4
+#define CS_CLOCK_DIVIDER_8 8
+#define CS_CLOCK_DIVIDER_16 16
+#define CS_CLOCK_DIVIDER_32 32
+
+#define CS_DCORSEL_0 0x00
+#define CS_DCORSEL_1 0x01
+#define CS_DCOFSEL_0 0x00
+#define CS_DCOFSEL_1 0x01
+#define CS_DCOFSEL_2 0x02
+#define CS_DCOFSEL_3 0x03
+#define CS_DCOFSEL_4 0x04
+#define CS_DCOFSEL_5 0x05
+#define CS_DCOFSEL_6 0x06
+
+#define CS_LFXT_DRIVE_0 0x00
+#define CS_LFXT_DRIVE_1 0x01
+#define CS_LFXT_DRIVE_2 0x02
+#define CS_LFXT_DRIVE_3 0x03
+
+void CS_setDCOFreq(uint16_t dcorsel, uint16_t dcofsel);
+void CS_initClockSignal(uint8_t selectedClockSignal, uint16_t clockSource, uint16_t clockSourceDivider);
+void CS_setExternalClockSource(uint32_t LFXTCLK_frequency, uint32_t HFXTCLK_frequency);
+void CS_turnOnLFXT(uint16_t lfxtdrive);
+uint32_t CS_getACLK(void);
+uint32_t CS_getMCLK(void);
+uint32_t CS_getSMCLK(void);
+
+/* PMM */
+
+#define PMM_LPM5_INTERRUPT 0x0010
+
+void PMM_unlockLPM5(void);
+void PMM_turnOffRegulator(void);
+void PMM_turnOnRegulator(void);
+uint16_t PMM_getInterruptStatus(uint16_t mask);
+void PMM_clearInterrupt(uint16_t mask);
+
+/* FRAMCtl */
+
+#define FRAMCTL_ACCESS_TIME_CYCLES_0 0x00
+#define FRAMCTL_ACCESS_TIME_CYCLES_1 0x10
+#define FRAMCTL_DELAY_FROM_LPM_ENABLE 0x00
+#define FRAMCTL_DELAY_FROM_LPM_DISABLE 0x02
+
+void FRAMCtl_configureWaitStateControl(uint8_t waitState);
+void FRAMCtl_delayPowerUpFromLPM(uint8_t delayStatus);
+
+/* GPIO */
+
+#define GPIO_PORT_P1 1
+#define GPIO_PORT_P2 2
+#define GPIO_PORT_P3 3
+#define GPIO_PORT_P4 4
+#define GPIO_PORT_P5 5
+#define GPIO_PORT_P6 6
+#define GPIO_PORT_P7 7
+#define GPIO_PORT_P8 8
+#define GPIO_PORT_P9 9
+#define GPIO_PORT_P10 10
+#define GPIO_PORT_PJ 13
+
+#define GPIO_PIN0 0x0001
+#define GPIO_PIN1 0x0002
+#define GPIO_PIN2 0x0004
+#define GPIO_PIN3 0x0008
+#define GPIO_PIN4 0x0010
+#define GPIO_PIN5 0x0020
+#define GPIO_PIN6 0x0040
+#define GPIO_PIN7 0x0080
+
+#define GPIO_PRIMARY_MODULE_FUNCTION 0x01
+#define GPIO_SECONDARY_MODULE_FUNCTION 0x02
+#define GPIO_TERNARY_MODULE_FUNCTION 0x03
+
+#define GPIO_INPUT_PIN_HIGH 0x01
+#define GPIO_INPUT_PIN_LOW 0x00
+
+#define GPIO_LOW_TO_HIGH_TRANSITION 0x00
+#define GPIO_HIGH_TO_LOW_TRANSITION 0x01
+
+void GPIO_setAsOutputPin(uint8_t selectedPort, uint16_t selectedPins);
+void GPIO_setAsInputPin(uint8_t selectedPort, uint16_t selectedPins);
+void GPIO_setAsInputPinWithPullDownResistor(uint8_t selectedPort, uint16_t selectedPins);
+void GPIO_setAsInputPinWithPullUpResistor(uint8_t selectedPort, uint16_t selectedPins);
+void GPIO_setAsPeripheralModuleFunctionInputPin(uint8_t selectedPort, uint16_t selectedPins, uint8_t mode);
+void GPIO_setAsPeripheralModuleFunctionOutputPin(uint8_t selectedPort, uint16_t selectedPins, uint8_t mode);
+void GPIO_setOutputHighOnPin(uint8_t selectedPort, uint16_t selectedPins);
+void GPIO_setOutputLowOnPin(uint8_t selectedPort, uint16_t selectedPins);
+uint8_t GPIO_getInputPinValue(uint8_t selectedPort, uint16_t selectedPins);
+void GPIO_selectInterruptEdge(uint8_t selectedPort, uint16_t selectedPins, uint8_t edgeSelect);
+void GPIO_enableInterrupt(uint8_t selectedPort, uint16_t selectedPins);
+void GPIO_disableInterrupt(uint8_t selectedPort, uint16_t selectedPins);
+void GPIO_clearInterrupt(uint8_t selectedPort, uint16_t selectedPins);
+uint16_t GPIO_getInterruptStatus(uint8_t selectedPort, uint16_t selectedPins);
+
+/* Timer_A */
+
+#define TIMER_A_CLOCKSOURCE_EXTERNAL_TXCLK 0x0000
+#define TIMER_A_CLOCKSOURCE_ACLK 0x0100
+#define TIMER_A_CLOCKSOURCE_SMCLK 0x0200
+
+// Dividers are their own value on the host
+#define TIMER_A_CLOCKSOURCE_DIVIDER_1 1
+#define TIMER_A_CLOCKSOURCE_DIVIDER_2 2
+#define TIMER_A_CLOCKSOURCE_DIVIDER_4 4
+#define TIMER_A_CLOCKSOURCE_DIVIDER_8 8
+#define TIMER_A_CLOCKSOURCE_DIVIDER_16 16
+#define TIMER_A_CLOCKSOURCE_DIVIDER_32 32
+#define TIMER_A_CLOCKSOURCE_DIVIDER_64 64
+
+#define TIMER_A_TAIE_INTERRUPT_ENABLE 0x0002
+#define TIMER_A_TAIE_INTERRUPT_DISABLE 0x0000
+#define TIMER_A_DO_CLEAR 0x0004
+#define TIMER_A_SKIP_CLEAR 0x0000
+
+#define TIMER_A_CAPTURECOMPARE_REGISTER_0 0x02
+#define TIMER_A_CAPTURECOMPARE_REGISTER_1 0x04
+#define TIMER_A_CAPTURECOMPARE_REGISTER_2 0x06
+
+#define TIMER_A_CAPTURECOMPARE_INTERRUPT_ENABLE 0x0010
+#define TIMER_A_CAPTURECOMPARE_INTERRUPT_DISABLE 0x0000
+#define TIMER_A_OUTPUTMODE_OUTBITVALUE 0x0000
+
+typedef struct Timer_A_initContinuousModeParam {
+    uint16_t clockSource;
+    uint16_t clockSourceDivider;
+    uint16_t timerInterruptEnable_TAIE;
+    uint16_t timerClear;
+    bool startTimer;
+} Timer_A_initContinuousModeParam;
+
+typedef struct Timer_A_initCompareModeParam {
+    uint16_t compareRegister;
+    uint16_t compareInterruptEnable;
+    uint16_t compareOutputMode;
+    uint16_t compareValue;
+} Timer_A_initCompareModeParam;
+
+void Timer_A_initContinuousMode(uint16_t baseAddress, Timer_A_initContinuousModeParam *param);
+void Timer_A_initCompareMode(uint16_t baseAddress, Timer_A_initCompareModeParam *param);
+void Timer_A_setCompareValue(uint16_t baseAddress, uint16_t compareRegister, uint16_t compareValue);
+uint16_t Timer_A_getCounterValue(uint16_t baseAddress);
+void Timer_A_enableCaptureCompareInterrupt(uint16_t baseAddress, uint16_t captureCompareRegister);
+void Timer_A_disableCaptureCompareInterrupt(uint16_t baseAddress, uint16_t captureCompareRegister);
+void Timer_A_clearCaptureCompareInterrupt(uint16_t baseAddress, uint16_t captureCompareRegister);
+void Timer_A_stop(uint16_t baseAddress);
+
+/* EUSCI_A_UART */
+
+#define EUSCI_A_UART_CLOCKSOURCE_SMCLK 0x80
+#define EUSCI_A_UART_CLOCKSOURCE_ACLK 0x40
+#define EUSCI_A_UART_NO_PARITY 0x00
+#define EUSCI_A_UART_ODD_PARITY 0x01
+#define EUSCI_A_UART_EVEN_PARITY 0x02
+#define EUSCI_A_UART_LSB_FIRST 0x00
+#define EUSCI_A_UART_MSB_FIRST 0x01
+#define EUSCI_A_UART_ONE_STOP_BIT 0x00
+#define EUSCI_A_UART_TWO_STOP_BITS 0x01
+#define EUSCI_A_UART_MODE 0x00
+#define EUSCI_A_UART_OVERSAMPLING_BAUDRATE_GENERATION 0x01
+#define EUSCI_A_UART_LOW_FREQUENCY_BAUDRATE_GENERATION 0x00
+
+#define EUSCI_A_UART_RECEIVE_INTERRUPT 0x0001
+#define EUSCI_A_UART_TRANSMIT_INTERRUPT 0x0002
+#define EUSCI_A_UART_TRANSMIT_COMPLETE_INTERRUPT 0x0008
+#define EUSCI_A_UART_RECEIVE_INTERRUPT_FLAG 0x0001
+#define EUSCI_A_UART_TRANSMIT_INTERRUPT_FLAG 0x0002
+
+typedef struct EUSCI_A_UART_initParam {
+    uint8_t selectClockSource;
+    uint16_t clockPrescalar;
+    uint8_t firstModReg;
+    uint8_t secondModReg;
+    uint8_t parity;
+    uint16_t msborLsbFirst;
+    uint16_t numberofStopBits;
+    uint16_t uartMode;
+    uint8_t overSampling;
+} EUSCI_A_UART_initParam;
+
+bool EUSCI_A_UART_init(uint16_t baseAddress, EUSCI_A_UART_initParam *param);
+void EUSCI_A_UART_enable(uint16_t baseAddress);
+void EUSCI_A_UART_disable(uint16_t baseAddress);
+void EUSCI_A_UART_transmitData(uint16_t baseAddress, uint8_t transmitData);
+uint8_t EUSCI_A_UART_receiveData(uint16_t baseAddress);
+void EUSCI_A_UART_enableInterrupt(uint16_t baseAddress, uint8_t mask);
+void EUSCI_A_UART_disableInterrupt(uint16_t baseAddress, uint8_t mask);
+void EUSCI_A_UART_clearInterrupt(uint16_t baseAddress, uint8_t mask);
+uint8_t EUSCI_A_UART_getInterruptStatus(uint16_t baseAddress, uint8_t mask);
+uint32_t EUSCI_A_UART_getTransmitBufferAddress(uint16_t baseAddress);
+
+/* DMA */
+
+// Only the UART transmit triggers are emulated, moving bytes into that UART's TXBUF
+#define DMA_CHANNEL_0 0x00
+#define DMA_CHANNEL_1 0x10
+#define DMA_CHANNEL_2 0x20
+#define DMA_TRIGGERSOURCE_15 0x0F
+#define DMA_TRIGGERSOURCE_17 0x11
+#define DMA_TRANSFER_SINGLE 0x0000
+#define DMA_TRIGGER_RISINGEDGE 0x00
+#define DMA_SIZE_SRCBYTE_DSTBYTE 0xC0
+#define DMA_DIRECTION_UNCHANGED 0x0000
+#define DMA_DIRECTION_INCREMENT 0x0300
+#define DMA_INT_INACTIVE 0x0
+#define DMA_INT_ACTIVE 0x0008
+
+#define DMAIV_NONE 0x00
+#define DMAIV_DMA0IFG 0x02
+#define DMAIV_DMA1IFG 0x04
+#define DMAIV_DMA2IFG 0x06
+
+typedef struct DMA_initParam {
+    uint8_t channelSelect;
+    uint16_t transferModeSelect;
+    uint16_t transferSize;
+    uint8_t triggerSourceSelect;
+    uint8_t transferUnitSelect;
+    uint8_t triggerTypeSelect;
+} DMA_initParam;
+
+void DMA_init(DMA_initParam *param);
+void DMA_setTransferSize(uint8_t channelSelect, uint16_t transferSize);
+uint16_t DMA_getTransferSize(uint8_t channelSelect);
+// Addresses are host pointers here, hence uintptr_t (uint32_t in driverlib)
+void DMA_setSrcAddress(uint8_t channelSelect, uintptr_t srcAddress, uint16_t directionSelect);
+void DMA_setDstAddress(uint8_t channelSelect, uintptr_t dstAddress, uint16_t directionSelect);
+void DMA_enableTransfers(uint8_t channelSelect);
+void DMA_startTransfer(uint8_t channelSelect);
+void DMA_disableTransfers(uint8_t channelSelect);
+void DMA_enableInterrupt(uint8_t channelSelect);
+void DMA_disableInterrupt(uint8_t channelSelect);
+uint16_t DMA_getInterruptStatus(uint8_t channelSelect);
+void DMA_clearInterrupt(uint8_t channelSelect);
+
+/* AES256 */
+
+// Encryption only
+#define AES256_KEYLENGTH_256BIT 256
+#define AES256_BUSY 0x0001
+#define AES256_NOT_BUSY 0x00
+#define AES256_READY_INTERRUPT 0x0001
+
+uint8_t AES256_setCipherKey(uint16_t baseAddress, const uint8_t *cipherKey, uint16_t keyLength);
+void AES256_encryptData(uint16_t baseAddress, const uint8_t *data, uint8_t *encryptedData);
+void AES256_startEncryptData(uint16_t baseAddress, const uint8_t *data);
+uint8_t AES256_getDataOut(uint16_t baseAddress, uint8_t *outputData);
+uint16_t AES256_isBusy(uint16_t baseAddress);
+void AES256_clearInterrupt(uint16_t baseAddress);
+uint32_t AES256_getInterruptStatus(uint16_t baseAddress);
+void AES256_enableInterrupt(uint16_t baseAddress);
+void AES256_disableInterrupt(uint16_t baseAddress);
+
+/* MPY32 */
+
+// 16 x 16 bit operands only
+#define MPY32_MULTIPLY_UNSIGNED 0x00
+#define MPY32_MULTIPLY_SIGNED 0x02
+#define MPY32_MULTIPLYACCUMULATE_UNSIGNED 0x04
+#define MPY32_MULTIPLYACCUMULATE_SIGNED 0x06
+
+void MPY32_setOperandOne16Bit(uint8_t multiplicationType, uint16_t operand);
+void MPY32_setOperandTwo16Bit(uint16_t operand);
+uint64_t MPY32_getResult(void);
+void MPY32_preloadResult(uint64_t result);
+
+/* RTC_C */
+
+// Calendar mode, from LFXT, in binary
+typedef struct Calendar {
+    uint8_t Seconds;
+    uint8_t Minutes;
+    uint8_t Hours;
+    uint8_t DayOfWeek;
+    uint8_t DayOfMonth;
+    // 1-12, as the module counts them
+    uint8_t Month;
+    uint16_t Year;
+} Calendar;
+
+#define RTC_C_FORMAT_BINARY 0x00
+#define RTC_C_FORMAT_BCD 0x80
+#define RTC_C_PRESCALE_0 0x0
+#define RTC_C_PRESCALE_1 0x2
+#define RTC_C_CLOCK_READ_READY_INTERRUPT 0x10
+
+#define RTCHOLD 0x0040
+#define RTCIV__NONE 0x00
+#define RTCIV__RTCOFIFG 0x02
+#define RTCIV__RTCRDYIFG 0x04
+#define RTCIV__RTCTEVIFG 0x06
+#define RTCIV__RTCAIFG 0x08
+#define RTCIV__RT0PSIFG 0x0A
+#define RTCIV__RT1PSIFG 0x0C
+
+void RTC_C_initCalendar(uint16_t baseAddress, Calendar *CalendarTime, uint16_t formatSelect);
+void RTC_C_startClock(uint16_t baseAddress);
+void RTC_C_holdClock(uint16_t baseAddress);
+Calendar RTC_C_getCalendarTime(uint16_t baseAddress);
+uint8_t RTC_C_getPrescaleValue(uint16_t baseAddress, uint8_t prescaleSelect);
+void RTC_C_enableInterrupt(uint16_t baseAddress, uint8_t interruptMask);
+void RTC_C_disableInterrupt(uint16_t baseAddress, uint8_t interruptMask);
+uint8_t RTC_C_getInterruptStatus(uint16_t baseAddress, uint8_t interruptFlagMask);
+void RTC_C_clearInterrupt(uint16_t baseAddress, uint8_t interruptFlagMask);
+
+/* EUSCI_B_SPI */
+
+#define EUSCI_B_SPI_CLOCKSOURCE_ACLK 0x40
+#define EUSCI_B_SPI_CLOCKSOURCE_SMCLK 0x80
+#define EUSCI_B_SPI_MSB_FIRST 0x2000
+#define EUSCI_B_SPI_LSB_FIRST 0x0000
+#define EUSCI_B_SPI_PHASE_DATA_CHANGED_ONFIRST_CAPTURED_ON_NEXT 0x0000
+#define EUSCI_B_SPI_PHASE_DATA_CAPTURED_ONFIRST_CHANGED_ON_NEXT 0x8000
+#define EUSCI_B_SPI_CLOCKPOLARITY_INACTIVITY_HIGH 0x4000
+#define EUSCI_B_SPI_CLOCKPOLARITY_INACTIVITY_LOW 0x0000
+#define EUSCI_B_SPI_3PIN 0x0000
+#define EUSCI_B_SPI_4PIN_UCxSTE_ACTIVE_HIGH 0x0200
+#define EUSCI_B_SPI_4PIN_UCxSTE_ACTIVE_LOW 0x0400
+#define EUSCI_B_SPI_PREVENT_CONFLICTS_WITH_OTHER_MASTERS 0x0000
+#define EUSCI_B_SPI_ENABLE_SIGNAL_FOR_4WIRE_SLAVE 0x0002
+
+#define EUSCI_B_SPI_RECEIVE_INTERRUPT 0x0001
+#define EUSCI_B_SPI_TRANSMIT_INTERRUPT 0x0002
+
+typedef struct EUSCI_B_SPI_initMasterParam {
+    uint8_t selectClockSource;
+    uint32_t clockSourceFrequency;
+    uint32_t desiredSpiClock;
+    uint16_t msbFirst;
+    uint16_t clockPhase;
+    uint16_t clockPolarity;
+    uint16_t spiMode;
+} EUSCI_B_SPI_initMasterParam;
+
+void EUSCI_B_SPI_initMaster(uint16_t baseAddress, EUSCI_B_SPI_initMasterParam *param);
+void EUSCI_B_SPI_select4PinFunctionality(uint16_t baseAddress, uint8_t select4PinFunctionality);
+void EUSCI_B_SPI_enable(uint16_t baseAddress);
+void EUSCI_B_SPI_disable(uint16_t baseAddress);
+void EUSCI_B_SPI_transmitData(uint16_t baseAddress, uint8_t transmitData);
+uint8_t EUSCI_B_SPI_receiveData(uint16_t baseAddress);
+void EUSCI_B_SPI_enableInterrupt(uint16_t baseAddress, uint8_t mask);
+void EUSCI_B_SPI_disableInterrupt(uint16_t baseAddress, uint8_t mask);
+void EUSCI_B_SPI_clearInterrupt(uint16_t baseAddress, uint8_t mask);
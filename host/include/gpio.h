@@ -0,0 +1,4 @@
+#pragma once
+
+// The firmware includes driverlib headers piecemeal; on the host they all live in driverlib.h
+#include "driverlib.h"
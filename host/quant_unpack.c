@@ -0,0 +1,160 @@
+#include <string.h>
+#include "quant_unpack.h"
+#include "../quant.h"
+#include "../rtc_anchor.h"
+#include "../autorange.h"
+#include "../shock.h"
+#include "../health.h"
+
+static void discard(struct quant_unpack *q, size_t n) {
+    q->len -= n;
+    memmove(q->buf, &q->buf[n], q->len);
+}
+
+static void resync(struct quant_unpack *q, size_t n) {
+    q->stats.resync_bytes += n;
+    discard(q, n);
+}
+
+static uint8_t width(const uint8_t *header, uint8_t axis) {
+    return (axis < 3) ? header[5] >> 4 : header[5] & 0x0f;
+}
+
+static uint8_t exponent(const uint8_t *header, uint8_t axis) {
+    uint8_t b = header[6 + axis / 2];
+
+    return (axis % 2) ? b & 0x0f : b >> 4;
+}
+
+static size_t sample_len(const uint8_t *header) {
+    return 2 + (3 * width(header, 0) + 3 * width(header, 3) + 7) / 8;
+}
+
+// Length of the block a header starts, or 0 if it can't be one
+static size_t block_len(const uint8_t *header) {
+    uint8_t i;
+
+    if (header[4] == 0) {
+        return 0;
+    }
+    for (i = 0; i < QUANT_AXES; i++) {
+        if (width(header, i) < 8 || exponent(header, i) > 16 - width(header, i)) {
+            return 0;
+        }
+    }
+    return QUANT_HEADER + header[4] * sample_len(header) + 1;
+}
+
+static void put_le16(uint8_t *dst, int32_t v) {
+    dst[0] = (uint32_t)v & 0xff;
+    dst[1] = ((uint32_t)v >> 8) & 0xff;
+}
+
+static void unpack(struct quant_unpack *q, const uint8_t *block) {
+    const uint8_t *src = &block[QUANT_HEADER];
+    uint16_t index = block[2] | (block[3] << 8);
+    uint8_t record[16];
+    uint32_t bits, field;
+    uint8_t k, i, w, have, used;
+    int32_t v;
+
+    for (k = 0; k < block[4]; k++, src += sample_len(block)) {
+        put_le16(&record[0], index + k);
+        record[2] = src[0];
+        record[3] = src[1];
+        bits = 0;
+        have = 0;
+        used = 2;
+        for (i = 0; i < QUANT_AXES; i++) {
+            w = width(block, i);
+            while (have < w) {
+                bits |= (uint32_t)src[used++] << have;
+                have += 8;
+            }
+            field = bits & ((1UL << w) - 1);
+            bits >>= w;
+            have -= w;
+            // Sign extend, then scale back up
+            v = (field & (1UL << (w - 1))) ? (int32_t)field - (1L << w) : (int32_t)field;
+            put_le16(&record[4 + 2 * i], v * (1L << exponent(block, i)));
+        }
+        q->stats.samples += 1;
+        q->callback(record, sizeof(record), q->ctx);
+    }
+}
+
+static uint8_t sum(const uint8_t *buf, size_t len) {
+    uint8_t s = 0;
+
+    while (len--) {
+        s += *buf++;
+    }
+    return s;
+}
+
+// Take whole blocks, and the records handed on, off the front of the bytes
+static void parse(struct quant_unpack *q) {
+    size_t n;
+    uint8_t block;
+
+    while (q->len >= 2) {
+        block = q->buf[0] == QUANT_SYNC0 && q->buf[1] == QUANT_SYNC1;
+        if (block) {
+            n = (q->len < QUANT_HEADER) ? QUANT_HEADER : block_len(q->buf);
+        } else if (q->buf[0] == RTC_ANCHOR_SYNC0 && q->buf[1] == RTC_ANCHOR_SYNC1) {
+            n = RTC_ANCHOR_LEN;
+        } else if (q->buf[0] == AUTORANGE_SYNC0 && q->buf[1] == AUTORANGE_SYNC1) {
+            n = AUTORANGE_LEN;
+        } else if (q->buf[0] == SHOCK_SYNC0 && q->buf[1] == SHOCK_SYNC1) {
+            n = SHOCK_LEN;
+        } else if (q->buf[0] == HEALTH_SYNC0 && q->buf[1] == HEALTH_SYNC1) {
+            n = HEALTH_LEN;
+        } else {
+            n = 0;
+        }
+        if (n == 0) {
+            resync(q, 1);
+            continue;
+        }
+        if (q->len < n) {
+            if (q->ended) {
+                resync(q, 1);
+                continue;
+            }
+            return;
+        }
+        if (sum(q->buf, n) != 0xff) {
+            resync(q, 1);
+            continue;
+        }
+
+        if (block) {
+            q->stats.blocks += 1;
+            unpack(q, q->buf);
+        } else {
+            q->stats.passed += 1;
+            q->callback(q->buf, n, q->ctx);
+        }
+        discard(q, n);
+    }
+    if (q->ended && q->len) {
+        resync(q, q->len);
+    }
+}
+
+void quant_unpack_init(struct quant_unpack *q, quant_unpack_callback callback, void *ctx) {
+    memset(q, 0, sizeof(*q));
+    q->callback = callback;
+    q->ctx = ctx;
+}
+
+void quant_unpack_put(struct quant_unpack *q, uint8_t byte) {
+    q->buf[q->len] = byte;
+    q->len += 1;
+    parse(q);
+}
+
+void quant_unpack_end(struct quant_unpack *q) {
+    q->ended = 1;
+    parse(q);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+Unpacks a DUMP_QUANT build's blocks (../quant.h) back into the 16 byte binary records of
+DUMP_BINARY, each axis as its field times 2^e, so uart_decode and the rest take them as they
+are. The RTC anchors of an RTC_ANCHOR build (../rtc_anchor.h), the range changes of an
+AUTORANGE one (../autorange.h), and the shock and health events of SHOCK and HEALTH ones
+(../shock.h, ../health.h) are handed on as they came.
+
+A block is taken once its check byte agrees; anything else (a block cut short or corrupted, or
+plain text sent after the samples) is skipped a byte at a time and counted, and all of a block
+with a bad byte in it is lost.
+*/
+
+// The longest block: the header, 255 samples of 2 + 6 * 15 bits, and the check byte
+#define QUANT_UNPACK_BLOCK (9 + 255 * 14 + 1)
+
+typedef void (*quant_unpack_callback)(const uint8_t *record, size_t len, void *ctx);
+
+struct quant_unpack_stats {
+    uint32_t blocks;
+    uint32_t samples;
+    // Anchors, range changes, shock and health events handed on
+    uint32_t passed;
+    // Bytes thrown away while finding the blocks again
+    uint32_t resync_bytes;
+};
+
+struct quant_unpack {
+    quant_unpack_callback callback;
+    void *ctx;
+    uint8_t buf[QUANT_UNPACK_BLOCK];
+    size_t len;
+    uint8_t ended;
+    struct quant_unpack_stats stats;
+};
+
+void quant_unpack_init(struct quant_unpack *q, quant_unpack_callback callback, void *ctx);
+
+void quant_unpack_put(struct quant_unpack *q, uint8_t byte);
+
+// End of the stream
+void quant_unpack_end(struct quant_unpack *q);
@@ -0,0 +1,191 @@
+/*
+Unpacks a DUMP_QUANT build's UART output (../quant.h) from a serial port, pty or file, and
+writes it to stdout as DUMP_BINARY records, for uart_decode. A tty is put in raw mode first.
+
+With -r, compares the samples with a DUMP_BINARY capture of the same samples instead, and
+reports the bytes each took and the error the packing made.
+
+usage: quant_unpack [-r reference] [path]
+  -r    the DUMP_BINARY output to compare with
+  path  where to read from (default stdin)
+  e.g. quant_unpack build/uart.bin | build/uart_decode -f bin
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include "quant_unpack.h"
+#include "uart_decode.h"
+
+// Samples of a capture by index, from a uart_decoder
+struct capture {
+    struct uart_decode_record *records;
+    uint8_t *have;
+    size_t max;
+    size_t bytes;
+};
+
+static void add_record(const struct uart_decode_record *rec, void *ctx) {
+    struct capture *c = ctx;
+    size_t max = c->max;
+
+    while (rec->index >= max) {
+        max = max ? 2 * max : 1024;
+    }
+    if (max != c->max) {
+        c->records = realloc(c->records, max * sizeof(*c->records));
+        c->have = realloc(c->have, max);
+        if (!c->records || !c->have) {
+            perror("quant_unpack");
+            exit(1);
+        }
+        memset(&c->have[c->max], 0, max - c->max);
+        c->max = max;
+    }
+    c->records[rec->index] = *rec;
+    c->have[rec->index] = 1;
+}
+
+static void write_record(const uint8_t *record, size_t len, void *ctx) {
+    (void)ctx;
+    fwrite(record, 1, len, stdout);
+}
+
+static void decode_record(const uint8_t *record, size_t len, void *ctx) {
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        uart_decoder_put(ctx, record[i], 0);
+    }
+}
+
+static int read_reference(const char *path, struct capture *c) {
+    struct uart_decoder dec;
+    uint8_t buf[256];
+    size_t got, i;
+    FILE *f = fopen(path, "rb");
+
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    uart_decoder_init(&dec, UART_DECODE_BINARY, add_record, c);
+    while ((got = fread(buf, 1, sizeof(buf), f)) > 0) {
+        c->bytes += got;
+        for (i = 0; i < got; i++) {
+            uart_decoder_put(&dec, buf[i], 0);
+        }
+    }
+    uart_decoder_finish(&dec);
+    fclose(f);
+    return 0;
+}
+
+static void report(const struct capture *ref, const struct capture *got, size_t bytes) {
+    double sq[2] = { 0, 0 };
+    int max[2] = { 0, 0 };
+    int16_t a, b;
+    int err;
+    size_t i, n = 0, ref_n = 0;
+    uint8_t g, axis;
+
+    for (i = 0; i < ref->max; i++) {
+        ref_n += ref->have[i];
+        if (i >= got->max || !ref->have[i] || !got->have[i]) {
+            continue;
+        }
+        n += 1;
+        // Accel, then gyro
+        for (g = 0; g < 2; g++) {
+            for (axis = 0; axis < 3; axis++) {
+                a = g ? ref->records[i].gyr[axis] : ref->records[i].acc[axis];
+                b = g ? got->records[i].gyr[axis] : got->records[i].acc[axis];
+                err = abs(a - b);
+                sq[g] += (double)err * err;
+                if (err > max[g]) {
+                    max[g] = err;
+                }
+            }
+        }
+    }
+    if (n == 0 || ref_n == 0) {
+        fprintf(stderr, "quant_unpack: no samples in common with the reference\n");
+        return;
+    }
+    printf("%6.2f bytes/sample (%5.1f%% of binary, %.2fx the samples/s)  "
+           "accel error rms %6.2f max %4d LSB  gyro error rms %6.2f max %4d LSB\n",
+        (double)bytes / n, 100.0 * bytes / n / ((double)ref->bytes / ref_n),
+        ((double)ref->bytes / ref_n) / ((double)bytes / n),
+        sqrt(sq[0] / (3 * n)), max[0], sqrt(sq[1] / (3 * n)), max[1]);
+}
+
+int main(int argc, char **argv) {
+    struct quant_unpack q;
+    struct uart_decoder dec;
+    struct capture ref = { 0 }, got = { 0 };
+    struct termios tio;
+    const char *reference = NULL;
+    uint8_t buf[256];
+    ssize_t n, i;
+    size_t bytes = 0;
+    int fd = STDIN_FILENO;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:")) != -1) {
+        if (opt != 'r') {
+            fprintf(stderr, "usage: %s [-r reference] [path]\n", argv[0]);
+            return 1;
+        }
+        reference = optarg;
+    }
+    if (reference && read_reference(reference, &ref) != 0) {
+        return 1;
+    }
+    if (optind < argc) {
+        fd = open(argv[optind], O_RDONLY | O_NOCTTY);
+        if (fd < 0) {
+            perror(argv[optind]);
+            return 1;
+        }
+    }
+    if (isatty(fd) && tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+
+    uart_decoder_init(&dec, UART_DECODE_BINARY, add_record, &got);
+    quant_unpack_init(&q, reference ? decode_record : write_record, reference ? (void *)&dec : NULL);
+    for (;;) {
+        n = read(fd, buf, sizeof(buf));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        // A pty whose other end has gone away reads as EIO
+        if (n <= 0) {
+            break;
+        }
+        bytes += n;
+        for (i = 0; i < n; i++) {
+            quant_unpack_put(&q, buf[i]);
+        }
+    }
+    quant_unpack_end(&q);
+    fflush(stdout);
+
+    fprintf(stderr, "quant_unpack: %u blocks, %u samples, %u other records, %u bytes resynced\n",
+        q.stats.blocks, q.stats.samples, q.stats.passed, q.stats.resync_bytes);
+    if (reference) {
+        uart_decoder_finish(&dec);
+        report(&ref, &got, bytes);
+    }
+    free(ref.records);
+    free(ref.have);
+    free(got.records);
+    free(got.have);
+    return 0;
+}
@@ -0,0 +1,141 @@
+/*
+Runs the firmware on the emulated MCU against a recorded SPI trace instead of the simulated
+sensor (see spi_replay.h), and reports how far it got and how fast.
+
+usage: bmi270_replay [-T] [-o uart.bin] [-f bin|csv] trace
+  -T     keep the trace's original timing, in wall-clock time
+  -o     write everything the firmware sends on the UART to this file
+  -f     format dump_samples() was built with, for counting the samples it sends (default bin)
+  trace  a file with the trace in it anywhere, such as a capture of the board's UART
+
+The trace has to come from a firmware with the same ACQ_MODE and ODR_HZ as this build, or the
+replay diverges within a few transactions.
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <driverlib.h>
+#include "hal_host.h"
+#include "spi_replay.h"
+#include "spi_trace_file.h"
+#include "uart_decode.h"
+#include "../spi_trace.h"
+
+// main() in main.c, renamed by the Makefile
+int firmware_main(void);
+
+struct output {
+    FILE *file;
+    struct uart_decoder decoder;
+};
+
+static struct output out;
+static double wall;
+
+static void count_record(const struct uart_decode_record *rec, void *ctx) {
+    (void)rec;
+    (void)ctx;
+}
+
+static void uart_out(uint16_t base, uint8_t byte, void *ctx) {
+    struct output *out = ctx;
+
+    (void)base;
+    if (out->file) {
+        fputc(byte, out->file);
+    }
+    uart_decoder_put(&out->decoder, byte, 0);
+}
+
+static double wall_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void report(void) {
+    struct spi_replay_stats stats;
+    uint32_t remaining;
+
+    uart_decoder_finish(&out.decoder);
+    if (out.file) {
+        fclose(out.file);
+    }
+
+    spi_replay_get_stats(&stats);
+    remaining = spi_replay_remaining();
+    if (wall <= 0) {
+        wall = 1e-9;
+    }
+    fprintf(stderr, "replayed      %u records, %llu bytes, %u not reached, %u write mismatches, %u timeouts\n",
+        stats.records, (unsigned long long)stats.bytes, remaining, stats.write_mismatches, stats.failed);
+    fprintf(stderr, "throughput    %.3f s wall, %.0f transactions/s, %.2f MB/s, %.0f samples/s (%u samples)\n",
+        wall, stats.records / wall, stats.bytes / wall / 1e6, out.decoder.stats.records / wall,
+        out.decoder.stats.records);
+}
+
+// The firmware still wants the bus, but the trace was cut short: report up to here
+static void trace_ended(void) {
+    wall = wall_seconds() - wall;
+    fprintf(stderr, "replay: end of the trace, with the firmware still running\n");
+    report();
+    exit(0);
+}
+
+int main(int argc, char **argv) {
+    struct spi_trace trace;
+    struct spi_replay_config replay = { .trace = &trace, .original_timing = 0, .ended = trace_ended };
+    enum uart_decode_format format = UART_DECODE_BINARY;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "To:f:")) != -1) {
+        switch (opt) {
+            case 'T':
+                replay.original_timing = 1;
+                break;
+            case 'o':
+                out.file = fopen(optarg, "wb");
+                if (!out.file) {
+                    perror(optarg);
+                    return 1;
+                }
+                break;
+            case 'f':
+                if (strcmp(optarg, "bin") == 0 || strcmp(optarg, "csv") == 0) {
+                    format = (optarg[0] == 'b') ? UART_DECODE_BINARY : UART_DECODE_CSV;
+                    break;
+                }
+                // fall through
+            default:
+                fprintf(stderr, "usage: %s [-T] [-o uart.bin] [-f bin|csv] trace\n", argv[0]);
+                return 1;
+        }
+    }
+    if (optind + 1 != argc) {
+        fprintf(stderr, "usage: %s [-T] [-o uart.bin] [-f bin|csv] trace\n", argv[0]);
+        return 1;
+    }
+    if (spi_trace_load(argv[optind], &trace)) {
+        return 1;
+    }
+    fprintf(stderr, "trace         %u records, %zu bytes%s\n", trace.count, trace.records_len,
+        (trace.flags & SPI_TRACE_OVERFLOWED) ? ", cut short when the buffer filled" : "");
+
+    hal_host_reset();
+    uart_decoder_init(&out.decoder, format, count_record, NULL);
+    hal_host_set_uart_sink(uart_out, &out);
+    spi_replay_start(&replay);
+
+    wall = wall_seconds();
+    firmware_main();
+    wall = wall_seconds() - wall;
+    hal_host_drain();
+    report();
+
+    spi_trace_free(&trace);
+    return 0;
+}
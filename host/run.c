@@ -0,0 +1,706 @@
+/*
+Runs the firmware on the emulated MCU with a simulated BMI270 attached, as fast as the host
+allows, and reports what happened.
+
+usage: bmi270_host [-o uart.bin] [-a uart_a0.bin] [-O records.bin] [-p clock_ppm] [-s seed] [-b baud] [-d drop_ppm] [-r]
+                   [-t decoder] [-B] [-A] [-f bin|csv] [-c commands] [-m motion] [-e] [-S ms | -R ms]
+  -o  write everything the firmware sends on the UART (A1) to this file
+  -a  write what it sends on A0 to this file, with -o (SINK_STRIPE's second lane)
+  -O  write the records sent to the file sink to this file (OUTPUT_SINKS with SINK_FILE)
+  -p  sensor clock error against the MCU, in ppm
+  -s  seed for the simulated sample noise, and for the byte drops
+  -b  run the UART at this baud rate instead of the firmware's
+  -d  drop this many bytes per million on the way into the pty
+  -r  pace the pty at the UART's baud rate in wall-clock time
+  -t  send the UART through a pty to this command, run with the pty's path appended
+      (e.g. -t "build/uart_decode -f bin")
+  -B  benchmark: decode the pty's output in-process and report samples/s, loss and latency,
+      with latency taken in virtual time from each sample's sens_time to its last byte
+  -A  acquisition benchmark: report what getting the samples out of the sensor cost, from the
+      first sample read to the first byte sent on the UART, per sample read: SPI bytes and
+      transactions, time awake (interrupts and busy waits; the emulation doesn't charge for
+      anything else), and wake-ups; then the samples the sensor produced that were never read,
+      and how long samples waited in the sensor before being read
+  -f  format dump_samples() was built with, for -B (default bin)
+  -c  commands for the dump service (DUMP_SERVICE=1, ../dump_service.h), ';' between them, each
+      sent once the UART has been quiet for a while (default "x", to let the firmware finish)
+  -m  what the simulated sensor feels: wobble (the default, gentle and well inside 2 g and
+      2000 dps), impacts (the wobble, with a 1200 dps spin from 1 to 2 s and 12 g knocks at
+      2.5 and 4 s, then quiet), or still+x, still-x ... still-z (lying still, with that axis of
+      the board up)
+  -e  the sensor has the scale, misalignment and offset errors of a real part, and is mounted
+      turned 90 degrees about z, its x along the board's y (calib_fit -m -y,x,z)
+  -S  hang the SPI bus: the first byte sent this many ms of virtual time after reset never
+      finishes, so the transaction misses its deadline; then report when samples came again and
+      the gap they left
+  -R  as -S, and the sensor browns out with that byte: it forgets its configuration and config
+      file, and comes back 2 ms later in I2C mode
+*/
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <driverlib.h>
+#include "hal_host.h"
+#include "sim_bmi270.h"
+#include "uart_decode.h"
+#include "uart_pty.h"
+#include "sink_file.h"
+#include "../sink.h"
+#include "../poll_sched.h"
+#include "../BMI270_SensorAPI/bmi2.h"
+#include "../bmi270_spi.h"
+
+// main() in main.c, renamed by the Makefile
+int firmware_main(void);
+
+// -a's file, for what goes out on A0
+static FILE *uart_a0_out;
+
+static void uart_to_file(uint16_t base, uint8_t byte, void *ctx) {
+    if (base != EUSCI_A0_BASE) {
+        fputc(byte, (FILE *)ctx);
+    } else if (uart_a0_out) {
+        fputc(byte, uart_a0_out);
+    }
+}
+
+// Typing -c's commands into the UART's receiver, a line at a time once the firmware is
+// listening and its reply has stopped coming
+struct commands {
+    const char *text;
+    uint64_t byte_ps;
+    // Earliest the next byte can go
+    uint64_t next_ps;
+    // Part way through a line
+    uint8_t in_line;
+    uint32_t uart_bytes;
+};
+
+// How long the UART has to be quiet before the next command
+#define COMMAND_GAP_PS (HAL_HOST_PS_PER_S / 50)
+
+static uint64_t commands_next(void *ctx) {
+    struct commands *c = ctx;
+    struct hal_host_stats hal;
+
+    if ((*c->text == '\0' && !c->in_line) || !hal_host_uart_rx_enabled(EUSCI_A1_BASE)) {
+        return HAL_HOST_NEVER;
+    }
+    hal_host_get_stats(&hal);
+    if (!c->in_line && hal.uart_bytes != c->uart_bytes) {
+        c->uart_bytes = hal.uart_bytes;
+        c->next_ps = hal.now_ps + COMMAND_GAP_PS;
+    }
+    return c->next_ps;
+}
+
+static void commands_run(void *ctx, uint64_t now_ps) {
+    struct commands *c = ctx;
+    // The last command ends like the others
+    char byte = *c->text ? *c->text++ : ';';
+
+    c->in_line = (byte != ';');
+    hal_host_uart_receive(EUSCI_A1_BASE, c->in_line ? byte : '\r');
+    c->next_ps = now_ps + (c->in_line ? c->byte_ps : COMMAND_GAP_PS);
+}
+
+static struct commands commands = { "x", 0, 0, 0, 0 };
+static const struct hal_host_hook commands_hook = { commands_next, commands_run, &commands };
+
+// What the -B benchmark keeps track of
+struct bench {
+    // Decodes everything the firmware sends, before the drops
+    struct uart_decoder sent;
+    // Decodes what comes out of the pty
+    struct uart_decoder received;
+    int reader;
+    uint32_t pty_written;
+
+    // Sent records: sensor time steps between neighbours, to count samples the firmware missed
+    uint64_t last_sent_sens;
+    uint32_t last_sent_index;
+    uint64_t *steps;
+    uint32_t num_steps;
+    // Every record sent, by index, to check what arrives against
+    struct uart_decode_record *records;
+    uint32_t num_records;
+
+    // Received records
+    uint64_t sens_offset;
+    uint64_t first_produced;
+    uint64_t last_arrival;
+    uint64_t latency_min;
+    uint64_t latency_max;
+    double latency_sum;
+    // Received records that differ from what was sent
+    uint32_t corrupt;
+};
+
+static struct bench bench;
+
+// What the -A benchmark keeps track of: everything as of the first sample read, and as of the
+// first byte on the UART
+struct acq {
+    struct hal_host_stats hal[2];
+    struct sim_bmi270_stats sim[2];
+    struct bmi270_spi_stats spi[2];
+    uint8_t started;
+    uint8_t finished;
+    // Samples read in between, and how long they'd waited in the sensor
+    uint32_t reads;
+    uint64_t waited_sum;
+    uint64_t waited_max;
+};
+
+static struct acq acq;
+
+// What -S and -R keep track of, from the production times of the samples read
+struct fault {
+    uint64_t at_ps;
+    uint8_t brown_out;
+    // Whoever else wants to hear of each sample read
+    void (*read)(uint64_t waited_ps);
+    uint64_t last_produced;
+    // Shortest step between two samples read, taken as the sample period
+    uint64_t min_step;
+    // When the first sample was read after the stall, and the longest step since
+    uint64_t resumed_ps;
+    uint64_t max_step;
+};
+
+static struct fault fault = { HAL_HOST_NEVER, 0, NULL, 0, UINT64_MAX, HAL_HOST_NEVER, 0 };
+
+static void bench_sent(const struct uart_decode_record *rec, void *ctx) {
+    struct bench *b = ctx;
+    uint64_t step = rec->sens_time - b->last_sent_sens;
+
+    if (b->sent.stats.records > 1 && rec->index == b->last_sent_index + 1) {
+        b->steps = realloc(b->steps, (b->num_steps + 1) * sizeof(b->steps[0]));
+        b->steps[b->num_steps++] = step;
+    }
+    b->last_sent_sens = rec->sens_time;
+    b->last_sent_index = rec->index;
+
+    if (rec->index >= b->num_records) {
+        b->records = realloc(b->records, (rec->index + 1) * sizeof(b->records[0]));
+        memset(&b->records[b->num_records], 0, (rec->index + 1 - b->num_records) * sizeof(b->records[0]));
+        b->num_records = rec->index + 1;
+    }
+    b->records[rec->index] = *rec;
+}
+
+static void bench_received(const struct uart_decode_record *rec, void *ctx) {
+    struct bench *b = ctx;
+    uint64_t produced, latency;
+
+    if (b->received.stats.records == 1) {
+        // The first record's sensor time, as sent, is the first value at or after the first
+        // sample that matches it in the bits the format carries
+        struct sim_bmi270_stats sim;
+        uint64_t mask = (1ULL << uart_decoder_sens_bits(&b->received)) - 1;
+        sim_bmi270_get_stats(&sim);
+        b->sens_offset = sim.first_tick + ((rec->sens_time - sim.first_tick) & mask) - rec->sens_time;
+        b->first_produced = sim_bmi270_tick_ps(rec->sens_time + b->sens_offset);
+        b->latency_min = UINT64_MAX;
+    }
+    produced = sim_bmi270_tick_ps(rec->sens_time + b->sens_offset);
+    latency = rec->arrival - produced;
+    if (latency < b->latency_min) b->latency_min = latency;
+    if (latency > b->latency_max) b->latency_max = latency;
+    b->latency_sum += latency;
+    b->last_arrival = rec->arrival;
+
+    // Both decoders unwrap sens_time from their own first record, so leave it out
+    if (rec->index >= b->num_records ||
+        memcmp(rec->acc, b->records[rec->index].acc, sizeof(rec->acc)) != 0 ||
+        memcmp(rec->gyr, b->records[rec->index].gyr, sizeof(rec->gyr)) != 0) {
+        b->corrupt += 1;
+    }
+}
+
+// Feeds each byte to the pty and reads it straight back, so it arrives at the current virtual time
+static void uart_to_bench(uint16_t base, uint8_t byte, void *ctx) {
+    struct bench *b = ctx;
+    struct uart_pty_stats pty;
+    struct pollfd pfd = { .fd = b->reader, .events = POLLIN };
+    uint8_t got;
+
+    uart_decoder_put(&b->sent, byte, hal_host_now_ps());
+    uart_pty_sink(base, byte, NULL);
+    uart_pty_get_stats(&pty);
+    if (pty.bytes - pty.dropped == b->pty_written) {
+        return;
+    }
+    b->pty_written += 1;
+    for (;;) {
+        if (read(b->reader, &got, 1) == 1) {
+            break;
+        }
+        if ((errno != EAGAIN && errno != EINTR) || poll(&pfd, 1, 1000) == 0) {
+            perror("pty read");
+            exit(3);
+        }
+    }
+    uart_decoder_put(&b->received, got, hal_host_now_ps());
+}
+
+// The first sample read starts the measurement; it came after the setup, so it isn't counted
+static void acq_read(uint64_t waited_ps) {
+    if (!acq.started) {
+        hal_host_get_stats(&acq.hal[0]);
+        sim_bmi270_get_stats(&acq.sim[0]);
+        bmi270_spi_get_stats(&acq.spi[0]);
+        acq.started = 1;
+        return;
+    }
+    if (acq.finished) {
+        return;
+    }
+    acq.reads += 1;
+    acq.waited_sum += waited_ps;
+    if (waited_ps > acq.waited_max) {
+        acq.waited_max = waited_ps;
+    }
+}
+
+// The first byte on the UART ends it
+static void uart_to_acq(uint16_t base, uint8_t byte, void *ctx) {
+    (void)base;
+    (void)byte;
+    (void)ctx;
+
+    if (acq.started && !acq.finished) {
+        hal_host_get_stats(&acq.hal[1]);
+        sim_bmi270_get_stats(&acq.sim[1]);
+        bmi270_spi_get_stats(&acq.spi[1]);
+        acq.finished = 1;
+    }
+}
+
+static void fault_read(uint64_t waited_ps) {
+    struct hal_host_stats hal;
+    uint64_t now = hal_host_now_ps();
+    uint64_t produced = now - waited_ps;
+    uint64_t step = produced - fault.last_produced;
+
+    if (fault.read) {
+        fault.read(waited_ps);
+    }
+    hal_host_get_stats(&hal);
+    if (fault.last_produced != 0 && step != 0) {
+        if (step < fault.min_step) {
+            fault.min_step = step;
+        }
+        // The sample being read when it hung may have counted; the one after it is the first
+        // the firmware got
+        if (now > hal.spi_stall_ps && produced > hal.spi_stall_ps) {
+            if (fault.resumed_ps == HAL_HOST_NEVER) {
+                fault.resumed_ps = now;
+            }
+            if (step > fault.max_step) {
+                fault.max_step = step;
+            }
+        }
+    }
+    fault.last_produced = produced;
+}
+
+static int compare_steps(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Samples missing between the records sent, taking the median step as the sample period
+static uint32_t sensor_lost(void) {
+    uint64_t period;
+    uint32_t lost = 0, i;
+
+    if (bench.num_steps == 0) {
+        return 0;
+    }
+    qsort(bench.steps, bench.num_steps, sizeof(bench.steps[0]), compare_steps);
+    period = bench.steps[bench.num_steps / 2];
+    for (i = 0; i < bench.num_steps; i++) {
+        lost += (uint32_t)((bench.steps[i] + period / 2) / period) - 1;
+    }
+    return lost;
+}
+
+static void bench_report(uint32_t baud, uint32_t drop_ppm) {
+    const struct uart_decode_stats *sent = &bench.sent.stats;
+    const struct uart_decode_stats *rx = &bench.received.stats;
+    uint32_t link_lost = sent->records - rx->records;
+    uint32_t sensor = sensor_lost();
+    uint32_t produced = sent->records + sensor;
+    double span = (double)(bench.last_arrival - bench.first_produced) / HAL_HOST_PS_PER_S;
+
+    printf("%s %8u baud %5u ppm  %5u samples  %8.1f samples/s  loss %6.2f%% (sensor %u, link %u)"
+        "  corrupt %u  latency %.3f/%.3f/%.3f s\n",
+        bench.sent.format == UART_DECODE_BINARY ? "bin" : "csv", baud, drop_ppm, rx->records,
+        span > 0 ? rx->records / span : 0.0,
+        produced ? 100.0 * (sensor + link_lost) / produced : 0.0, sensor, link_lost, bench.corrupt,
+        rx->records ? (double)bench.latency_min / HAL_HOST_PS_PER_S : 0.0,
+        rx->records ? bench.latency_sum / rx->records / HAL_HOST_PS_PER_S : 0.0,
+        (double)bench.latency_max / HAL_HOST_PS_PER_S);
+}
+
+static void acq_report(void) {
+    const struct hal_host_stats *hal = acq.hal;
+    const struct sim_bmi270_stats *sim = acq.sim;
+    uint32_t produced = sim[1].samples - sim[0].samples;
+    // Whatever was produced and isn't still waiting was either read or lost
+    int32_t lost = (int32_t)(sim[0].pending + produced - sim[1].pending - acq.reads);
+    uint64_t awake = (hal[1].now_ps - hal[1].sleep_ps) - (hal[0].now_ps - hal[0].sleep_ps);
+
+    if (!acq.finished || acq.reads == 0) {
+        printf("no samples read\n");
+        return;
+    }
+    printf("%7.2f bytes %6.3f transactions %8.2f us awake %6.3f wake-ups /sample  "
+        "lost %6.2f%%  waited %9.1f/%9.1f us\n",
+        (double)(hal[1].spi_bytes - hal[0].spi_bytes) / acq.reads,
+        (double)(acq.spi[1].transactions - acq.spi[0].transactions) / acq.reads,
+        (double)awake / acq.reads / 1e6,
+        (double)(hal[1].wakeups - hal[0].wakeups) / acq.reads,
+        produced ? 100.0 * lost / produced : 0.0,
+        (double)acq.waited_sum / acq.reads / 1e6, (double)acq.waited_max / 1e6);
+}
+
+static void fault_report(const struct hal_host_stats *hal, const struct bmi270_spi_stats *spi,
+    const struct sim_bmi270_stats *sim) {
+    if (hal->spi_stall_ps == HAL_HOST_NEVER) {
+        fprintf(stderr, "fault         never hit: no SPI byte after %.3f ms\n", (double)fault.at_ps / 1e9);
+        return;
+    }
+    fprintf(stderr, "fault         spi stall at %.3f ms%s; %u timeouts, %u recoveries, %u config loads\n",
+        (double)hal->spi_stall_ps / 1e9, fault.brown_out ? " with a brown-out" : "", spi->timeouts,
+        spi->recoveries, sim->config_loads);
+    if (fault.resumed_ps == HAL_HOST_NEVER) {
+        fprintf(stderr, "              no samples read after it\n");
+        return;
+    }
+    fprintf(stderr, "              samples read again %.3f ms after it; longest gap since %.3f ms, %llu samples missing\n",
+        (double)(fault.resumed_ps - hal->spi_stall_ps) / 1e9, (double)fault.max_step / 1e9,
+        (unsigned long long)((fault.max_step + fault.min_step / 2) / fault.min_step - 1));
+}
+
+// Knocks of 12 g on x, each a 10 ms half sine, and a spin about z, over a small wobble
+static void impacts(double t, double acc_g[3], double gyr_dps[3]) {
+    static const double knocks[] = { 2.5, 4.0 };
+    double s;
+    unsigned i;
+
+    acc_g[0] = 0.10 * sin(2 * M_PI * 0.5 * t);
+    acc_g[1] = 0.05 * sin(2 * M_PI * 1.3 * t + 1.0);
+    acc_g[2] = 1.0 + 0.02 * sin(2 * M_PI * 3.0 * t);
+    gyr_dps[0] = 3.0 * sin(2 * M_PI * 0.7 * t);
+    gyr_dps[1] = 1.0 * sin(2 * M_PI * 2.1 * t);
+    gyr_dps[2] = 0.5 * sin(2 * M_PI * 0.2 * t);
+
+    for (i = 0; i < sizeof(knocks) / sizeof(knocks[0]); i++) {
+        if (t >= knocks[i] && t < knocks[i] + 0.010) {
+            acc_g[0] += 12.0 * sin(M_PI * (t - knocks[i]) / 0.010);
+        }
+    }
+    if (t >= 1.0 && t < 2.0) {
+        s = sin(M_PI * (t - 1.0));
+        gyr_dps[2] += 1200.0 * s * s;
+    }
+}
+
+// Lying still, with axis still_axis of the board pointing up (still_sign -1: down)
+static int still_axis, still_sign;
+
+static void still(double t, double acc_g[3], double gyr_dps[3]) {
+    int i;
+
+    (void)t;
+    for (i = 0; i < 3; i++) {
+        acc_g[i] = (i == still_axis) ? still_sign : 0.0;
+        gyr_dps[i] = 0.0;
+    }
+}
+
+// -e: scale errors of a couple of percent, misalignment of under a degree and offsets of tens of
+// mg and about a dps, with the sensor's x along the board's y and its y along the board's -x
+static const struct sim_bmi270_errors part_errors = {
+    .acc_gain = { { -0.005, 1.020, -0.008 }, { -0.985, 0.004, 0.006 }, { -0.003, -0.007, 1.010 } },
+    .acc_bias_g = { 0.035, -0.050, 0.060 },
+    .gyr_gain = { { 0, 1, 0 }, { -1, 0, 0 }, { 0, 0, 1 } },
+    .gyr_bias_dps = { 0.8, -0.5, 1.2 },
+};
+
+static pid_t spawn_decoder(const char *command, const char *path) {
+    char *line;
+    pid_t pid;
+
+    if (asprintf(&line, "%s %s", command, path) < 0) {
+        return -1;
+    }
+    pid = fork();
+    if (pid == 0) {
+        execl("/bin/sh", "sh", "-c", line, (char *)NULL);
+        _exit(127);
+    }
+    free(line);
+    return pid;
+}
+
+static double wall_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv) {
+    struct sim_bmi270_config sensor = { .clock_ppm = 0, .seed = 1, .motion = NULL };
+    struct hal_host_stats hal;
+    struct sim_bmi270_stats sim;
+    struct bmi270_spi_stats spi;
+    struct poll_sched_stats sched;
+    struct uart_pty_config pty = { .pace_baud = 0, .drop_ppm = 0, .seed = 1 };
+    struct uart_pty_stats pty_stats;
+    enum uart_decode_format format = UART_DECODE_BINARY;
+    const char *decoder = NULL;
+    const char *pty_path = NULL;
+    pid_t decoder_pid = -1;
+    uint32_t baud = 0;
+    uint8_t pace = 0, benchmark = 0, acquisition = 0;
+    FILE *uart_out = NULL, *records_out = NULL;
+    struct sink *const sinks[] = { &sink_uart, &sink_fram, &sink_null, &sink_file, &sink_stripe,
+        &sink_aes };
+    const struct sink_stats *ss;
+    uint8_t i;
+    double wall, virt;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:a:O:p:s:b:d:rt:BAf:c:m:eS:R:")) != -1) {
+        switch (opt) {
+            case 'o':
+                uart_out = fopen(optarg, "wb");
+                if (!uart_out) {
+                    perror(optarg);
+                    return 1;
+                }
+                break;
+            case 'a':
+                uart_a0_out = fopen(optarg, "wb");
+                if (!uart_a0_out) {
+                    perror(optarg);
+                    return 1;
+                }
+                break;
+            case 'O':
+                records_out = fopen(optarg, "wb");
+                if (!records_out) {
+                    perror(optarg);
+                    return 1;
+                }
+                sink_file_open(records_out);
+                break;
+            case 'p':
+                sensor.clock_ppm = atoi(optarg);
+                break;
+            case 's':
+                sensor.seed = (uint32_t)strtoul(optarg, NULL, 0);
+                pty.seed = sensor.seed;
+                break;
+            case 'b':
+                baud = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'd':
+                pty.drop_ppm = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'r':
+                pace = 1;
+                break;
+            case 't':
+                decoder = optarg;
+                break;
+            case 'B':
+                benchmark = 1;
+                break;
+            case 'A':
+                acquisition = 1;
+                break;
+            case 'c':
+                commands.text = optarg;
+                break;
+            case 'm':
+                if (strcmp(optarg, "wobble") == 0 || strcmp(optarg, "impacts") == 0) {
+                    sensor.motion = (optarg[0] == 'i') ? impacts : NULL;
+                    break;
+                }
+                if (strncmp(optarg, "still", 5) == 0 && strlen(optarg) == 7 && strchr("+-", optarg[5]) &&
+                    strchr("xyz", optarg[6])) {
+                    still_sign = (optarg[5] == '+') ? 1 : -1;
+                    still_axis = optarg[6] - 'x';
+                    sensor.motion = still;
+                    break;
+                }
+                goto usage;
+            case 'e':
+                sensor.errors = &part_errors;
+                break;
+            case 'S':
+            case 'R':
+                fault.at_ps = (uint64_t)(atof(optarg) * 1e9);
+                fault.brown_out = (opt == 'R');
+                break;
+            case 'f':
+                if (strcmp(optarg, "bin") == 0 || strcmp(optarg, "csv") == 0) {
+                    format = (optarg[0] == 'b') ? UART_DECODE_BINARY : UART_DECODE_CSV;
+                    break;
+                }
+                // fall through
+            default:
+            usage:
+                fprintf(stderr, "usage: %s [-o uart.bin] [-a uart_a0.bin] [-O records.bin] [-p clock_ppm] [-s seed] [-b baud] [-d drop_ppm] [-r]\n"
+                    "       [-t decoder] [-B] [-A] [-f bin|csv] [-c commands] [-m motion] [-e] [-S ms | -R ms]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (uart_out && (decoder || benchmark)) {
+        fprintf(stderr, "-o can't be used with -t or -B\n");
+        return 1;
+    }
+    if (acquisition && (uart_out || decoder || benchmark)) {
+        fprintf(stderr, "-A can't be used with -o, -t or -B\n");
+        return 1;
+    }
+
+    if (acquisition) {
+        sensor.read = acq_read;
+    }
+    if (fault.at_ps != HAL_HOST_NEVER) {
+        fault.read = sensor.read;
+        sensor.read = fault_read;
+    }
+    hal_host_reset();
+    sim_bmi270_attach(&sensor);
+    if (fault.at_ps != HAL_HOST_NEVER) {
+        hal_host_stall_spi(fault.at_ps);
+        if (fault.brown_out) {
+            sim_bmi270_brown_out(fault.at_ps);
+        }
+    }
+    // Ten bits a byte, at the firmware's 115200 unless told otherwise
+    commands.byte_ps = 10 * HAL_HOST_PS_PER_S / (baud ? baud : 115200);
+    hal_host_add_hook(&commands_hook);
+    if (baud) {
+        hal_host_set_uart_baud(EUSCI_A1_BASE, baud);
+    }
+    if (uart_out) {
+        hal_host_set_uart_sink(uart_to_file, uart_out);
+    }
+    if (decoder || benchmark) {
+        // The firmware's UART runs at 115200 unless told otherwise
+        pty.pace_baud = pace ? (baud ? baud : 115200) : 0;
+        pty_path = uart_pty_open(&pty);
+        if (!pty_path) {
+            perror("pty");
+            return 1;
+        }
+    }
+    if (decoder) {
+        decoder_pid = spawn_decoder(decoder, pty_path);
+        if (decoder_pid < 0) {
+            perror(decoder);
+            return 1;
+        }
+        hal_host_set_uart_sink(uart_pty_sink, NULL);
+    } else if (benchmark) {
+        uart_decoder_init(&bench.sent, format, bench_sent, &bench);
+        uart_decoder_init(&bench.received, format, bench_received, &bench);
+        bench.reader = open(pty_path, O_RDONLY | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+        if (bench.reader < 0) {
+            perror(pty_path);
+            return 1;
+        }
+        hal_host_set_uart_sink(uart_to_bench, &bench);
+    } else if (acquisition) {
+        hal_host_set_uart_sink(uart_to_acq, NULL);
+    }
+
+    wall = wall_seconds();
+    firmware_main();
+    hal_host_drain();
+    wall = wall_seconds() - wall;
+
+    if (uart_out) {
+        fclose(uart_out);
+    }
+    if (uart_a0_out) {
+        fclose(uart_a0_out);
+    }
+    if (records_out) {
+        fclose(records_out);
+    }
+    if (pty_path) {
+        uart_pty_get_stats(&pty_stats);
+        if (benchmark) {
+            uart_decoder_finish(&bench.sent);
+            uart_decoder_finish(&bench.received);
+            close(bench.reader);
+        }
+        uart_pty_close();
+        if (decoder_pid > 0) {
+            waitpid(decoder_pid, NULL, 0);
+        }
+    }
+
+    hal_host_get_stats(&hal);
+    sim_bmi270_get_stats(&sim);
+    bmi270_spi_get_stats(&spi);
+    poll_sched_get_stats(&sched);
+    virt = (double)hal.now_ps / HAL_HOST_PS_PER_S;
+
+    fprintf(stderr, "virtual time  %.3f s (%.1fx real time, %.3f s wall)\n", virt, virt / wall, wall);
+    fprintf(stderr, "cpu asleep    %.1f%%, %u wake-ups, %u interrupts\n",
+        100.0 * hal.sleep_ps / (hal.now_ps ? hal.now_ps : 1), hal.wakeups, hal.isrs);
+    fprintf(stderr, "spi           %u transactions, %u bytes, %u timeouts, longest %u us\n",
+        spi.transactions, hal.spi_bytes, spi.timeouts, spi.max_us);
+    if (hal.dma_transfers) {
+        fprintf(stderr, "uart          %u bytes, %u moved by DMA\n", hal.uart_bytes, hal.dma_transfers);
+    } else {
+        fprintf(stderr, "uart          %u bytes\n", hal.uart_bytes);
+    }
+    if (hal.aes_blocks) {
+        fprintf(stderr, "aes           %u blocks\n", hal.aes_blocks);
+    }
+    if (pty_path) {
+        fprintf(stderr, "pty           %u bytes, %u dropped\n", pty_stats.bytes, pty_stats.dropped);
+    }
+    for (i = 0; i < sizeof(sinks) / sizeof(sinks[0]); i += 1) {
+        ss = &sinks[i]->stats;
+        if (ss->records || ss->dropped) {
+            fprintf(stderr, "sink %-8s %u records, %u bytes, %u waits, %u dropped\n",
+                sinks[i]->name, ss->records, ss->bytes, ss->waits, ss->dropped);
+        }
+    }
+    fprintf(stderr, "sensor        %u samples, %u fifo frames, %u dropped, %u config loads\n",
+        sim.samples, sim.fifo_frames, sim.fifo_dropped, sim.config_loads);
+    if (sched.reads) {
+        fprintf(stderr, "poll sched    %u reads, %u misses, period %u, locked %u\n",
+            sched.reads, sched.misses, sched.period_sens, sched.locked);
+    }
+    if (fault.at_ps != HAL_HOST_NEVER) {
+        fault_report(&hal, &spi, &sim);
+    }
+    if (benchmark) {
+        bench_report(baud ? baud : 115200, pty.drop_ppm);
+    }
+    if (acquisition) {
+        acq_report();
+    }
+    return 0;
+}
@@ -0,0 +1,230 @@
+/*
+Puts the samples of an RTC_ANCHOR build (../rtc_anchor.h) on UTC. Decodes the firmware's UART
+output as uart_decode does, then maps each sample's sensor time to UTC through the anchors,
+linearly between each pair and carrying on the nearest pair's rate beyond the first and last,
+so drift between the sensor's clock and the RTC crystal is followed as it goes. With only one
+anchor, the sensor time is taken at its nominal 39.0625 us a tick.
+
+Prints "index, UTC, sens_time,  ax, ay, az,  gx, gy, gz" lines on stdout, the UTC as
+2026-10-18T12:34:56.789012Z, and the sensor clock's error against the RTC on stderr, with a
+warning if any anchor is from before the RTC was set (RTC_ANCHOR_SYNCED).
+
+usage: sample_utc [-f bin|csv] [path]
+  -f    the format dump_samples() was built with (default bin)
+  path  where to read from (default stdin); a tty is put in raw mode first
+  e.g. sample_utc -f bin build/uart.bin > build/utc.csv
+*/
+
+#define _DEFAULT_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "uart_decode.h"
+#include "../rtc_anchor.h"
+
+#define TICK_S 39.0625e-6
+
+struct capture {
+    struct uart_decode_record *records;
+    size_t num_records, max_records;
+    struct uart_decode_anchor *anchors;
+    size_t num_anchors, max_anchors;
+};
+
+// An anchor's sensor time on the records' unwrapped scale, and its UTC as seconds after the
+// first anchor's whole second
+struct point {
+    double sens_time;
+    double utc;
+};
+
+static void *grow(void *array, size_t *max, size_t size) {
+    *max = *max ? 2 * *max : 1024;
+    array = realloc(array, *max * size);
+    if (!array) {
+        perror("sample_utc");
+        exit(1);
+    }
+    return array;
+}
+
+static void add_record(const struct uart_decode_record *rec, void *ctx) {
+    struct capture *c = ctx;
+
+    if (c->num_records == c->max_records) {
+        c->records = grow(c->records, &c->max_records, sizeof(*rec));
+    }
+    c->records[c->num_records++] = *rec;
+}
+
+static void add_anchor(const struct uart_decode_anchor *anchor, void *ctx) {
+    struct capture *c = ctx;
+
+    if (c->num_anchors == c->max_anchors) {
+        c->anchors = grow(c->anchors, &c->max_anchors, sizeof(*anchor));
+    }
+    c->anchors[c->num_anchors++] = *anchor;
+}
+
+// The record an anchor was taken next to: the one it was taken before, or the last if it came
+// after them all
+static const struct uart_decode_record *near_record(const struct capture *c, uint32_t next) {
+    size_t lo = 0, hi = c->num_records, mid;
+
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if (c->records[mid].index < next) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return &c->records[(lo < c->num_records) ? lo : c->num_records - 1];
+}
+
+// The anchors are within a sample period or so of their record, well inside the 16 bits the
+// binary records keep of the sensor time, so the difference in those bits places them
+static void to_points(const struct capture *c, struct point *p) {
+    const struct uart_decode_record *rec;
+    const struct uart_decode_anchor *a;
+    size_t i;
+
+    for (i = 0; i < c->num_anchors; i++) {
+        a = &c->anchors[i];
+        rec = near_record(c, a->next);
+        p[i].sens_time = (double)rec->sens_time + (int16_t)(a->sens_time - (uint16_t)rec->sens_time);
+        p[i].utc = (double)(a->utc - c->anchors[0].utc) + (double)a->subsec / RTC_ANCHOR_SUBSEC_HZ;
+    }
+}
+
+static double to_utc(const struct point *p, size_t n, double sens_time) {
+    size_t i = 0;
+
+    if (n == 1) {
+        return p[0].utc + (sens_time - p[0].sens_time) * TICK_S;
+    }
+    // The pair around sens_time, or the first or last
+    while (i + 2 < n && sens_time >= p[i + 1].sens_time) {
+        i += 1;
+    }
+    return p[i].utc + (sens_time - p[i].sens_time) * (p[i + 1].utc - p[i].utc) /
+                      (p[i + 1].sens_time - p[i].sens_time);
+}
+
+static void print_utc(uint32_t base, double utc) {
+    long long us = llround(utc * 1e6);
+    long long sec = (us >= 0) ? us / 1000000 : -((999999 - us) / 1000000);
+    time_t t = (time_t)(base + sec);
+    struct tm tm;
+    char when[32];
+
+    gmtime_r(&t, &tm);
+    strftime(when, sizeof(when), "%Y-%m-%dT%H:%M:%S", &tm);
+    printf("%s.%06lldZ", when, us - sec * 1000000);
+}
+
+int main(int argc, char **argv) {
+    enum uart_decode_format format = UART_DECODE_BINARY;
+    struct capture c = { 0 };
+    struct uart_decoder dec;
+    struct termios tio;
+    struct point *p;
+    const struct uart_decode_record *rec;
+    uint8_t buf[256];
+    ssize_t got, i;
+    size_t k, n, unset;
+    double span;
+    int fd = STDIN_FILENO;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:")) != -1) {
+        if (opt == 'f' && strcmp(optarg, "bin") == 0) {
+            format = UART_DECODE_BINARY;
+        } else if (opt == 'f' && strcmp(optarg, "csv") == 0) {
+            format = UART_DECODE_CSV;
+        } else {
+            fprintf(stderr, "usage: %s [-f bin|csv] [path]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind < argc) {
+        fd = open(argv[optind], O_RDONLY | O_NOCTTY);
+        if (fd < 0) {
+            perror(argv[optind]);
+            return 1;
+        }
+    }
+    if (isatty(fd) && tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+
+    uart_decoder_init(&dec, format, add_record, &c);
+    uart_decoder_on_anchor(&dec, add_anchor);
+    for (;;) {
+        got = read(fd, buf, sizeof(buf));
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            break;
+        }
+        for (i = 0; i < got; i++) {
+            uart_decoder_put(&dec, buf[i], 0);
+        }
+    }
+    uart_decoder_finish(&dec);
+
+    n = c.num_anchors;
+    if (n == 0 || c.num_records == 0) {
+        fprintf(stderr, "sample_utc: %zu records and %zu anchors; was the firmware built with RTC_ANCHOR=1?\n",
+            c.num_records, n);
+        return 1;
+    }
+    p = calloc(n, sizeof(*p));
+    if (!p) {
+        perror("sample_utc");
+        return 1;
+    }
+    to_points(&c, p);
+    for (k = 1; k < n; k++) {
+        if (p[k].sens_time <= p[k - 1].sens_time) {
+            fprintf(stderr, "sample_utc: anchor %zu doesn't follow the one before\n", k);
+            return 1;
+        }
+    }
+
+    for (k = 0; k < c.num_records; k++) {
+        rec = &c.records[k];
+        printf("%u, ", rec->index);
+        print_utc(c.anchors[0].utc, to_utc(p, n, (double)rec->sens_time));
+        printf(", %llu,  %d, %d, %d,  %d, %d, %d\n", (unsigned long long)rec->sens_time,
+            rec->acc[0], rec->acc[1], rec->acc[2], rec->gyr[0], rec->gyr[1], rec->gyr[2]);
+    }
+
+    fprintf(stderr, "sample_utc: %zu records, %zu anchors", c.num_records, n);
+    span = p[n - 1].utc - p[0].utc;
+    if (n > 1 && span > 0) {
+        // Positive when the sensor's clock runs fast of the RTC's
+        fprintf(stderr, ", sensor clock %+.1f ppm against the RTC over %.3f s",
+            ((p[n - 1].sens_time - p[0].sens_time) * TICK_S / span - 1) * 1e6, span);
+    }
+    fprintf(stderr, "\n");
+    for (k = 0, unset = 0; k < n; k++) {
+        unset += !(c.anchors[k].flags & RTC_ANCHOR_SYNCED);
+    }
+    if (unset) {
+        fprintf(stderr, "sample_utc: %zu of the anchors are from before the RTC was set (the dump "
+            "service's T), so their UTC is only as good as the time it started from\n", unset);
+    }
+    free(p);
+    free(c.records);
+    free(c.anchors);
+    return 0;
+}
@@ -0,0 +1,630 @@
+#include <math.h>
+#include <string.h>
+#include <driverlib.h>
+#include "hal_host.h"
+#include "sim_bmi270.h"
+#include "../bmi270_int.h"
+
+#define CS_PORT GPIO_PORT_P1
+#define CS_PIN GPIO_PIN5
+
+#define CONFIG_SIZE 8192
+#define FIFO_SIZE 2048
+// Largest frame we produce: header + gyro + accel
+#define MAX_FRAME_LEN 13
+
+// 25.6 kHz sensor time tick at the nominal clock, in ps
+#define NOMINAL_TICK_PS 39062500ULL
+// How long the config takes to load after INIT_CTRL is set
+#define LOAD_TIME_PS (10ULL * 1000000000ULL)
+// Width of the data-ready pulse on INT1
+#define DRDY_PULSE_PS (2500ULL * 1000ULL)
+// From a brown-out to answering the bus again, as long as the API waits after a soft reset
+#define POWER_UP_PS (2000ULL * 1000000ULL)
+
+#define REG_CHIP_ID 0x00
+#define REG_ERR 0x02
+#define REG_STATUS 0x03
+#define REG_ACC_X 0x0C
+#define REG_GYR_X 0x12
+#define REG_SENSORTIME 0x18
+#define REG_INT_STATUS_0 0x1C
+#define REG_INT_STATUS_1 0x1D
+#define REG_INTERNAL_STATUS 0x21
+#define REG_FIFO_LENGTH_0 0x24
+#define REG_FIFO_LENGTH_1 0x25
+#define REG_FIFO_DATA 0x26
+#define REG_FEAT_PAGE 0x2F
+#define REG_FEATURES 0x30
+#define REG_ACC_CONF 0x40
+#define REG_ACC_RANGE 0x41
+#define REG_GYR_CONF 0x42
+#define REG_GYR_RANGE 0x43
+#define REG_FIFO_WTM_0 0x46
+#define REG_FIFO_WTM_1 0x47
+#define REG_FIFO_CONFIG_0 0x48
+#define REG_FIFO_CONFIG_1 0x49
+#define REG_SATURATION 0x4A
+#define REG_INT1_IO_CTRL 0x53
+#define REG_INT_MAP_DATA 0x58
+#define REG_INIT_CTRL 0x59
+#define REG_INIT_ADDR_0 0x5B
+#define REG_INIT_ADDR_1 0x5C
+#define REG_INIT_DATA 0x5E
+#define REG_PWR_CONF 0x7C
+#define REG_PWR_CTRL 0x7D
+#define REG_CMD 0x7E
+
+#define STATUS_DRDY_ACC 0x80
+#define STATUS_DRDY_GYR 0x40
+#define STATUS_CMD_RDY 0x10
+
+#define ERR_FIFO 0x40
+
+#define INT1_FFULL 0x01
+#define INT1_FWM 0x02
+#define INT1_DRDY 0x04
+
+extern const uint8_t bmi270_config_file[];
+
+static struct sim_bmi270_config cfg;
+static struct sim_bmi270_stats stats;
+
+static uint8_t regs[128];
+static uint8_t features[8][16];
+static uint8_t config[CONFIG_SIZE];
+static uint16_t init_addr;
+static uint64_t load_at;
+
+static uint64_t tick_ps;
+// Absolute sensor time tick of the next sample
+static uint64_t next_tick;
+static uint8_t sampling;
+static uint32_t noise_state;
+
+static uint8_t fifo[FIFO_SIZE];
+static uint16_t fifo_head;
+static uint16_t fifo_fill;
+// When each frame in the FIFO was produced, oldest first
+static uint64_t frame_produced[FIFO_SIZE];
+static uint16_t frames_head;
+static uint16_t frames_count;
+// When the accel data registers were last written
+static uint64_t data_produced;
+
+static uint64_t drdy_end;
+static uint8_t int1_level;
+
+// sim_bmi270_brown_out()'s time, until it hits
+static uint64_t brown_out_at;
+// When the part is back up after a brown-out, and whether it's still in I2C mode
+static uint64_t up_at;
+static uint8_t i2c_mode;
+
+// SPI transaction state
+static uint8_t byte_index;
+static uint8_t addr;
+static uint8_t reading;
+static uint32_t sens_latch;
+static uint8_t time_frame[4];
+static uint8_t time_frame_index;
+static uint8_t empty_index;
+// Bytes of the FIFO's oldest frame read so far in this burst; it's only popped once all of it
+// has been read, and sent again from the start by the next burst otherwise
+static uint16_t frame_read;
+
+static uint64_t current_tick(void) {
+    return hal_host_now_ps() / tick_ps;
+}
+
+static uint32_t odr_period(uint8_t conf) {
+    // ODR code 8 is 100 Hz (256 ticks), and each step doubles or halves it
+    uint8_t odr = conf & 0x0F;
+    if (odr == 0) {
+        odr = 1;
+    }
+    return (odr >= 8) ? (256UL >> (odr - 8)) : (256UL << (8 - odr));
+}
+
+static uint8_t acc_enabled(void) {
+    return regs[REG_PWR_CTRL] & 0x04;
+}
+
+static uint8_t gyr_enabled(void) {
+    return regs[REG_PWR_CTRL] & 0x02;
+}
+
+static uint32_t sample_period(void) {
+    uint32_t acc = acc_enabled() ? odr_period(regs[REG_ACC_CONF]) : 0;
+    uint32_t gyr = gyr_enabled() ? odr_period(regs[REG_GYR_CONF]) : 0;
+    if (!acc) return gyr;
+    if (!gyr) return acc;
+    return (acc < gyr) ? acc : gyr;
+}
+
+static void reschedule(void) {
+    uint32_t period = sample_period();
+
+    sampling = (period != 0);
+    if (sampling) {
+        next_tick = (current_tick() / period + 1) * period;
+    }
+}
+
+static uint16_t fifo_watermark(void) {
+    return regs[REG_FIFO_WTM_0] | ((uint16_t)(regs[REG_FIFO_WTM_1] & 0x1F) << 8);
+}
+
+static uint8_t fifo_headers(void) {
+    return regs[REG_FIFO_CONFIG_1] & 0x10;
+}
+
+static void update_int1(void) {
+    uint8_t map = regs[REG_INT_MAP_DATA];
+    uint8_t io = regs[REG_INT1_IO_CTRL];
+    uint16_t wtm = fifo_watermark();
+    uint8_t active = ((map & INT1_FFULL) && fifo_fill + MAX_FRAME_LEN > FIFO_SIZE) ||
+        ((map & INT1_FWM) && wtm && fifo_fill >= wtm) ||
+        ((map & INT1_DRDY) && drdy_end != HAL_HOST_NEVER);
+    // Output disabled leaves the pin to the MCU's pull-down; lvl (bit 1) picks the active level
+    uint8_t level = (io & 0x08) ? (active == ((io >> 1) & 1)) : 0;
+
+    if (level != int1_level) {
+        int1_level = level;
+        hal_host_set_input(BMI_INT1_PORT, BMI_INT1_PIN, level);
+    }
+}
+
+// A sample produced at produced has just been read out
+static void read_out(uint64_t produced) {
+    stats.reads += 1;
+    if (cfg.read) {
+        cfg.read(hal_host_now_ps() - produced);
+    }
+}
+
+static void reset_registers(void) {
+    memset(regs, 0, sizeof(regs));
+    memset(features, 0, sizeof(features));
+    regs[REG_CHIP_ID] = 0x24;
+    regs[REG_STATUS] = STATUS_CMD_RDY;
+    regs[REG_ACC_CONF] = 0xA8;
+    regs[REG_ACC_RANGE] = 0x02;
+    regs[REG_GYR_CONF] = 0xA9;
+    regs[REG_FIFO_WTM_0] = 0x00;
+    regs[REG_FIFO_WTM_1] = 0x02;
+    regs[REG_FIFO_CONFIG_0] = 0x02;
+    regs[REG_FIFO_CONFIG_1] = 0x10;
+    regs[REG_PWR_CONF] = 0x03;
+    fifo_fill = 0;
+    frames_count = 0;
+    load_at = HAL_HOST_NEVER;
+    drdy_end = HAL_HOST_NEVER;
+    reschedule();
+    update_int1();
+}
+
+/* Samples */
+
+static void default_motion(double t, double acc_g[3], double gyr_dps[3]) {
+    acc_g[0] = 0.10 * sin(2 * M_PI * 0.5 * t);
+    acc_g[1] = 0.05 * sin(2 * M_PI * 1.3 * t + 1.0);
+    acc_g[2] = 1.0 + 0.02 * sin(2 * M_PI * 3.0 * t);
+    gyr_dps[0] = 30.0 * sin(2 * M_PI * 0.7 * t);
+    gyr_dps[1] = 10.0 * sin(2 * M_PI * 2.1 * t);
+    gyr_dps[2] = 5.0 * sin(2 * M_PI * 0.2 * t);
+}
+
+// v = gain * v + bias
+static void distort(double v[3], const double gain[3][3], const double bias[3]) {
+    double in[3] = { v[0], v[1], v[2] };
+    uint8_t r;
+
+    for (r = 0; r < 3; r++) {
+        v[r] = gain[r][0] * in[0] + gain[r][1] * in[1] + gain[r][2] * in[2] + bias[r];
+    }
+}
+
+static int16_t noise(void) {
+    noise_state = noise_state * 1103515245UL + 12345UL;
+    return (int16_t)((noise_state >> 16) % 7) - 3;
+}
+
+// Convert to LSB at the given scale, clipping (and flagging) like the sensor does
+static int16_t to_lsb(double val, double lsb_per_unit, uint8_t *saturated, uint8_t bit) {
+    double lsb = val * lsb_per_unit + noise();
+    if (lsb >= 32767.0) {
+        *saturated |= bit;
+        return 32767;
+    }
+    if (lsb <= -32768.0) {
+        *saturated |= bit;
+        return -32768;
+    }
+    return (int16_t)lrint(lsb);
+}
+
+static void put_le16(uint8_t *dst, int16_t val) {
+    dst[0] = (uint8_t)val;
+    dst[1] = (uint8_t)((uint16_t)val >> 8);
+}
+
+static uint16_t frame_len(uint8_t header) {
+    if ((header & 0xE0) == 0x80) {
+        return 1 + 6 * (((header >> 2) & 1) + ((header >> 3) & 1)) + 8 * ((header >> 4) & 1);
+    }
+    return 1;
+}
+
+static void fifo_push(const uint8_t *frame, uint16_t len) {
+    uint16_t i;
+
+    while (fifo_fill + len > FIFO_SIZE) {
+        if (regs[REG_FIFO_CONFIG_0] & 0x01) {
+            // Stop-on-full keeps the old data and loses the new
+            stats.fifo_dropped += 1;
+            regs[REG_ERR] |= ERR_FIFO;
+            return;
+        }
+        // Stream mode drops the oldest frame to make room
+        uint16_t drop = fifo_headers() ? frame_len(fifo[fifo_head]) : len;
+        fifo_head = (fifo_head + drop) % FIFO_SIZE;
+        fifo_fill -= drop;
+        frames_head = (frames_head + 1) % FIFO_SIZE;
+        frames_count -= 1;
+        frame_read = 0;
+        stats.fifo_dropped += 1;
+        regs[REG_ERR] |= ERR_FIFO;
+    }
+    for (i = 0; i < len; i++) {
+        fifo[(fifo_head + fifo_fill + i) % FIFO_SIZE] = frame[i];
+    }
+    fifo_fill += len;
+    frame_produced[(frames_head + frames_count) % FIFO_SIZE] = hal_host_now_ps();
+    frames_count += 1;
+    stats.fifo_frames += 1;
+}
+
+static void produce_sample(uint64_t tick) {
+    double acc_g[3], gyr_dps[3];
+    uint8_t acc_due = acc_enabled() && (tick % odr_period(regs[REG_ACC_CONF]) == 0);
+    uint8_t gyr_due = gyr_enabled() && (tick % odr_period(regs[REG_GYR_CONF]) == 0);
+    double acc_scale = 16384.0 / (1 << (regs[REG_ACC_RANGE] & 0x03));
+    double gyr_scale = 32768.0 / (2000 >> (regs[REG_GYR_RANGE] & 0x07));
+    uint8_t saturated = 0;
+    uint8_t frame[MAX_FRAME_LEN];
+    uint16_t len = 0;
+    uint8_t fifo_acc, fifo_gyr;
+    uint8_t i;
+
+    (cfg.motion ? cfg.motion : default_motion)(tick * (NOMINAL_TICK_PS * 1e-12), acc_g, gyr_dps);
+    if (cfg.errors) {
+        distort(acc_g, cfg.errors->acc_gain, cfg.errors->acc_bias_g);
+        distort(gyr_dps, cfg.errors->gyr_gain, cfg.errors->gyr_bias_dps);
+    }
+
+    if (acc_due) {
+        for (i = 0; i < 3; i++) {
+            put_le16(&regs[REG_ACC_X + 2 * i], to_lsb(acc_g[i], acc_scale, &saturated, 1 << i));
+        }
+        regs[REG_STATUS] |= STATUS_DRDY_ACC;
+        regs[REG_INT_STATUS_1] |= 0x80;
+        data_produced = hal_host_now_ps();
+    }
+    if (gyr_due) {
+        for (i = 0; i < 3; i++) {
+            put_le16(&regs[REG_GYR_X + 2 * i], to_lsb(gyr_dps[i], gyr_scale, &saturated, 8 << i));
+        }
+        regs[REG_STATUS] |= STATUS_DRDY_GYR;
+        regs[REG_INT_STATUS_1] |= 0x40;
+    }
+    regs[REG_SATURATION] = saturated;
+    if (stats.samples == 0) {
+        stats.first_tick = tick;
+    }
+    stats.samples += 1;
+
+    // FIFO frames carry the sensors in aux, gyro, accel order
+    fifo_acc = acc_due && (regs[REG_FIFO_CONFIG_1] & 0x40);
+    fifo_gyr = gyr_due && (regs[REG_FIFO_CONFIG_1] & 0x80);
+    if (fifo_headers()) {
+        frame[len++] = 0x80 | (fifo_gyr << 3) | (fifo_acc << 2);
+    } else if ((regs[REG_FIFO_CONFIG_1] & 0x40) && !fifo_acc) {
+        // Headerless frames only go in when every enabled sensor has a sample
+        fifo_gyr = 0;
+    } else if ((regs[REG_FIFO_CONFIG_1] & 0x80) && !fifo_gyr) {
+        fifo_acc = 0;
+    }
+    if (fifo_gyr) {
+        memcpy(&frame[len], &regs[REG_GYR_X], 6);
+        len += 6;
+    }
+    if (fifo_acc) {
+        memcpy(&frame[len], &regs[REG_ACC_X], 6);
+        len += 6;
+    }
+    if (fifo_acc || fifo_gyr) {
+        uint16_t wtm = fifo_watermark();
+        uint8_t was_above = wtm && fifo_fill >= wtm;
+        fifo_push(frame, len);
+        if (wtm && fifo_fill >= wtm && !was_above) {
+            regs[REG_INT_STATUS_1] |= 0x02;
+        }
+        if (fifo_fill + MAX_FRAME_LEN > FIFO_SIZE) {
+            regs[REG_INT_STATUS_1] |= 0x01;
+        }
+    }
+
+    drdy_end = hal_host_now_ps() + DRDY_PULSE_PS;
+    update_int1();
+}
+
+/* Event loop hook */
+
+static uint64_t hook_next(void *ctx) {
+    uint64_t next = sampling ? next_tick * tick_ps : HAL_HOST_NEVER;
+    (void)ctx;
+    if (load_at < next) next = load_at;
+    if (drdy_end < next) next = drdy_end;
+    return next;
+}
+
+static void hook_run(void *ctx, uint64_t now) {
+    (void)ctx;
+    if (load_at <= now) {
+        load_at = HAL_HOST_NEVER;
+        if (memcmp(config, bmi270_config_file, CONFIG_SIZE) == 0) {
+            regs[REG_INTERNAL_STATUS] = 0x01;
+            stats.config_loads += 1;
+        } else {
+            regs[REG_INTERNAL_STATUS] = 0x02;
+        }
+    }
+    if (drdy_end <= now) {
+        drdy_end = HAL_HOST_NEVER;
+        update_int1();
+    }
+    while (sampling && next_tick * tick_ps <= now) {
+        produce_sample(next_tick);
+        next_tick += sample_period();
+    }
+}
+
+/* Registers */
+
+static uint16_t headerless_frame_len(void) {
+    return 6 * (((regs[REG_FIFO_CONFIG_1] >> 6) & 1) + ((regs[REG_FIFO_CONFIG_1] >> 7) & 1));
+}
+
+static uint8_t fifo_pop(void) {
+    uint8_t val;
+    uint16_t len;
+
+    if (fifo_fill) {
+        val = fifo[(fifo_head + frame_read) % FIFO_SIZE];
+        frame_read += 1;
+        len = fifo_headers() ? frame_len(fifo[fifo_head]) : headerless_frame_len();
+        if (frame_read >= len) {
+            fifo_head = (fifo_head + len) % FIFO_SIZE;
+            fifo_fill -= len;
+            frame_read = 0;
+            frames_head = (frames_head + 1) % FIFO_SIZE;
+            frames_count -= 1;
+            read_out(frame_produced[(frames_head + FIFO_SIZE - 1) % FIFO_SIZE]);
+            update_int1();
+        }
+        return val;
+    }
+    if (!fifo_headers()) {
+        // Headerless mode pads with the 0x8000 empty marker
+        return (empty_index++ & 1) ? 0x80 : 0x00;
+    }
+    // Reading past the end gives one sensortime frame per burst, then empty frames
+    if ((regs[REG_FIFO_CONFIG_0] & 0x02) && time_frame_index < sizeof(time_frame)) {
+        if (time_frame_index == 0) {
+            uint32_t t = (uint32_t)current_tick() & 0xFFFFFF;
+            time_frame[0] = 0x44;
+            time_frame[1] = (uint8_t)t;
+            time_frame[2] = (uint8_t)(t >> 8);
+            time_frame[3] = (uint8_t)(t >> 16);
+        }
+        return time_frame[time_frame_index++];
+    }
+    return 0x80;
+}
+
+static uint8_t read_reg(uint8_t reg) {
+    uint8_t val;
+
+    switch (reg) {
+        case REG_ACC_X:
+            if (regs[REG_STATUS] & STATUS_DRDY_ACC) {
+                regs[REG_STATUS] &= ~STATUS_DRDY_ACC;
+                read_out(data_produced);
+            }
+            return regs[reg];
+        case REG_GYR_X:
+            regs[REG_STATUS] &= ~STATUS_DRDY_GYR;
+            return regs[reg];
+        case REG_SENSORTIME:
+            // Reading the first byte latches the other two
+            sens_latch = (uint32_t)current_tick() & 0xFFFFFF;
+            return (uint8_t)sens_latch;
+        case REG_SENSORTIME + 1:
+            return (uint8_t)(sens_latch >> 8);
+        case REG_SENSORTIME + 2:
+            return (uint8_t)(sens_latch >> 16);
+        // fifo_err and aux_err clear on read, the error code and fatal_err don't
+        case REG_ERR:
+            val = regs[reg];
+            regs[reg] &= 0x3F;
+            return val;
+        case REG_INT_STATUS_0:
+        case REG_INT_STATUS_1:
+            val = regs[reg];
+            regs[reg] = 0;
+            return val;
+        case REG_FIFO_LENGTH_0:
+            return (uint8_t)fifo_fill;
+        case REG_FIFO_LENGTH_1:
+            return (uint8_t)(fifo_fill >> 8) & 0x3F;
+        case REG_FIFO_DATA:
+            return fifo_pop();
+        case REG_INIT_DATA:
+            return config[init_addr++ % CONFIG_SIZE];
+        default:
+            if (reg >= REG_FEATURES && reg < REG_FEATURES + 16) {
+                return features[regs[REG_FEAT_PAGE] & 0x07][reg - REG_FEATURES];
+            }
+            return regs[reg];
+    }
+}
+
+static void write_reg(uint8_t reg, uint8_t val) {
+    if (reg >= REG_FEATURES && reg < REG_FEATURES + 16) {
+        features[regs[REG_FEAT_PAGE] & 0x07][reg - REG_FEATURES] = val;
+        return;
+    }
+    if (reg < REG_ACC_CONF && reg != REG_FEAT_PAGE) {
+        // Read-only
+        return;
+    }
+
+    switch (reg) {
+        case REG_CMD:
+            if (val == 0xB6) {
+                memset(config, 0, sizeof(config));
+                reset_registers();
+            } else if (val == 0xB0) {
+                fifo_fill = 0;
+                frames_count = 0;
+                update_int1();
+            }
+            return;
+        case REG_INIT_DATA:
+            config[init_addr++ % CONFIG_SIZE] = val;
+            return;
+        default:
+            break;
+    }
+
+    regs[reg] = val;
+    switch (reg) {
+        case REG_ACC_CONF:
+        case REG_GYR_CONF:
+        case REG_PWR_CTRL:
+            reschedule();
+            break;
+        case REG_INIT_ADDR_0:
+        case REG_INIT_ADDR_1:
+            init_addr = (uint16_t)(((regs[REG_INIT_ADDR_0] & 0x0F) | ((uint16_t)regs[REG_INIT_ADDR_1] << 4)) * 2);
+            break;
+        case REG_INIT_CTRL:
+            if (val & 0x01) {
+                load_at = hal_host_now_ps() + LOAD_TIME_PS;
+            }
+            break;
+        case REG_FIFO_WTM_0:
+        case REG_FIFO_WTM_1:
+        case REG_INT1_IO_CTRL:
+        case REG_INT_MAP_DATA:
+            update_int1();
+            break;
+        default:
+            break;
+    }
+}
+
+/* SPI */
+
+static void spi_select(void *ctx, uint8_t sel) {
+    (void)ctx;
+    // Chip select going high once the part is up is what switches it to SPI
+    if (!sel && i2c_mode && hal_host_now_ps() >= up_at) {
+        i2c_mode = 0;
+    }
+    byte_index = 0;
+    time_frame_index = 0;
+    empty_index = 0;
+    frame_read = 0;
+    if (sel) {
+        stats.transactions += 1;
+    }
+}
+
+static uint8_t spi_transfer(void *ctx, uint8_t mosi) {
+    uint8_t miso = 0;
+    (void)ctx;
+
+    if (hal_host_now_ps() >= brown_out_at) {
+        brown_out_at = HAL_HOST_NEVER;
+        memset(config, 0, sizeof(config));
+        reset_registers();
+        up_at = hal_host_now_ps() + POWER_UP_PS;
+        i2c_mode = 1;
+        stats.brown_outs += 1;
+    }
+    if (i2c_mode) {
+        // SDO isn't driven; take the line as reading 0
+        return 0;
+    }
+
+    if (byte_index == 0) {
+        addr = mosi & 0x7F;
+        reading = mosi & 0x80;
+    } else if (reading) {
+        // The first byte after the address of a read is a dummy
+        if (byte_index > 1) {
+            miso = read_reg(addr);
+            if (addr != REG_FIFO_DATA && addr != REG_INIT_DATA) {
+                addr = (addr + 1) & 0x7F;
+            }
+        }
+    } else {
+        write_reg(addr, mosi);
+        if (addr != REG_INIT_DATA) {
+            addr = (addr + 1) & 0x7F;
+        }
+    }
+    if (byte_index < 2) {
+        byte_index += 1;
+    }
+    return miso;
+}
+
+void sim_bmi270_attach(const struct sim_bmi270_config *config_in) {
+    static const struct hal_host_spi_device dev = { spi_select, spi_transfer, NULL };
+    static const struct hal_host_hook hook = { hook_next, hook_run, NULL };
+
+    cfg = *config_in;
+    memset(&stats, 0, sizeof(stats));
+    tick_ps = NOMINAL_TICK_PS * 1000000 / (1000000 + cfg.clock_ppm);
+    noise_state = cfg.seed;
+    int1_level = 0;
+    fifo_head = 0;
+    brown_out_at = HAL_HOST_NEVER;
+    up_at = 0;
+    i2c_mode = 0;
+    memset(config, 0, sizeof(config));
+    reset_registers();
+
+    hal_host_attach_spi(EUSCI_B0_BASE, CS_PORT, CS_PIN, &dev);
+    hal_host_add_hook(&hook);
+}
+
+void sim_bmi270_get_stats(struct sim_bmi270_stats *out) {
+    *out = stats;
+    if (regs[REG_FIFO_CONFIG_1] & 0x40) {
+        out->pending = frames_count;
+    } else {
+        out->pending = (regs[REG_STATUS] & STATUS_DRDY_ACC) ? 1 : 0;
+    }
+}
+
+void sim_bmi270_brown_out(uint64_t at_ps) {
+    brown_out_at = at_ps;
+}
+
+uint64_t sim_bmi270_tick_ps(uint64_t tick) {
+    return tick * tick_ps;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+Simulated BMI270 on the host's SPI bus (chip select on P1.5, INT1 on P1.3, as on the board).
+
+It models what the firmware in this tree depends on:
+- the SPI protocol: address byte, a dummy byte on reads, auto-increment (except FIFO_DATA and
+  INIT_DATA), soft reset, and the config upload through INIT_ADDR/INIT_DATA/INIT_CTRL, which
+  only reports success if the image that arrived is the real one,
+- the 25.6 kHz sensor time counter, running off its own clock (clock_ppm lets it drift against
+  the MCU), with samples produced when sensor time is a multiple of the ODR period,
+- data registers, STATUS data-ready bits, saturation flags and the range settings, with the
+  scale, misalignment and offset errors of a real part if asked for,
+- the FIFO in header and headerless mode, with the sensortime frame read past the end, a
+  partly read frame sent again in full by the next read,
+  watermark/full status, stream or stop-on-full overflow, and flush,
+- INT1 with data-ready, watermark and FIFO-full mapped to it, non-latched,
+- a brown-out, on request: everything, the config file included, goes back to its power-on
+  state, nothing answers until the part has powered up again, and it then sits in I2C mode,
+  ignoring the bus, until chip select next goes high.
+It also reports each sample as it's read out, with how long it had been waiting in the sensor.
+Feature pages are plain storage; none of the feature engine runs.
+*/
+
+// How a part as built and mounted gets what it feels wrong: each of accel and gyro reads
+// gain * felt + bias, gain taking in the scale and misalignment of the axes and how the sensor
+// sits on the board
+struct sim_bmi270_errors {
+    double acc_gain[3][3];
+    double acc_bias_g[3];
+    double gyr_gain[3][3];
+    double gyr_bias_dps[3];
+};
+
+struct sim_bmi270_config {
+    // Sensor clock error in ppm; positive means the sensor runs fast
+    int32_t clock_ppm;
+    // Seed for the sample noise
+    uint32_t seed;
+    // Motion at time t (in seconds of sensor time); NULL for a gentle built-in wobble
+    void (*motion)(double t, double acc_g[3], double gyr_dps[3]);
+    // NULL for a perfect part, square on the board
+    const struct sim_bmi270_errors *errors;
+    // Called as each sample is read out (the data registers while fresh, or a whole FIFO frame),
+    // with how long it had been in the sensor, in ps; may be NULL
+    void (*read)(uint64_t waited_ps);
+};
+
+struct sim_bmi270_stats {
+    uint32_t samples;
+    uint32_t fifo_frames;
+    // Frames that didn't fit in the FIFO
+    uint32_t fifo_dropped;
+    uint32_t transactions;
+    uint32_t config_loads;
+    uint32_t brown_outs;
+    // Samples read out
+    uint32_t reads;
+    // Samples waiting to be read: frames in the FIFO if it's collecting accel data, otherwise
+    // whether the data registers hold one
+    uint32_t pending;
+    // Sensor time of the first sample, without the 24 bit wrap
+    uint64_t first_tick;
+};
+
+// Attach to the emulated MCU; call after hal_host_reset()
+void sim_bmi270_attach(const struct sim_bmi270_config *config);
+
+void sim_bmi270_get_stats(struct sim_bmi270_stats *stats);
+
+// Brown out as the first SPI byte at or after at_ps arrives
+void sim_bmi270_brown_out(uint64_t at_ps);
+
+// Virtual time at which sensor time (without the wrap) reaches tick
+uint64_t sim_bmi270_tick_ps(uint64_t tick);
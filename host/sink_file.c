@@ -0,0 +1,44 @@
+/*
+The host file sink (../sink.h): records go to the file run.c opens for -O.
+*/
+
+#include <stdio.h>
+#include "../sink.h"
+#include "sink_file.h"
+
+static FILE *out;
+
+void sink_file_open(FILE *file) {
+    out = file;
+}
+
+static uint8_t file_writev(struct sink *sink, const struct sink_vec *vec, uint8_t n) {
+    uint16_t len = 0;
+    uint8_t i;
+
+    if (!out) {
+        return SINK_FULL;
+    }
+    for (i = 0; i < n; i += 1) {
+        if (fwrite(vec[i].buf, 1, vec[i].len, out) != vec[i].len) {
+            return SINK_FULL;
+        }
+        len += vec[i].len;
+    }
+    sink->stats.records += 1;
+    sink->stats.bytes += len;
+    return SINK_OK;
+}
+
+static void file_wait(struct sink *sink) {
+    (void)sink;
+}
+
+static void file_flush(struct sink *sink) {
+    (void)sink;
+    if (out) {
+        fflush(out);
+    }
+}
+
+struct sink sink_file = { "file", file_writev, file_wait, file_flush, { 0 } };
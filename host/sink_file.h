@@ -0,0 +1,6 @@
+#pragma once
+
+#include <stdio.h>
+
+// Where sink_file writes; records are dropped until this is called
+void sink_file_open(FILE *file);
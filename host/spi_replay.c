@@ -0,0 +1,166 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <driverlib.h>
+#include "hal_host.h"
+#include "spi_replay.h"
+#include "../BMI270_SensorAPI/bmi2.h"
+#include "../bmi270_int.h"
+#include "../bmi270_spi.h"
+#include "../spi_trace.h"
+#include "../mem_watch.h"
+
+static struct spi_replay_config cfg;
+static struct spi_replay_stats stats;
+static struct bmi270_spi_stats spi_stats;
+
+// The record the next transaction has to match
+static struct spi_trace_record next;
+static uint8_t have_next;
+
+// Wall-clock time of the first record, for original timing
+static struct timespec start;
+
+static void advance(void) {
+    have_next = (spi_trace_next(cfg.trace, &next) == 0);
+    if (have_next) {
+        hal_host_set_input(BMI_INT1_PORT, BMI_INT1_PIN, (next.flags & SPI_TRACE_INT1) != 0);
+    }
+}
+
+static void wait_until(uint32_t time_us) {
+    uint64_t ns = (uint64_t)time_us * 1000;
+    struct timespec due = start;
+
+    if (stats.records == 0) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        return;
+    }
+    due.tv_sec += ns / 1000000000ULL;
+    due.tv_nsec += ns % 1000000000ULL;
+    if (due.tv_nsec >= 1000000000L) {
+        due.tv_sec += 1;
+        due.tv_nsec -= 1000000000L;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL) == EINTR);
+}
+
+static void diverged(const char *what, uint8_t reg_addr, uint8_t read, uint32_t len) {
+    fprintf(stderr, "replay: diverged at record %u: firmware did a %s of %u bytes at 0x%02x, ",
+        stats.records, read ? "read" : "write", len, reg_addr);
+    if (have_next) {
+        fprintf(stderr, "trace has a %s of %u bytes at 0x%02x (%s)\n",
+            (next.flags & SPI_TRACE_READ) ? "read" : "write", next.len, next.reg_addr, what);
+    } else {
+        fprintf(stderr, "trace has ended\n");
+    }
+    exit(2);
+}
+
+// Checks the transaction against the next record, and waits for its time if need be
+static const struct spi_trace_record *take(uint8_t reg_addr, uint8_t read, uint32_t len) {
+    if (!have_next && (cfg.trace->flags & SPI_TRACE_OVERFLOWED)) {
+        cfg.ended();
+    }
+    if (!have_next) {
+        diverged("", reg_addr, read, len);
+    }
+    if (next.reg_addr != reg_addr) {
+        diverged("different register", reg_addr, read, len);
+    }
+    if (((next.flags & SPI_TRACE_READ) != 0) != read) {
+        diverged("different direction", reg_addr, read, len);
+    }
+    if (next.len != len) {
+        diverged("different length", reg_addr, read, len);
+    }
+    if (cfg.original_timing) {
+        wait_until(next.time_us);
+    }
+    return &next;
+}
+
+static BMI2_INTF_RETURN_TYPE finish(const struct spi_trace_record *rec) {
+    uint8_t failed = (rec->flags & SPI_TRACE_FAILED) != 0;
+
+    stats.records += 1;
+    stats.bytes += rec->len;
+    spi_stats.transactions += 1;
+    if (failed) {
+        stats.failed += 1;
+        spi_stats.timeouts += 1;
+    }
+    advance();
+    return failed ? BMI2_SPI_E_TIMEOUT : BMI2_INTF_RET_SUCCESS;
+}
+
+void spi_replay_start(const struct spi_replay_config *config) {
+    cfg = *config;
+    memset(&stats, 0, sizeof(stats));
+    memset(&spi_stats, 0, sizeof(spi_stats));
+    advance();
+}
+
+uint32_t spi_replay_remaining(void) {
+    struct spi_trace_record rec;
+    uint32_t left = have_next;
+
+    while (spi_trace_next(cfg.trace, &rec) == 0) {
+        left += 1;
+    }
+    have_next = 0;
+    return left;
+}
+
+void spi_replay_get_stats(struct spi_replay_stats *out) {
+    *out = stats;
+}
+
+/* What ../bmi270_spi.c provides */
+
+void init_spi(void) {
+}
+
+void bmi2_delay_us(uint32_t period, void *intf_ptr) {
+    (void)period;
+    (void)intf_ptr;
+}
+
+BMI2_INTF_RETURN_TYPE bmi2_spi_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr) {
+    const struct spi_trace_record *rec = take(reg_addr, 1, len);
+
+    (void)intf_ptr;
+    memcpy(reg_data, rec->payload, len);
+    return finish(rec);
+}
+
+BMI2_INTF_RETURN_TYPE bmi2_spi_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, void *intf_ptr) {
+    const struct spi_trace_record *rec = take(reg_addr, 0, len);
+
+    (void)intf_ptr;
+    if (memcmp(reg_data, rec->payload, len) != 0) {
+        stats.write_mismatches += 1;
+    }
+    return finish(rec);
+}
+
+void init_bmi_device(struct bmi2_dev *bmi) {
+    bmi->intf = BMI2_SPI_INTF;
+    bmi->read = bmi2_spi_read;
+    bmi->write = bmi2_spi_write;
+    bmi->delay_us = bmi2_delay_us;
+    bmi->intf_ptr = NULL;
+    bmi->read_write_len = 46;
+    bmi->variant = NULL;
+    mem_watch_attach(bmi);
+}
+
+void bmi270_spi_recover(void) {
+    spi_stats.recoveries += 1;
+}
+
+void bmi270_spi_get_stats(struct bmi270_spi_stats *out) {
+    *out = spi_stats;
+}
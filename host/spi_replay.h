@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+#include "spi_trace_file.h"
+
+/*
+SPI backend that serves the firmware's bus transactions from a recorded trace, in place of
+../bmi270_spi.c and the simulated sensor. It provides the same functions (init_spi(),
+init_bmi_device(), bmi2_spi_read() and so on), so the firmware links against it unchanged.
+
+Each transaction has to be the one the trace has next: same register, direction and length.
+Reads get the recorded bytes, and a recorded timeout comes back as a timeout again. Writes are
+compared with what was recorded; a difference is counted, not fatal, so a change to a
+configuration value can still be replayed. Any other difference means the firmware no longer
+does what it did when the trace was taken, and the replay stops there with exit status 2.
+Running off the end of a trace that was cut short (SPI_TRACE_OVERFLOWED) isn't a divergence:
+the config's ended callback is called instead, and mustn't return.
+
+INT1 follows the trace: after each transaction it's driven high if SPI_TRACE_INT1 is set on the
+next one, and low if not, which is what wakes the FIFO and data-ready modes. A pulse that rose
+and fell between two transactions is recorded as asserted, so it comes back as a longer one,
+still with its rising edge.
+
+With original_timing set, each transaction waits until its recorded time (from the first one)
+has passed in wall-clock time; otherwise the trace is replayed as fast as the firmware can
+consume it, and bmi2_delay_us() doesn't wait either.
+*/
+
+struct spi_replay_config {
+    struct spi_trace *trace;
+    uint8_t original_timing;
+    void (*ended)(void);
+};
+
+struct spi_replay_stats {
+    uint32_t records;
+    // Payload bytes served or checked
+    uint64_t bytes;
+    uint32_t write_mismatches;
+    // Recorded timeouts served
+    uint32_t failed;
+};
+
+void spi_replay_start(const struct spi_replay_config *config);
+
+// Records the firmware didn't get to
+uint32_t spi_replay_remaining(void);
+
+void spi_replay_get_stats(struct spi_replay_stats *stats);
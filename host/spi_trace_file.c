@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "spi_trace_file.h"
+#include "../spi_trace.h"
+
+static uint32_t get_le32(const uint8_t *src) {
+    return src[0] | (src[1] << 8) | (src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+// Whether len bytes hold exactly count records
+static int records_valid(const uint8_t *buf, size_t len, uint32_t count) {
+    size_t pos = 0;
+    uint32_t i;
+
+    for (i = 0; i < count; i++) {
+        if (len - pos < SPI_TRACE_RECORD_LEN) {
+            return 0;
+        }
+        pos += SPI_TRACE_RECORD_LEN + (buf[pos + 6] | (buf[pos + 7] << 8));
+        if (pos > len) {
+            return 0;
+        }
+    }
+    return pos == len;
+}
+
+int spi_trace_load(const char *path, struct spi_trace *trace) {
+    FILE *f = fopen(path, "rb");
+    uint8_t *buf = NULL;
+    size_t size = 0, got;
+    size_t i;
+
+    memset(trace, 0, sizeof(*trace));
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    for (;;) {
+        buf = realloc(buf, size + 65536);
+        got = fread(&buf[size], 1, 65536, f);
+        size += got;
+        if (got < 65536) {
+            break;
+        }
+    }
+    fclose(f);
+
+    // The samples in front of the trace can contain "SPIT" too, so take the first header whose
+    // lengths add up
+    for (i = 0; i + SPI_TRACE_HEADER_LEN <= size; i++) {
+        const uint8_t *h = &buf[i];
+        uint32_t len, count;
+
+        if (memcmp(h, "SPIT", 4) != 0 || h[4] != SPI_TRACE_VERSION) {
+            continue;
+        }
+        len = get_le32(&h[8]);
+        count = get_le32(&h[12]);
+        if (len > size - i - SPI_TRACE_HEADER_LEN ||
+            !records_valid(&h[SPI_TRACE_HEADER_LEN], len, count)) {
+            continue;
+        }
+        trace->data = buf;
+        trace->size = size;
+        trace->flags = h[5];
+        trace->count = count;
+        trace->records = &h[SPI_TRACE_HEADER_LEN];
+        trace->records_len = len;
+        return 0;
+    }
+
+    fprintf(stderr, "%s: no SPI trace found\n", path);
+    free(buf);
+    return -1;
+}
+
+void spi_trace_free(struct spi_trace *trace) {
+    free(trace->data);
+    memset(trace, 0, sizeof(*trace));
+}
+
+int spi_trace_next(struct spi_trace *trace, struct spi_trace_record *rec) {
+    const uint8_t *src = &trace->records[trace->pos];
+
+    if (trace->pos >= trace->records_len) {
+        return -1;
+    }
+    rec->time_us = get_le32(src);
+    rec->reg_addr = src[4];
+    rec->flags = src[5];
+    rec->len = src[6] | (src[7] << 8);
+    rec->payload = &src[SPI_TRACE_RECORD_LEN];
+    trace->pos += SPI_TRACE_RECORD_LEN + rec->len;
+    return 0;
+}
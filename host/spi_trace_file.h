@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+Reader for the SPI traces spi_trace_dump() sends (format in ../spi_trace.h). The trace is
+found by its header anywhere in the file, so a capture of the whole UART output, samples and
+all, loads as it is.
+*/
+
+struct spi_trace_record {
+    uint32_t time_us;
+    uint8_t reg_addr;
+    // SPI_TRACE_* flags
+    uint8_t flags;
+    uint16_t len;
+    const uint8_t *payload;
+};
+
+struct spi_trace {
+    uint8_t *data;
+    size_t size;
+    // Header flags
+    uint8_t flags;
+    uint32_t count;
+    // Records, and where the next one starts
+    const uint8_t *records;
+    size_t records_len;
+    size_t pos;
+};
+
+// Returns 0 on success; otherwise prints why to stderr and returns -1
+int spi_trace_load(const char *path, struct spi_trace *trace);
+
+void spi_trace_free(struct spi_trace *trace);
+
+// Returns 0 and fills in rec, or -1 at the end of the trace
+int spi_trace_next(struct spi_trace *trace, struct spi_trace_record *rec);
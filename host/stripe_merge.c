@@ -0,0 +1,136 @@
+#include <string.h>
+#include "stripe_merge.h"
+#include "../sink.h"
+
+static void discard(struct stripe_lane *l, size_t n) {
+    l->len -= n;
+    memmove(l->buf, &l->buf[n], l->len);
+}
+
+// Unwrap a lane's 16 bit seq against the one due
+static uint32_t unwrap(const struct stripe_merge *m, uint16_t seq) {
+    return m->expected + (uint32_t)(int32_t)(int16_t)(seq - (uint16_t)m->expected);
+}
+
+// Take whole frames off the front of lane's bytes, into its queue
+static void parse(struct stripe_merge *m, uint8_t lane) {
+    struct stripe_lane *l = &m->lanes[lane];
+    size_t frame;
+    uint16_t seq;
+    uint8_t *slot;
+
+    while (l->len >= SINK_STRIPE_HEADER && l->count < STRIPE_MERGE_QUEUE) {
+        frame = SINK_STRIPE_HEADER + l->buf[3];
+        seq = l->buf[1] | (l->buf[2] << 8);
+        if (l->buf[0] != SINK_STRIPE_SYNC || l->buf[3] == 0 ||
+            (l->synced && (uint16_t)(seq - l->last_seq - 1) >= 0x8000)) {
+            m->stats.resync_bytes[lane] += 1;
+            discard(l, 1);
+            continue;
+        }
+        if (l->len < frame + (l->ended ? 0 : 1)) {
+            // Wait for the byte after it, unless there won't be one
+            if (!l->ended) {
+                return;
+            }
+            m->stats.resync_bytes[lane] += l->len;
+            discard(l, l->len);
+            return;
+        }
+        if (l->len > frame && l->buf[frame] != SINK_STRIPE_SYNC) {
+            m->stats.resync_bytes[lane] += 1;
+            discard(l, 1);
+            continue;
+        }
+
+        slot = l->queue[(l->head + l->count) % STRIPE_MERGE_QUEUE];
+        memcpy(slot, l->buf, frame);
+        l->queue_seq[(l->head + l->count) % STRIPE_MERGE_QUEUE] = m->started ? unwrap(m, seq) : seq;
+        l->count += 1;
+        l->synced = 1;
+        l->last_seq = seq;
+        discard(l, frame);
+    }
+}
+
+// Hand on every frame that's due, skipping those that can't come any more. With force, a
+// lane with nothing yet isn't waited for.
+static void merge(struct stripe_merge *m, uint8_t force) {
+    struct stripe_lane *l;
+    uint32_t lowest, seq;
+    uint8_t i, found, idle;
+    uint8_t *frame;
+
+    for (;;) {
+        found = idle = 0;
+        lowest = UINT32_MAX;
+        for (i = 0; i < STRIPE_MERGE_LANES && !found; i++) {
+            l = &m->lanes[i];
+            if (l->count == 0) {
+                // Nothing yet from a lane that's still going, so what's due may be on its way
+                idle |= !l->ended;
+                continue;
+            }
+            seq = l->queue_seq[l->head];
+            if (m->started && seq <= m->expected) {
+                // Due, or already skipped as lost
+                frame = l->queue[l->head];
+                l->head = (l->head + 1) % STRIPE_MERGE_QUEUE;
+                l->count -= 1;
+                if (seq == m->expected) {
+                    m->stats.frames += 1;
+                    m->expected += 1;
+                    m->callback(&frame[SINK_STRIPE_HEADER], frame[3], m->ctx);
+                }
+                found = 1;
+            } else if (seq < lowest) {
+                lowest = seq;
+            }
+        }
+        if (found) {
+            continue;
+        }
+        if (lowest == UINT32_MAX || (idle && !force)) {
+            return;
+        }
+        if (m->started) {
+            m->stats.lost += lowest - m->expected;
+        }
+        m->started = 1;
+        m->expected = lowest;
+    }
+}
+
+void stripe_merge_init(struct stripe_merge *m, stripe_merge_callback callback, void *ctx) {
+    memset(m, 0, sizeof(*m));
+    m->callback = callback;
+    m->ctx = ctx;
+}
+
+void stripe_merge_put(struct stripe_merge *m, uint8_t lane, uint8_t byte) {
+    struct stripe_lane *l = &m->lanes[lane];
+
+    l->buf[l->len] = byte;
+    l->len += 1;
+    parse(m, lane);
+    merge(m, 0);
+    if (l->count == STRIPE_MERGE_QUEUE && l->len >= STRIPE_MERGE_FRAME) {
+        // Fed on with a full queue: stop waiting for the other lane
+        merge(m, 1);
+        parse(m, lane);
+    }
+}
+
+uint8_t stripe_merge_room(const struct stripe_merge *m, uint8_t lane) {
+    return m->lanes[lane].count < STRIPE_MERGE_QUEUE;
+}
+
+void stripe_merge_end(struct stripe_merge *m, uint8_t lane) {
+    uint8_t i;
+
+    m->lanes[lane].ended = 1;
+    for (i = 0; i < STRIPE_MERGE_LANES; i++) {
+        parse(m, i);
+    }
+    merge(m, 0);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+Puts sink_stripe's two UART streams (../sink.h) back together: frames are picked out of each
+lane's bytes and handed on in seq order, payload only, so what comes out is what dump_samples()
+would have sent down a single UART.
+
+Each lane carries its frames in seq order, so once both lanes have a frame waiting (or have
+ended) and neither is the next one due, the frames in between are taken as lost and skipped.
+A lane that gets STRIPE_MERGE_QUEUE frames ahead of the other stops waiting for it too; a
+reader that can hold back (stripe_merge_room()) only lets that happen when the other lane has
+gone quiet.
+
+A frame is taken once the byte after it is another frame's sync byte, or at the end of the
+stream; a frame that doesn't check out (the wrong sync byte after it, or a seq going backwards
+on its lane) is resynced past a byte at a time.
+*/
+
+#define STRIPE_MERGE_LANES 2
+// Frames held per lane while the other lane catches up
+#define STRIPE_MERGE_QUEUE 16
+#define STRIPE_MERGE_FRAME (4 + 255)
+
+typedef void (*stripe_merge_callback)(const uint8_t *payload, size_t len, void *ctx);
+
+struct stripe_merge_stats {
+    uint32_t frames;
+    // Frames skipped over in seq
+    uint32_t lost;
+    // Bytes thrown away while finding the frames again, per lane
+    uint32_t resync_bytes[STRIPE_MERGE_LANES];
+};
+
+struct stripe_lane {
+    uint8_t buf[2 * STRIPE_MERGE_FRAME];
+    size_t len;
+    uint8_t synced;
+    uint8_t ended;
+    uint16_t last_seq;
+    // Frames parsed and not yet handed on
+    uint8_t queue[STRIPE_MERGE_QUEUE][STRIPE_MERGE_FRAME];
+    uint32_t queue_seq[STRIPE_MERGE_QUEUE];
+    uint8_t head, count;
+};
+
+struct stripe_merge {
+    stripe_merge_callback callback;
+    void *ctx;
+    struct stripe_lane lanes[STRIPE_MERGE_LANES];
+    uint8_t started;
+    // Next seq due, unwrapped
+    uint32_t expected;
+    struct stripe_merge_stats stats;
+};
+
+void stripe_merge_init(struct stripe_merge *m, stripe_merge_callback callback, void *ctx);
+
+void stripe_merge_put(struct stripe_merge *m, uint8_t lane, uint8_t byte);
+
+// Whether lane can take more bytes without giving up on the other lane
+uint8_t stripe_merge_room(const struct stripe_merge *m, uint8_t lane);
+
+// End of one lane's stream
+void stripe_merge_end(struct stripe_merge *m, uint8_t lane);
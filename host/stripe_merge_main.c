@@ -0,0 +1,96 @@
+/*
+Merges the two UARTs of a SINK_STRIPE build (../sink.h) back into one stream on stdout, in the
+format dump_samples() was built with, for uart_decode. Serial ports, ptys and files all work;
+a tty is put in raw mode first.
+
+usage: stripe_merge a1_path a0_path
+  e.g. stripe_merge build/uart.bin build/uart_a0.bin | build/uart_decode -f bin
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <termios.h>
+#include <unistd.h>
+#include "stripe_merge.h"
+
+// How long a lane that's got ahead waits for the other before giving up on its frames
+#define QUIET_MS 1000
+
+static void write_payload(const uint8_t *payload, size_t len, void *ctx) {
+    (void)ctx;
+    fwrite(payload, 1, len, stdout);
+}
+
+int main(int argc, char **argv) {
+    struct stripe_merge m;
+    struct pollfd fds[STRIPE_MERGE_LANES];
+    struct termios tio;
+    uint8_t buf[STRIPE_MERGE_LANES][256];
+    // Bytes read from each lane and not yet fed to the merge
+    ssize_t got[STRIPE_MERGE_LANES] = { 0 }, used[STRIPE_MERGE_LANES] = { 0 };
+    uint8_t lane, open_lanes = STRIPE_MERGE_LANES;
+    int ready = 1;
+
+    if (argc != 1 + STRIPE_MERGE_LANES) {
+        fprintf(stderr, "usage: %s a1_path a0_path\n", argv[0]);
+        return 1;
+    }
+    for (lane = 0; lane < STRIPE_MERGE_LANES; lane++) {
+        fds[lane].fd = open(argv[1 + lane], O_RDONLY | O_NOCTTY);
+        fds[lane].events = POLLIN;
+        if (fds[lane].fd < 0) {
+            perror(argv[1 + lane]);
+            return 1;
+        }
+        if (isatty(fds[lane].fd) && tcgetattr(fds[lane].fd, &tio) == 0) {
+            cfmakeraw(&tio);
+            tcsetattr(fds[lane].fd, TCSANOW, &tio);
+        }
+    }
+
+    stripe_merge_init(&m, write_payload, NULL);
+    while (open_lanes) {
+        // Hold back a lane that's ahead, unless the last wait timed out
+        for (lane = 0; lane < STRIPE_MERGE_LANES; lane++) {
+            while (used[lane] < got[lane] && (ready == 0 || stripe_merge_room(&m, lane))) {
+                stripe_merge_put(&m, lane, buf[lane][used[lane]++]);
+            }
+            fds[lane].events = (used[lane] == got[lane]) ? POLLIN : 0;
+        }
+        ready = poll(fds, STRIPE_MERGE_LANES, QUIET_MS);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("poll");
+            return 1;
+        }
+        for (lane = 0; lane < STRIPE_MERGE_LANES; lane++) {
+            // Hang-ups are reported whether asked for or not
+            if (fds[lane].fd < 0 || !fds[lane].revents || used[lane] < got[lane]) {
+                continue;
+            }
+            got[lane] = read(fds[lane].fd, buf[lane], sizeof(buf[lane]));
+            used[lane] = 0;
+            if (got[lane] < 0 && errno == EINTR) {
+                got[lane] = 0;
+                continue;
+            }
+            // A pty whose other end has gone away reads as EIO
+            if (got[lane] <= 0) {
+                got[lane] = 0;
+                close(fds[lane].fd);
+                fds[lane].fd = -1;
+                open_lanes -= 1;
+                stripe_merge_end(&m, lane);
+            }
+        }
+    }
+    fflush(stdout);
+
+    fprintf(stderr, "stripe_merge: %u frames, %u lost, %u/%u bytes resynced\n",
+        m.stats.frames, m.stats.lost, m.stats.resync_bytes[0], m.stats.resync_bytes[1]);
+    return 0;
+}
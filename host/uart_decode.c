@@ -0,0 +1,498 @@
+#include <stdio.h>
+#include <string.h>
+#include "uart_decode.h"
+#include "../dma_dump.h"
+#include "../rtc_anchor.h"
+#include "../autorange.h"
+#include "../shock.h"
+#include "../health.h"
+
+#define BINARY_RECORD_LEN 16
+
+struct frame {
+    uint32_t index;
+    uint32_t sens;
+    int16_t acc[3];
+    int16_t gyr[3];
+};
+
+static uint32_t index_mask(const struct uart_decoder *dec) {
+    return (dec->format == UART_DECODE_BINARY) ? 0xFFFF : 0xFFFFFFFF;
+}
+
+static uint32_t sens_mask(const struct uart_decoder *dec) {
+    return (dec->format == UART_DECODE_BINARY) ? 0xFFFF : 0xFFFFFF;
+}
+
+// Length of the frame starting at buf[start], or 0 if it hasn't all arrived yet
+static size_t frame_len(const struct uart_decoder *dec, size_t start) {
+    size_t avail = dec->len - start;
+    size_t i;
+
+    if (dec->format == UART_DECODE_BINARY) {
+        return (avail >= BINARY_RECORD_LEN) ? BINARY_RECORD_LEN : 0;
+    }
+    for (i = 0; i < avail && i < UART_DECODE_MAX_LINE; i++) {
+        if (dec->buf[start + i] == '\n') {
+            return i + 1;
+        }
+    }
+    // Too long for a line: hand it over whole, to be thrown away
+    return (avail >= UART_DECODE_MAX_LINE) ? UART_DECODE_MAX_LINE : 0;
+}
+
+static int16_t get_le16(const uint8_t *src) {
+    return (int16_t)(src[0] | (src[1] << 8));
+}
+
+static int parse(const struct uart_decoder *dec, size_t start, size_t len, struct frame *f) {
+    const uint8_t *src = &dec->buf[start];
+    char line[UART_DECODE_MAX_LINE + 1];
+    unsigned long index, sens;
+    int acc[3], gyr[3];
+    int used = -1;
+    uint8_t i;
+
+    if (dec->format == UART_DECODE_BINARY) {
+        f->index = src[0] | (src[1] << 8);
+        f->sens = src[2] | (src[3] << 8);
+        for (i = 0; i < 3; i++) {
+            f->acc[i] = get_le16(&src[4 + 2 * i]);
+            f->gyr[i] = get_le16(&src[10 + 2 * i]);
+        }
+        return 1;
+    }
+
+    memcpy(line, src, len);
+    line[len] = '\0';
+    if (sscanf(line, "%lu, %lu, %d, %d, %d, %d, %d, %d%n", &index, &sens,
+            &acc[0], &acc[1], &acc[2], &gyr[0], &gyr[1], &gyr[2], &used) != 8 ||
+        strcmp(&line[used], "\r\n") != 0 || sens > 0xFFFFFF) {
+        return 0;
+    }
+    f->index = (uint32_t)index;
+    f->sens = (uint32_t)sens;
+    for (i = 0; i < 3; i++) {
+        if (acc[i] < INT16_MIN || acc[i] > INT16_MAX || gyr[i] < INT16_MIN || gyr[i] > INT16_MAX) {
+            return 0;
+        }
+        f->acc[i] = (int16_t)acc[i];
+        f->gyr[i] = (int16_t)gyr[i];
+    }
+    return 1;
+}
+
+// Whether a DMA dump's block marker starts at buf[start]. A record can start with the same four
+// bytes, so one at the front that carries the expected index is left to be a record.
+static int marker_at(const struct uart_decoder *dec, size_t start) {
+    const uint8_t *src = &dec->buf[start];
+
+    if (dec->format != UART_DECODE_BINARY || dec->len - start < DMA_DUMP_MARKER_LEN ||
+        src[0] != DMA_DUMP_SYNC0 || src[1] != DMA_DUMP_SYNC1 || (src[2] ^ src[3]) != 0xFF) {
+        return 0;
+    }
+    return start != 0 || !dec->synced || (uint32_t)(src[0] | (src[1] << 8)) != (dec->expected & 0xFFFF);
+}
+
+// Length of an RTC anchor starting at buf[start], or 0 if there isn't a whole one there; as
+// with the markers, a binary one at the front that could be the expected record is left to be
+// a record
+static size_t anchor_at(const struct uart_decoder *dec, size_t start, struct uart_decode_anchor *a) {
+    const uint8_t *src = &dec->buf[start];
+    char line[UART_DECODE_MAX_LINE + 1];
+    unsigned long next, sens, utc;
+    unsigned subsec, flags;
+    int used = -1;
+    uint8_t sum = 0;
+    size_t n, i;
+
+    if (dec->format == UART_DECODE_BINARY) {
+        n = RTC_ANCHOR_LEN;
+        if (dec->len - start < n || src[0] != RTC_ANCHOR_SYNC0 || src[1] != RTC_ANCHOR_SYNC1) {
+            return 0;
+        }
+        for (i = 0; i < n; i++) {
+            sum += src[i];
+        }
+        if (sum != 0xFF ||
+            (start == 0 && dec->synced && (uint32_t)(src[0] | (src[1] << 8)) == (dec->expected & 0xFFFF))) {
+            return 0;
+        }
+        next = src[2] | (src[3] << 8);
+        sens = src[4] | (src[5] << 8) | ((unsigned long)src[6] << 16);
+        utc = src[8] | (src[9] << 8) | ((unsigned long)src[10] << 16) | ((unsigned long)src[11] << 24);
+        subsec = src[12] | (src[13] << 8);
+        flags = src[14];
+        if (dec->synced) {
+            // Unwrap next against the record due, which it's at most a little way from
+            next = dec->expected + (uint32_t)(int32_t)(int16_t)(next - (uint16_t)dec->expected);
+        }
+    } else {
+        n = frame_len(dec, start);
+        if (n == 0 || src[0] != '@') {
+            return 0;
+        }
+        memcpy(line, src, n);
+        line[n] = '\0';
+        if (sscanf(line, "@, %lu, %lu, %lu, %u, %u%n", &next, &sens, &utc, &subsec, &flags, &used) != 5 ||
+            strcmp(&line[used], "\r\n") != 0) {
+            return 0;
+        }
+    }
+    if (sens > 0xFFFFFF || subsec >= RTC_ANCHOR_SUBSEC_HZ || flags > 0xFF) {
+        return 0;
+    }
+    if (a) {
+        a->next = (uint32_t)next;
+        a->sens_time = (uint32_t)sens;
+        a->utc = (uint32_t)utc;
+        a->subsec = (uint16_t)subsec;
+        a->flags = (uint8_t)flags;
+        a->arrival = dec->buf_arrival[start + n - 1];
+    }
+    return n;
+}
+
+// Length of a range change starting at buf[start], or 0 if there isn't a whole one there, as
+// for the anchors
+static size_t range_at(const struct uart_decoder *dec, size_t start, struct uart_decode_range *r) {
+    const uint8_t *src = &dec->buf[start];
+    char line[UART_DECODE_MAX_LINE + 1];
+    unsigned long next, sens;
+    unsigned acc_g, gyr_dps;
+    int used = -1;
+    uint8_t sum = 0;
+    size_t n, i;
+
+    if (dec->format == UART_DECODE_BINARY) {
+        n = AUTORANGE_LEN;
+        if (dec->len - start < n || src[0] != AUTORANGE_SYNC0 || src[1] != AUTORANGE_SYNC1) {
+            return 0;
+        }
+        for (i = 0; i < n; i++) {
+            sum += src[i];
+        }
+        if (sum != 0xFF || src[7] > 3 || src[8] > 4 ||
+            (start == 0 && dec->synced && (uint32_t)(src[0] | (src[1] << 8)) == (dec->expected & 0xFFFF))) {
+            return 0;
+        }
+        next = src[2] | (src[3] << 8);
+        sens = src[4] | (src[5] << 8) | ((unsigned long)src[6] << 16);
+        acc_g = 2u << src[7];
+        gyr_dps = 2000u >> src[8];
+        if (dec->synced) {
+            next = dec->expected + (uint32_t)(int32_t)(int16_t)(next - (uint16_t)dec->expected);
+        }
+    } else {
+        n = frame_len(dec, start);
+        if (n == 0 || src[0] != '!') {
+            return 0;
+        }
+        memcpy(line, src, n);
+        line[n] = '\0';
+        if (sscanf(line, "!, %lu, %lu, %u, %u%n", &next, &sens, &acc_g, &gyr_dps, &used) != 4 ||
+            strcmp(&line[used], "\r\n") != 0 || acc_g > 16 || gyr_dps > 2000) {
+            return 0;
+        }
+    }
+    if (sens > 0xFFFFFF) {
+        return 0;
+    }
+    if (r) {
+        r->next = (uint32_t)next;
+        r->sens_time = (uint32_t)sens;
+        r->acc_g = (uint8_t)acc_g;
+        r->gyr_dps = (uint16_t)gyr_dps;
+        r->arrival = dec->buf_arrival[start + n - 1];
+    }
+    return n;
+}
+
+// Length of a shock event starting at buf[start], or 0 if there isn't a whole one there, as for
+// the anchors
+static size_t shock_at(const struct uart_decoder *dec, size_t start, struct uart_decode_shock *e) {
+    const uint8_t *src = &dec->buf[start];
+    char line[UART_DECODE_MAX_LINE + 1];
+    unsigned long first, sens;
+    unsigned count, peak;
+    int used = -1;
+    uint8_t sum = 0;
+    size_t n, i;
+
+    if (dec->format == UART_DECODE_BINARY) {
+        n = SHOCK_LEN;
+        if (dec->len - start < n || src[0] != SHOCK_SYNC0 || src[1] != SHOCK_SYNC1) {
+            return 0;
+        }
+        for (i = 0; i < n; i++) {
+            sum += src[i];
+        }
+        if (sum != 0xFF ||
+            (start == 0 && dec->synced && (uint32_t)(src[0] | (src[1] << 8)) == (dec->expected & 0xFFFF))) {
+            return 0;
+        }
+        first = src[2] | (src[3] << 8);
+        sens = src[4] | (src[5] << 8) | ((unsigned long)src[6] << 16);
+        count = src[7] | (src[8] << 8);
+        peak = src[9] | (src[10] << 8);
+        if (dec->synced) {
+            first = dec->expected + (uint32_t)(int32_t)(int16_t)(first - (uint16_t)dec->expected);
+        }
+    } else {
+        n = frame_len(dec, start);
+        if (n == 0 || src[0] != '^') {
+            return 0;
+        }
+        memcpy(line, src, n);
+        line[n] = '\0';
+        if (sscanf(line, "^, %lu, %lu, %u, %u%n", &first, &sens, &count, &peak, &used) != 4 ||
+            strcmp(&line[used], "\r\n") != 0 || count > 0xFFFF || peak > 0xFFFF) {
+            return 0;
+        }
+    }
+    if (sens > 0xFFFFFF || count == 0) {
+        return 0;
+    }
+    if (e) {
+        e->first = (uint32_t)first;
+        e->sens_time = (uint32_t)sens;
+        e->count = (uint16_t)count;
+        e->peak_mg = (uint16_t)peak;
+        e->arrival = dec->buf_arrival[start + n - 1];
+    }
+    return n;
+}
+
+// Length of a health event starting at buf[start], or 0 if there isn't a whole one there, as
+// for the anchors
+static size_t health_at(const struct uart_decoder *dec, size_t start, struct uart_decode_health *h) {
+    const uint8_t *src = &dec->buf[start];
+    char line[UART_DECODE_MAX_LINE + 1];
+    unsigned long next;
+    unsigned regs[4];
+    int used = -1;
+    uint8_t sum = 0;
+    size_t n, i;
+
+    if (dec->format == UART_DECODE_BINARY) {
+        n = HEALTH_LEN;
+        if (dec->len - start < n || src[0] != HEALTH_SYNC0 || src[1] != HEALTH_SYNC1) {
+            return 0;
+        }
+        for (i = 0; i < n; i++) {
+            sum += src[i];
+        }
+        if (sum != 0xFF ||
+            (start == 0 && dec->synced && (uint32_t)(src[0] | (src[1] << 8)) == (dec->expected & 0xFFFF))) {
+            return 0;
+        }
+        next = src[2] | (src[3] << 8);
+        for (i = 0; i < 4; i++) {
+            regs[i] = src[4 + i];
+        }
+        if (dec->synced) {
+            next = dec->expected + (uint32_t)(int32_t)(int16_t)(next - (uint16_t)dec->expected);
+        }
+    } else {
+        n = frame_len(dec, start);
+        if (n == 0 || src[0] != '#') {
+            return 0;
+        }
+        memcpy(line, src, n);
+        line[n] = '\0';
+        if (sscanf(line, "#, %lu, %u, %u, %u, %u%n", &next, &regs[0], &regs[1], &regs[2], &regs[3],
+                &used) != 5 ||
+            strcmp(&line[used], "\r\n") != 0 || (regs[0] | regs[1] | regs[2] | regs[3]) > 0xFF) {
+            return 0;
+        }
+    }
+    if (h) {
+        h->next = (uint32_t)next;
+        h->err = (uint8_t)regs[0];
+        h->status = (uint8_t)regs[1];
+        h->saturation = (uint8_t)regs[2];
+        h->internal_err = (uint8_t)regs[3];
+        h->arrival = dec->buf_arrival[start + n - 1];
+    }
+    return n;
+}
+
+// Length of the markers, anchors, range changes and shock and health events at buf[start]
+static size_t skip_at(const struct uart_decoder *dec, size_t start) {
+    size_t n, skip = 0;
+
+    for (;;) {
+        if (marker_at(dec, start + skip)) {
+            skip += DMA_DUMP_MARKER_LEN;
+        } else if ((n = anchor_at(dec, start + skip, NULL)) != 0 ||
+                   (n = range_at(dec, start + skip, NULL)) != 0 ||
+                   (n = shock_at(dec, start + skip, NULL)) != 0 ||
+                   (n = health_at(dec, start + skip, NULL)) != 0) {
+            skip += n;
+        } else {
+            return skip;
+        }
+    }
+}
+
+// Whether b can be the record straight after a
+static int follows(const struct uart_decoder *dec, const struct frame *a, const struct frame *b) {
+    uint32_t step = (b->sens - a->sens) & sens_mask(dec);
+    return ((b->index - a->index) & index_mask(dec)) == 1 && step != 0 && step <= sens_mask(dec) / 2;
+}
+
+// Whether f can come after the last record taken, some records later
+static int continues(const struct uart_decoder *dec, const struct frame *f) {
+    uint32_t gap = (f->index - dec->expected) & index_mask(dec);
+    uint32_t step = (f->sens - dec->last_sens) & sens_mask(dec);
+    return !dec->synced || (gap <= index_mask(dec) / 2 && step != 0 && step <= sens_mask(dec) / 2);
+}
+
+static void discard(struct uart_decoder *dec, size_t n, uint8_t resync) {
+    if (resync) {
+        dec->stats.resync_bytes += n;
+    }
+    dec->len -= n;
+    memmove(dec->buf, &dec->buf[n], dec->len);
+    memmove(dec->buf_arrival, &dec->buf_arrival[n], dec->len * sizeof(dec->buf_arrival[0]));
+}
+
+static void accept(struct uart_decoder *dec, const struct frame *f, size_t n) {
+    struct uart_decode_record rec;
+    uint32_t gap = (f->index - dec->expected) & index_mask(dec);
+
+    if (dec->stats.records == 0) {
+        dec->sens_time = f->sens;
+    } else {
+        dec->sens_time += (f->sens - dec->last_sens) & sens_mask(dec);
+    }
+    dec->last_sens = f->sens;
+
+    rec.index = dec->expected + gap;
+    rec.sens_time = dec->sens_time;
+    memcpy(rec.acc, f->acc, sizeof(rec.acc));
+    memcpy(rec.gyr, f->gyr, sizeof(rec.gyr));
+    rec.arrival = dec->buf_arrival[n - 1];
+
+    dec->stats.records += 1;
+    dec->stats.lost += gap;
+    dec->expected = rec.index + 1;
+    dec->synced = 1;
+    discard(dec, n, 0);
+    dec->callback(&rec, dec->ctx);
+}
+
+static void decode(struct uart_decoder *dec, uint8_t final) {
+    size_t n0, n1, skip;
+    struct frame f0, f1;
+    struct uart_decode_anchor anchor;
+    struct uart_decode_range range;
+    struct uart_decode_shock shock;
+    struct uart_decode_health health;
+    uint8_t csv = (dec->format == UART_DECODE_CSV);
+
+    for (;;) {
+        if (marker_at(dec, 0)) {
+            dec->stats.blocks += 1;
+            discard(dec, DMA_DUMP_MARKER_LEN, 0);
+            continue;
+        }
+        if ((n0 = anchor_at(dec, 0, &anchor)) != 0) {
+            dec->stats.anchors += 1;
+            discard(dec, n0, 0);
+            if (dec->anchor_callback) {
+                dec->anchor_callback(&anchor, dec->ctx);
+            }
+            continue;
+        }
+        if ((n0 = range_at(dec, 0, &range)) != 0) {
+            dec->stats.ranges += 1;
+            discard(dec, n0, 0);
+            if (dec->range_callback) {
+                dec->range_callback(&range, dec->ctx);
+            }
+            continue;
+        }
+        if ((n0 = shock_at(dec, 0, &shock)) != 0) {
+            dec->stats.shocks += 1;
+            discard(dec, n0, 0);
+            if (dec->shock_callback) {
+                dec->shock_callback(&shock, dec->ctx);
+            }
+            continue;
+        }
+        if ((n0 = health_at(dec, 0, &health)) != 0) {
+            dec->stats.health += 1;
+            discard(dec, n0, 0);
+            if (dec->health_callback) {
+                dec->health_callback(&health, dec->ctx);
+            }
+            continue;
+        }
+        n0 = frame_len(dec, 0);
+        if (n0 == 0) {
+            if (final) {
+                discard(dec, dec->len, 1);
+            }
+            return;
+        }
+        if (!parse(dec, 0, n0, &f0) || !continues(dec, &f0)) {
+            discard(dec, csv ? n0 : 1, 1);
+            continue;
+        }
+        // The record after may come after any of the records skip_at() passes over
+        skip = skip_at(dec, n0);
+        n1 = frame_len(dec, n0 + skip);
+        if (n1 && parse(dec, n0 + skip, n1, &f1) && follows(dec, &f0, &f1)) {
+            accept(dec, &f0, n0);
+            continue;
+        }
+        if (dec->synced && ((f0.index - dec->expected) & index_mask(dec)) == 0 && (csv || final)) {
+            accept(dec, &f0, n0);
+            continue;
+        }
+        if (n1 == 0 && !final) {
+            return;
+        }
+        discard(dec, csv ? n0 : 1, 1);
+    }
+}
+
+void uart_decoder_init(struct uart_decoder *dec, enum uart_decode_format format,
+        uart_decode_callback callback, void *ctx) {
+    memset(dec, 0, sizeof(*dec));
+    dec->format = format;
+    dec->callback = callback;
+    dec->ctx = ctx;
+}
+
+void uart_decoder_on_anchor(struct uart_decoder *dec, uart_decode_anchor_callback callback) {
+    dec->anchor_callback = callback;
+}
+
+void uart_decoder_on_range(struct uart_decoder *dec, uart_decode_range_callback callback) {
+    dec->range_callback = callback;
+}
+
+void uart_decoder_on_shock(struct uart_decoder *dec, uart_decode_shock_callback callback) {
+    dec->shock_callback = callback;
+}
+
+void uart_decoder_on_health(struct uart_decoder *dec, uart_decode_health_callback callback) {
+    dec->health_callback = callback;
+}
+
+void uart_decoder_put(struct uart_decoder *dec, uint8_t byte, uint64_t arrival) {
+    dec->buf[dec->len] = byte;
+    dec->buf_arrival[dec->len] = arrival;
+    dec->len += 1;
+    decode(dec, 0);
+}
+
+void uart_decoder_finish(struct uart_decoder *dec) {
+    decode(dec, 1);
+}
+
+uint8_t uart_decoder_sens_bits(const struct uart_decoder *dec) {
+    return (dec->format == UART_DECODE_BINARY) ? 16 : 24;
+}
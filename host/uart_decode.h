@@ -0,0 +1,153 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+Streaming decoder for what dump_samples() in main.c sends, in either of its formats:
+- UART_DECODE_BINARY: 16 byte records (index and sens_time low 16 bits, then accel and gyro
+  x/y/z, all 16 bit little-endian),
+- UART_DECODE_CSV: "index, sens_time,  ax, ay, az,  gx, gy, gz\r\n" lines.
+
+Neither format has a sync marker or a checksum, so a record is only taken once the one after
+it confirms it (the next index, and a small step forward in sens_time), and only if it carries
+on from the last record taken; on a mismatch the decoder slides forward a byte (a line, for
+CSV) until two records agree again. A CSV record carrying the index it expects is taken
+straight away, as the line ending already frames it. A lost byte that leaves a record
+well-formed, like a dropped digit, goes undetected.
+
+A binary stream may also carry the block markers of a DMA dump (../dma_dump.h) between
+records; they're skipped and counted. Either format may carry RTC anchors (../rtc_anchor.h),
+range changes (../autorange.h), shock events (../shock.h) and health events (../health.h),
+which go to their callbacks, if there are any, rather than being taken for records.
+*/
+
+enum uart_decode_format {
+    UART_DECODE_BINARY,
+    UART_DECODE_CSV
+};
+
+struct uart_decode_record {
+    // Index in the firmware's sample buffer, without the 16 bit wrap of the binary format
+    uint32_t index;
+    // Sensor time, unwrapped from the first record's (16 or 24 bit) value onwards
+    uint64_t sens_time;
+    int16_t acc[3];
+    int16_t gyr[3];
+    // Arrival time the caller gave with the record's last byte
+    uint64_t arrival;
+};
+
+struct uart_decode_anchor {
+    // Index of the sample the anchor was taken before, without the 16 bit wrap
+    uint32_t next;
+    // Sensor time, 24 bit, as read
+    uint32_t sens_time;
+    // RTC time, in seconds since 1970-01-01 UTC and 1/32768ths
+    uint32_t utc;
+    uint16_t subsec;
+    // RTC_ANCHOR_SYNCED if the RTC had been set to the real time
+    uint8_t flags;
+    // Arrival time the caller gave with the anchor's last byte
+    uint64_t arrival;
+};
+
+struct uart_decode_range {
+    // Index of the first sample at these ranges, without the 16 bit wrap
+    uint32_t next;
+    // Sensor time, 24 bit, read after the switch
+    uint32_t sens_time;
+    // Full scale, +/- g and +/- dps
+    uint8_t acc_g;
+    uint16_t gyr_dps;
+    // Arrival time the caller gave with the record's last byte
+    uint64_t arrival;
+};
+
+struct uart_decode_shock {
+    // Index of the sample that tripped it, without the 16 bit wrap
+    uint32_t first;
+    // Its sensor time, 24 bit
+    uint32_t sens_time;
+    // Samples from first to the end of the burst
+    uint16_t count;
+    uint16_t peak_mg;
+    // Arrival time the caller gave with the record's last byte
+    uint64_t arrival;
+};
+
+struct uart_decode_health {
+    // Index of the first sample after the change, without the 16 bit wrap
+    uint32_t next;
+    // ERR_REG, STATUS (cmd_rdy and aux_busy), SATURATION and INTERNAL_ERR
+    uint8_t err;
+    uint8_t status;
+    uint8_t saturation;
+    uint8_t internal_err;
+    // Arrival time the caller gave with the record's last byte
+    uint64_t arrival;
+};
+
+struct uart_decode_stats {
+    uint32_t records;
+    // Records skipped over in the index sequence
+    uint32_t lost;
+    // Bytes thrown away while finding the records again
+    uint32_t resync_bytes;
+    // DMA dump block markers skipped
+    uint32_t blocks;
+    uint32_t anchors;
+    uint32_t ranges;
+    uint32_t shocks;
+    uint32_t health;
+};
+
+typedef void (*uart_decode_callback)(const struct uart_decode_record *record, void *ctx);
+typedef void (*uart_decode_anchor_callback)(const struct uart_decode_anchor *anchor, void *ctx);
+typedef void (*uart_decode_range_callback)(const struct uart_decode_range *range, void *ctx);
+typedef void (*uart_decode_shock_callback)(const struct uart_decode_shock *shock, void *ctx);
+typedef void (*uart_decode_health_callback)(const struct uart_decode_health *health, void *ctx);
+
+// Longest CSV line that's still taken for a record
+#define UART_DECODE_MAX_LINE 80
+
+struct uart_decoder {
+    enum uart_decode_format format;
+    uart_decode_callback callback;
+    uart_decode_anchor_callback anchor_callback;
+    uart_decode_range_callback range_callback;
+    uart_decode_shock_callback shock_callback;
+    uart_decode_health_callback health_callback;
+    void *ctx;
+    uint8_t buf[2 * UART_DECODE_MAX_LINE];
+    uint64_t buf_arrival[2 * UART_DECODE_MAX_LINE];
+    size_t len;
+    uint8_t synced;
+    uint32_t expected;
+    uint32_t last_sens;
+    uint64_t sens_time;
+    struct uart_decode_stats stats;
+};
+
+void uart_decoder_init(struct uart_decoder *dec, enum uart_decode_format format,
+    uart_decode_callback callback, void *ctx);
+
+// Have anchors handed to callback, with the same ctx as the records
+void uart_decoder_on_anchor(struct uart_decoder *dec, uart_decode_anchor_callback callback);
+
+// Have range changes handed to callback, likewise; each comes before the sample it starts at
+void uart_decoder_on_range(struct uart_decoder *dec, uart_decode_range_callback callback);
+
+// Have shock events handed to callback, likewise, each before the sample that tripped it
+void uart_decoder_on_shock(struct uart_decoder *dec, uart_decode_shock_callback callback);
+
+// Have health events handed to callback, likewise, each before the sample after the change
+void uart_decoder_on_health(struct uart_decoder *dec, uart_decode_health_callback callback);
+
+void uart_decoder_put(struct uart_decoder *dec, uint8_t byte, uint64_t arrival);
+
+// End of stream: takes the last record if it's the one expected
+void uart_decoder_finish(struct uart_decoder *dec);
+
+// Width of sens_time as sent, in bits
+uint8_t uart_decoder_sens_bits(const struct uart_decoder *dec);
@@ -0,0 +1,155 @@
+/*
+Decodes the firmware's UART output from a serial port, pty or file, and prints the samples as
+CSV on stdout. The real board's port works as well as the host build's pty. The shock events
+of a SHOCK build (../shock.h) and the health events of a HEALTH one (../health.h) are listed
+on stderr as they come.
+
+usage: uart_decode [-f bin|csv] [-u] [path]
+  -f    the format dump_samples() was built with (default bin)
+  -u    print accel in g and gyro in dps, at the ranges the range changes of an AUTORANGE
+        build (../autorange.h) give, or 2 g and 2000 dps without them, instead of LSB
+  path  where to read from (default stdin); a tty is put in raw mode first
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include "uart_decode.h"
+
+// Range changes not yet reached, and the ranges in force
+#define PENDING 64
+struct units {
+    struct uart_decode_range pending[PENDING];
+    uint8_t head, count;
+    double acc_g, gyr_dps;
+};
+
+static void add_range(const struct uart_decode_range *range, void *ctx) {
+    struct units *u = ctx;
+
+    if (u->count == PENDING) {
+        u->acc_g = u->pending[u->head].acc_g;
+        u->gyr_dps = u->pending[u->head].gyr_dps;
+        u->head = (u->head + 1) % PENDING;
+        u->count -= 1;
+    }
+    u->pending[(u->head + u->count) % PENDING] = *range;
+    u->count += 1;
+}
+
+static void print_units(const struct uart_decode_record *rec, void *ctx) {
+    struct units *u = ctx;
+    double a, g;
+
+    while (u->count && u->pending[u->head].next <= rec->index) {
+        u->acc_g = u->pending[u->head].acc_g;
+        u->gyr_dps = u->pending[u->head].gyr_dps;
+        u->head = (u->head + 1) % PENDING;
+        u->count -= 1;
+    }
+    a = u->acc_g / 32768;
+    g = u->gyr_dps / 32768;
+    printf("%u, %llu,  %.5f, %.5f, %.5f,  %.3f, %.3f, %.3f\n", rec->index, (unsigned long long)rec->sens_time,
+        rec->acc[0] * a, rec->acc[1] * a, rec->acc[2] * a, rec->gyr[0] * g, rec->gyr[1] * g, rec->gyr[2] * g);
+}
+
+static void print_shock(const struct uart_decode_shock *shock, void *ctx) {
+    (void)ctx;
+    fprintf(stderr, "uart_decode: shock at %u (sensor time %u), %u samples, peak %u mg\n",
+        shock->first, shock->sens_time, shock->count, shock->peak_mg);
+}
+
+static void print_health(const struct uart_decode_health *health, void *ctx) {
+    (void)ctx;
+    fprintf(stderr, "uart_decode: health at %u: err 0x%02x status 0x%02x saturation 0x%02x "
+        "internal_err 0x%02x\n", health->next, health->err, health->status, health->saturation,
+        health->internal_err);
+}
+
+static void print_record(const struct uart_decode_record *rec, void *ctx) {
+    (void)ctx;
+    printf("%u, %llu,  %d, %d, %d,  %d, %d, %d\n", rec->index, (unsigned long long)rec->sens_time,
+        rec->acc[0], rec->acc[1], rec->acc[2], rec->gyr[0], rec->gyr[1], rec->gyr[2]);
+}
+
+int main(int argc, char **argv) {
+    enum uart_decode_format format = UART_DECODE_BINARY;
+    struct uart_decoder dec;
+    struct units units = { .head = 0, .count = 0, .acc_g = 2, .gyr_dps = 2000 };
+    uint8_t scale = 0;
+    struct termios tio;
+    uint8_t buf[256];
+    ssize_t got, i;
+    int fd = STDIN_FILENO;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:u")) != -1) {
+        if (opt == 'u') {
+            scale = 1;
+        } else if (opt == 'f' && strcmp(optarg, "bin") == 0) {
+            format = UART_DECODE_BINARY;
+        } else if (opt == 'f' && strcmp(optarg, "csv") == 0) {
+            format = UART_DECODE_CSV;
+        } else {
+            fprintf(stderr, "usage: %s [-f bin|csv] [-u] [path]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind < argc) {
+        fd = open(argv[optind], O_RDONLY | O_NOCTTY);
+        if (fd < 0) {
+            perror(argv[optind]);
+            return 1;
+        }
+    }
+    if (isatty(fd) && tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+
+    if (scale) {
+        uart_decoder_init(&dec, format, print_units, &units);
+        uart_decoder_on_range(&dec, add_range);
+    } else {
+        uart_decoder_init(&dec, format, print_record, NULL);
+    }
+    uart_decoder_on_shock(&dec, print_shock);
+    uart_decoder_on_health(&dec, print_health);
+    for (;;) {
+        got = read(fd, buf, sizeof(buf));
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        // A pty whose other end has gone away reads as EIO
+        if (got <= 0) {
+            break;
+        }
+        for (i = 0; i < got; i++) {
+            uart_decoder_put(&dec, buf[i], 0);
+        }
+    }
+    uart_decoder_finish(&dec);
+
+    fprintf(stderr, "uart_decode: %u records, %u lost, %u bytes resynced",
+        dec.stats.records, dec.stats.lost, dec.stats.resync_bytes);
+    if (dec.stats.blocks) {
+        fprintf(stderr, ", %u DMA blocks", dec.stats.blocks);
+    }
+    if (dec.stats.anchors) {
+        fprintf(stderr, ", %u RTC anchors", dec.stats.anchors);
+    }
+    if (dec.stats.ranges) {
+        fprintf(stderr, ", %u range changes", dec.stats.ranges);
+    }
+    if (dec.stats.shocks) {
+        fprintf(stderr, ", %u shock events", dec.stats.shocks);
+    }
+    if (dec.stats.health) {
+        fprintf(stderr, ", %u health events", dec.stats.health);
+    }
+    fprintf(stderr, "\n");
+    return 0;
+}
@@ -0,0 +1,125 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include "uart_pty.h"
+
+// How long uart_pty_close() waits for the reader to catch up
+#define CLOSE_WAIT_MS 5000
+
+static struct uart_pty_config cfg;
+static struct uart_pty_stats stats;
+
+static int master = -1;
+static int slave = -1;
+static char slave_path[64];
+static uint32_t rand_state;
+
+// Wall-clock time the first byte went out at, when pacing
+static struct timespec pace_start;
+
+static uint32_t next_rand(void) {
+    // xorshift32
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+    return rand_state;
+}
+
+static void pace(void) {
+    uint64_t ns = (uint64_t)stats.bytes * 10 * 1000000000ULL / cfg.pace_baud;
+    struct timespec due = pace_start;
+
+    if (stats.bytes == 0) {
+        clock_gettime(CLOCK_MONOTONIC, &pace_start);
+        return;
+    }
+    due.tv_sec += ns / 1000000000ULL;
+    due.tv_nsec += ns % 1000000000ULL;
+    if (due.tv_nsec >= 1000000000L) {
+        due.tv_sec += 1;
+        due.tv_nsec -= 1000000000L;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL) == EINTR);
+}
+
+const char *uart_pty_open(const struct uart_pty_config *config) {
+    struct termios tio;
+
+    cfg = *config;
+    memset(&stats, 0, sizeof(stats));
+    rand_state = cfg.seed ? cfg.seed : 1;
+
+    master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (master < 0) {
+        return NULL;
+    }
+    if (grantpt(master) || unlockpt(master) || ptsname_r(master, slave_path, sizeof(slave_path))) {
+        goto fail;
+    }
+    slave = open(slave_path, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (slave < 0 || tcgetattr(slave, &tio)) {
+        goto fail;
+    }
+    cfmakeraw(&tio);
+    if (tcsetattr(slave, TCSANOW, &tio)) {
+        goto fail;
+    }
+    return slave_path;
+
+fail:
+    uart_pty_close();
+    return NULL;
+}
+
+void uart_pty_sink(uint16_t base, uint8_t byte, void *ctx) {
+    (void)base;
+    (void)ctx;
+
+    if (master < 0) {
+        return;
+    }
+    if (cfg.pace_baud) {
+        pace();
+    }
+    stats.bytes += 1;
+    if (cfg.drop_ppm && next_rand() % 1000000 < cfg.drop_ppm) {
+        stats.dropped += 1;
+        return;
+    }
+    while (write(master, &byte, 1) != 1) {
+        if (errno != EINTR) {
+            perror("uart_pty");
+            exit(3);
+        }
+    }
+}
+
+void uart_pty_close(void) {
+    int waited, pending;
+
+    if (slave >= 0) {
+        for (waited = 0; waited < CLOSE_WAIT_MS; waited++) {
+            if (ioctl(slave, FIONREAD, &pending) || pending == 0) {
+                break;
+            }
+            usleep(1000);
+        }
+        close(slave);
+        slave = -1;
+    }
+    if (master >= 0) {
+        close(master);
+        master = -1;
+    }
+}
+
+void uart_pty_get_stats(struct uart_pty_stats *out) {
+    *out = stats;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+Linux pseudo-terminal standing in for the board's UART cable.
+
+Installed as the hal_host UART sink, every byte the firmware finishes sending through
+uart_write() is written to the master side, so whatever opens the slave side (uart_decode,
+a terminal program, the benchmark in run.c) sees what a host on the real serial port would.
+
+Optionally it:
+- paces the writes at the link's baud rate in wall-clock time, for readers that care about
+  timing rather than just content (the emulation otherwise runs far faster than real time),
+- drops bytes at a given rate, from a seeded generator so a run is repeatable.
+
+The master is written with blocking writes, so the reader must keep up or the firmware stalls,
+as a full transmit path would on the board.
+*/
+
+struct uart_pty_config {
+    // Pace writes at this many bits/s (10 bits per byte, for 8N1); 0 for as fast as possible
+    uint32_t pace_baud;
+    // Bytes to drop, per million
+    uint32_t drop_ppm;
+    uint32_t seed;
+};
+
+struct uart_pty_stats {
+    uint32_t bytes;
+    uint32_t dropped;
+};
+
+// Opens the pty and returns the slave's path, or NULL (with errno set). The slave is kept open
+// in raw mode until uart_pty_close(), so its settings stick before the reader opens it.
+const char *uart_pty_open(const struct uart_pty_config *config);
+
+// hal_host_uart_sink; ctx is unused
+void uart_pty_sink(uint16_t base, uint8_t byte, void *ctx);
+
+// Waits (for a few seconds at most) for the reader to take everything written, then hangs up,
+// which the reader sees as EIO
+void uart_pty_close(void);
+
+void uart_pty_get_stats(struct uart_pty_stats *stats);
@@ -10,6 +10,7 @@ P1.7: UCB0SOMI (peripheral out, controller in) -> BMI270 pin 1
 */
 
 #include <stdio.h>
+#include <string.h>
 #include "eusci_a_uart.h"
 #include "gpio.h"
 #include "uart.h"
@@ -19,19 +20,150 @@ P1.7: UCB0SOMI (peripheral out, controller in) -> BMI270 pin 1
 #include "bmi270_spi.h"
 #include "util.h"
 #include "cs.h"
+#include "poll_sched.h"
+#include "fifo_batch.h"
+#include "drdy.h"
+#include "hibernate.h"
+#include "reattach.h"
+#include "spi_trace.h"
+#include "bench.h"
+#include "wcet.h"
+#include "mem_watch.h"
+#include "regscript.h"
+#include "sink.h"
+#include "dma_dump.h"
+#include "dump_service.h"
+#include "rtc_anchor.h"
+#include "quant.h"
+#include "autorange.h"
+#include "calib.h"
+#include "shock.h"
+#include "health.h"
 
  // 200hz * 20sec
 #define DATA_LEN 1000
 
+// How samples get from the sensor to sensor_data:
+// ACQ_POLL: INT1 isn't wired, read the data registers when the poll scheduler expects a sample
+// ACQ_FIFO_BATCH: INT1 wired to P1.3, sleep in LPM3 and drain the FIFO on each watermark interrupt
+// ACQ_HIBERNATE: like ACQ_FIFO_BATCH, but with the MCU fully off in LPM4.5 between batches
+// ACQ_DRDY: INT1 wired to P1.3, sleep in LPM3 and read the data registers on each data ready pulse
+#define ACQ_POLL 0
+#define ACQ_FIFO_BATCH 1
+#define ACQ_HIBERNATE 2
+#define ACQ_DRDY 3
+#ifndef ACQ_MODE
+#define ACQ_MODE ACQ_POLL
+#endif
+
+// Output data rate of both accel and gyro, in Hz: 25, 50, 100, 200, 400, 800 or 1600
+#ifndef ODR_HZ
+#define ODR_HZ 200
+#endif
+// Sample period in sensor time ticks
+#define ODR_PERIOD_SENS (25600 / ODR_HZ)
+
+// How dump_samples() sends sensor_data over the UART:
+// DUMP_BINARY: 16 byte records (index, sens_time, accel and gyro, all 16 bit little-endian)
+// DUMP_CSV: one line of text per sample
+// DUMP_QUANT: blocks of samples with fewer bits per axis, lossy (quant.h)
+#define DUMP_BINARY 0
+#define DUMP_CSV 1
+#define DUMP_QUANT 2
+#ifndef DUMP_FORMAT
+#define DUMP_FORMAT DUMP_BINARY
+#endif
+
+// OUTPUT_SINKS (sink.h): where the samples go, any of SINK_UART, SINK_FRAM, SINK_NULL,
+// SINK_STRIPE, SINK_AES and SINK_FILE (host only) ORed together
+#if ((OUTPUT_SINKS) & (SINK_UART | SINK_FRAM | SINK_NULL | SINK_FILE | SINK_STRIPE | SINK_AES)) == 0
+#error "OUTPUT_SINKS needs at least one sink"
+#endif
+// SINK_STRIPE's frames share A1 with nothing else
+#if ((OUTPUT_SINKS) & SINK_STRIPE) && ((OUTPUT_SINKS) & SINK_UART)
+#error "SINK_STRIPE and SINK_UART can't both be in OUTPUT_SINKS"
+#endif
+// Nor do SINK_AES's, and nothing goes out on A1 in the clear beside them
+#if ((OUTPUT_SINKS) & SINK_AES) && (((OUTPUT_SINKS) & (SINK_UART | SINK_STRIPE)) || DUMP_DMA || DUMP_SERVICE)
+#error "SINK_AES needs OUTPUT_SINKS without SINK_UART or SINK_STRIPE, and DUMP_DMA and DUMP_SERVICE off"
+#endif
+
+// DUMP_DMA=1 (dma_dump.h) fills the FRAM log and then has the DMA send it, so the UART is its
+// own and the records are the binary ones
+#if DUMP_DMA && (DUMP_FORMAT != DUMP_BINARY || !((OUTPUT_SINKS) & SINK_FRAM) || ((OUTPUT_SINKS) & (SINK_UART | SINK_STRIPE)))
+#error "DUMP_DMA needs DUMP_FORMAT == DUMP_BINARY and OUTPUT_SINKS with SINK_FRAM but not SINK_UART or SINK_STRIPE"
+#endif
+
+// DUMP_SERVICE=1 (dump_service.h) keeps the capture in FRAM, indexed, and serves any part of it
+// over the UART after the dump, and on later boots before capturing again
+#if DUMP_SERVICE && DATA_LEN > DUMP_SERVICE_STRIDE * DUMP_SERVICE_CHUNKS
+#error "DUMP_SERVICE needs DUMP_SERVICE_STRIDE * DUMP_SERVICE_CHUNKS >= DATA_LEN"
+#endif
+
+// RTC_ANCHOR=1 (rtc_anchor.h) pairs the sensor time with the RTC's calendar through the capture,
+// and sends the anchors with the samples. LPM4 would stop the RTC.
+#if RTC_ANCHOR && ACQ_MODE == ACQ_HIBERNATE
+#error "RTC_ANCHOR doesn't work with ACQ_HIBERNATE"
+#endif
+
+// AUTORANGE=1 (autorange.h) switches the accel and gyro ranges as the samples call for it, and
+// sends the switches with the samples. Hibernating would lose the controller's state.
+#if AUTORANGE && ACQ_MODE == ACQ_HIBERNATE
+#error "AUTORANGE doesn't work with ACQ_HIBERNATE"
+#endif
+
+// SHOCK=1 (shock.h) switches the accel and gyro to SHOCK_ODR_HZ for a while after a shock, and
+// sends the events with the samples. The FIFO modes time their frames from one sample period,
+// and the poll scheduler locks onto one, so it takes ACQ_DRDY, where each sample brings its own.
+#if SHOCK && ACQ_MODE != ACQ_DRDY
+#error "SHOCK needs ACQ_MODE == ACQ_DRDY"
+#endif
+
+// HEALTH=1 (health.h) watches the sensor's error and status registers through the capture, and
+// sends their changes with the samples. Hibernating would lose where the reads had got to.
+#if HEALTH && ACQ_MODE == ACQ_HIBERNATE
+#error "HEALTH doesn't work with ACQ_HIBERNATE"
+#endif
+
+// BENCH=1 runs the benchmarks in bench.c instead of capturing samples. They count cycles on
+// SMCLK, so they need ACQ_POLL's clocks, with SMCLK = MCLK.
+#if BENCH && ACQ_MODE != ACQ_POLL
+#error "BENCH needs ACQ_MODE == ACQ_POLL"
+#endif
+// WCET=1 runs the worst-case execution time harness in wcet.c instead, on the same clocks
+#if WCET && ACQ_MODE != ACQ_POLL
+#error "WCET needs ACQ_MODE == ACQ_POLL"
+#endif
+
 #pragma PERSISTENT(sensor_data)
 static struct bmi2_sens_data sensor_data[DATA_LEN] = { { { 0 } } };
 
+/*! Sinks the samples go to. */
+static struct sink *const sinks[] = {
+#if (OUTPUT_SINKS) & SINK_UART
+    &sink_uart,
+#endif
+#if (OUTPUT_SINKS) & SINK_FRAM
+    &sink_fram,
+#endif
+#if (OUTPUT_SINKS) & SINK_NULL
+    &sink_null,
+#endif
+#if (OUTPUT_SINKS) & SINK_FILE
+    &sink_file,
+#endif
+#if (OUTPUT_SINKS) & SINK_STRIPE
+    &sink_stripe,
+#endif
+#if (OUTPUT_SINKS) & SINK_AES
+    &sink_aes,
+#endif
+};
+#define NUM_SINKS ((uint8_t)(sizeof(sinks) / sizeof(sinks[0])))
+
 /******************************************************************************/
 /*!                Macro definition                                           */
 
-/*! Earth's gravity in m/s^2 */
-#define GRAVITY_EARTH  (9.80665f)
-
 /*! Macros to select the sensors                   */
 #define ACCEL          UINT8_C(0x00)
 #define GYRO           UINT8_C(0x01)
@@ -40,85 +172,57 @@ static struct bmi2_sens_data sensor_data[DATA_LEN] = { { { 0 } } };
 /*!           Static Function Declaration                                     */
 
 /*!
- *  @brief This internal API is used to set configurations for accel.
+ *  @brief This internal API initializes bmi270, configures accel and gyro and enables them.
  *
- *  @param[in] bmi       : Structure instance of bmi2_dev.
+ *  @param[in] bmi         : Structure instance of bmi2_dev.
+ *  @param[in] sensor_list : Accel and gyro, to enable.
  *
  *  @return Status of execution.
  */
-static int8_t set_accel_gyro_config(struct bmi2_dev *bmi);
+static int8_t bring_up(struct bmi2_dev *bmi, const uint8_t *sensor_list);
 
 /*!
- *  @brief This function converts lsb to meter per second squared for 16 bit accelerometer at
- *  range 2G, 4G, 8G or 16G.
+ *  @brief This internal API is used to set configurations for accel.
  *
- *  @param[in] val       : LSB from each axis.
- *  @param[in] g_range   : Gravity range.
- *  @param[in] bit_width : Resolution for accel.
+ *  @param[in] bmi       : Structure instance of bmi2_dev.
  *
- *  @return Accel values in meter per second squared.
+ *  @return Status of execution.
  */
-static float lsb_to_mps2(int16_t val, float g_range, uint8_t bit_width);
+static int8_t set_accel_gyro_config(struct bmi2_dev *bmi);
 
 /*!
- *  @brief This function converts lsb to degree per second for 16 bit gyro at
- *  range 125, 250, 500, 1000 or 2000dps.
- *
- *  @param[in] val       : LSB from each axis.
- *  @param[in] dps       : Degree per second.
- *  @param[in] bit_width : Resolution for gyro.
+ *  @brief This internal API gives the accel/gyro ODR setting for ODR_HZ.
  *
- *  @return Degree per second.
+ *  @return ODR setting (BMI2_ACC_ODR_* and BMI2_GYR_ODR_* share values).
  */
-static float lsb_to_dps(int16_t val, float dps, uint8_t bit_width);
+static uint8_t odr_setting(void);
 
 /******************************************************************************/
 /*!            Functions                                        */
 
-void init_spi() {
-    // Set pins P1.6 and P1.4 as UCB0SIMO and UCB0CLK respectively
-    GPIO_setAsPeripheralModuleFunctionOutputPin(
-        GPIO_PORT_P1,
-        GPIO_PIN6 + GPIO_PIN4,
-        GPIO_PRIMARY_MODULE_FUNCTION
-    );
-
-    // Set pin P1.7 as UCB0SOMI
-    GPIO_setAsPeripheralModuleFunctionInputPin(
-        GPIO_PORT_P1,
-        GPIO_PIN7,
-        GPIO_PRIMARY_MODULE_FUNCTION
-    );
-
-    // While it is possible to set this as an SPI chip select pin (UCB0STE), it should instead
-    // be set just as a normal GPIO output, so that it doesn't get driven low after every write.
-    GPIO_setAsOutputPin(GPIO_PORT_P1, GPIO_PIN5);
-    GPIO_setOutputLowOnPin(GPIO_PORT_P1, GPIO_PIN5);
-    __delay_cycles(100);
-    GPIO_setOutputHighOnPin(GPIO_PORT_P1, GPIO_PIN5);
-
-    // Disable the GPIO power-on default high-impedance mode
-    // to activate previously configured port settings
-    PMM_unlockLPM5();
-
-    EUSCI_B_SPI_initMasterParam param = {
-        .selectClockSource = EUSCI_B_SPI_CLOCKSOURCE_SMCLK,
-        .clockSourceFrequency = CS_getSMCLK(),
-        .desiredSpiClock = 2000000,
-        // Per the datasheet, the BMI270 supports either 00 (the current setting) or 11 for clockPhase and clockPolarity.
-        // This is automatically detected by the BMI270.
-        .clockPhase = EUSCI_B_SPI_PHASE_DATA_CHANGED_ONFIRST_CAPTURED_ON_NEXT,
-        .clockPolarity = EUSCI_B_SPI_CLOCKPOLARITY_INACTIVITY_LOW,
-        .msbFirst = EUSCI_B_SPI_MSB_FIRST,
-        .spiMode = EUSCI_B_SPI_4PIN_UCxSTE_ACTIVE_LOW
-    };
-    EUSCI_B_SPI_initMaster(SPI_BASE, &param);
-    // Honestly I have no idea what this next line does, it might do nothing
-    EUSCI_B_SPI_select4PinFunctionality(SPI_BASE, EUSCI_B_SPI_ENABLE_SIGNAL_FOR_4WIRE_SLAVE);
-    EUSCI_B_SPI_enable(SPI_BASE);
-}
-
 void init_clk() {
+#if ACQ_MODE == ACQ_FIFO_BATCH || ACQ_MODE == ACQ_HIBERNATE || ACQ_MODE == ACQ_DRDY
+    // Batches (or samples) are drained as fast as possible: MCLK at 16 MHz (which needs an FRAM wait state),
+    // with SMCLK divided back down so the SPI, UART and timer settings stay the same
+    FRAMCtl_configureWaitStateControl(FRAMCTL_ACCESS_TIME_CYCLES_1);
+    CS_setDCOFreq(CS_DCORSEL_1, CS_DCOFSEL_4);
+
+    CS_initClockSignal(CS_MCLK,  CS_DCOCLK_SELECT,  CS_CLOCK_DIVIDER_1); // 16 MHz
+    CS_initClockSignal(CS_SMCLK, CS_DCOCLK_SELECT,  CS_CLOCK_DIVIDER_2); // 8 MHz
+#endif
+
+#if ACQ_MODE == ACQ_FIFO_BATCH || ACQ_MODE == ACQ_DRDY
+    // ACLK keeps running in LPM3, so run it from the 32.768 kHz crystal on PJ.4/PJ.5.
+    // (ACQ_HIBERNATE wakes on INT1 alone, and crystal start-up would dominate every wake-up.)
+    GPIO_setAsPeripheralModuleFunctionInputPin(GPIO_PORT_PJ, GPIO_PIN4 + GPIO_PIN5, GPIO_PRIMARY_MODULE_FUNCTION);
+    PMM_unlockLPM5();
+    //Set external clock frequency to 32.768 KHz
+    CS_setExternalClockSource(32768, 0);
+    //Set ACLK=XT1
+    CS_initClockSignal(CS_ACLK, CS_LFXTCLK_SELECT, CS_CLOCK_DIVIDER_1);
+    //Start XT1 with no time out
+    CS_turnOnLFXT(CS_LFXT_DRIVE_0);
+#elif ACQ_MODE == ACQ_POLL
     // Set DCO Frequency to 8 MHz
     CS_setDCOFreq(CS_DCORSEL_1, CS_DCOFSEL_3);
 
@@ -126,12 +230,25 @@ void init_clk() {
     CS_initClockSignal(CS_MCLK,  CS_DCOCLK_SELECT,  CS_CLOCK_DIVIDER_1); // 8 MHz
     CS_initClockSignal(CS_SMCLK, CS_DCOCLK_SELECT,  CS_CLOCK_DIVIDER_1); // 8 MHz
 
+#if RTC_ANCHOR
+    // The RTC runs from the 32.768 kHz crystal on PJ.4/PJ.5, through ACLK
+    GPIO_setAsPeripheralModuleFunctionInputPin(GPIO_PORT_PJ, GPIO_PIN4 + GPIO_PIN5, GPIO_PRIMARY_MODULE_FUNCTION);
+    PMM_unlockLPM5();
+    //Set external clock frequency to 32.768 KHz
+    CS_setExternalClockSource(32768, 0);
+    //Set ACLK=XT1
+    CS_initClockSignal(CS_ACLK, CS_LFXTCLK_SELECT, CS_CLOCK_DIVIDER_1);
+    //Start XT1 with no time out
+    CS_turnOnLFXT(CS_LFXT_DRIVE_0);
+#else
     //Set external clock frequency to 32.768 KHz
     // CS_setExternalClockSource(32768, 0);
     // //Set ACLK=XT1
     // CS_initClockSignal(CS_ACLK, CS_LFXTCLK_SELECT, CS_CLOCK_DIVIDER_1);
     // //Start XT1 with no time out
     // CS_turnOnLFXT(CS_LFXT_DRIVE_0);
+#endif
+#endif
 }
 
 void init_uart() {
@@ -191,6 +308,285 @@ static int8_t set_feature_config(struct bmi2_dev *bmi2_dev)
     return rslt;
 }
 
+/*! Longest record or CSV line that goes ahead of a sample. */
+#define DUMP_RECORD_MAX 48
+
+/*!
+ * @brief A kind of event kept alongside the samples, each of which dump_samples() sends ahead of
+ * the sample it goes with.
+ */
+struct event_source
+{
+    uint16_t (*count)(void);
+
+    /*! Index of the sample event i goes ahead of. */
+    uint16_t (*at)(uint16_t i);
+
+    /*! Event i as its record, or with DUMP_CSV its line, in out; returns its length. */
+    uint16_t (*format)(uint16_t i, char *out);
+};
+
+/*!
+ * @brief Where dump_samples() has got to in each kind of record that goes ahead of the samples.
+ */
+struct dump_cursors
+{
+    uint16_t anchor;
+    uint16_t range;
+    uint16_t shock;
+    uint16_t health;
+};
+
+#if RTC_ANCHOR
+static uint16_t anchor_at(uint16_t i)
+{
+    return rtc_anchor_get(i)->next;
+}
+
+static uint16_t anchor_format(uint16_t i, char *out)
+{
+#if DUMP_FORMAT == DUMP_CSV
+    const struct rtc_anchor *a = rtc_anchor_get(i);
+
+    return sprintf(out, "@, %u, %lu, %lu, %u, %u\r\n", a->next, (unsigned long)a->sens_time,
+                   (unsigned long)a->utc, a->subsec, a->flags);
+#else
+    rtc_anchor_pack(i, (uint8_t *)out);
+    return RTC_ANCHOR_LEN;
+#endif
+}
+
+static const struct event_source anchors = { rtc_anchor_count, anchor_at, anchor_format };
+#endif
+
+#if SHOCK
+static uint16_t shock_at(uint16_t i)
+{
+    return shock_get(i)->first;
+}
+
+static uint16_t shock_format(uint16_t i, char *out)
+{
+#if DUMP_FORMAT == DUMP_CSV
+    const struct shock_event *e = shock_get(i);
+
+    return sprintf(out, "^, %u, %lu, %u, %u\r\n", e->first, (unsigned long)e->sens_time,
+                   e->count, e->peak_mg);
+#else
+    shock_pack(i, (uint8_t *)out);
+    return SHOCK_LEN;
+#endif
+}
+
+static const struct event_source shocks = { shock_count, shock_at, shock_format };
+#endif
+
+#if HEALTH
+static uint16_t health_at(uint16_t i)
+{
+    return health_get(i)->next;
+}
+
+static uint16_t health_format(uint16_t i, char *out)
+{
+#if DUMP_FORMAT == DUMP_CSV
+    const struct health_event *e = health_get(i);
+
+    return sprintf(out, "#, %u, %u, %u, %u, %u\r\n", e->next, e->err, e->status,
+                   e->saturation, e->internal_err);
+#else
+    health_pack(i, (uint8_t *)out);
+    return HEALTH_LEN;
+#endif
+}
+
+static const struct event_source healths = { health_count, health_at, health_format };
+#endif
+
+#if RTC_ANCHOR || SHOCK || HEALTH
+/*!
+ * @brief This function sends the events of src from the i'th on that go ahead of sample upto or
+ * one before it, skipping any before sample first, to the OUTPUT_SINKS. Returns the next event's
+ * number.
+ */
+static uint16_t dump_events(const struct event_source *src, uint16_t i, uint32_t first,
+                            uint32_t upto)
+{
+    char record[DUMP_RECORD_MAX];
+    struct sink_vec vec;
+
+    vec.buf = record;
+    for (; i < src->count() && src->at(i) <= upto; i += 1) {
+        if (src->at(i) < first) {
+            continue;
+        }
+        vec.len = src->format(i, record);
+        sink_write(sinks, NUM_SINKS, &vec, 1);
+    }
+    return i;
+}
+#endif
+
+#if AUTORANGE
+/*!
+ * @brief This function sends a range record ahead of each sample from indx to upto that was
+ * taken at different ranges from the one before it, and ahead of sample first whatever the
+ * ranges, to the OUTPUT_SINKS. c is the range change in force before indx; returns the one in
+ * force at upto. Unlike the events, the changes go by sensor time, so this one follows the
+ * samples rather than an index kept with each change.
+ */
+static uint16_t dump_ranges(uint16_t c, uint32_t first, uint32_t indx, uint32_t upto)
+{
+    char record[DUMP_RECORD_MAX];
+    struct sink_vec vec;
+    uint16_t now;
+#if DUMP_FORMAT == DUMP_CSV
+    const struct autorange_change *r;
+#endif
+
+    vec.buf = record;
+    for (; indx <= upto; indx += 1) {
+        now = autorange_at(c, sensor_data[indx].sens_time);
+        if (now == c && indx != first) {
+            continue;
+        }
+        c = now;
+#if DUMP_FORMAT == DUMP_CSV
+        r = autorange_get(c);
+        vec.len = sprintf(record, "!, %lu, %lu, %u, %u\r\n", (unsigned long)indx,
+                          (unsigned long)r->sens_time, 2 << r->acc_range, 2000 >> r->gyr_range);
+#else
+        autorange_pack(c, indx, (uint8_t *)record);
+        vec.len = AUTORANGE_LEN;
+#endif
+        sink_write(sinks, NUM_SINKS, &vec, 1);
+    }
+    return c;
+}
+#endif
+
+/*!
+ * @brief This function sends everything that goes ahead of the samples from indx to upto (the
+ * anchors, range changes, shock and health events) to the OUTPUT_SINKS, carrying on from c.
+ */
+static void dump_ahead(struct dump_cursors *c, uint32_t first, uint32_t indx, uint32_t upto)
+{
+#if RTC_ANCHOR
+    c->anchor = dump_events(&anchors, c->anchor, first, upto);
+#endif
+#if AUTORANGE
+    c->range = dump_ranges(c->range, first, indx, upto);
+#endif
+#if SHOCK
+    c->shock = dump_events(&shocks, c->shock, first, upto);
+#endif
+#if HEALTH
+    c->health = dump_events(&healths, c->health, first, upto);
+#endif
+}
+
+/*!
+ * @brief This function sends count samples in sensor_data, from index first, to the OUTPUT_SINKS.
+ */
+static void dump_samples(uint32_t first, uint32_t count)
+{
+    uint32_t indx;
+    char output[80];
+    struct sink_vec vec[3];
+#if DUMP_FORMAT == DUMP_QUANT
+    struct quant_block block;
+    uint8_t k, n;
+#else
+    uint8_t pieces;
+#endif
+    struct dump_cursors cursors = { 0, 0, 0, 0 };
+
+#if (OUTPUT_SINKS) & SINK_FRAM
+    /* The FRAM log keeps the last dump only. */
+    sink_fram_clear();
+#endif
+
+#if DUMP_FORMAT == DUMP_QUANT
+    /* A block's exponents come from all of its samples, so the anchors in it go out ahead. */
+    for (indx = first; indx < first + count; indx += n) {
+        n = (first + count - indx < QUANT_BLOCK) ? first + count - indx : QUANT_BLOCK;
+        dump_ahead(&cursors, first, indx, indx + n - 1);
+        quant_begin(&block, &sensor_data[indx], indx, n);
+        vec[0].buf = block.header;
+        vec[0].len = QUANT_HEADER;
+        sink_write(sinks, NUM_SINKS, vec, 1);
+
+        vec[0].buf = output;
+        for (k = 0; k < n; k += 1) {
+            vec[0].len = quant_pack(&block, &sensor_data[indx + k], (uint8_t *)output);
+            sink_write(sinks, NUM_SINKS, vec, 1);
+        }
+    }
+#else
+    for (indx = first; indx < first + count; indx += 1) {
+        dump_ahead(&cursors, first, indx, indx);
+#if DUMP_FORMAT == DUMP_CSV
+        vec[0].buf = output;
+        vec[0].len = sprintf(output, "%lu, %lu,  %d, %d, %d,  %d, %d, %d\r\n",
+                   (unsigned long)indx,
+                   (unsigned long)sensor_data[indx].sens_time,
+                   sensor_data[indx].acc.x,
+                   sensor_data[indx].acc.y,
+                   sensor_data[indx].acc.z,
+                   sensor_data[indx].gyr.x,
+                   sensor_data[indx].gyr.y,
+                   sensor_data[indx].gyr.z
+                   );
+        pieces = 1;
+#else
+        output[0] = indx & 0xff;
+        output[1] = (indx >> 8) & 0xff;
+        output[2] = sensor_data[indx].sens_time & 0xff;
+        output[3] = (sensor_data[indx].sens_time >> 8) & 0xff;
+        vec[0].buf = output;
+        vec[0].len = 4;
+
+        /* x, y and z as they lie, little-endian on the MSP430 as on the host. */
+        vec[1].buf = &sensor_data[indx].acc;
+        vec[1].len = 6;
+        vec[2].buf = &sensor_data[indx].gyr;
+        vec[2].len = 6;
+        pieces = 3;
+#endif
+        sink_write(sinks, NUM_SINKS, vec, pieces);
+    }
+#endif
+    /* Anchors and health events can also come after the last sample. */
+#if RTC_ANCHOR
+    (void)dump_events(&anchors, cursors.anchor, first, first + count);
+#endif
+#if HEALTH
+    (void)dump_events(&healths, cursors.health, first, first + count);
+#endif
+
+    sink_flush(sinks, NUM_SINKS);
+
+#if DUMP_DMA
+    {
+        uint32_t len;
+        const uint8_t *log = sink_fram_log(&len);
+
+        dma_dump(log, len);
+    }
+#endif
+}
+
+#if BENCH || WCET
+/*!
+ * @brief This function sends a line of the benchmark report over the UART.
+ */
+static void bench_print_uart(const char *line)
+{
+    uart_write(0, (const unsigned char *)line, strlen(line));
+    uart_write(0, (const unsigned char *)"\r\n", 2);
+}
+#endif
+
 int main(void) {
     /* Status of api are returned to this variable. */
     int8_t rslt;
@@ -208,6 +604,9 @@ int main(void) {
     
 
     uint32_t indx = 0;
+#if ACQ_MODE == ACQ_POLL
+    uint8_t fresh;
+#endif
 
     float acc_x = 0, acc_y = 0, acc_z = 0;
     float gyr_x = 0, gyr_y = 0, gyr_z = 0;
@@ -217,108 +616,311 @@ int main(void) {
     // Stop watchdog timer
     WDT_A_hold(WDT_A_BASE);
 
+#if MEM_REPORT
+    // Before anything else runs, so the high-water mark covers all of it
+    mem_watch_paint();
+#endif
+
     init_clk();
+#if RTC_ANCHOR
+    rtc_anchor_init();
+#endif
     init_spi();
     init_uart();
+#if (OUTPUT_SINKS) & SINK_STRIPE
+    uart_init_a0();
+#endif
     init_bmi_device(&bmi);
 
-    char output[64];
-    int len;
+#if BENCH
+    /* Time the library's hot paths, and a config upload to the sensor, instead of capturing. */
+    bench_clock_init();
+    bench_run(&bmi, 1, bench_print_uart);
+    return 0;
+#endif
+
+#if WCET
+    /* Find the worst cases of the ISRs and the FIFO extractors instead of capturing. */
+    bench_clock_init();
+    wcet_run(&bmi, bench_print_uart);
+    return 0;
+#endif
+
+#if ACQ_MODE == ACQ_POLL
+    poll_sched_init();
+#endif
+
+#if ACQ_MODE == ACQ_HIBERNATE
+    if (hibernate_woke())
+    {
+        // The sensor kept sampling while we were off, so carry on draining without initializing it again
+        indx = hibernate_resume(&bmi, sensor_data, limit);
+#if DUMP_SERVICE
+        dump_service_store(sensor_data, indx);
+#endif
+        dump_samples(0, indx);
+#if DUMP_SERVICE
+        dump_service_run(sensor_data, dump_samples);
+#endif
+#if MEM_REPORT
+        mem_watch_report(&bmi);
+#endif
+#if SPI_TRACE
+        spi_trace_stop();
+        spi_trace_dump();
+#endif
+        return 0;
+    }
+#endif
 
-    /* Initialize bmi270. */
-    rslt = bmi270_init(&bmi);
-    bmi2_error_codes_print_result(rslt);
+#if DUMP_SERVICE
+    if (dump_service_stored())
+    {
+        /* An earlier capture is still in FRAM: serve it until told to start a new one. */
+        dump_service_run(sensor_data, dump_samples);
+    }
+
+    /* The new capture overwrites it from the first sample, so a reset part way through must not find it stored. */
+    dump_service_clear();
+#endif
+
+#if SPI_TRACE
+    /* Record the bus traffic from here on, to replay on the host (host/replay.c). */
+    spi_trace_start();
+#endif
+
+#if REGSCRIPT
+    if (regscript_valid())
+    {
+        /* Replay the bring-up recorded on an earlier boot, as raw register accesses. */
+        rslt = regscript_run(&bmi);
+        bmi2_error_codes_print_result(rslt);
+    }
+    else
+    {
+        /* Bring the sensor up through the API, recording the bus traffic to replay next time. */
+        regscript_record(&bmi);
+        rslt = bring_up(&bmi, sensor_list);
+        rslt = regscript_stop(&bmi, rslt);
+        bmi2_error_codes_print_result(rslt);
+    }
+#else
+    rslt = bring_up(&bmi, sensor_list);
+#endif
 
     if (rslt == BMI2_OK)
     {
-        /* Accel and gyro configuration settings. */
-        rslt = set_accel_gyro_config(&bmi);
+        config.type = BMI2_ACCEL;
+
+        /* Get the accel configurations. */
+        rslt = bmi2_get_sensor_config(&config, 1, &bmi);
+        bmi2_error_codes_print_result(rslt);
+
+#if RTC_ANCHOR
+        /* Pin the sensor time to the RTC before the first sample; the capture loops do it again every RTC_ANCHOR_PERIOD s. */
+        rtc_anchor_clear();
+        rslt = rtc_anchor_take(&bmi, 0);
+        bmi2_error_codes_print_result(rslt);
+#endif
+
+#if AUTORANGE
+        /* Start from the ranges set_accel_gyro_config() left, and switch from there. */
+        rslt = autorange_start(&bmi);
+        bmi2_error_codes_print_result(rslt);
+#endif
+
+#if SHOCK
+        /* Start at ODR_HZ, and come back to it after each burst. */
+        rslt = shock_start(&bmi);
+        bmi2_error_codes_print_result(rslt);
+#endif
+
+#if HEALTH
+        /* The values to report changes from; after this the reads only come in idle slots. */
+        rslt = health_start(&bmi);
+        bmi2_error_codes_print_result(rslt);
+#endif
+
+        // len = sprintf(output,
+        //     "Data set, Time, Accel Range, Acc_Raw_X, Acc_Raw_Y, Acc_Raw_Z, Gyr_Raw_X, Gyr_Raw_Y, Gyr_Raw_Z\r\n");
+        // uart_write(0, output, len);
+
+#if ACQ_MODE == ACQ_FIFO_BATCH || ACQ_MODE == ACQ_HIBERNATE
+        rslt = fifo_batch_start(&bmi, ODR_PERIOD_SENS);
         bmi2_error_codes_print_result(rslt);
 
         if (rslt == BMI2_OK)
         {
-            /* NOTE:
-             * Accel and Gyro enable must be done after setting configurations
-             */
-            rslt = bmi2_sensor_enable(sensor_list, 2, &bmi);
+            rslt = reattach_snapshot(&bmi);
             bmi2_error_codes_print_result(rslt);
+        }
 
-            if (rslt == BMI2_OK)
-            {
-                config.type = BMI2_ACCEL;
+        if (rslt == BMI2_OK)
+        {
+#if ACQ_MODE == ACQ_HIBERNATE
+            indx = hibernate_run(&bmi, sensor_data, limit, 0);
+#else
+            indx = fifo_batch_run(&bmi, sensor_data, limit);
+#endif
+        }
+#elif ACQ_MODE == ACQ_DRDY
+#if SHOCK
+        /* A sample at ODR_HZ also lies on a boundary of the bursts' shorter period. */
+        rslt = drdy_start(&bmi, SHOCK_PERIOD_SENS);
+#else
+        rslt = drdy_start(&bmi, ODR_PERIOD_SENS);
+#endif
+        bmi2_error_codes_print_result(rslt);
 
-                /* Get the accel configurations. */
-                rslt = bmi2_get_sensor_config(&config, 1, &bmi);
-                bmi2_error_codes_print_result(rslt);
+        if (rslt == BMI2_OK)
+        {
+            rslt = reattach_snapshot(&bmi);
+            bmi2_error_codes_print_result(rslt);
+        }
 
-                // len = sprintf(output,
-                //     "Data set, Time, Accel Range, Acc_Raw_X, Acc_Raw_Y, Acc_Raw_Z, Gyr_Raw_X, Gyr_Raw_Y, Gyr_Raw_Z\r\n");
-                // uart_write(0, output, len);
+        if (rslt == BMI2_OK)
+        {
+            indx = drdy_run(&bmi, sensor_data, limit);
+        }
+
+#if SHOCK
+        /* Don't leave the sensor at the bursts' rate if the capture ended in one. */
+        rslt = shock_stop(&bmi);
+        bmi2_error_codes_print_result(rslt);
+#endif
+#else
+        /* Keep a copy of the configuration for fast recovery after a bus failure. */
+        rslt = reattach_snapshot(&bmi);
+        bmi2_error_codes_print_result(rslt);
 
-                while (indx < limit)
+        while (indx < limit)
+        {
+            // INT1 isn't wired on this board, so sleep until the poll scheduler
+            // expects the next sample instead of reading the registers flat out
+            poll_sched_wait();
+#if HEALTH
+            rslt = health_get_sensor_data(&sensor_data[indx], indx, &bmi);
+#else
+            rslt = bmi2_get_sensor_data(&sensor_data[indx], &bmi);
+#endif
+            // bmi2_error_codes_print_result(rslt);
+
+            if (rslt == BMI2_E_COM_FAIL)
+            {
+                // A transaction missed its deadline; get the bus and the stream back
+                // and carry on rather than waiting for the watchdog, or end the capture
+                // if the sensor can't be got back, as the other loops do
+                rslt = reattach_recover(&bmi);
+                bmi2_error_codes_print_result(rslt);
+                if (rslt != BMI2_OK)
                 {
-                    rslt = bmi2_get_sensor_data(&sensor_data[indx], &bmi);
-                    // bmi2_error_codes_print_result(rslt);
+                    break;
+                }
+                continue;
+            }
+
+            fresh = (rslt == BMI2_OK) && (sensor_data[indx].status & BMI2_DRDY_ACC) &&
+                (sensor_data[indx].status & BMI2_DRDY_GYR);
+            poll_sched_update(fresh, sensor_data[indx].sens_time);
 
-                    if ((rslt == BMI2_OK) && (sensor_data[indx].status & BMI2_DRDY_ACC) &&
-                        (sensor_data[indx].status & BMI2_DRDY_GYR))
+            if (fresh)
+            {
+                /* Converting lsb to meter per second squared for 16 bit accelerometer at the range it was taken at. */
+                // acc_x = lsb_to_mps2(sensor_data.acc.x, (float)autorange_acc_g(), bmi.resolution);
+                // acc_y = lsb_to_mps2(sensor_data.acc.y, (float)autorange_acc_g(), bmi.resolution);
+                // acc_z = lsb_to_mps2(sensor_data.acc.z, (float)autorange_acc_g(), bmi.resolution);
+
+                // /* Converting lsb to degree per second for 16 bit gyro at the range it was taken at. */
+                // gyr_x = lsb_to_dps(sensor_data.gyr.x, (float)autorange_gyr_dps(), bmi.resolution);
+                // gyr_y = lsb_to_dps(sensor_data.gyr.y, (float)autorange_gyr_dps(), bmi.resolution);
+                // gyr_z = lsb_to_dps(sensor_data.gyr.z, (float)autorange_gyr_dps(), bmi.resolution);
+
+                
+
+                indx++;
+#if AUTORANGE
+                rslt = autorange_update(&bmi, &sensor_data[indx - 1], 1);
+                if (rslt == BMI2_E_COM_FAIL)
+                {
+                    rslt = reattach_recover(&bmi);
+                    bmi2_error_codes_print_result(rslt);
+                    if (rslt != BMI2_OK)
                     {
-                        /* Converting lsb to meter per second squared for 16 bit accelerometer at 2G range. */
-                        // acc_x = lsb_to_mps2(sensor_data.acc.x, (float)2, bmi.resolution);
-                        // acc_y = lsb_to_mps2(sensor_data.acc.y, (float)2, bmi.resolution);
-                        // acc_z = lsb_to_mps2(sensor_data.acc.z, (float)2, bmi.resolution);
+                        break;
+                    }
+                }
+#endif
+#if CALIB
+                calib_apply(&sensor_data[indx - 1], 1);
+#endif
+#if HEALTH
+                /* The next sample is most of a period away. */
+                (void)health_idle(&bmi, indx, sensor_data[indx - 1].sens_time);
+#endif
+            }
+#if RTC_ANCHOR
+            (void)rtc_anchor_poll(&bmi, indx);
+#endif
+        }
+#endif
 
-                        // /* Converting lsb to degree per second for 16 bit gyro at 2000dps range. */
-                        // gyr_x = lsb_to_dps(sensor_data.gyr.x, (float)2000, bmi.resolution);
-                        // gyr_y = lsb_to_dps(sensor_data.gyr.y, (float)2000, bmi.resolution);
-                        // gyr_z = lsb_to_dps(sensor_data.gyr.z, (float)2000, bmi.resolution);
+#if RTC_ANCHOR
+        /* And after the last, so the whole capture is bracketed. */
+        rslt = rtc_anchor_take(&bmi, indx);
+        bmi2_error_codes_print_result(rslt);
+#endif
+
+#if DUMP_SERVICE
+        /* Keep the capture before sending it, so a dump cut short can be asked for again. */
+        dump_service_store(sensor_data, indx);
+#endif
+        dump_samples(0, indx);
+#if DUMP_SERVICE
+        dump_service_run(sensor_data, dump_samples);
+#endif
+    }
 
-                        
+#if MEM_REPORT
+    /* How much stack and scratch arena the run needed, to size them by. */
+    mem_watch_report(&bmi);
+#endif
 
-                        indx++;
-                    }
-                }
+#if SPI_TRACE
+    /* Send the trace whether or not the sensor came up; a failed start is worth replaying too. */
+    spi_trace_stop();
+    spi_trace_dump();
+#endif
+}
 
-                for (indx = 0; indx < DATA_LEN; indx += 1) {
-                    // len = sprintf(output, "%lu, %lu,  %d, %d, %d,  %d, %d, %d\r\n",
-                    //            indx,
-                    //            sensor_data[indx].sens_time,
-                    //            //config.cfg.acc.range,
-                    //            sensor_data[indx].acc.x,
-                    //            sensor_data[indx].acc.y,
-                    //            sensor_data[indx].acc.z,
-                    //         //    acc_x,
-                    //         //    acc_y,
-                    //         //    acc_z,
-                    //            sensor_data[indx].gyr.x,
-                    //            sensor_data[indx].gyr.y,
-                    //            sensor_data[indx].gyr.z
-                    //         //    gyr_x,
-                    //         //    gyr_y,
-                    //         //    gyr_z
-                    //            );
-                    output[0] = indx & 0xff;
-                    output[1] = (indx >> 8) & 0xff;
-                    output[2] = sensor_data[indx].sens_time & 0xff;
-                    output[3] = (sensor_data[indx].sens_time >> 8) & 0xff;
-                    output[4] = sensor_data[indx].acc.x & 0xff;
-                    output[5] = sensor_data[indx].acc.x >> 8;
-                    output[6] = sensor_data[indx].acc.y & 0xff;
-                    output[7] = sensor_data[indx].acc.y >> 8;
-                    output[8] = sensor_data[indx].acc.z & 0xff;
-                    output[9] = sensor_data[indx].acc.z >> 8;
-                    output[10] = sensor_data[indx].gyr.x & 0xff;
-                    output[11] = sensor_data[indx].gyr.x >> 8;
-                    output[12] = sensor_data[indx].gyr.y & 0xff;
-                    output[13] = sensor_data[indx].gyr.y >> 8;
-                    output[14] = sensor_data[indx].gyr.z & 0xff;
-                    output[15] = sensor_data[indx].gyr.z >> 8;
-                    len = 16;
-                    uart_write(0, output, len);
-                }
-            }
+/*!
+ * @brief This internal API initializes bmi270, configures accel and gyro and enables them.
+ */
+static int8_t bring_up(struct bmi2_dev *bmi, const uint8_t *sensor_list)
+{
+    /* Status of api are returned to this variable. */
+    int8_t rslt;
+
+    /* Initialize bmi270. */
+    rslt = bmi270_init(bmi);
+    bmi2_error_codes_print_result(rslt);
+
+    if (rslt == BMI2_OK)
+    {
+        /* Accel and gyro configuration settings. */
+        rslt = set_accel_gyro_config(bmi);
+        bmi2_error_codes_print_result(rslt);
+
+        if (rslt == BMI2_OK)
+        {
+            /* NOTE:
+             * Accel and Gyro enable must be done after setting configurations
+             */
+            rslt = bmi2_sensor_enable(sensor_list, 2, bmi);
+            bmi2_error_codes_print_result(rslt);
         }
     }
+
+    return rslt;
 }
 
 /*!
@@ -348,7 +950,7 @@ static int8_t set_accel_gyro_config(struct bmi2_dev *bmi)
     {
         /* NOTE: The user can change the following configuration parameters according to their requirement. */
         /* Set Output Data Rate */
-        config[ACCEL].cfg.acc.odr = BMI2_ACC_ODR_200HZ;
+        config[ACCEL].cfg.acc.odr = odr_setting();
 
         /* Gravity range of the sensor (+/- 2G, 4G, 8G, 16G). */
         config[ACCEL].cfg.acc.range = BMI2_ACC_RANGE_2G;
@@ -373,7 +975,7 @@ static int8_t set_accel_gyro_config(struct bmi2_dev *bmi)
 
         /* The user can change the following configuration parameters according to their requirement. */
         /* Set Output Data Rate */
-        config[GYRO].cfg.gyr.odr = BMI2_GYR_ODR_200HZ;
+        config[GYRO].cfg.gyr.odr = odr_setting();
 
         /* Gyroscope Angular Rate Measurement Range.By default the range is 2000dps. */
         config[GYRO].cfg.gyr.range = BMI2_GYR_RANGE_2000;
@@ -405,27 +1007,25 @@ static int8_t set_accel_gyro_config(struct bmi2_dev *bmi)
 }
 
 /*!
- * @brief This function converts lsb to meter per second squared for 16 bit accelerometer at
- * range 2G, 4G, 8G or 16G.
+ * @brief This internal API gives the accel/gyro ODR setting for ODR_HZ.
  */
-static float lsb_to_mps2(int16_t val, float g_range, uint8_t bit_width)
+static uint8_t odr_setting(void)
 {
-    double power = 2;
+    /* Each setting doubles the rate of the one before, and 100 Hz is 256 sensor time ticks. */
+    uint8_t odr = BMI2_ACC_ODR_100HZ;
+    uint16_t period = 256;
 
-    float half_scale = (float)((pow((double)power, (double)bit_width) / 2.0f));
-
-    return (GRAVITY_EARTH * val * g_range) / half_scale;
-}
-
-/*!
- * @brief This function converts lsb to degree per second for 16 bit gyro at
- * range 125, 250, 500, 1000 or 2000dps.
- */
-static float lsb_to_dps(int16_t val, float dps, uint8_t bit_width)
-{
-    double power = 2;
+    while (period > ODR_PERIOD_SENS)
+    {
+        period >>= 1;
+        odr++;
+    }
 
-    float half_scale = (float)((pow((double)power, (double)bit_width) / 2.0f));
+    while (period < ODR_PERIOD_SENS)
+    {
+        period <<= 1;
+        odr--;
+    }
 
-    return (dps / (half_scale)) * (val);
-}
\ No newline at end of file
+    return odr;
+}
@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include <driverlib.h>
+#include "mem_watch.h"
+#include "uart.h"
+
+#define PAINT 0xA5
+
+#if MEM_SCRATCH_FRAM
+#pragma PERSISTENT(scratch_buf)
+#endif
+// Whole words, so that the arena starts aligned the way bmi2_scratch_alloc() needs
+static uint32_t scratch_buf[(MEM_SCRATCH_SIZE + 3) / 4] = { 0 };
+static struct bmi2_scratch scratch = { (uint8_t *)scratch_buf, sizeof(scratch_buf), 0, 0 };
+
+#if defined(__TI_COMPILER_VERSION__)
+// The .stack section, as the linker command file lays it out
+extern uint8_t _stack;
+extern uint8_t __STACK_END;
+#define STACK_LOW (&_stack)
+#define STACK_HIGH (&__STACK_END)
+#elif defined(__MSP430__)
+// msp430-gcc puts the stack at the top of RAM, growing down to the end of .bss and the heap
+extern uint8_t end;
+extern uint8_t __stack;
+#define STACK_LOW (&end)
+#define STACK_HIGH (&__stack)
+#endif
+// The host build runs main() on the host's own stack, which isn't ours to paint; nothing is
+// measured there, and the stack figures are 0
+
+void mem_watch_attach(struct bmi2_dev *bmi) {
+    bmi->scratch = &scratch;
+}
+
+void mem_watch_paint(void) {
+#if defined(__TI_COMPILER_VERSION__) || defined(__MSP430__)
+    volatile uint8_t *p;
+    uint8_t *sp = (uint8_t *)__get_SP_register();
+
+    // Everything below the stack pointer is free; leave a little for this function's own calls
+    for (p = STACK_LOW; p < sp - 8; p++) {
+        *p = PAINT;
+    }
+#endif
+}
+
+uint16_t mem_watch_stack_used(void) {
+#if defined(__TI_COMPILER_VERSION__) || defined(__MSP430__)
+    const uint8_t *p = STACK_LOW;
+
+    while (p < STACK_HIGH && *p == PAINT) {
+        p++;
+    }
+    return (uint16_t)(STACK_HIGH - p);
+#else
+    return 0;
+#endif
+}
+
+uint16_t mem_watch_stack_size(void) {
+#if defined(__TI_COMPILER_VERSION__) || defined(__MSP430__)
+    return (uint16_t)(STACK_HIGH - STACK_LOW);
+#else
+    return 0;
+#endif
+}
+
+void mem_watch_report(const struct bmi2_dev *bmi) {
+    char line[64];
+    int len;
+
+    len = sprintf(line, "# mem stack %u/%u scratch %u/%u dev %u\r\n", mem_watch_stack_used(),
+        mem_watch_stack_size(), bmi->scratch ? bmi->scratch->peak : 0, (unsigned)sizeof(scratch_buf),
+        (unsigned)sizeof(*bmi));
+    uart_write(0, (const unsigned char *)line, len);
+}
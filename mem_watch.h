@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+#include "BMI270_SensorAPI/bmi2.h"
+
+/*
+Where the RAM goes, made explicit:
+- the scratch arena: the sensor driver takes its temporary buffers (register reads, feature
+  pages) from a fixed MEM_SCRATCH_SIZE bytes attached to the device instead of the stack, and
+  fails with BMI2_E_SCRATCH rather than overflowing when they don't fit. The arena is in RAM,
+  or in FRAM with MEM_SCRATCH_FRAM set, for when RAM is short and the extra wait states on
+  register reads don't matter,
+- stack painting: mem_watch_paint() fills the unused stack with a pattern first thing, and
+  mem_watch_stack_used() finds how far down it has been overwritten since.
+
+With MEM_REPORT set to 1, main() sends both high-water marks after the samples, as a text line:
+
+  # mem stack <bytes used>/<stack size> scratch <peak bytes>/<MEM_SCRATCH_SIZE> dev <bytes>
+
+A stack figure equal to the size means the stack ran into whatever is below it. dev is what
+struct bmi2_dev takes per sensor, the rest being shared through its const struct bmi2_variant. The host build
+runs on the host's own stack, which it doesn't paint, so its stack figures are 0/0; the scratch
+figure is the same on both.
+*/
+
+// Bytes of scratch arena. A register read takes its length plus the dummy byte (rounded up to
+// 4) and a feature page 16; the firmware peaks at 36. Raise it before calling anything that
+// reads more registers at once.
+#ifndef MEM_SCRATCH_SIZE
+#define MEM_SCRATCH_SIZE 64
+#endif
+
+#ifndef MEM_SCRATCH_FRAM
+#define MEM_SCRATCH_FRAM 0
+#endif
+
+#ifndef MEM_REPORT
+#define MEM_REPORT 0
+#endif
+
+// Give the device the scratch arena; init_bmi_device() does this
+void mem_watch_attach(struct bmi2_dev *bmi);
+
+// Fill the unused stack with the pattern. Call it first thing in main().
+void mem_watch_paint(void);
+
+// Bytes of stack used since mem_watch_paint(), at most
+uint16_t mem_watch_stack_used(void);
+uint16_t mem_watch_stack_size(void);
+
+// Send the "# mem" line out of the UART
+void mem_watch_report(const struct bmi2_dev *bmi);
@@ -0,0 +1,203 @@
+#include <driverlib.h>
+#include "poll_sched.h"
+
+// Nominal timer ticks per sensor time tick: 39.0625 us at 1 MHz, in Q16
+#define NOMINAL_RATIO_Q16 2560000UL
+// Don't bother sleeping for less than this many timer ticks
+#define MIN_SLEEP_TICKS 20
+// Longest single compare interval: sleep_until() takes the distance to the compare as signed,
+// so anything past half the 16 bit timer would look overdue
+#define MAX_SLEEP_TICKS 0x7000
+// Frequency estimates are only taken over baselines shorter than this (in sensor ticks),
+// so the 16 bit timer can't have wrapped between the two reads
+#define MAX_BASELINE_SENS 1600
+// Sample periods run from 6.4 kHz (4 ticks) to 0.78 Hz (32768 ticks)
+#define MIN_PERIOD_SENS 4
+#define MAX_PERIOD_SENS 32768UL
+
+static uint32_t ratio_q16 = NOMINAL_RATIO_Q16;
+static uint16_t period_sens;
+
+static uint32_t last_sens_time;
+static uint16_t last_read_tick;
+static uint8_t have_last;
+// Whether the last fresh read came soon after its sample (see poll_sched_update)
+static uint8_t last_prompt;
+
+// Timer value just after the current read, and how long after that to wake up next
+static uint16_t read_tick;
+static uint16_t wait_base;
+static uint32_t wait_ticks;
+static uint8_t have_wait;
+
+static uint8_t misses;
+static struct poll_sched_stats stats;
+
+/* Round a sensor time delta to the nearest power of two (in the log domain), which is what
+every BMI270 output data rate works out to */
+static uint32_t round_pow2(uint32_t val) {
+    uint32_t pow2 = 1;
+    while ((pow2 << 1) <= val) {
+        pow2 <<= 1;
+    }
+    if (val - pow2 >= (pow2 >> 1)) {
+        pow2 <<= 1;
+    }
+    return pow2;
+}
+
+static void reset_lock(void) {
+    period_sens = 0;
+    have_last = 0;
+    last_prompt = 0;
+    misses = 0;
+    stats.locked = 0;
+}
+
+static void sleep_until(uint16_t when) {
+    Timer_A_setCompareValue(TIMER_A0_BASE, TIMER_A_CAPTURECOMPARE_REGISTER_0, when);
+    Timer_A_clearCaptureCompareInterrupt(TIMER_A0_BASE, TIMER_A_CAPTURECOMPARE_REGISTER_0);
+
+    // Interrupts stay off between the check and going to sleep, otherwise the compare could
+    // fire in between and we'd sleep through a whole timer period
+    __disable_interrupt();
+    if ((int16_t)(when - Timer_A_getCounterValue(TIMER_A0_BASE)) > MIN_SLEEP_TICKS) {
+        Timer_A_enableCaptureCompareInterrupt(TIMER_A0_BASE, TIMER_A_CAPTURECOMPARE_REGISTER_0);
+
+        // Enter LPM0, with interrupts enabled, and wait for the compare interrupt
+        __bis_SR_register(LPM0_bits + GIE);
+
+        Timer_A_disableCaptureCompareInterrupt(TIMER_A0_BASE, TIMER_A_CAPTURECOMPARE_REGISTER_0);
+    } else {
+        __enable_interrupt();
+    }
+}
+
+void poll_sched_init(void) {
+    Timer_A_initContinuousModeParam param = {
+        .clockSource = TIMER_A_CLOCKSOURCE_SMCLK,
+        // 8 MHz SMCLK / 8 = 1 us per tick
+        .clockSourceDivider = TIMER_A_CLOCKSOURCE_DIVIDER_8,
+        .timerInterruptEnable_TAIE = TIMER_A_TAIE_INTERRUPT_DISABLE,
+        .timerClear = TIMER_A_DO_CLEAR,
+        .startTimer = true
+    };
+    Timer_A_initContinuousMode(TIMER_A0_BASE, &param);
+
+    Timer_A_initCompareModeParam compare = {
+        .compareRegister = TIMER_A_CAPTURECOMPARE_REGISTER_0,
+        .compareInterruptEnable = TIMER_A_CAPTURECOMPARE_INTERRUPT_DISABLE,
+        .compareOutputMode = TIMER_A_OUTPUTMODE_OUTBITVALUE,
+        .compareValue = 0
+    };
+    Timer_A_initCompareMode(TIMER_A0_BASE, &compare);
+
+    ratio_q16 = NOMINAL_RATIO_Q16;
+    have_wait = 0;
+    reset_lock();
+    stats.reads = 0;
+    stats.misses = 0;
+}
+
+void poll_sched_wait(void) {
+    uint16_t now = Timer_A_getCounterValue(TIMER_A0_BASE);
+
+    if (have_wait) {
+        uint16_t elapsed = now - wait_base;
+        uint32_t remaining = (elapsed < wait_ticks) ? wait_ticks - elapsed : 0;
+
+        // Waits longer than the timer can express are done in several hops
+        while (remaining > MIN_SLEEP_TICKS) {
+            uint16_t hop = (remaining > MAX_SLEEP_TICKS) ? MAX_SLEEP_TICKS : (uint16_t)remaining;
+            now += hop;
+            sleep_until(now);
+            remaining -= hop;
+        }
+    }
+}
+
+void poll_sched_update(uint8_t fresh, uint32_t sens_time) {
+    uint32_t until_next;
+    uint8_t prompt;
+
+    // The sensor time comes at the end of a burst read, some hundreds of us after the status
+    // byte at its start, so it pairs with the timer now rather than when the read began
+    read_tick = Timer_A_getCounterValue(TIMER_A0_BASE);
+
+    stats.reads += 1;
+    have_wait = 1;
+    wait_base = read_tick;
+
+    if (!fresh) {
+        stats.misses += 1;
+        if (misses < UINT8_MAX) {
+            misses += 1;
+        }
+        // Only a lock can be dropped: while learning, a long run of misses is just a slow ODR
+        if (misses >= POLL_SCHED_MAX_MISSES && period_sens != 0) {
+            reset_lock();
+        }
+        wait_ticks = POLL_SCHED_FAST_US;
+        return;
+    }
+    // A read is only known to have closely followed its sample if we were polling fast for it
+    // or waking up on a prediction; the very first one could be most of a period late
+    prompt = (misses > 0) || (period_sens != 0);
+    misses = 0;
+
+    sens_time &= 0xFFFFFF;
+    if (have_last) {
+        uint32_t d_sens = (sens_time - last_sens_time) & 0xFFFFFF;
+        uint16_t d_tick = read_tick - last_read_tick;
+
+        if (d_sens > 0 && d_sens < MAX_BASELINE_SENS) {
+            // Frequency detector: timer ticks per sensor tick over the last interval,
+            // rejecting anything more than 1/8 off nominal as a glitch
+            uint32_t meas = ((uint32_t)d_tick << 16) / d_sens;
+            if (meas > NOMINAL_RATIO_Q16 - (NOMINAL_RATIO_Q16 >> 3) &&
+                meas < NOMINAL_RATIO_Q16 + (NOMINAL_RATIO_Q16 >> 3)) {
+                ratio_q16 += ((int32_t)(meas - ratio_q16)) >> 3;
+            }
+        }
+
+        // The shortest gap between two prompt reads is the period; a longer one just
+        // means a sample was skipped
+        uint32_t period = round_pow2(d_sens);
+        if (prompt && last_prompt && period >= MIN_PERIOD_SENS && period <= MAX_PERIOD_SENS &&
+            (period_sens == 0 || period < period_sens)) {
+            period_sens = (uint16_t)period;
+        }
+    }
+    last_prompt = prompt;
+    last_sens_time = sens_time;
+    last_read_tick = read_tick;
+    have_last = 1;
+
+    if (period_sens == 0) {
+        wait_ticks = POLL_SCHED_FAST_US;
+        return;
+    }
+    stats.locked = 1;
+
+    // Phase detector: samples land on multiples of the period in sensor time, so the low bits
+    // of sens_time say how long ago the sample we just read was produced
+    until_next = period_sens - (sens_time & (period_sens - 1));
+    wait_ticks = ((until_next * (ratio_q16 >> 8)) >> 8) + POLL_SCHED_GUARD_US;
+}
+
+void poll_sched_get_stats(struct poll_sched_stats *out) {
+    *out = stats;
+    out->period_sens = period_sens;
+    out->ratio_q16 = ratio_q16;
+}
+
+#if defined(__TI_COMPILER_VERSION__) || defined(__IAR_SYSTEMS_ICC__)
+#pragma vector=TIMER0_A0_VECTOR
+__interrupt
+#elif defined(__GNUC__)
+__attribute__((interrupt(TIMER0_A0_VECTOR)))
+#endif
+void TIMER0_A0_ISR(void)
+{
+    __bic_SR_register_on_exit(LPM0_bits); // leave low power mode
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+Timer-predicted polling for boards that don't have the BMI270's INT1 pin wired up.
+
+Instead of hammering the data registers, poll_sched_wait() sleeps in LPM0 until just after
+the next sample is expected. The prediction is a small PLL locked to the sensor's own clock:
+- the sample period (in sensor time ticks) is learned from successive sens_time values,
+- the phase comes from sens_time itself, since the BMI270 produces samples when its 25.6 kHz
+  sensor time counter is a multiple of the period,
+- the ratio between the sensor clock and our timer is tracked so DCO drift doesn't walk the
+  wake-up point off the sample.
+If a read finds no new data, we fall back to polling every POLL_SCHED_FAST_US until a sample
+turns up, and after POLL_SCHED_MAX_MISSES misses in a row we drop the lock and relearn.
+
+Uses TIMER_A0 in continuous mode at 1 MHz (SMCLK / 8), and CCR0 for the wake-up.
+*/
+
+// How long after the expected sample instant to wake up, in timer ticks (us)
+#define POLL_SCHED_GUARD_US 40
+// Polling interval used while unlocked or after a miss
+#define POLL_SCHED_FAST_US 100
+// Consecutive misses before the lock is dropped
+#define POLL_SCHED_MAX_MISSES 8
+
+struct poll_sched_stats {
+    uint32_t reads;
+    uint32_t misses;
+    // Estimated sample period, in sensor time ticks (1 tick = 39.0625 us)
+    uint16_t period_sens;
+    // Timer ticks per sensor time tick, Q16
+    uint32_t ratio_q16;
+    uint8_t locked;
+};
+
+void poll_sched_init(void);
+
+// Sleep until the next sample is expected to be ready (returns immediately if it's overdue)
+void poll_sched_wait(void);
+
+// Feed the result of the read that followed poll_sched_wait(): whether it found a new
+// sample, and the sensor time that came with it. Call it straight after the read, since the
+// timer is sampled here to pair with sens_time.
+void poll_sched_update(uint8_t fresh, uint32_t sens_time);
+
+void poll_sched_get_stats(struct poll_sched_stats *stats);
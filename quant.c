@@ -0,0 +1,105 @@
+#include "quant.h"
+
+static const uint8_t widths[QUANT_AXES] = {
+    QUANT_ACC_BITS, QUANT_ACC_BITS, QUANT_ACC_BITS, QUANT_GYR_BITS, QUANT_GYR_BITS, QUANT_GYR_BITS
+};
+
+// Axis i of a sample: accel x, y, z, then gyro x, y, z, which lie next to each other
+static int16_t axis(const struct bmi2_sens_data *s, uint8_t i) {
+    return (i < 3) ? (&s->acc.x)[i] : (&s->gyr.x)[i - 3];
+}
+
+// v / 2^e, rounded to the nearest (halves up); >> floors on both compilers
+static int32_t scale(int16_t v, uint8_t e) {
+    return e ? ((int32_t)v + (1L << (e - 1))) >> e : v;
+}
+
+#if QUANT_BFP
+// The smallest exponent that fits the range min..max into a field of bits
+static uint8_t fit(int16_t min, int16_t max, uint8_t bits) {
+    uint8_t e = 0;
+
+    while (e < 16 - bits &&
+           (scale(max, e) > (1L << (bits - 1)) - 1 || scale(min, e) < -(1L << (bits - 1)))) {
+        e += 1;
+    }
+    return e;
+}
+#endif
+
+void quant_begin(struct quant_block *b, const struct bmi2_sens_data *data, uint16_t first, uint8_t count) {
+    uint8_t i, k;
+#if QUANT_BFP
+    int16_t v, min, max;
+#endif
+
+    for (i = 0; i < QUANT_AXES; i += 1) {
+#if QUANT_BFP
+        min = max = axis(&data[0], i);
+        for (k = 1; k < count; k += 1) {
+            v = axis(&data[k], i);
+            if (v < min) {
+                min = v;
+            } else if (v > max) {
+                max = v;
+            }
+        }
+        b->exps[i] = fit(min, max, widths[i]);
+#else
+        b->exps[i] = 16 - widths[i];
+#endif
+    }
+
+    b->header[0] = QUANT_SYNC0;
+    b->header[1] = QUANT_SYNC1;
+    b->header[2] = first & 0xff;
+    b->header[3] = first >> 8;
+    b->header[4] = count;
+    b->header[5] = (QUANT_ACC_BITS << 4) | QUANT_GYR_BITS;
+    b->header[6] = (b->exps[0] << 4) | b->exps[1];
+    b->header[7] = (b->exps[2] << 4) | b->exps[3];
+    b->header[8] = (b->exps[4] << 4) | b->exps[5];
+
+    b->left = count;
+    b->sum = 0;
+    for (k = 0; k < QUANT_HEADER; k += 1) {
+        b->sum += b->header[k];
+    }
+}
+
+uint8_t quant_pack(struct quant_block *b, const struct bmi2_sens_data *s, uint8_t *out) {
+    uint32_t bits = 0;
+    int32_t q, top;
+    uint8_t i, have = 0, len = 2;
+
+    out[0] = s->sens_time & 0xff;
+    out[1] = (s->sens_time >> 8) & 0xff;
+
+    for (i = 0; i < QUANT_AXES; i += 1) {
+        // Only the top of the range can round past what the field holds
+        top = (1L << (widths[i] - 1)) - 1;
+        q = scale(axis(s, i), b->exps[i]);
+        if (q > top) {
+            q = top;
+        }
+        bits |= ((uint32_t)q & ((1UL << widths[i]) - 1)) << have;
+        have += widths[i];
+        while (have >= 8) {
+            out[len++] = bits & 0xff;
+            bits >>= 8;
+            have -= 8;
+        }
+    }
+    if (have) {
+        out[len++] = bits & 0xff;
+    }
+
+    for (i = 0; i < len; i += 1) {
+        b->sum += out[i];
+    }
+    b->left -= 1;
+    if (b->left == 0) {
+        out[len++] = ~b->sum;
+    }
+    return len;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdint.h>
+#include "BMI270_SensorAPI/bmi2.h"
+
+/*
+Lossy packing of the samples, for DUMP_FORMAT == DUMP_QUANT: each axis keeps QUANT_ACC_BITS or
+QUANT_GYR_BITS bits instead of 16, trading a known error for fewer bytes on the link and in the
+FRAM log.
+
+Samples go out in blocks of up to QUANT_BLOCK. Each axis of a block shares an exponent e, and
+sends its values rounded to the nearest multiple of 2^e, as v / 2^e in a signed field of the
+axis's width. With QUANT_BFP=1 (block floating point) e is the smallest that fits the block's
+values, so a quiet axis keeps all its bits and a busy one loses only what it must; with
+QUANT_BFP=0 it's always 16 minus the width, a plain drop of the low bits. Either way the error
+is at most 2^(e-1), bar the top of the range, which is clipped by up to 2^e - 1.
+
+A block is a header
+
+  d5 5d first_lo first_hi count widths e01 e23 e45
+
+(first: index of its first sample, as in the binary records; widths: accel's in the high
+nibble and gyro's in the low; e01..e45: the exponents of ax ay az gx gy gz, a nibble each,
+high nibble first), then count samples of
+
+  sens_lo sens_hi  ax ay az gx gy gz
+
+with the six fields packed least significant bit first and the last byte padded with zeros,
+then a check byte: the block's bytes before it summed, complemented. The fields are 8 to 15
+bits; at 12 bits a sample is 11 bytes against the binary format's 16, at 10 bits 10, at 8 bits
+8. host/quant_unpack.c turns the blocks back into binary records.
+*/
+
+#ifndef QUANT_ACC_BITS
+#define QUANT_ACC_BITS 12
+#endif
+
+#ifndef QUANT_GYR_BITS
+#define QUANT_GYR_BITS 12
+#endif
+
+// 1 for an exponent per block and axis from the block's values, 0 for a fixed one
+#ifndef QUANT_BFP
+#define QUANT_BFP 1
+#endif
+
+// Samples per block, at most 255
+#ifndef QUANT_BLOCK
+#define QUANT_BLOCK 16
+#endif
+
+#if QUANT_ACC_BITS < 8 || QUANT_ACC_BITS > 15 || QUANT_GYR_BITS < 8 || QUANT_GYR_BITS > 15
+#error "QUANT_ACC_BITS and QUANT_GYR_BITS have to be 8 to 15"
+#endif
+#if QUANT_BLOCK < 1 || QUANT_BLOCK > 255
+#error "QUANT_BLOCK has to be 1 to 255"
+#endif
+
+#define QUANT_SYNC0 0xD5
+#define QUANT_SYNC1 0x5D
+#define QUANT_HEADER 9
+#define QUANT_AXES 6
+// A packed sample, and the longest quant_pack() makes (the block's last, with the check byte)
+#define QUANT_SAMPLE_LEN (2 + (3 * QUANT_ACC_BITS + 3 * QUANT_GYR_BITS + 7) / 8)
+#define QUANT_PACK_MAX (QUANT_SAMPLE_LEN + 1)
+
+struct quant_block {
+    uint8_t header[QUANT_HEADER];
+    uint8_t exps[QUANT_AXES];
+    // Samples still to pack, and the running sum for the check byte
+    uint8_t left;
+    uint8_t sum;
+};
+
+// Start a block of the count samples at data, the first of them being sample first: pick the
+// exponents and make the header
+void quant_begin(struct quant_block *b, const struct bmi2_sens_data *data, uint16_t first, uint8_t count);
+
+// Pack the block's next sample into out, with the check byte after the last. Returns the
+// length, at most QUANT_PACK_MAX.
+uint8_t quant_pack(struct quant_block *b, const struct bmi2_sens_data *s, uint8_t *out);
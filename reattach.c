@@ -0,0 +1,199 @@
+#include <driverlib.h>
+#include "BMI270_SensorAPI/bmi270.h"
+#include "reattach.h"
+#include "bmi270_spi.h"
+
+// The status read covers CHIP_ID through INTERNAL_STATUS in one burst
+#define STATUS_READ_LEN (BMI2_INTERNAL_STATUS_ADDR - BMI2_CHIP_ID_ADDR + 1)
+
+// Configuration load can take up to 20 ms after the upload
+#define CONFIG_LOAD_POLLS 20
+
+// A sensor that has just browned out needs as long as after a soft reset to answer again
+#define POWER_UP_US 2000
+
+struct reg_run {
+    uint8_t addr;
+    uint8_t len;
+};
+
+// Register blocks making up the configuration, in the order they have to be written back.
+// Power configuration goes last so advanced power save doesn't slow down the other writes.
+static const struct reg_run reg_runs[] = {
+    { BMI2_ACC_CONF_ADDR, BMI2_FIFO_CONFIG_1_ADDR - BMI2_ACC_CONF_ADDR + 1 },      // ACC_CONF .. FIFO_CONFIG_1
+    { BMI2_INT1_IO_CTRL_ADDR, BMI2_INT_MAP_DATA_ADDR - BMI2_INT1_IO_CTRL_ADDR + 1 }, // INT1_IO_CTRL .. INT_MAP_DATA
+    { BMI2_PWR_CTRL_ADDR, 1 },
+    { BMI2_PWR_CONF_ADDR, 1 },
+};
+#define NUM_REG_RUNS (sizeof(reg_runs) / sizeof(reg_runs[0]))
+#define REG_IMAGE_LEN 18
+
+struct snapshot {
+    uint8_t valid;
+    uint8_t regs[REG_IMAGE_LEN];
+    // Bit n set if feature page n holds configuration
+    uint8_t page_mask;
+    uint8_t pages[BMI270_MAX_PAGE_NUM][BMI2_FEAT_SIZE_IN_BYTES];
+};
+
+#pragma PERSISTENT(snap)
+static struct snapshot snap = { 0 };
+
+int8_t reattach_snapshot(struct bmi2_dev *bmi) {
+    int8_t rslt = BMI2_OK;
+    uint8_t i, offset = 0;
+
+    snap.valid = 0;
+
+    for (i = 0; i < NUM_REG_RUNS && rslt == BMI2_OK; i += 1) {
+        rslt = bmi2_get_regs(reg_runs[i].addr, &snap.regs[offset], reg_runs[i].len, bmi);
+        offset += reg_runs[i].len;
+    }
+
+    // Only the pages the feature inputs live on need keeping
+    snap.page_mask = 0;
+    for (i = 0; i < bmi->variant->input_sens; i += 1) {
+        snap.page_mask |= 1 << bmi->variant->feat_config[i].page;
+    }
+    for (i = 0; i < BMI270_MAX_PAGE_NUM && rslt == BMI2_OK; i += 1) {
+        if (snap.page_mask & (1 << i)) {
+            rslt = bmi2_get_feat_config(i, snap.pages[i], bmi);
+        }
+    }
+
+    if (rslt == BMI2_OK) {
+        snap.valid = 1;
+    }
+    return rslt;
+}
+
+static int8_t upload_config(struct bmi2_dev *bmi) {
+    int8_t rslt;
+    uint8_t status = 0;
+    uint8_t i;
+
+    rslt = bmi2_write_config_file(bmi);
+    if (rslt != BMI2_E_CONFIG_LOAD) {
+        return rslt;
+    }
+
+    // The sensor may still be initializing, give it a little longer
+    for (i = 0; i < CONFIG_LOAD_POLLS; i += 1) {
+        bmi->delay_us(1000, bmi->intf_ptr);
+        rslt = bmi2_get_internal_status(&status, bmi);
+        if (rslt != BMI2_OK) {
+            return rslt;
+        }
+        if ((status & BMI2_CONFIG_LOAD_STATUS_MASK) == BMI2_CONFIG_LOAD_SUCCESS) {
+            bmi->load_status = BMI2_CONFIG_LOAD_SUCCESS;
+            return BMI2_OK;
+        }
+    }
+    return BMI2_E_CONFIG_LOAD;
+}
+
+/* Write back the parts of a register run that differ from the snapshot, as one burst. If the
+sensor was reset, there's no point reading it back first. */
+static int8_t restore_run(const struct reg_run *run, const uint8_t *image, uint8_t was_reset,
+                          struct bmi2_dev *bmi, uint8_t *restored) {
+    int8_t rslt;
+    uint8_t current[REG_IMAGE_LEN];
+    int8_t first = 0, last = run->len - 1;
+
+    if (!was_reset) {
+        rslt = bmi2_get_regs(run->addr, current, run->len, bmi);
+        if (rslt != BMI2_OK) {
+            return rslt;
+        }
+        while (first <= last && current[first] == image[first]) {
+            first += 1;
+        }
+        while (last >= first && current[last] == image[last]) {
+            last -= 1;
+        }
+        if (first > last) {
+            return BMI2_OK;
+        }
+    }
+
+    *restored |= REATTACH_REGS;
+    return bmi2_set_regs(run->addr + first, &image[first], last - first + 1, bmi);
+}
+
+int8_t reattach(struct bmi2_dev *bmi, uint8_t *restored) {
+    int8_t rslt;
+    uint8_t status[STATUS_READ_LEN];
+    uint8_t was_reset;
+    uint8_t i, offset = 0;
+
+    *restored = 0;
+    if (!snap.valid) {
+        return BMI2_E_INVALID_STATUS;
+    }
+
+    // One read tells us whether the sensor is there and whether it still has its config. After
+    // a brown-out the sensor may still be powering up, and once up it's in I2C mode until a
+    // read switches it to SPI, so give it the time to power up and two more goes.
+    rslt = bmi2_get_regs(BMI2_CHIP_ID_ADDR, status, STATUS_READ_LEN, bmi);
+    for (i = 0; i < 2 && rslt == BMI2_OK && status[0] != bmi->chip_id; i += 1) {
+        if (i == 0) {
+            bmi->delay_us(POWER_UP_US, bmi->intf_ptr);
+        }
+        rslt = bmi2_get_regs(BMI2_CHIP_ID_ADDR, status, STATUS_READ_LEN, bmi);
+    }
+    if (rslt != BMI2_OK) {
+        return rslt;
+    }
+    if (status[0] != bmi->chip_id) {
+        return BMI2_E_DEV_NOT_FOUND;
+    }
+
+    was_reset = (status[STATUS_READ_LEN - 1] & BMI2_CONFIG_LOAD_STATUS_MASK) != BMI2_CONFIG_LOAD_SUCCESS;
+    if (was_reset) {
+        // Out of reset the sensor is in advanced power save mode
+        bmi->aps_status = BMI2_ENABLE;
+
+        rslt = upload_config(bmi);
+        if (rslt != BMI2_OK) {
+            return rslt;
+        }
+        *restored |= REATTACH_CONFIG_FILE;
+
+        // Feature pages come back as defaults along with the config file
+        for (i = 0; i < BMI270_MAX_PAGE_NUM && rslt == BMI2_OK; i += 1) {
+            if (snap.page_mask & (1 << i)) {
+                rslt = bmi2_set_regs(BMI2_FEAT_PAGE_ADDR, &i, 1, bmi);
+                if (rslt == BMI2_OK) {
+                    rslt = bmi2_set_regs(BMI2_FEATURES_REG_ADDR, snap.pages[i], BMI2_FEAT_SIZE_IN_BYTES, bmi);
+                }
+            }
+        }
+    }
+
+    for (i = 0; i < NUM_REG_RUNS && rslt == BMI2_OK; i += 1) {
+        rslt = restore_run(&reg_runs[i], &snap.regs[offset], was_reset, bmi, restored);
+        offset += reg_runs[i].len;
+    }
+
+    return rslt;
+}
+
+void reattach_note(uint8_t addr, uint8_t value) {
+    uint8_t i, offset = 0;
+
+    for (i = 0; i < NUM_REG_RUNS; i += 1) {
+        if (addr >= reg_runs[i].addr && addr < reg_runs[i].addr + reg_runs[i].len) {
+            snap.regs[offset + addr - reg_runs[i].addr] = value;
+            return;
+        }
+        offset += reg_runs[i].len;
+    }
+}
+
+int8_t reattach_recover(struct bmi2_dev *bmi) {
+    // What had to be restored; not needed here
+    uint8_t restored;
+
+    bmi270_spi_recover();
+    return reattach(bmi, &restored);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+#include "BMI270_SensorAPI/bmi2.h"
+
+/*
+Fast re-attach to the sensor after a bus failure or a sensor brown-out.
+
+reattach_snapshot() keeps a compact copy of the configuration the sensor ended up with --
+register images of the config and interrupt blocks, power control, and the feature pages -- in
+FRAM. reattach() then works out with a single status read whether the sensor kept its state,
+and restores only what it lost: the config file is uploaded only if INTERNAL_STATUS says it's
+gone, and registers are rewritten only where they differ from the snapshot, one burst per
+differing span.
+*/
+
+// What reattach() had to restore
+#define REATTACH_REGS 0x01
+#define REATTACH_CONFIG_FILE 0x02
+
+// Capture the sensor's current configuration. Call once setup is complete.
+int8_t reattach_snapshot(struct bmi2_dev *bmi);
+
+// Bring the sensor back to the snapshot; restored gets REATTACH_* flags for what was rewritten
+int8_t reattach(struct bmi2_dev *bmi, uint8_t *restored);
+
+// A register the snapshot holds has been written to value since it was taken, and is to be
+// restored to that instead
+void reattach_note(uint8_t addr, uint8_t value);
+
+// Get the sample stream going again after a bus failure: reset the SPI interface, then
+// reattach()
+int8_t reattach_recover(struct bmi2_dev *bmi);
@@ -0,0 +1,465 @@
+#include <stdio.h>
+#include <string.h>
+#include <driverlib.h>
+#include "BMI270_SensorAPI/bmi2.h"
+#include "regscript.h"
+
+// Ops; multi-byte operands are little-endian
+#define RS_END 0x00
+#define RS_WRITE 0x01  // addr, len, data[len]
+#define RS_CONFIG 0x02 // offset16, len16, chunk16, gap16
+#define RS_DELAY 0x03  // us16
+#define RS_POLL 0x04   // addr, mask, value, tries
+
+#define SCRIPT_VALID 0x5253
+#define NO_OP 0xFFFF
+
+// Data bytes per line of regscript_print()
+#define PRINT_BYTES 16
+
+struct script {
+    uint16_t valid;
+    uint16_t len;
+    // The API's state at the end of the recording
+    struct bmi2_dev dev;
+    uint8_t ops[REGSCRIPT_SIZE];
+};
+
+#pragma PERSISTENT(script)
+static struct script script = { 0 };
+
+static struct {
+    struct bmi2_dev *bmi;
+    bmi2_read_fptr_t read;
+    bmi2_write_fptr_t write;
+    bmi2_delay_fptr_t delay_us;
+    uint16_t len;
+    uint8_t overflow;
+    // The last access was dropped or went into a config op, so the delay after it goes too
+    uint8_t skip_delay;
+    // The next CHIP_ID read only brings the interface over to SPI
+    uint8_t spi_switch;
+    // Offset of the RS_DELAY or RS_CONFIG op the script ends with, to extend it
+    uint16_t delay_op;
+    uint16_t config_op;
+    // An INIT_ADDR write is held back until it's clear whether a config chunk follows:
+    // 1 once held, 2 once the delay after it came too
+    uint8_t init_pending;
+    uint8_t init_addr[2];
+    uint32_t init_gap;
+} rec;
+
+static uint16_t get16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static void put16(uint8_t *p, uint16_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+// Append an op with size bytes of operands, leaving room for RS_END; NULL if it doesn't fit
+static uint8_t *emit(uint8_t op, uint16_t size) {
+    uint16_t at = rec.len;
+
+    if (rec.overflow || (uint32_t)at + 1 + size + 1 > REGSCRIPT_SIZE) {
+        rec.overflow = 1;
+        return NULL;
+    }
+    script.ops[at] = op;
+    rec.len = at + 1 + size;
+    rec.delay_op = NO_OP;
+    rec.config_op = NO_OP;
+    return &script.ops[at + 1];
+}
+
+static void emit_write(uint8_t addr, const uint8_t *data, uint32_t len) {
+    uint8_t *op;
+
+    if (len > 0xFF) {
+        rec.overflow = 1;
+        return;
+    }
+    op = emit(RS_WRITE, 2 + len);
+    if (op) {
+        op[0] = addr;
+        op[1] = (uint8_t)len;
+        memcpy(&op[2], data, len);
+    }
+}
+
+static void emit_delay(uint32_t us) {
+    uint8_t *op;
+    uint32_t total;
+
+    while (us > 0) {
+        if (rec.delay_op != NO_OP) {
+            op = &script.ops[rec.delay_op + 1];
+            total = get16(op) + us;
+            if (total <= 0xFFFF) {
+                put16(op, (uint16_t)total);
+                return;
+            }
+            put16(op, 0xFFFF);
+            us = total - 0xFFFF;
+        }
+        op = emit(RS_DELAY, 2);
+        if (!op) {
+            return;
+        }
+        put16(op, 0);
+        rec.delay_op = (uint16_t)(op - 1 - script.ops);
+    }
+}
+
+static void emit_poll(uint8_t addr, uint8_t mask, uint8_t value, uint8_t tries) {
+    uint8_t *op = emit(RS_POLL, 4);
+
+    if (op) {
+        op[0] = addr;
+        op[1] = mask;
+        op[2] = value;
+        op[3] = tries;
+    }
+}
+
+// Write out a held back INIT_ADDR write, now that it isn't part of the config upload
+static void flush_init(void) {
+    uint8_t pending = rec.init_pending;
+
+    rec.init_pending = 0;
+    if (pending) {
+        emit_write(BMI2_INIT_ADDR_0, rec.init_addr, 2);
+    }
+    if (pending == 2) {
+        emit_delay(rec.init_gap);
+    }
+}
+
+// A write to INIT_DATA is a config chunk if it's the config file's bytes at INIT_ADDR
+static uint8_t config_chunk(const uint8_t *data, uint32_t len, uint16_t *index) {
+    const struct bmi2_variant *variant = rec.bmi->variant;
+
+    *index = (uint16_t)(((rec.init_addr[1] << 4) | (rec.init_addr[0] & 0x0F)) * 2);
+    return variant && variant->config_file_ptr && (uint32_t)*index + len <= variant->config_size &&
+           memcmp(variant->config_file_ptr + *index, data, len) == 0;
+}
+
+static void record_config(uint16_t index, uint16_t len) {
+    uint8_t *op;
+
+    // The upload goes one chunk after another, so most chunks just extend the op
+    if (rec.config_op != NO_OP) {
+        op = &script.ops[rec.config_op + 1];
+        if (get16(&op[0]) + get16(&op[2]) == index && get16(&op[4]) == len) {
+            put16(&op[2], get16(&op[2]) + len);
+            return;
+        }
+    }
+    op = emit(RS_CONFIG, 8);
+    if (op) {
+        put16(&op[0], index);
+        put16(&op[2], len);
+        put16(&op[4], len);
+        put16(&op[6], (uint16_t)rec.init_gap);
+        rec.config_op = (uint16_t)(op - 1 - script.ops);
+    }
+}
+
+static BMI2_INTF_RETURN_TYPE record_write(uint8_t reg_addr, const uint8_t *data, uint32_t len, void *intf_ptr) {
+    BMI2_INTF_RETURN_TYPE ret = rec.write(reg_addr, data, len, intf_ptr);
+    uint16_t index;
+
+    rec.skip_delay = 0;
+    if (ret != BMI2_INTF_RET_SUCCESS) {
+        // The bring-up fails with it, so the script won't be kept
+        return ret;
+    }
+
+    if (reg_addr == BMI2_INIT_DATA_ADDR && rec.init_pending && config_chunk(data, len, &index)) {
+        if (rec.init_pending == 1) {
+            rec.init_gap = 0;
+        }
+        rec.init_pending = 0;
+        record_config(index, (uint16_t)len);
+        rec.skip_delay = 1;
+        return ret;
+    }
+
+    flush_init();
+    if (reg_addr == BMI2_INIT_ADDR_0 && len == 2) {
+        rec.init_addr[0] = data[0];
+        rec.init_addr[1] = data[1];
+        rec.init_pending = 1;
+        return ret;
+    }
+    if (reg_addr == BMI2_CMD_REG_ADDR && data[0] == BMI2_SOFT_RESET_CMD) {
+        rec.spi_switch = 1;
+    }
+    emit_write(reg_addr, data, len);
+    return ret;
+}
+
+// The API waits out the longest config load before reading INTERNAL_STATUS; poll for that
+// long instead, so a sensor that's done sooner doesn't keep the script waiting. The first
+// millisecond stays, as a gap before the first read like the one between retries.
+static uint8_t status_tries(void) {
+    uint32_t tries = REGSCRIPT_POLL_TRIES;
+    uint16_t us;
+
+    if (rec.delay_op != NO_OP) {
+        us = get16(&script.ops[rec.delay_op + 1]);
+        if (us >= 2000) {
+            tries += us / 1000 - 1;
+            put16(&script.ops[rec.delay_op + 1], 1000 + us % 1000);
+        }
+    }
+    return tries > 0xFF ? 0xFF : (uint8_t)tries;
+}
+
+static BMI2_INTF_RETURN_TYPE record_read(uint8_t reg_addr, uint8_t *data, uint32_t len, void *intf_ptr) {
+    BMI2_INTF_RETURN_TYPE ret = rec.read(reg_addr, data, len, intf_ptr);
+    uint8_t reg = reg_addr & BMI2_SPI_WR_MASK;
+
+    rec.skip_delay = 0;
+    if (ret != BMI2_INTF_RET_SUCCESS) {
+        return ret;
+    }
+
+    flush_init();
+    // data[len - 1] is the register, after the dummy byte if there is one
+    if (len == 1u + rec.bmi->dummy_byte && reg == BMI2_CHIP_ID_ADDR) {
+        if (rec.spi_switch) {
+            emit_poll(reg_addr, 0, 0, 0);
+        } else {
+            emit_poll(reg_addr, 0xFF, data[len - 1], 1);
+        }
+        rec.spi_switch = 0;
+    } else if (len == 1u + rec.bmi->dummy_byte && reg == BMI2_INTERNAL_STATUS_ADDR) {
+        emit_poll(reg_addr, BMI2_CONFIG_LOAD_STATUS_MASK, data[len - 1] & BMI2_CONFIG_LOAD_STATUS_MASK,
+                  status_tries());
+    } else {
+        rec.skip_delay = 1;
+    }
+    return ret;
+}
+
+static void record_delay(uint32_t period, void *intf_ptr) {
+    rec.delay_us(period, intf_ptr);
+
+    if (rec.init_pending == 1) {
+        rec.init_gap = period;
+        rec.init_pending = 2;
+        return;
+    }
+    flush_init();
+    if (rec.skip_delay) {
+        rec.skip_delay = 0;
+        return;
+    }
+    emit_delay(period);
+}
+
+void regscript_record(struct bmi2_dev *bmi) {
+    script.valid = 0;
+
+    memset(&rec, 0, sizeof(rec));
+    rec.bmi = bmi;
+    rec.read = bmi->read;
+    rec.write = bmi->write;
+    rec.delay_us = bmi->delay_us;
+    rec.delay_op = NO_OP;
+    rec.config_op = NO_OP;
+    // The recording starts from power-up, so the first CHIP_ID read is the dummy one
+    rec.spi_switch = 1;
+
+    bmi->read = record_read;
+    bmi->write = record_write;
+    bmi->delay_us = record_delay;
+}
+
+int8_t regscript_stop(struct bmi2_dev *bmi, int8_t rslt) {
+    flush_init();
+
+    bmi->read = rec.read;
+    bmi->write = rec.write;
+    bmi->delay_us = rec.delay_us;
+
+    if (rslt == BMI2_OK && rec.overflow) {
+        rslt = BMI2_E_OUT_OF_RANGE;
+    }
+    if (rslt == BMI2_OK) {
+        script.ops[rec.len] = RS_END;
+        script.len = rec.len;
+        script.dev = *bmi;
+        script.valid = SCRIPT_VALID;
+    }
+    return rslt;
+}
+
+uint8_t regscript_valid(void) {
+    return script.valid == SCRIPT_VALID;
+}
+
+uint16_t regscript_length(void) {
+    return regscript_valid() ? script.len : 0;
+}
+
+void regscript_clear(void) {
+    script.valid = 0;
+}
+
+static int8_t run_write(struct bmi2_dev *bmi, uint8_t addr, const uint8_t *data, uint16_t len) {
+    bmi->intf_rslt = bmi->write(addr, data, len, bmi->intf_ptr);
+    return bmi->intf_rslt == BMI2_INTF_RET_SUCCESS ? BMI2_OK : BMI2_E_COM_FAIL;
+}
+
+// The config upload as upload_file() does it: INIT_ADDR, then a chunk of INIT_DATA
+static int8_t run_config(struct bmi2_dev *bmi, uint16_t index, uint16_t len, uint16_t chunk, uint16_t gap) {
+    const uint8_t *config;
+    uint16_t end = index + len;
+    uint16_t n;
+    uint8_t addr[2];
+    int8_t rslt = BMI2_OK;
+
+    if (!bmi->variant || !bmi->variant->config_file_ptr || chunk == 0) {
+        return BMI2_E_NULL_PTR;
+    }
+    config = bmi->variant->config_file_ptr;
+
+    for (; index < end && rslt == BMI2_OK; index += n) {
+        n = end - index < chunk ? end - index : chunk;
+        addr[0] = (uint8_t)((index / 2) & 0x0F);
+        addr[1] = (uint8_t)((index / 2) >> 4);
+        rslt = run_write(bmi, BMI2_INIT_ADDR_0, addr, 2);
+        bmi->delay_us(gap, bmi->intf_ptr);
+        if (rslt == BMI2_OK) {
+            rslt = run_write(bmi, BMI2_INIT_DATA_ADDR, config + index, n);
+            bmi->delay_us(gap, bmi->intf_ptr);
+        }
+    }
+    return rslt;
+}
+
+static int8_t run_poll(struct bmi2_dev *bmi, uint8_t addr, uint8_t mask, uint8_t value, uint8_t tries) {
+    uint8_t buf[2];
+    uint8_t len = 1 + bmi->dummy_byte;
+    uint8_t i = 0;
+
+    do {
+        if (i > 0) {
+            bmi->delay_us(1000, bmi->intf_ptr);
+        }
+        bmi->intf_rslt = bmi->read(addr, buf, len, bmi->intf_ptr);
+        if (bmi->intf_rslt != BMI2_INTF_RET_SUCCESS) {
+            return BMI2_E_COM_FAIL;
+        }
+        if ((buf[len - 1] & mask) == value) {
+            return BMI2_OK;
+        }
+        i += 1;
+    } while (i < tries);
+
+    return (addr & BMI2_SPI_WR_MASK) == BMI2_CHIP_ID_ADDR ? BMI2_E_DEV_NOT_FOUND : BMI2_E_CONFIG_LOAD;
+}
+
+int8_t regscript_run(struct bmi2_dev *bmi) {
+    // Keep the freshly set up interface functions, everything else comes from the recording
+    bmi2_read_fptr_t read = bmi->read;
+    bmi2_write_fptr_t write = bmi->write;
+    bmi2_delay_fptr_t delay_us = bmi->delay_us;
+    void *intf_ptr = bmi->intf_ptr;
+    struct bmi2_scratch *scratch = bmi->scratch;
+    const uint8_t *op = script.ops;
+    int8_t rslt = BMI2_OK;
+
+    if (!regscript_valid()) {
+        return BMI2_E_INVALID_INPUT;
+    }
+
+    *bmi = script.dev;
+    bmi->read = read;
+    bmi->write = write;
+    bmi->delay_us = delay_us;
+    bmi->intf_ptr = intf_ptr;
+    bmi->scratch = scratch;
+
+    while (rslt == BMI2_OK && *op != RS_END) {
+        switch (*op) {
+            case RS_WRITE:
+                rslt = run_write(bmi, op[1], &op[3], op[2]);
+                op += 3 + op[2];
+                break;
+            case RS_CONFIG:
+                rslt = run_config(bmi, get16(&op[1]), get16(&op[3]), get16(&op[5]), get16(&op[7]));
+                op += 9;
+                break;
+            case RS_DELAY:
+                bmi->delay_us(get16(&op[1]), bmi->intf_ptr);
+                op += 3;
+                break;
+            case RS_POLL:
+                rslt = run_poll(bmi, op[1], op[2], op[3], op[4]);
+                op += 5;
+                break;
+            default:
+                rslt = BMI2_E_INVALID_INPUT;
+                break;
+        }
+    }
+    return rslt;
+}
+
+void regscript_print(regscript_print_fn print) {
+    char line[64];
+    const uint8_t *op = script.ops;
+    uint8_t i;
+    int len;
+
+    if (!regscript_valid()) {
+        print("no register script");
+        return;
+    }
+    sprintf(line, "register script, %u bytes", script.len);
+    print(line);
+
+    while (*op != RS_END) {
+        switch (*op) {
+            case RS_WRITE:
+                len = sprintf(line, "w %02x", op[1]);
+                for (i = 0; i < op[2]; i += 1) {
+                    if (i > 0 && i % PRINT_BYTES == 0) {
+                        print(line);
+                        len = sprintf(line, "    ");
+                    }
+                    len += sprintf(line + len, " %02x", op[3 + i]);
+                }
+                print(line);
+                op += 3 + op[2];
+                break;
+            case RS_CONFIG:
+                sprintf(line, "c %04x %u %u %u", get16(&op[1]), get16(&op[3]), get16(&op[5]), get16(&op[7]));
+                print(line);
+                op += 9;
+                break;
+            case RS_DELAY:
+                sprintf(line, "d %u", get16(&op[1]));
+                print(line);
+                op += 3;
+                break;
+            case RS_POLL:
+                if (op[4] == 0) {
+                    sprintf(line, "r %02x", op[1]);
+                } else {
+                    sprintf(line, "p %02x %02x %02x %u", op[1], op[2], op[3], op[4]);
+                }
+                print(line);
+                op += 5;
+                break;
+            default:
+                sprintf(line, "bad op %02x", *op);
+                print(line);
+                return;
+        }
+    }
+}
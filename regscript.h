@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stdint.h>
+#include "BMI270_SensorAPI/bmi2.h"
+
+/*
+Register scripts: the bus traffic of a bring-up, recorded once through the sensor API and
+replayed on later boots without it.
+
+regscript_record() puts itself between the API and bmi's read/write/delay_us, and
+regscript_stop() keeps what went over the bus as a script in FRAM, with the bmi2_dev state the
+API left behind. regscript_run() then plays the script straight into read/write/delay_us: no
+null checks, read-modify-writes or feature page reads, just the writes and waits that matter.
+
+Recording keeps:
+- every write, and the delay after it,
+- the config file upload as a single op, replayed from the variant's config file,
+- CHIP_ID reads, as a check that the sensor is there (the first read after a reset only brings
+  the interface over to SPI, so it is kept as a plain read),
+- INTERNAL_STATUS reads, as a wait until the config load status comes back the same; a delay
+  just before is folded into the wait, so the script only waits as long as the sensor needs,
+- delays, merged where they follow each other.
+Every other read is dropped, with the delay after it: the API only reads to decide what to
+write, and the writes are in the script already.
+
+regscript_print() lists the script one op per line, for review:
+
+  w 7e b6             write b6 to 0x7e
+  c 0000 8188 46 2    config file bytes 0..8187, 46 at a time, 2 us after each access
+  d 2000              wait 2000 us
+  r 80                read 0x00 (0x80 with the SPI read bit) and ignore it
+  p a1 0f 01 20       read 0x21 until (value & 0f) == 01, up to 20 times 1 ms apart
+                      (1 time: check once)
+*/
+
+#ifndef REGSCRIPT
+#define REGSCRIPT 0
+#endif
+
+// Bytes of ops kept in FRAM. A bmi270_init() plus accel/gyro setup takes about 200.
+#ifndef REGSCRIPT_SIZE
+#define REGSCRIPT_SIZE 512
+#endif
+
+// Times to read INTERNAL_STATUS before giving up on the config load
+#ifndef REGSCRIPT_POLL_TRIES
+#define REGSCRIPT_POLL_TRIES 20
+#endif
+
+// Where each line of regscript_print() goes
+typedef void (*regscript_print_fn)(const char *line);
+
+// Start recording everything bmi's interface does, until regscript_stop()
+void regscript_record(struct bmi2_dev *bmi);
+
+// Stop recording and put bmi's interface back. The script is kept if rslt (the bring-up's
+// result) is BMI2_OK and it fit; returns rslt, or BMI2_E_OUT_OF_RANGE if it didn't fit.
+int8_t regscript_stop(struct bmi2_dev *bmi, int8_t rslt);
+
+// Whether there's a recorded script to run
+uint8_t regscript_valid(void);
+
+// Bytes of ops in the recorded script
+uint16_t regscript_length(void);
+
+// Replay the script and give bmi the state it was recorded with (keeping its interface).
+// bmi must be set up by init_bmi_device().
+int8_t regscript_run(struct bmi2_dev *bmi);
+
+// Forget the script, so the next boot records a new one
+void regscript_clear(void);
+
+// List the script
+void regscript_print(regscript_print_fn print);
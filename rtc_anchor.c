@@ -0,0 +1,202 @@
+#include <string.h>
+#include <driverlib.h>
+#include "rtc_anchor.h"
+
+#define SECONDS_PER_DAY 86400UL
+
+#pragma PERSISTENT(anchors)
+static struct rtc_anchor anchors[RTC_ANCHOR_MAX] = { { 0 } };
+#pragma PERSISTENT(num_anchors)
+static uint16_t num_anchors = 0;
+
+// Whether the running calendar was set by rtc_anchor_set(); only means anything while the RTC
+// is running, which it stops doing at a brown-out
+#pragma PERSISTENT(synced)
+static uint8_t synced = 0;
+
+// Set by the ISR every RTC_ANCHOR_PERIOD seconds
+volatile static uint8_t due;
+static uint16_t seconds;
+
+// Days since 1970-01-01 of a date in the Gregorian calendar (month 1-12)
+static uint32_t days_from_civil(uint16_t year, uint8_t month, uint8_t day) {
+    uint16_t era, yoe;
+    uint32_t doy, doe;
+
+    year -= (month <= 2);
+    era = year / 400;
+    yoe = year - era * 400;
+    doy = (153 * (uint32_t)(month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    doe = (uint32_t)yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return (uint32_t)era * 146097 + doe - 719468;
+}
+
+static void civil_from_days(uint32_t days, Calendar *cal) {
+    uint32_t era, doe, yoe, doy, mp;
+
+    days += 719468;
+    era = days / 146097;
+    doe = days - era * 146097;
+    yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    mp = (5 * doy + 2) / 153;
+    cal->DayOfMonth = doy - (153 * mp + 2) / 5 + 1;
+    cal->Month = (mp < 10) ? mp + 3 : mp - 9;
+    cal->Year = yoe + era * 400 + (cal->Month <= 2);
+    // 1970-01-01 was a Thursday
+    cal->DayOfWeek = (days - 719468 + 4) % 7;
+}
+
+static uint8_t two_digits(const char *s) {
+    return (uint8_t)(((s[0] == ' ') ? 0 : (s[0] - '0') * 10) + (s[1] - '0'));
+}
+
+// __DATE__ ("Oct 18 2026") and __TIME__ ("12:34:56"), as seconds since 1970
+static uint32_t build_time(void) {
+    static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    const char *date = __DATE__;
+    const char *time = __TIME__;
+    uint8_t month = 0;
+
+    while (month < 11 && memcmp(&months[3 * month], date, 3) != 0) {
+        month += 1;
+    }
+    return days_from_civil(two_digits(&date[7]) * 100 + two_digits(&date[9]), month + 1,
+                           two_digits(&date[4])) * SECONDS_PER_DAY +
+           two_digits(&time[0]) * 3600UL + two_digits(&time[3]) * 60 + two_digits(&time[6]);
+}
+
+static void start_calendar(uint32_t utc) {
+    uint32_t of_day = utc % SECONDS_PER_DAY;
+    Calendar cal;
+
+    // The RTC counts months 1-12, whatever driverlib's Calendar says
+    civil_from_days(utc / SECONDS_PER_DAY, &cal);
+    cal.Hours = of_day / 3600;
+    cal.Minutes = (of_day / 60) % 60;
+    cal.Seconds = of_day % 60;
+
+    // This holds the clock, and it stays held until started again
+    RTC_C_initCalendar(RTC_C_BASE, &cal, RTC_C_FORMAT_BINARY);
+    RTC_C_startClock(RTC_C_BASE);
+}
+
+void rtc_anchor_init(void) {
+    // Only a brown-out resets the RTC, and it comes out of it held
+    if (RTCCTL13 & RTCHOLD) {
+        synced = 0;
+        start_calendar(RTC_ANCHOR_START ? RTC_ANCHOR_START : build_time());
+    }
+    RTC_C_clearInterrupt(RTC_C_BASE, RTC_C_CLOCK_READ_READY_INTERRUPT);
+    RTC_C_enableInterrupt(RTC_C_BASE, RTC_C_CLOCK_READ_READY_INTERRUPT);
+}
+
+void rtc_anchor_set(uint32_t utc) {
+    start_calendar(utc);
+    synced = 1;
+}
+
+void rtc_anchor_clear(void) {
+    num_anchors = 0;
+}
+
+int8_t rtc_anchor_take(struct bmi2_dev *bmi, uint16_t next) {
+    struct rtc_anchor a;
+    Calendar cal;
+    uint8_t ps0, ps1;
+    uint8_t sens[BMI2_SENSOR_TIME_LENGTH];
+    int8_t rslt;
+
+    // The prescalers carry into each other and into the calendar while they're read, so read
+    // them all again until nothing has moved on underneath
+    do {
+        cal = RTC_C_getCalendarTime(RTC_C_BASE);
+        ps1 = RTC_C_getPrescaleValue(RTC_C_BASE, RTC_C_PRESCALE_1);
+        ps0 = RTC_C_getPrescaleValue(RTC_C_BASE, RTC_C_PRESCALE_0);
+    } while (ps1 != RTC_C_getPrescaleValue(RTC_C_BASE, RTC_C_PRESCALE_1) ||
+             cal.Seconds != RTC_C_getCalendarTime(RTC_C_BASE).Seconds);
+
+    rslt = bmi2_get_regs(BMI2_SENSORTIME_ADDR, sens, sizeof(sens), bmi);
+    if (rslt != BMI2_OK) {
+        return rslt;
+    }
+
+    a.utc = days_from_civil(cal.Year, cal.Month, cal.DayOfMonth) * SECONDS_PER_DAY +
+            cal.Hours * 3600UL + cal.Minutes * 60 + cal.Seconds;
+    // RT0PS counts ACLK, and RT1PS (whose top bit is the seconds) counts RT0PS's overflows
+    a.subsec = ((uint16_t)(ps1 & 0x7F) << 8) | ps0;
+    a.sens_time = sens[0] | ((uint32_t)sens[1] << 8) | ((uint32_t)sens[2] << 16);
+    a.next = next;
+    a.flags = synced ? RTC_ANCHOR_SYNCED : 0;
+
+    // Full up: keep the latest in the last slot, so the end of the capture is still anchored
+    if (num_anchors < RTC_ANCHOR_MAX) {
+        num_anchors += 1;
+    }
+    anchors[num_anchors - 1] = a;
+    return BMI2_OK;
+}
+
+int8_t rtc_anchor_poll(struct bmi2_dev *bmi, uint16_t next) {
+    if (!due) {
+        return BMI2_OK;
+    }
+    due = 0;
+    return rtc_anchor_take(bmi, next);
+}
+
+uint16_t rtc_anchor_count(void) {
+    return num_anchors;
+}
+
+const struct rtc_anchor *rtc_anchor_get(uint16_t i) {
+    return &anchors[i];
+}
+
+void rtc_anchor_pack(uint16_t i, uint8_t out[RTC_ANCHOR_LEN]) {
+    const struct rtc_anchor *a = &anchors[i];
+    uint8_t k, sum = 0;
+
+    out[0] = RTC_ANCHOR_SYNC0;
+    out[1] = RTC_ANCHOR_SYNC1;
+    out[2] = a->next & 0xff;
+    out[3] = a->next >> 8;
+    out[4] = a->sens_time & 0xff;
+    out[5] = (a->sens_time >> 8) & 0xff;
+    out[6] = (a->sens_time >> 16) & 0xff;
+    out[7] = i & 0xff;
+    out[8] = a->utc & 0xff;
+    out[9] = (a->utc >> 8) & 0xff;
+    out[10] = (a->utc >> 16) & 0xff;
+    out[11] = a->utc >> 24;
+    out[12] = a->subsec & 0xff;
+    out[13] = a->subsec >> 8;
+    out[14] = a->flags;
+    for (k = 0; k < RTC_ANCHOR_LEN - 1; k += 1) {
+        sum += out[k];
+    }
+    out[15] = ~sum;
+}
+
+
+#if defined(__TI_COMPILER_VERSION__) || defined(__IAR_SYSTEMS_ICC__)
+#pragma vector=RTC_C_VECTOR
+__interrupt
+#elif defined(__GNUC__)
+__attribute__((interrupt(RTC_C_VECTOR)))
+#endif
+void RTC_C_ISR(void)
+{
+  switch(__even_in_range(RTCIV,RTCIV__RT1PSIFG))
+  {
+    // Once a second, as the calendar moves on; nothing to wake for, the capture loop looks
+    case RTCIV__RTCRDYIFG:
+        seconds += 1;
+        if (seconds >= RTC_ANCHOR_PERIOD) {
+            seconds = 0;
+            due = 1;
+        }
+        break;
+    default: break;
+  }
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <stdint.h>
+#include "BMI270_SensorAPI/bmi2.h"
+
+/*
+Wall-clock anchors for the BMI270's sensor time. The RTC_C runs a calendar from the 32.768 kHz
+crystal (LFXT, on ACLK), and every RTC_ANCHOR_PERIOD seconds the capture loop pairs its time,
+to 1/32768 s from the prescalers, with the 24 bit sensor time read straight after. A host can
+then put every sample on UTC (host/sample_utc.c), taking out the drift between the two clocks
+as it goes, instead of lining captures up with other data by hand.
+
+The anchors are kept in FRAM with the samples, and dump_samples() sends each one ahead of the
+sample it was taken before, as a 16 byte binary record
+
+  a9 9a next_lo next_hi  sens0 sens1 sens2 seq  utc0 utc1 utc2 utc3  sub_lo sub_hi  flags check
+
+(next: index of the sample after it; sens: sensor time; seq: the anchor's number in the
+capture; utc: seconds since 1970-01-01; sub: 1/32768ths of a second; flags: RTC_ANCHOR_SYNCED
+if the calendar had been set when it was taken; check: the bytes before it summed,
+complemented), or, with DUMP_CSV, a line
+
+  @, next, sens_time, utc, sub, flags
+
+There's an anchor before the first sample of a capture and after the last, so even a short one
+is bracketed.
+
+The RTC keeps running through any reset short of a brown-out, and rtc_anchor_init() leaves it
+be when it finds it running. Otherwise it starts the calendar from RTC_ANCHOR_START seconds
+since 1970-01-01 UTC, or by default from the time the firmware was built (__DATE__ and
+__TIME__, taken as UTC; set RTC_ANCHOR_START if the build machine's clock isn't), which is only
+a guess: anchors are flagged as synced once rtc_anchor_set() has been given the real time,
+with the dump service's T command (dump_service.h), and stay so until the RTC loses it.
+*/
+
+#ifndef RTC_ANCHOR
+#define RTC_ANCHOR 0
+#endif
+
+// Seconds between anchors
+#ifndef RTC_ANCHOR_PERIOD
+#define RTC_ANCHOR_PERIOD 1
+#endif
+
+// Anchors kept per capture; any after that are dropped, bar the last
+#ifndef RTC_ANCHOR_MAX
+#define RTC_ANCHOR_MAX 64
+#endif
+
+// 0 for the build time
+#ifndef RTC_ANCHOR_START
+#define RTC_ANCHOR_START 0
+#endif
+
+#define RTC_ANCHOR_SYNC0 0xA9
+#define RTC_ANCHOR_SYNC1 0x9A
+#define RTC_ANCHOR_LEN 16
+#define RTC_ANCHOR_SUBSEC_HZ 32768
+
+// Anchor flags
+#define RTC_ANCHOR_SYNCED 0x01
+
+struct rtc_anchor {
+    // Seconds since 1970-01-01 UTC, and 1/32768ths
+    uint32_t utc;
+    uint16_t subsec;
+    // 24 bit, in 39.0625 us ticks
+    uint32_t sens_time;
+    // Index of the next sample to be captured
+    uint16_t next;
+    // RTC_ANCHOR_*
+    uint8_t flags;
+};
+
+// Start the RTC unless it's still running from before a reset, and take its interrupt; ACLK
+// has to be running from LFXT already
+void rtc_anchor_init(void);
+
+// Set the calendar to utc, seconds since 1970-01-01 UTC, and count it as synced from now on
+void rtc_anchor_set(uint32_t utc);
+
+// Forget the last capture's anchors
+void rtc_anchor_clear(void);
+
+// Take an anchor now, before sample next. BMI2_OK, or the error reading the sensor time.
+int8_t rtc_anchor_take(struct bmi2_dev *bmi, uint16_t next);
+
+// Take one if RTC_ANCHOR_PERIOD has gone by since the last; for the capture loops
+int8_t rtc_anchor_poll(struct bmi2_dev *bmi, uint16_t next);
+
+uint16_t rtc_anchor_count(void);
+
+const struct rtc_anchor *rtc_anchor_get(uint16_t i);
+
+// Anchor i as its binary record
+void rtc_anchor_pack(uint16_t i, uint8_t out[RTC_ANCHOR_LEN]);
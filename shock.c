@@ -0,0 +1,213 @@
+#include "shock.h"
+#include "autorange.h"
+#include "reattach.h"
+
+// The ODR is the low nibble of ACC_CONF and GYR_CONF, with the same values for both
+#define ODR_MASK 0x0F
+
+#pragma PERSISTENT(events)
+static struct shock_event events[SHOCK_MAX] = { { 0 } };
+#pragma PERSISTENT(num_events)
+static uint16_t num_events = 0;
+
+// ACC_CONF and GYR_CONF as the capture started, and the ODR setting of the bursts
+static uint8_t acc_conf, gyr_conf, burst_odr;
+// Whether a sample has come in under SHOCK_LOW_MG since the last trip
+static uint8_t armed;
+// Samples left in the burst, 0 between them
+static uint16_t left;
+// Whether the ODRs still have to go back to the capture's: a burst has ended, or its start
+// failed part way, and the write hasn't gone through yet
+static uint8_t restore;
+
+// The levels squared, at the range they were last worked out for
+static uint8_t levels_range = 0xFF;
+static uint32_t high2, low2;
+
+// ODR setting for a period in sensor time ticks; each doubles the rate of the one before, and
+// 100 Hz is 256 ticks
+static uint8_t odr_for(uint16_t period) {
+    uint8_t odr = BMI2_ACC_ODR_100HZ;
+
+    for (; period > 256; period >>= 1) {
+        odr -= 1;
+    }
+    for (; period < 256; period <<= 1) {
+        odr += 1;
+    }
+    return odr;
+}
+
+// A level in mg, squared in LSB^2 at ACC_RANGE range, or past anything a sample can reach
+static uint32_t level2(uint16_t mg, uint8_t range) {
+    uint32_t lsb = ((uint32_t)mg << (14 - range)) / 1000;
+
+    return (lsb > 0xFFFF) ? 0xFFFFFFFF : lsb * lsb;
+}
+
+static uint32_t magnitude2(const struct bmi2_sens_axes_data *v) {
+    // Each square is at most 2^30, so the three fit
+    return (uint32_t)((int32_t)v->x * v->x) + (uint32_t)((int32_t)v->y * v->y) +
+           (uint32_t)((int32_t)v->z * v->z);
+}
+
+// Magnitude in mg from its square at ACC_RANGE range; only for the samples over the trip level
+static uint16_t to_mg(uint32_t m2, uint8_t range) {
+    uint32_t root = 0, bit = 1UL << 30;
+
+    while (bit > m2) {
+        bit >>= 2;
+    }
+    for (; bit != 0; bit >>= 2) {
+        if (m2 >= root + bit) {
+            m2 -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+    }
+    // 2 g is 2^14 LSB per g, and each range wider halves it
+    return (uint16_t)((root * 1000) >> (14 - range));
+}
+
+// Into a burst, or back to the registers as they were. reattach() is told, so a recovery
+// leaves the ODRs as they're meant to be.
+static int8_t set_odr(struct bmi2_dev *bmi, uint8_t burst) {
+    uint8_t reg = burst ? (acc_conf & ~ODR_MASK) | burst_odr : acc_conf;
+    int8_t rslt = bmi2_set_regs(BMI2_ACC_CONF_ADDR, &reg, 1, bmi);
+
+    if (rslt == BMI2_OK) {
+        reattach_note(BMI2_ACC_CONF_ADDR, reg);
+        reg = burst ? (gyr_conf & ~ODR_MASK) | burst_odr : gyr_conf;
+        rslt = bmi2_set_regs(BMI2_GYR_CONF_ADDR, &reg, 1, bmi);
+    }
+    if (rslt == BMI2_OK) {
+        reattach_note(BMI2_GYR_CONF_ADDR, reg);
+    }
+    return rslt;
+}
+
+int8_t shock_start(struct bmi2_dev *bmi) {
+    uint8_t regs[3];
+    int8_t rslt;
+
+    // ACC_CONF, ACC_RANGE, GYR_CONF
+    rslt = bmi2_get_regs(BMI2_ACC_CONF_ADDR, regs, sizeof(regs), bmi);
+    if (rslt == BMI2_OK) {
+        acc_conf = regs[0];
+        gyr_conf = regs[2];
+    }
+    burst_odr = odr_for(SHOCK_PERIOD_SENS);
+    num_events = 0;
+    armed = 1;
+    left = 0;
+    restore = 0;
+    return rslt;
+}
+
+int8_t shock_update(struct bmi2_dev *bmi, const struct bmi2_sens_data *data, uint16_t index) {
+    struct shock_event *e;
+    uint8_t range = BMI2_ACC_RANGE_2G;
+    uint32_t m2;
+    uint16_t mg;
+    int8_t rslt;
+
+#if AUTORANGE
+    range = autorange_for(data->sens_time)->acc_range;
+#endif
+    if (range != levels_range) {
+        high2 = level2(SHOCK_HIGH_MG, range);
+        low2 = level2(SHOCK_LOW_MG, range);
+        levels_range = range;
+    }
+
+    m2 = magnitude2(&data->acc);
+    if (m2 < low2) {
+        armed = 1;
+    } else if (armed && m2 >= high2 && (left != 0 || num_events < SHOCK_MAX)) {
+        armed = 0;
+        if (left == 0) {
+            rslt = set_odr(bmi, 1);
+            if (rslt != BMI2_OK) {
+                // ACC_CONF may have gone through
+                restore = 1;
+                return rslt;
+            }
+            restore = 0;
+            e = &events[num_events];
+            e->first = index;
+            e->sens_time = data->sens_time;
+            e->count = 0;
+            e->peak_mg = 0;
+            num_events += 1;
+        }
+        // This sample and the window after it
+        left = SHOCK_WINDOW + 1;
+    }
+    if (left != 0) {
+        e = &events[num_events - 1];
+        e->count += 1;
+        if (m2 >= high2) {
+            mg = to_mg(m2, range);
+            if (mg > e->peak_mg) {
+                e->peak_mg = mg;
+            }
+        }
+        left -= 1;
+        restore = (left == 0);
+    }
+    if (!restore) {
+        return BMI2_OK;
+    }
+
+    // Tried again with each sample until it goes through
+    rslt = set_odr(bmi, 0);
+    if (rslt == BMI2_OK) {
+        restore = 0;
+    }
+    return rslt;
+}
+
+int8_t shock_stop(struct bmi2_dev *bmi) {
+    int8_t rslt;
+
+    if (left == 0 && !restore) {
+        return BMI2_OK;
+    }
+    // The event keeps the samples it got
+    rslt = set_odr(bmi, 0);
+    if (rslt == BMI2_OK) {
+        left = 0;
+        restore = 0;
+    }
+    return rslt;
+}
+
+uint16_t shock_count(void) {
+    return num_events;
+}
+
+const struct shock_event *shock_get(uint16_t i) {
+    return &events[i];
+}
+
+void shock_pack(uint16_t i, uint8_t out[SHOCK_LEN]) {
+    const struct shock_event *e = &events[i];
+    uint8_t k, sum = 0;
+
+    out[0] = SHOCK_SYNC0;
+    out[1] = SHOCK_SYNC1;
+    out[2] = e->first & 0xff;
+    out[3] = e->first >> 8;
+    out[4] = e->sens_time & 0xff;
+    out[5] = (e->sens_time >> 8) & 0xff;
+    out[6] = (e->sens_time >> 16) & 0xff;
+    out[7] = e->count & 0xff;
+    out[8] = e->count >> 8;
+    out[9] = e->peak_mg & 0xff;
+    out[10] = e->peak_mg >> 8;
+    for (k = 0; k < SHOCK_LEN - 1; k += 1) {
+        sum += out[k];
+    }
+    out[11] = ~sum;
+}
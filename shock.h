@@ -0,0 +1,105 @@
+#pragma once
+
+#include <stdint.h>
+#include "BMI270_SensorAPI/bmi2.h"
+
+/*
+Shock detection with burst capture, for SHOCK=1: the capture runs at ODR_HZ, and a knock or a
+drop's landing switches the accel and gyro to SHOCK_ODR_HZ for a window of samples, then back,
+so the shocks come at full rate without streaming at it the whole time.
+
+The capture loop hands shock_update() each sample as it's taken, before CALIB's correction
+(calib.h), and it compares the accel's magnitude squared, x^2 + y^2 + z^2 in LSB^2, with the
+squares of SHOCK_HIGH_MG and SHOCK_LOW_MG at the range the sample was taken at (AUTORANGE's,
+autorange.h, or 2 g), so there's no square root or division per sample. A sample at or over
+SHOCK_HIGH_MG trips it:
+- the ODR fields of ACC_CONF and GYR_CONF are set to SHOCK_ODR_HZ, one write each, the rest of
+  the two registers left as they are,
+- SHOCK_WINDOW samples after it are taken at that rate, and the ODRs then set back (if that
+  write fails, it's tried again with each sample after, and shock_stop() tries once more as the
+  capture ends, cutting short a burst still going),
+- it isn't tripped again until a sample has come in under SHOCK_LOW_MG; trips during the
+  window carry it on for another SHOCK_WINDOW samples rather than starting a new event.
+The range caps what can be seen: at 2 g, an axis can't read over 2000 mg.
+
+The samples from the window go into the capture with the rest, and the events are kept in FRAM
+alongside them, up to SHOCK_MAX per capture (after that it stops tripping). dump_samples()
+sends each ahead of the sample that tripped it as the 12 byte record
+
+  c3 3c first_lo first_hi  sens0 sens1 sens2  count_lo count_hi  peak_lo peak_hi  check
+
+(first: index of the sample that tripped it; sens: its sensor time; count: samples from it to
+the end of the window, so first to first + count - 1, all but the first at SHOCK_ODR_HZ; peak:
+the largest magnitude in the event, in mg; check: the bytes before it summed, complemented),
+or, with DUMP_CSV, a line
+
+  ^, first, sens_time, count, peak_mg
+*/
+
+#ifndef SHOCK
+#define SHOCK 0
+#endif
+
+// Trip and re-arm levels of the accel's magnitude; gravity alone is 1000
+#ifndef SHOCK_HIGH_MG
+#define SHOCK_HIGH_MG 1500
+#endif
+
+#ifndef SHOCK_LOW_MG
+#define SHOCK_LOW_MG 1200
+#endif
+
+// Rate of the bursts, one of the sensor's ODRs
+#ifndef SHOCK_ODR_HZ
+#define SHOCK_ODR_HZ 1600
+#endif
+
+// Samples at SHOCK_ODR_HZ after the one that trips it
+#ifndef SHOCK_WINDOW
+#define SHOCK_WINDOW 160
+#endif
+
+// Events kept per capture
+#ifndef SHOCK_MAX
+#define SHOCK_MAX 16
+#endif
+
+#if SHOCK_LOW_MG >= SHOCK_HIGH_MG
+#error "SHOCK_LOW_MG has to be under SHOCK_HIGH_MG"
+#endif
+
+// Sample period of the bursts in sensor time ticks
+#define SHOCK_PERIOD_SENS (25600 / SHOCK_ODR_HZ)
+
+// Not 0xC3, which sink_stripe resyncs on
+#define SHOCK_SYNC0 0xC7
+#define SHOCK_SYNC1 0x7C
+#define SHOCK_LEN 12
+
+struct shock_event {
+    // Index of the sample that tripped it, and its sensor time, 24 bit
+    uint16_t first;
+    uint32_t sens_time;
+    // Samples from first to the end of the window
+    uint16_t count;
+    // Largest magnitude, mg
+    uint16_t peak_mg;
+};
+
+// Forget the last capture's events and take the sensor's ODRs as the ones to come back to
+int8_t shock_start(struct bmi2_dev *bmi);
+
+// Look at the sample just taken, sample index of the capture, and start or end a burst if it
+// calls for it. BMI2_OK, or the error writing the sensor.
+int8_t shock_update(struct bmi2_dev *bmi, const struct bmi2_sens_data *data, uint16_t index);
+
+// The capture is over: put the ODRs back if a burst is still going or its end didn't get them
+// back. BMI2_OK, or the error writing the sensor.
+int8_t shock_stop(struct bmi2_dev *bmi);
+
+uint16_t shock_count(void);
+
+const struct shock_event *shock_get(uint16_t i);
+
+// Event i as its binary record
+void shock_pack(uint16_t i, uint8_t out[SHOCK_LEN]);
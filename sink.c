@@ -0,0 +1,331 @@
+#include <string.h>
+#include <driverlib.h>
+#include "uart.h"
+#include "aes_stream.h"
+#include "dma_dump.h"
+#include "sink.h"
+
+static uint16_t vec_len(const struct sink_vec *vec, uint8_t n) {
+    uint16_t len = 0;
+    uint8_t i;
+
+    for (i = 0; i < n; i += 1) {
+        len += vec[i].len;
+    }
+    return len;
+}
+
+static void vec_copy(uint8_t *to, const struct sink_vec *vec, uint8_t n) {
+    uint8_t i;
+
+    for (i = 0; i < n; i += 1) {
+        memcpy(to, vec[i].buf, vec[i].len);
+        to += vec[i].len;
+    }
+}
+
+static void no_wait(struct sink *sink) {
+    (void)sink;
+}
+
+uint8_t sink_write(struct sink *const *sinks, uint8_t count, const struct sink_vec *vec, uint8_t n) {
+    uint8_t i, rslt, taken = 0;
+
+    for (i = 0; i < count; i += 1) {
+        while ((rslt = sinks[i]->writev(sinks[i], vec, n)) == SINK_BUSY) {
+            sinks[i]->stats.waits += 1;
+            sinks[i]->wait(sinks[i]);
+        }
+        if (rslt == SINK_OK) {
+            taken += 1;
+        } else {
+            sinks[i]->stats.dropped += 1;
+        }
+    }
+    return taken;
+}
+
+void sink_flush(struct sink *const *sinks, uint8_t count) {
+    uint8_t i;
+
+    for (i = 0; i < count; i += 1) {
+        sinks[i]->flush(sinks[i]);
+    }
+}
+
+static void tally(struct sink *sink, uint16_t len) {
+    sink->stats.records += 1;
+    sink->stats.bytes += len;
+}
+
+// UART: the buffer being filled goes out as soon as the UART is free, so records only pile up
+// while an earlier buffer is being sent
+
+static unsigned char uart_bufs[2][SINK_UART_BUF];
+static uint16_t uart_fill;
+// The buffer being filled; the other one may be going out
+static uint8_t uart_cur;
+
+static void uart_send(void) {
+    if (uart_fill) {
+        uart_write_async(uart_bufs[uart_cur], uart_fill);
+        uart_cur ^= 1;
+        uart_fill = 0;
+    }
+}
+
+static uint8_t uart_writev(struct sink *sink, const struct sink_vec *vec, uint8_t n) {
+    uint16_t len = vec_len(vec, n);
+
+    if (len > SINK_UART_BUF) {
+        return SINK_FULL;
+    }
+    if (uart_fill + len > SINK_UART_BUF) {
+        if (uart_busy()) {
+            return SINK_BUSY;
+        }
+        uart_send();
+    }
+    vec_copy(&uart_bufs[uart_cur][uart_fill], vec, n);
+    uart_fill += len;
+    tally(sink, len);
+
+    if (!uart_busy()) {
+        uart_send();
+    }
+    return SINK_OK;
+}
+
+static void uart_wait(struct sink *sink) {
+    (void)sink;
+    uart_flush();
+}
+
+static void uart_sink_flush(struct sink *sink) {
+    (void)sink;
+    uart_flush();
+    uart_send();
+    uart_flush();
+}
+
+struct sink sink_uart = { "uart", uart_writev, uart_wait, uart_sink_flush, { 0 } };
+
+// Striped: filled buffers go out as frames on whichever of A1 and A0 is free, so the two
+// lanes together carry twice what one would. A third buffer fills while both are sending.
+
+#if SINK_UART_BUF > 255
+#error "sink_stripe's and sink_aes's frames carry their length in a byte"
+#endif
+
+#define STRIPE_BUFS (UART_PORTS + 1)
+#define STRIPE_NONE 0xFF
+
+static unsigned char stripe_bufs[STRIPE_BUFS][SINK_STRIPE_HEADER + SINK_UART_BUF];
+// Payload bytes in the buffer being filled
+static uint16_t stripe_fill;
+static uint8_t stripe_cur;
+static uint16_t stripe_seq;
+// The buffer each lane is sending, or STRIPE_NONE
+static uint8_t stripe_sending[UART_PORTS] = { STRIPE_NONE, STRIPE_NONE };
+
+static uint8_t stripe_free_lane(void) {
+    uint8_t port;
+
+    for (port = 0; port < UART_PORTS; port += 1) {
+        if (!uart_port_busy(port)) {
+            return port;
+        }
+    }
+    return STRIPE_NONE;
+}
+
+// Send the buffer being filled on lane port, and take a buffer neither lane is sending
+static void stripe_send(uint8_t port) {
+    unsigned char *buf = stripe_bufs[stripe_cur];
+    uint8_t other = port ^ 1;
+    uint8_t i;
+
+    buf[0] = SINK_STRIPE_SYNC;
+    buf[1] = stripe_seq & 0xff;
+    buf[2] = stripe_seq >> 8;
+    buf[3] = stripe_fill;
+    uart_port_write_async(port, buf, SINK_STRIPE_HEADER + stripe_fill);
+    stripe_seq += 1;
+    stripe_sending[port] = stripe_cur;
+    if (!uart_port_busy(other)) {
+        stripe_sending[other] = STRIPE_NONE;
+    }
+
+    for (i = 0; i < STRIPE_BUFS; i += 1) {
+        if (i != stripe_sending[0] && i != stripe_sending[1]) {
+            break;
+        }
+    }
+    stripe_cur = i;
+    stripe_fill = 0;
+}
+
+static uint8_t stripe_writev(struct sink *sink, const struct sink_vec *vec, uint8_t n) {
+    uint16_t len = vec_len(vec, n);
+    uint8_t port;
+
+    if (len > SINK_UART_BUF) {
+        return SINK_FULL;
+    }
+    if (stripe_fill + len > SINK_UART_BUF) {
+        port = stripe_free_lane();
+        if (port == STRIPE_NONE) {
+            return SINK_BUSY;
+        }
+        stripe_send(port);
+    }
+    vec_copy(&stripe_bufs[stripe_cur][SINK_STRIPE_HEADER + stripe_fill], vec, n);
+    stripe_fill += len;
+    tally(sink, len);
+
+    port = stripe_free_lane();
+    if (port != STRIPE_NONE) {
+        stripe_send(port);
+    }
+    return SINK_OK;
+}
+
+static void stripe_wait(struct sink *sink) {
+    (void)sink;
+    uart_port_wait_any();
+}
+
+static void stripe_flush(struct sink *sink) {
+    uint8_t port;
+
+    (void)sink;
+    if (stripe_fill) {
+        stripe_send(uart_port_wait_any());
+    }
+    for (port = 0; port < UART_PORTS; port += 1) {
+        uart_port_flush(port);
+    }
+}
+
+struct sink sink_stripe = { "stripe", stripe_writev, stripe_wait, stripe_flush, { 0 } };
+
+// Encrypted: the keystream is made ahead by the AES module, so encrypting is an XOR on the way
+// into the buffer, and the DMA sends one buffer while the next fills. Each frame starts on a
+// fresh keystream block.
+
+static unsigned char aes_bufs[2][SINK_AES_HEADER + SINK_UART_BUF];
+static unsigned char aes_start[SINK_AES_HEADER + AES_STREAM_NONCE];
+// Payload bytes in the buffer being filled
+static uint16_t aes_fill;
+static uint8_t aes_cur;
+static uint8_t aes_started;
+
+static void aes_send(void) {
+    if (aes_fill) {
+        aes_bufs[aes_cur][1] = aes_fill;
+        dma_send_async(aes_bufs[aes_cur], SINK_AES_HEADER + aes_fill);
+        aes_cur ^= 1;
+        aes_fill = 0;
+    }
+}
+
+// Start the keystream, and send the nonce the receiver needs for it
+static void aes_begin(void) {
+    aes_start[0] = SINK_AES_START;
+    aes_start[1] = AES_STREAM_NONCE;
+    aes_start[2] = aes_start[3] = 0;
+    aes_stream_start(&aes_start[SINK_AES_HEADER]);
+    dma_send_async(aes_start, sizeof(aes_start));
+    aes_started = 1;
+}
+
+static uint8_t aes_writev(struct sink *sink, const struct sink_vec *vec, uint8_t n) {
+    uint16_t len = vec_len(vec, n);
+    unsigned char *to;
+    uint32_t block;
+    uint8_t i;
+
+    if (len > SINK_UART_BUF) {
+        return SINK_FULL;
+    }
+    if (!aes_started) {
+        aes_begin();
+    }
+    if (aes_fill + len > SINK_UART_BUF) {
+        if (dma_send_busy()) {
+            return SINK_BUSY;
+        }
+        aes_send();
+    }
+    if (aes_fill == 0) {
+        block = aes_stream_align();
+        aes_bufs[aes_cur][0] = SINK_AES_SYNC;
+        aes_bufs[aes_cur][2] = block & 0xff;
+        aes_bufs[aes_cur][3] = (block >> 8) & 0xff;
+    }
+    to = &aes_bufs[aes_cur][SINK_AES_HEADER + aes_fill];
+    for (i = 0; i < n; i += 1) {
+        aes_stream_xor(to, vec[i].buf, vec[i].len);
+        to += vec[i].len;
+    }
+    aes_fill += len;
+    tally(sink, len);
+
+    if (!dma_send_busy()) {
+        aes_send();
+    }
+    return SINK_OK;
+}
+
+static void aes_wait(struct sink *sink) {
+    (void)sink;
+    dma_send_wait();
+}
+
+static void aes_flush(struct sink *sink) {
+    (void)sink;
+    dma_send_wait();
+    aes_send();
+    dma_send_wait();
+}
+
+struct sink sink_aes = { "aes", aes_writev, aes_wait, aes_flush, { 0 } };
+
+// FRAM
+
+#pragma PERSISTENT(fram_log)
+static uint8_t fram_log[SINK_FRAM_SIZE] = { 0 };
+#pragma PERSISTENT(fram_len)
+static uint32_t fram_len = 0;
+
+static uint8_t fram_writev(struct sink *sink, const struct sink_vec *vec, uint8_t n) {
+    uint16_t len = vec_len(vec, n);
+
+    if (fram_len + len > SINK_FRAM_SIZE) {
+        return SINK_FULL;
+    }
+    vec_copy(&fram_log[fram_len], vec, n);
+    fram_len += len;
+    tally(sink, len);
+    return SINK_OK;
+}
+
+struct sink sink_fram = { "fram", fram_writev, no_wait, no_wait, { 0 } };
+
+const uint8_t *sink_fram_log(uint32_t *len) {
+    *len = fram_len;
+    return fram_log;
+}
+
+void sink_fram_clear(void) {
+    fram_len = 0;
+}
+
+// Null
+
+static uint8_t null_writev(struct sink *sink, const struct sink_vec *vec, uint8_t n) {
+    tally(sink, vec_len(vec, n));
+    return SINK_OK;
+}
+
+struct sink sink_null = { "null", null_writev, no_wait, no_wait, { 0 } };
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+Output sinks: where the sample records go, so the capture loop doesn't care whether they're
+streamed, stored or thrown away.
+
+A record is written as a vector of pieces (a header built on the stack, then the sample fields
+where they lie), and each sink takes all of it or none of it:
+- SINK_OK, it's taken,
+- SINK_BUSY, not yet: the sink is still sending earlier records. sink_write() waits it out with
+  the sink's wait(); a caller with something better to do can call writev() itself and retry,
+- SINK_FULL, never: the sink has no room left, and the record is counted as dropped.
+
+The sinks:
+- sink_uart, EUSCI_A1 without blocking: records are copied into one of two buffers, one
+  filling while the other goes out under the TX interrupt,
+- sink_fram, an append-only log in FRAM (SINK_FRAM_SIZE bytes), which keeps the last run
+  through a reset or power loss; read it back with sink_fram_log(),
+- sink_null, which counts and throws away, to time the capture and formatting without the link,
+- sink_file, a file on the host (host/sink_file.c; bmi270_host -O),
+- sink_stripe, both UARTs at once: records are batched as for sink_uart, and each batch goes
+  out as a frame on whichever of A1 and A0 is free,
+
+  c3 seq_lo seq_hi len  <len bytes of records>
+
+  with seq counting frames across both lanes. host/stripe_merge.c puts the two streams back
+  in order; a frame lost on one lane shows up as a gap in seq.
+- sink_aes, A1 encrypted: records are batched as for sink_uart, encrypted with AES-256 in CTR
+  mode (aes_stream.h) as they're copied in, and each batch goes out by DMA (dma_dump.h) as
+
+  e5 len block_lo block_hi  <len bytes of ciphertext>
+
+  with the frame's keystream starting at block (the low 16 bits of its number), so each frame
+  can be decrypted on its own. The first frame of a boot is
+
+  e6 08 00 00  <the nonce, in the clear>
+
+  host/aes_decrypt.c turns the stream back into what sink_uart would have sent.
+
+OUTPUT_SINKS picks any combination of them for main(), ORing SINK_* together.
+*/
+
+#define SINK_UART 0x01
+#define SINK_FRAM 0x02
+#define SINK_NULL 0x04
+#define SINK_FILE 0x08
+#define SINK_STRIPE 0x10
+#define SINK_AES 0x20
+
+#ifndef OUTPUT_SINKS
+#define OUTPUT_SINKS SINK_UART
+#endif
+
+// Each of sink_uart's two buffers; a record has to fit in one
+#ifndef SINK_UART_BUF
+#define SINK_UART_BUF 64
+#endif
+
+// sink_stripe's frame header
+#define SINK_STRIPE_SYNC 0xC3
+#define SINK_STRIPE_HEADER 4
+
+// sink_aes's frame headers
+#define SINK_AES_SYNC 0xE5
+#define SINK_AES_START 0xE6
+#define SINK_AES_HEADER 4
+
+#ifndef SINK_FRAM_SIZE
+#define SINK_FRAM_SIZE 16384
+#endif
+
+#define SINK_OK 0
+#define SINK_BUSY 1
+#define SINK_FULL 2
+
+struct sink_vec {
+    const void *buf;
+    uint16_t len;
+};
+
+struct sink_stats {
+    uint32_t records;
+    uint32_t bytes;
+    // Times a record had to wait for the sink
+    uint32_t waits;
+    uint32_t dropped;
+};
+
+struct sink {
+    const char *name;
+    // Take the count pieces of one record, all or none; SINK_OK, SINK_BUSY or SINK_FULL
+    uint8_t (*writev)(struct sink *sink, const struct sink_vec *vec, uint8_t count);
+    // Sleep until the sink might take more
+    void (*wait)(struct sink *sink);
+    // Send whatever the sink is holding on to, and wait until it has gone
+    void (*flush)(struct sink *sink);
+    struct sink_stats stats;
+};
+
+extern struct sink sink_uart;
+extern struct sink sink_fram;
+extern struct sink sink_null;
+extern struct sink sink_stripe;
+extern struct sink sink_aes;
+// Host build only
+extern struct sink sink_file;
+
+// Write a record to each of count sinks, waiting for any that are busy. Returns the number
+// of sinks that took it.
+uint8_t sink_write(struct sink *const *sinks, uint8_t count, const struct sink_vec *vec, uint8_t n);
+
+// Flush each of count sinks
+void sink_flush(struct sink *const *sinks, uint8_t count);
+
+// The FRAM log, and its length in bytes
+const uint8_t *sink_fram_log(uint32_t *len);
+
+// Empty the FRAM log
+void sink_fram_clear(void);
@@ -0,0 +1,116 @@
+#include <driverlib.h>
+#include "BMI270_SensorAPI/bmi2.h"
+#include "bmi270_int.h"
+#include "bmi270_spi.h"
+#include "spi_trace.h"
+#include "uart.h"
+
+#if SPI_TRACE
+
+#pragma PERSISTENT(trace)
+static uint8_t trace[SPI_TRACE_SIZE] = { 0 };
+
+// Bytes of trace used, and the records in them
+#pragma PERSISTENT(fill)
+static uint32_t fill = 0;
+#pragma PERSISTENT(count)
+static uint32_t count = 0;
+
+#pragma PERSISTENT(recording)
+static uint8_t recording = 0;
+#pragma PERSISTENT(overflowed)
+static uint8_t overflowed = 0;
+
+// The 32 bit time of the last record, and the timer value it was taken from
+#pragma PERSISTENT(time_us)
+static uint32_t time_us = 0;
+#pragma PERSISTENT(last_tick)
+static uint16_t last_tick = 0;
+
+// Transactions don't nest, so one of each is enough
+static uint16_t begin_tick;
+static uint8_t begin_int1;
+// bmi270_int_edges() as the last transaction started
+static uint16_t last_edges;
+
+static void put_le32(uint8_t *dst, uint32_t val) {
+    dst[0] = val & 0xff;
+    dst[1] = (val >> 8) & 0xff;
+    dst[2] = (val >> 16) & 0xff;
+    dst[3] = (val >> 24) & 0xff;
+}
+
+void spi_trace_start(void) {
+    fill = 0;
+    count = 0;
+    overflowed = 0;
+    time_us = 0;
+    last_tick = Timer_A_getCounterValue(SPI_TIMER_BASE);
+    last_edges = bmi270_int_edges();
+    recording = 1;
+}
+
+void spi_trace_stop(void) {
+    recording = 0;
+}
+
+void spi_trace_begin(void) {
+    uint16_t edges = bmi270_int_edges();
+
+    begin_tick = Timer_A_getCounterValue(SPI_TIMER_BASE);
+    // A data ready pulse is over by the time the read it woke us for starts, so an edge since
+    // the last transaction counts as asserted too
+    begin_int1 = bmi270_int_active() || edges != last_edges;
+    last_edges = edges;
+}
+
+void spi_trace_end(uint8_t reg_addr, uint8_t flags, const uint8_t *payload, uint32_t len) {
+    uint8_t *rec;
+    uint32_t i;
+
+    if (!recording) {
+        return;
+    }
+    if (len > 0xFFFF || SPI_TRACE_SIZE - fill < SPI_TRACE_RECORD_LEN + len) {
+        // Stop rather than leave a hole the replay would trip over
+        overflowed = 1;
+        recording = 0;
+        return;
+    }
+
+    time_us += (uint16_t)(begin_tick - last_tick);
+    last_tick = begin_tick;
+    if (begin_int1) {
+        flags |= SPI_TRACE_INT1;
+    }
+
+    rec = &trace[fill];
+    put_le32(rec, time_us);
+    rec[4] = reg_addr;
+    rec[5] = flags;
+    rec[6] = len & 0xff;
+    rec[7] = (len >> 8) & 0xff;
+    for (i = 0; i < len; i++) {
+        rec[SPI_TRACE_RECORD_LEN + i] = payload[i];
+    }
+    fill += SPI_TRACE_RECORD_LEN + len;
+    count += 1;
+}
+
+void spi_trace_dump(void) {
+    uint8_t header[SPI_TRACE_HEADER_LEN] = { 'S', 'P', 'I', 'T', SPI_TRACE_VERSION };
+    uint32_t sent, chunk;
+
+    header[5] = overflowed ? SPI_TRACE_OVERFLOWED : 0;
+    put_le32(&header[8], fill);
+    put_le32(&header[12], count);
+
+    uart_write(0, header, sizeof(header));
+    // In pieces, as size_t is only 16 bits here
+    for (sent = 0; sent < fill; sent += chunk) {
+        chunk = (fill - sent > 0x4000) ? 0x4000 : fill - sent;
+        uart_write(0, &trace[sent], chunk);
+    }
+}
+
+#endif
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+SPI transaction trace, for replaying a board's exact bus traffic on Linux (see host/replay.c).
+
+With SPI_TRACE set to 1, bmi2_spi_read() and bmi2_spi_write() log every transaction into a
+buffer in FRAM, from spi_trace_start() until the buffer is full; spi_trace_dump() then sends
+it out of the UART. Recording stops rather than wrapping, since a replay has to start from the
+same state the sensor started from. The buffer and its position are persistent, so a trace
+carries on through ACQ_HIBERNATE's resets.
+
+Trace format (all little-endian):
+
+  header   "SPIT", version (1), flags (SPI_TRACE_OVERFLOWED), 2 reserved bytes,
+           uint32 length of the records that follow, in bytes, uint32 record count
+  record   uint32 time (us), uint8 register address, uint8 flags (SPI_TRACE_*),
+           uint16 payload length, payload (the bytes read, or the bytes written)
+
+Times come from the SPI deadline timer (TIMER_A1 at 1 MHz), extended to 32 bits in software.
+SMCLK stops in LPM3/4, so time spent asleep waiting for INT1 doesn't show, and a gap over the
+16 bit timer's 65 ms comes out 65 ms short for each wrap.
+*/
+
+#ifndef SPI_TRACE
+#define SPI_TRACE 0
+#endif
+
+// Bytes of FRAM for records (bmi270_init() alone takes about 9 KB, most of it the config upload)
+#ifndef SPI_TRACE_SIZE
+#define SPI_TRACE_SIZE 16384
+#endif
+
+#define SPI_TRACE_VERSION 1
+#define SPI_TRACE_HEADER_LEN 16
+#define SPI_TRACE_RECORD_LEN 8
+
+// Record flags
+#define SPI_TRACE_READ 0x01
+// INT1 was asserted when the transaction started, or rose since the one before started
+#define SPI_TRACE_INT1 0x02
+// The transaction missed its deadline (the payload is whatever had arrived)
+#define SPI_TRACE_FAILED 0x04
+
+// Header flags
+#define SPI_TRACE_OVERFLOWED 0x01
+
+// Clear the buffer and start recording
+void spi_trace_start(void);
+
+void spi_trace_stop(void);
+
+// Called as a transaction starts: notes the time and whether INT1 is asserted or has risen
+void spi_trace_begin(void);
+
+// Called once it's over, with SPI_TRACE_READ and SPI_TRACE_FAILED as they apply
+void spi_trace_end(uint8_t reg_addr, uint8_t flags, const uint8_t *payload, uint32_t len);
+
+// Send the header and records out of the UART
+void spi_trace_dump(void);
@@ -1,26 +1,200 @@
 #include "uart.h"
+#include "wcet.h"
 
-volatile static const unsigned char* print_buf;
-volatile static size_t print_buf_size;
-volatile static size_t print_buf_idx;
+// A transfer in progress on one of the UARTs
+struct tx {
+    const unsigned char *volatile buf;
+    volatile size_t size;
+    volatile size_t idx;
+    // Set while the main loop sleeps until the transfer ends; nothing else gets woken, as the
+    // SPI driver and the poll scheduler sleep in LPM0 too
+    volatile uint8_t waiting;
+};
+
+static struct tx txs[UART_PORTS];
+static const uint16_t bases[UART_PORTS] = { EUSCI_A1_BASE, EUSCI_A0_BASE };
+
+static uint8_t rx_buf[UART_RX_BUF];
+// Written only by the ISR
+volatile static uint8_t rx_head;
+// Written only by uart_read_line()
+volatile static uint8_t rx_tail;
+// Set while uart_read_line() sleeps until a byte comes in
+volatile static uint8_t rx_waiting;
+
+void uart_init_a0(void) {
+    GPIO_setAsPeripheralModuleFunctionInputPin(GPIO_PORT_P2, GPIO_PIN1, GPIO_PRIMARY_MODULE_FUNCTION);
+    GPIO_setAsPeripheralModuleFunctionOutputPin(GPIO_PORT_P2, GPIO_PIN0, GPIO_PRIMARY_MODULE_FUNCTION);
+
+    // As init_uart() sets up A1
+    EUSCI_A_UART_initParam param = {0};
+    param.selectClockSource = EUSCI_A_UART_CLOCKSOURCE_SMCLK;
+    param.clockPrescalar = 4;  // UCBRx
+    param.firstModReg = 5;  // UCBRFx
+    param.secondModReg = 0x55;  // UCBRSx
+    param.parity = EUSCI_A_UART_NO_PARITY;
+    param.msborLsbFirst = EUSCI_A_UART_LSB_FIRST;
+    param.numberofStopBits = EUSCI_A_UART_ONE_STOP_BIT;
+    param.uartMode = EUSCI_A_UART_MODE;
+    param.overSampling = EUSCI_A_UART_OVERSAMPLING_BAUDRATE_GENERATION; // OS16
+
+    if (STATUS_FAIL == EUSCI_A_UART_init(EUSCI_A0_BASE, &param)) {
+        return;
+    }
+
+    EUSCI_A_UART_enable(EUSCI_A0_BASE);
+}
+
+void uart_port_write_async(uint8_t port, const unsigned char *buf, size_t bufSize) {
+    struct tx *tx = &txs[port];
+
+    if (buf == NULL || bufSize == 0) {
+        return;
+    }
+    uart_port_flush(port);
+
+    tx->size = bufSize;
+    tx->idx = 0;
+    tx->buf = buf;
+    EUSCI_A_UART_enableInterrupt(bases[port], EUSCI_A_UART_TRANSMIT_INTERRUPT);
+}
+
+uint8_t uart_port_busy(uint8_t port) {
+    return txs[port].idx < txs[port].size;
+}
+
+void uart_port_flush(uint8_t port) {
+    struct tx *tx = &txs[port];
+
+    // Interrupts stay off between the check and going to sleep, so the last byte can't slip
+    // in between and leave us asleep
+    __disable_interrupt();
+    while (tx->idx < tx->size) {
+        tx->waiting = 1;
+
+        // Enter LPM0, with interrupts enabled, and wait for transmit interrupt
+        __bis_SR_register(LPM0_bits + GIE);
+        __disable_interrupt();
+    }
+    __enable_interrupt();
+}
+
+uint8_t uart_port_wait_any(void) {
+    uint8_t port, done;
+
+    __disable_interrupt();
+    for (;;) {
+        for (done = 0; done < UART_PORTS; done += 1) {
+            if (txs[done].idx == txs[done].size) {
+                break;
+            }
+        }
+        if (done < UART_PORTS) {
+            // Only the port that finished cleared its flag; the other one's end of transfer
+            // must not wake whatever sleeps in LPM0 next
+            for (port = 0; port < UART_PORTS; port += 1) {
+                txs[port].waiting = 0;
+            }
+            __enable_interrupt();
+            return done;
+        }
+        for (port = 0; port < UART_PORTS; port += 1) {
+            txs[port].waiting = 1;
+        }
+
+        // Enter LPM0, with interrupts enabled, and wait for either transmit interrupt
+        __bis_SR_register(LPM0_bits + GIE);
+        __disable_interrupt();
+    }
+}
+
+void uart_write_async(const unsigned char *buf, size_t bufSize) {
+    uart_port_write_async(UART_A1, buf, bufSize);
+}
+
+uint8_t uart_busy(void) {
+    return uart_port_busy(UART_A1);
+}
+
+void uart_flush(void) {
+    uart_port_flush(UART_A1);
+}
 
 size_t uart_write(int handle, const unsigned char *buf, size_t bufSize) {
-    // while (print_buf_idx < print_buf_size);
     if (buf == NULL) {
         return 0;
     }
 
-    print_buf_size = bufSize;
-    print_buf_idx = 0;
-    print_buf = buf;
-    EUSCI_A_UART_enableInterrupt(EUSCI_A1_BASE, EUSCI_A_UART_TRANSMIT_INTERRUPT);
+    uart_write_async(buf, bufSize);
+    uart_flush();
+
+    return bufSize;
+}
+
+void uart_rx_start(void) {
+    rx_head = rx_tail = 0;
+    EUSCI_A_UART_clearInterrupt(EUSCI_A1_BASE, EUSCI_A_UART_RECEIVE_INTERRUPT_FLAG);
+    EUSCI_A_UART_enableInterrupt(EUSCI_A1_BASE, EUSCI_A_UART_RECEIVE_INTERRUPT);
+}
+
+void uart_rx_stop(void) {
+    EUSCI_A_UART_disableInterrupt(EUSCI_A1_BASE, EUSCI_A_UART_RECEIVE_INTERRUPT);
+}
+
+static uint8_t rx_get(void) {
+    uint8_t byte;
+
+    __disable_interrupt();
+    while (rx_tail == rx_head) {
+        rx_waiting = 1;
+
+        // Enter LPM0, with interrupts enabled, and wait for receive interrupt
+        __bis_SR_register(LPM0_bits + GIE);
+        __disable_interrupt();
+    }
+    __enable_interrupt();
+
+    byte = rx_buf[rx_tail];
+    rx_tail = (rx_tail + 1) % UART_RX_BUF;
+    return byte;
+}
 
-    // Enter LPM0, with interrupts enabled, and wait for transmit interrupt
-    __bis_SR_register(LPM0_bits + GIE);
+size_t uart_read_line(char *buf, size_t size) {
+    size_t len = 0;
+    uint8_t byte;
 
-    EUSCI_A_UART_disableInterrupt(EUSCI_A1_BASE, EUSCI_A_UART_TRANSMIT_INTERRUPT);
+    for (;;) {
+        byte = rx_get();
+        if (byte == '\r' || byte == '\n') {
+            if (len > 0) {
+                break;
+            }
+            continue;
+        }
+        if (len + 1 < size) {
+            buf[len] = byte;
+            len += 1;
+        }
+    }
+    buf[len] = '\0';
+    return len;
+}
 
-    return bufSize;
+// The TX interrupt's work: the next byte, and at the end of the transfer, whether to wake the
+// main loop (the ISR has to leave the LPM itself)
+static inline uint8_t tx_next(uint8_t port) {
+    struct tx *tx = &txs[port];
+
+    EUSCI_A_UART_transmitData(bases[port], tx->buf[tx->idx]);
+    tx->idx += 1;
+    if (tx->idx == tx->size) {
+        EUSCI_A_UART_disableInterrupt(bases[port], EUSCI_A_UART_TRANSMIT_INTERRUPT);
+        if (tx->waiting) {
+            tx->waiting = 0;
+            return 1;
+        }
+    }
+    return 0;
 }
 
 
@@ -32,19 +206,55 @@ __attribute__((interrupt(USCI_A1_VECTOR)))
 #endif
 void EUSCI_A1_ISR(void)
 {
+  WCET_ISR_BEGIN();
+
   switch(__even_in_range(UCA1IV,USCI_UART_UCTXCPTIFG))
   {
     case USCI_NONE: break;
-    case USCI_UART_UCRXIFG: break;
+    case USCI_UART_UCRXIFG:
+        {
+            uint8_t next = (rx_head + 1) % UART_RX_BUF;
+            uint8_t byte = EUSCI_A_UART_receiveData(EUSCI_A1_BASE);
+
+            if (next != rx_tail) {
+                rx_buf[rx_head] = byte;
+                rx_head = next;
+            }
+            if (rx_waiting) {
+                rx_waiting = 0;
+                __bic_SR_register_on_exit(LPM0_bits); // leave low power mode
+            }
+        }
+        break;
     case USCI_UART_UCTXIFG:
-        EUSCI_A_UART_transmitData(EUSCI_A1_BASE,
-                           print_buf[print_buf_idx]);
-        print_buf_idx += 1;
-        if (print_buf_idx == print_buf_size) {
+        if (tx_next(UART_A1)) {
             __bic_SR_register_on_exit(LPM0_bits); // leave low power mode
         }
         break;
     case USCI_UART_UCSTTIFG: break;
     case USCI_UART_UCTXCPTIFG: break;
   }
-}
\ No newline at end of file
+
+  WCET_ISR_END(WCET_EUSCI_A1_ISR);
+}
+
+// Transmit only, for the second lane of sink_stripe. It runs the same code as A1's TX, so
+// A1's bound from the WCET harness covers it.
+#if defined(__TI_COMPILER_VERSION__) || defined(__IAR_SYSTEMS_ICC__)
+#pragma vector=USCI_A0_VECTOR
+__interrupt
+#elif defined(__GNUC__)
+__attribute__((interrupt(USCI_A0_VECTOR)))
+#endif
+void EUSCI_A0_ISR(void)
+{
+  switch(__even_in_range(UCA0IV,USCI_UART_UCTXCPTIFG))
+  {
+    case USCI_UART_UCTXIFG:
+        if (tx_next(UART_A0)) {
+            __bic_SR_register_on_exit(LPM0_bits); // leave low power mode
+        }
+        break;
+    default: break;
+  }
+}
@@ -4,4 +4,44 @@
 #include <stddef.h>
 #include <driverlib.h>
 
-size_t uart_write(int handle, const unsigned char *buf, size_t bufSize);
\ No newline at end of file
+// The UARTs: A1, the LaunchPad's backchannel, which everything goes over, and A0, on P2.0/P2.1,
+// only for the second lane of sink_stripe (sink.h)
+#define UART_A1 0
+#define UART_A0 1
+#define UART_PORTS 2
+
+// Send buf over EUSCI_A1, sleeping until it has all gone to the transmitter
+size_t uart_write(int handle, const unsigned char *buf, size_t bufSize);
+
+// Start sending buf and return straight away. buf has to stay as it is until uart_busy() says
+// it's done; a transfer still in progress is waited out first.
+void uart_write_async(const unsigned char *buf, size_t bufSize);
+
+uint8_t uart_busy(void);
+
+// Sleep until the transfer in progress has gone to the transmitter
+void uart_flush(void);
+
+// Set up EUSCI_A0 as init_uart() does A1 (115200 8N1 from 8 MHz SMCLK)
+void uart_init_a0(void);
+
+// uart_write_async(), uart_busy() and uart_flush() on either UART
+void uart_port_write_async(uint8_t port, const unsigned char *buf, size_t bufSize);
+uint8_t uart_port_busy(uint8_t port);
+void uart_port_flush(uint8_t port);
+
+// Sleep until either UART has finished its transfer, and return that one
+uint8_t uart_port_wait_any(void);
+
+// Bytes received and not yet read; more than this between reads are dropped
+#ifndef UART_RX_BUF
+#define UART_RX_BUF 32
+#endif
+
+// Start (and stop) taking bytes from EUSCI_A1's receiver, under the RX interrupt
+void uart_rx_start(void);
+void uart_rx_stop(void);
+
+// Sleep until a line ending in '\r' or '\n' has come in, and copy it to buf without its ending,
+// NUL-terminated. A line too long for buf is cut short. Empty lines are skipped.
+size_t uart_read_line(char *buf, size_t size);
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <math.h>
 #include "util.h"
 #include "BMI270_SensorAPI/bmi2_defs.h"
 
@@ -189,8 +190,36 @@ void bmi2_error_codes_print_result(char rslt)
                 rslt);
             break;
 
+        case BMI2_E_SCRATCH:
+            printf(
+                "Error [%d] : Scratch arena error. It occurs when the driver needs more temporary memory than " "MEM_SCRATCH_SIZE leaves\r\n",
+                rslt);
+            break;
+
         default:
             printf("Error [%d] : Unknown error code\r\n", rslt);
             break;
     }
+}
+
+/*! Earth's gravity in m/s^2 */
+#define GRAVITY_EARTH  (9.80665f)
+
+/* Conversion helpers from BMI270_SensorAPI examples */
+float lsb_to_mps2(int16_t val, float g_range, uint8_t bit_width)
+{
+    double power = 2;
+
+    float half_scale = (float)((pow((double)power, (double)bit_width) / 2.0f));
+
+    return (GRAVITY_EARTH * val * g_range) / half_scale;
+}
+
+float lsb_to_dps(int16_t val, float dps, uint8_t bit_width)
+{
+    double power = 2;
+
+    float half_scale = (float)((pow((double)power, (double)bit_width) / 2.0f));
+
+    return (dps / (half_scale)) * (val);
 }
\ No newline at end of file
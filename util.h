@@ -1,3 +1,11 @@
 #pragma once
 
-void bmi2_error_codes_print_result(char rslt);
\ No newline at end of file
+#include <stdint.h>
+
+void bmi2_error_codes_print_result(char rslt);
+
+// Accel LSB to m/s^2, at a range of g_range G (2, 4, 8 or 16)
+float lsb_to_mps2(int16_t val, float g_range, uint8_t bit_width);
+
+// Gyro LSB to degrees per second, at a range of dps (125, 250, 500, 1000 or 2000)
+float lsb_to_dps(int16_t val, float dps, uint8_t bit_width);
\ No newline at end of file
@@ -0,0 +1,367 @@
+#include <stdio.h>
+#include <string.h>
+#include "BMI270_SensorAPI/bmi270.h"
+#include "bmi270_spi.h"
+#include "uart.h"
+#include "wcet.h"
+
+#if WCET
+
+// The BMI270's FIFO; every read is a full one, plus the SPI dummy byte
+#define FIFO_SIZE 2048
+// Most samples one read can unpack: accel-only header frames
+#define MAX_SAMPLES (FIFO_SIZE / (1 + BMI2_FIFO_ACC_LENGTH))
+
+// Aux burst at 8 bytes, and headerless frames with all three sensors
+#define AUX_FRM_LEN BMI2_AUX_RD_BURST_FRM_LEN_8
+#define ALL_FRM_LEN (AUX_FRM_LEN + BMI2_FIFO_GYR_LENGTH + BMI2_FIFO_ACC_LENGTH)
+
+// What init_uart() sets up, for the time a byte takes on the wire
+#define UART_BAUD 115200
+
+// Header-mode frames, with the payload lengths the library skips over for each
+static const struct {
+    const char *name;
+    uint8_t header;
+    uint8_t len;
+} kinds[] = {
+    { "all", BMI2_FIFO_HEADER_ALL_FRM, ALL_FRM_LEN },
+    { "gyr+acc", BMI2_FIFO_HEADER_GYR_ACC_FRM, BMI2_FIFO_GYR_LENGTH + BMI2_FIFO_ACC_LENGTH },
+    { "aux+acc", BMI2_FIFO_HEADER_AUX_ACC_FRM, AUX_FRM_LEN + BMI2_FIFO_ACC_LENGTH },
+    { "aux+gyr", BMI2_FIFO_HEADER_AUX_GYR_FRM, AUX_FRM_LEN + BMI2_FIFO_GYR_LENGTH },
+    { "acc", BMI2_FIFO_HEADER_ACC_FRM, BMI2_FIFO_ACC_LENGTH },
+    { "gyr", BMI2_FIFO_HEADER_GYR_FRM, BMI2_FIFO_GYR_LENGTH },
+    { "aux", BMI2_FIFO_HEADER_AUX_FRM, AUX_FRM_LEN },
+    { "sensortime", BMI2_FIFO_HEADER_SENS_TIME_FRM, 3 },
+    { "skip", BMI2_FIFO_HEADER_SKIP_FRM, BMI2_FIFO_SKIP_FRM_LENGTH },
+    { "config", BMI2_FIFO_HEADER_INPUT_CFG_FRM, BMI2_FIFO_INPUT_CFG_LENGTH },
+};
+#define NUM_KINDS (sizeof(kinds) / sizeof(kinds[0]))
+
+// Headerless inputs: every frame real, every frame a dummy, or every other one
+enum headerless { HEADERLESS_VALID, HEADERLESS_DUMMY, HEADERLESS_ALTERNATE, HEADERLESS_COUNT };
+static const char *const headerless_names[HEADERLESS_COUNT] = {
+    "headerless", "headerless dummy", "headerless alternate dummy"
+};
+
+static const char *const isr_names[WCET_ISR_COUNT] = { "USCI_B0_ISR", "EUSCI_A1_ISR" };
+
+// Too big for RAM on the MSP430
+#pragma PERSISTENT(fifo_buf)
+static uint8_t fifo_buf[FIFO_SIZE + 1] = { 0 };
+#pragma PERSISTENT(axes_out)
+static struct bmi2_sens_axes_data axes_out[MAX_SAMPLES] = { { 0 } };
+#pragma PERSISTENT(aux_out)
+static struct bmi2_aux_fifo_data aux_out[MAX_SAMPLES] = { { { 0 } } };
+
+static struct bmi2_dev dev;
+static struct bmi2_fifo_frame fifo;
+static uint32_t rand_state;
+// Cost of a bench_clock_read(), taken off every measurement
+static uint32_t overhead;
+static char line[120];
+
+// What the ISRs are doing at the moment, and the worst each has seen
+static const char *during = "setup";
+static uint16_t during_len;
+static struct {
+    uint32_t calls;
+    uint32_t worst;
+    const char *during;
+    uint16_t during_len;
+} isrs[WCET_ISR_COUNT];
+
+// The worst input for the extractor being timed
+static struct {
+    uint32_t worst;
+    uint16_t bytes;
+    uint16_t samples;
+    char input[32];
+} extract;
+
+void wcet_isr_record(enum wcet_isr isr, uint32_t ticks) {
+    ticks = (ticks > overhead) ? ticks - overhead : 0;
+    isrs[isr].calls += 1;
+    if (ticks > isrs[isr].worst) {
+        isrs[isr].worst = ticks;
+        isrs[isr].during = during;
+        isrs[isr].during_len = during_len;
+    }
+}
+
+static uint8_t next_byte(void) {
+    // xorshift32
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+    return rand_state & 0xff;
+}
+
+static BMI2_INTF_RETURN_TYPE no_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr) {
+    return BMI2_E_COM_FAIL;
+}
+
+static BMI2_INTF_RETURN_TYPE no_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, void *intf_ptr) {
+    return BMI2_E_COM_FAIL;
+}
+
+static void no_delay(uint32_t period, void *intf_ptr) {
+}
+
+static void calibrate(void) {
+    uint32_t start, ticks;
+    uint8_t i;
+
+    overhead = UINT32_MAX;
+    for (i = 0; i < 16; i++) {
+        start = bench_clock_read();
+        ticks = bench_clock_read() - start;
+        if (ticks < overhead) {
+            overhead = ticks;
+        }
+    }
+}
+
+static void init_fifo(uint8_t header) {
+    memset(&fifo, 0, sizeof(fifo));
+    fifo.data = fifo_buf;
+    fifo.length = FIFO_SIZE + 1;
+    fifo.header_enable = header ? (BMI2_FIFO_HEADER_EN >> 8) : 0;
+    fifo.data_enable = BMI2_FIFO_ACC_EN | BMI2_FIFO_GYR_EN | BMI2_FIFO_AUX_EN;
+    fifo.acc_frm_len = BMI2_FIFO_ACC_LENGTH;
+    fifo.gyr_frm_len = BMI2_FIFO_GYR_LENGTH;
+    fifo.aux_frm_len = AUX_FRM_LEN;
+    fifo.acc_gyr_frm_len = BMI2_FIFO_ACC_LENGTH + BMI2_FIFO_GYR_LENGTH;
+    fifo.acc_aux_frm_len = BMI2_FIFO_ACC_LENGTH + AUX_FRM_LEN;
+    fifo.aux_gyr_frm_len = BMI2_FIFO_GYR_LENGTH + AUX_FRM_LEN;
+    fifo.all_frm_len = ALL_FRM_LEN;
+}
+
+/* A full FIFO read in header mode, of nothing but kinds[only], or of random kinds if only is
+negative, padded out with the over-read marker */
+static void fill_header(int8_t only) {
+    uint16_t pos = 0, i;
+    uint8_t k;
+
+    fifo_buf[pos++] = 0;    // SPI dummy byte
+    for (;;) {
+        k = (only >= 0) ? (uint8_t)only : next_byte() % NUM_KINDS;
+        if (pos + 1 + kinds[k].len > FIFO_SIZE + 1) {
+            break;
+        }
+        fifo_buf[pos++] = kinds[k].header;
+        for (i = 0; i < kinds[k].len; i++) {
+            // 0x80 would read as the over-read marker if a frame were misparsed
+            fifo_buf[pos++] = next_byte() | 0x01;
+        }
+    }
+    while (pos < FIFO_SIZE + 1) {
+        fifo_buf[pos++] = BMI2_FIFO_HEAD_OVER_READ_MSB;
+    }
+    init_fifo(1);
+}
+
+/* A full FIFO read in headerless mode, aux then gyro then accel in each frame; a dummy frame
+has the dummy marker in each sensor's slot */
+static void fill_headerless(enum headerless which) {
+    static const uint8_t dummy[] = { 0, BMI2_FIFO_HEADERLESS_DUMMY_BYTE_1, BMI2_FIFO_HEADERLESS_DUMMY_BYTE_2,
+        BMI2_FIFO_HEADERLESS_DUMMY_BYTE_3 };
+    uint16_t pos = 0, frame = 0, i;
+    uint8_t *slot;
+
+    fifo_buf[pos++] = 0;
+    while (pos + ALL_FRM_LEN <= FIFO_SIZE + 1) {
+        slot = &fifo_buf[pos];
+        for (i = 0; i < ALL_FRM_LEN; i++) {
+            fifo_buf[pos++] = next_byte() | 0x01;
+        }
+        if (which == HEADERLESS_DUMMY || (which == HEADERLESS_ALTERNATE && (frame & 1))) {
+            memcpy(slot, dummy, sizeof(dummy));
+            slot[0] = BMI2_FIFO_HEADERLESS_DUMMY_AUX;
+            memcpy(slot + AUX_FRM_LEN, dummy, sizeof(dummy));
+            slot[AUX_FRM_LEN] = BMI2_FIFO_HEADERLESS_DUMMY_GYR;
+            memcpy(slot + AUX_FRM_LEN + BMI2_FIFO_GYR_LENGTH, dummy, sizeof(dummy));
+            slot[AUX_FRM_LEN + BMI2_FIFO_GYR_LENGTH] = BMI2_FIFO_HEADERLESS_DUMMY_ACC;
+        }
+        frame++;
+    }
+    while (pos < FIFO_SIZE + 1) {
+        fifo_buf[pos++] = 0;
+    }
+    init_fifo(0);
+}
+
+static uint16_t extract_accel(void) {
+    uint16_t n = MAX_SAMPLES;
+
+    fifo.acc_byte_start_idx = 0;
+    (void)bmi2_extract_accel(axes_out, &n, &fifo, &dev);
+    return n;
+}
+
+static uint16_t extract_gyro(void) {
+    uint16_t n = MAX_SAMPLES;
+
+    fifo.gyr_byte_start_idx = 0;
+    (void)bmi2_extract_gyro(axes_out, &n, &fifo, &dev);
+    return n;
+}
+
+static uint16_t extract_aux(void) {
+    uint16_t n = MAX_SAMPLES;
+
+    fifo.aux_byte_start_idx = 0;
+    (void)bmi2_extract_aux(aux_out, &n, &fifo, &dev);
+    return n;
+}
+
+// Time one extraction of what's in fifo_buf, keeping it if it's the worst so far
+static void time_input(uint16_t (*once)(void), const char *input, uint16_t seed) {
+    uint32_t start, ticks, best = UINT32_MAX;
+    uint16_t samples = 0;
+    uint8_t rep;
+
+    for (rep = 0; rep < BENCH_REPS; rep++) {
+        start = bench_clock_read();
+        samples = once();
+        ticks = bench_clock_read() - start;
+        if (ticks < best) {
+            best = ticks;
+        }
+    }
+    best = (best > overhead) ? best - overhead : 0;
+
+    if (best > extract.worst) {
+        extract.worst = best;
+        extract.bytes = fifo.length;
+        extract.samples = samples;
+        if (seed) {
+            sprintf(extract.input, "%s %u", input, seed);
+        } else {
+            strcpy(extract.input, input);
+        }
+    }
+}
+
+static uint32_t to_ns(uint32_t ticks) {
+    return (uint32_t)((uint64_t)ticks * 1000000000UL / bench_clock_hz());
+}
+
+static void run_extractor(const char *name, uint16_t (*once)(void), bench_print print) {
+    uint32_t per_byte100;
+    uint16_t seed;
+    uint8_t k, h;
+
+    memset(&extract, 0, sizeof(extract));
+    for (k = 0; k < NUM_KINDS; k++) {
+        rand_state = 1;
+        fill_header((int8_t)k);
+        time_input(once, kinds[k].name, 0);
+    }
+    for (seed = 1; seed <= WCET_SEARCH; seed++) {
+        rand_state = seed;
+        fill_header(-1);
+        time_input(once, "random", seed);
+    }
+    for (h = 0; h < HEADERLESS_COUNT; h++) {
+        rand_state = 1;
+        fill_headerless((enum headerless)h);
+        time_input(once, headerless_names[h], 0);
+    }
+
+    per_byte100 = (uint32_t)((uint64_t)extract.worst * 100 / extract.bytes);
+    sprintf(line, "%s, %s, %u, %u, %lu, %lu, %lu.%02lu", name, extract.input, extract.bytes,
+        extract.samples, (unsigned long)extract.worst, (unsigned long)to_ns(extract.worst),
+        (unsigned long)(per_byte100 / 100), (unsigned long)(per_byte100 % 100));
+    print(line);
+}
+
+// Drive the SPI ISR through reads and writes of every length the firmware uses
+static void exercise_spi(struct bmi2_dev *bmi) {
+    static const uint16_t read_lens[] = { 1, 2, 16, 46, FIFO_SIZE };
+    static const uint16_t write_lens[] = { 1, 2, 16 };
+    uint8_t features[16];
+    uint8_t i;
+
+    during = "read";
+    for (i = 0; i < sizeof(read_lens) / sizeof(read_lens[0]); i++) {
+        during_len = read_lens[i];
+        (void)bmi->read(BMI2_FIFO_DATA_ADDR, fifo_buf, read_lens[i], bmi->intf_ptr);
+    }
+
+    // Writes put back what's there, so nothing changes
+    during = "setup";
+    if (bmi2_get_regs(BMI2_FEATURES_REG_ADDR, features, sizeof(features), bmi) != BMI2_OK) {
+        return;
+    }
+    during = "write";
+    for (i = 0; i < sizeof(write_lens) / sizeof(write_lens[0]); i++) {
+        during_len = write_lens[i];
+        (void)bmi->write(BMI2_FEATURES_REG_ADDR, features, write_lens[i], bmi->intf_ptr);
+        bmi->delay_us(450, bmi->intf_ptr);
+    }
+}
+
+// Drive the UART ISR through writes from one byte up to a whole line; each is a comment line
+static void exercise_uart(void) {
+    static const uint16_t lens[] = { 1, 2, 16, sizeof(line) - 1 };
+    uint8_t i;
+
+    memset(line, '.', sizeof(line) - 1);
+    line[0] = '#';
+    line[1] = ' ';
+    during = "uart";
+    for (i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+        during_len = lens[i];
+        uart_write(0, (const unsigned char *)line, lens[i]);
+        uart_write(0, (const unsigned char *)"\r\n", 2);
+    }
+    during = "report";
+    during_len = 0;
+}
+
+static void report_isr(enum wcet_isr isr, uint32_t wire_ticks, bench_print print) {
+    sprintf(line, "%s, %lu, %lu, %lu, %s %u, %lu", isr_names[isr], (unsigned long)isrs[isr].calls,
+        (unsigned long)isrs[isr].worst, (unsigned long)to_ns(isrs[isr].worst),
+        isrs[isr].during ? isrs[isr].during : "-", isrs[isr].during_len, (unsigned long)wire_ticks);
+    print(line);
+}
+
+void wcet_run(struct bmi2_dev *bmi, bench_print print) {
+    int8_t rslt;
+
+    calibrate();
+    memset(isrs, 0, sizeof(isrs));
+
+    memset(&dev, 0, sizeof(dev));
+    dev.intf = BMI2_SPI_INTF;
+    dev.read = no_read;
+    dev.write = no_write;
+    dev.delay_us = no_delay;
+    dev.dummy_byte = 1;
+    dev.resolution = 16;
+
+    during = "bmi270_init";
+    rslt = bmi270_init(bmi);
+    if (rslt != BMI2_OK) {
+        sprintf(line, "# bmi270_init failed (%d); the SPI ISR is timed on a sensor that isn't set up", rslt);
+        print(line);
+    }
+    exercise_spi(bmi);
+    exercise_uart();
+
+    sprintf(line, "# ticks at %lu Hz, less %lu for the clock read; extractors on a %u byte read,"
+        " best of %u runs, over %u inputs", (unsigned long)bench_clock_hz(), (unsigned long)overhead,
+        FIFO_SIZE + 1, BENCH_REPS, (unsigned)(NUM_KINDS + WCET_SEARCH + HEADERLESS_COUNT));
+    print(line);
+    print("# extractor, worst input, bytes, samples, worst ticks, worst ns, ticks/byte");
+    run_extractor("bmi2_extract_accel", extract_accel, print);
+    run_extractor("bmi2_extract_gyro", extract_gyro, print);
+    run_extractor("bmi2_extract_aux", extract_aux, print);
+
+    print("# isr, calls, worst ticks, worst ns, worst during, wire ticks/byte");
+    report_isr(WCET_USCI_B0_ISR, (uint32_t)((uint64_t)bench_clock_hz() * 8 / SPI_CLOCK_HZ), print);
+    report_isr(WCET_EUSCI_A1_ISR, bench_clock_hz() * 10 / UART_BAUD, print);
+}
+
+#endif
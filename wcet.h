@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+#include "BMI270_SensorAPI/bmi2.h"
+#include "bench.h"
+
+/*
+Worst-case execution times, for the code that has to keep up with the sensor:
+- USCI_B0_ISR (SPI) and EUSCI_A1_ISR (UART), timed on every call by probes at either end of the
+  handler, while wcet_run() drives them through every kind of transfer the firmware does: reads
+  and writes from one byte up to a whole FIFO, and UART lines from one byte up to the longest,
+- bmi2_extract_accel(), _gyro() and _aux() on a full 2 KB FIFO read with all sensors on, over
+  adversarial frame mixes: a FIFO of nothing but one kind of frame for each kind (including
+  skip, input config change and sensor time frames, which carry no samples), seeded random
+  mixes of all of them, and headerless reads with and without dummy frames.
+The extractors are timed once per input, best of BENCH_REPS to keep stray interrupts out; the
+worst input is the one that took longest. The ISR times leave out the hardware entry and exit.
+
+With WCET=1, main() runs wcet_run() instead of capturing samples, with ACQ_POLL's clocks, and
+sends the report over the UART, one CSV line per function:
+
+  isr, calls, worst ticks, worst ns, worst during, wire ticks/byte
+  extractor, worst input, bytes, samples, worst ticks, worst ns, ticks/byte
+
+Ticks come from bench_clock_read() as for the benchmarks: MCLK cycles on the MSP430 (probe
+overhead taken off), host nanoseconds in the host build, where the ISRs run against the
+emulation. The host numbers only rank the inputs; the bounds to design with are the board's.
+*/
+
+#ifndef WCET
+#define WCET 0
+#endif
+
+// Random frame mixes tried per extractor
+#ifndef WCET_SEARCH
+#define WCET_SEARCH 32
+#endif
+
+enum wcet_isr {
+    WCET_USCI_B0_ISR,
+    WCET_EUSCI_A1_ISR,
+    WCET_ISR_COUNT
+};
+
+#if WCET
+#define WCET_ISR_BEGIN() uint32_t wcet_start = bench_clock_read()
+#define WCET_ISR_END(isr) wcet_isr_record((isr), bench_clock_read() - wcet_start)
+#else
+#define WCET_ISR_BEGIN()
+#define WCET_ISR_END(isr)
+#endif
+
+// Keep the worst time seen for isr; called by the probes
+void wcet_isr_record(enum wcet_isr isr, uint32_t ticks);
+
+// Run everything and report. bmi must be set up by init_bmi_device(); the sensor is
+// initialized, and its FIFO and feature registers read and written.
+void wcet_run(struct bmi2_dev *bmi, bench_print print);